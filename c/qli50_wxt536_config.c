@@ -50,6 +50,10 @@ static char Config_Filename[FILENAME_LENGTH] = DEFAULT_FILENAME;
  * @see ../../estar/config/cdocs/estar_config.html#eSTAR_Config_Properties_t
  */
 static eSTAR_Config_Properties_t Config_Properties;
+/**
+ * Whether Config_Properties holds a loaded configuration (which must be destroyed when it is replaced).
+ */
+static int Config_Loaded = FALSE;
 
 /* =======================================================
 ** external functions 
@@ -86,23 +90,30 @@ int Qli50_Wxt536_Config_Filename_Set(char *filename)
 
 /**
  * Routine load the configuration from the Config_Filename into memory, and store in Config_Properties, using
- * eSTAR_Config_Parse_File.
+ * eSTAR_Config_Parse_File. This can be called again to reload the configuration (e.g. when the program is sent
+ * SIGHUP). The file is parsed into a new set of properties, which only replaces Config_Properties 
+ * (the previous properties are destroyed) if the file was parsed successfully, so a reload of a broken 
+ * config file leaves the previous configuration in use.
  * @return The routine returns TRUE on success, and FALSE on failure. 
  *         Qli50_Wxt536_Error_Number / Qli50_Wxt536_Error_String are set on failure. 
  * @see #Config_Filename
  * @see #Config_Properties
+ * @see #Config_Loaded
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
  * @see ../../estar/config/cdocs/estar_config.html#eSTAR_Config_Properties_t
  * @see ../../estar/config/cdocs/estar_config.html#eSTAR_Config_Parse_File
+ * @see ../../estar/config/cdocs/estar_config.html#eSTAR_Config_Destroy_Properties
  * @see ../../estar/config/cdocs/estar_config.html#eSTAR_Config_Error_To_String
  */
 int Qli50_Wxt536_Config_Load(void)
 {
+	eSTAR_Config_Properties_t config_properties;
 	char estar_error_string[512];
 	int retval;
 
-	retval = eSTAR_Config_Parse_File(Config_Filename,&Config_Properties);
+	memset(&config_properties,0,sizeof(eSTAR_Config_Properties_t));
+	retval = eSTAR_Config_Parse_File(Config_Filename,&config_properties);
 	if(retval == FALSE)
 	{
 		eSTAR_Config_Error_To_String(estar_error_string);
@@ -111,6 +122,10 @@ int Qli50_Wxt536_Config_Load(void)
 			estar_error_string);
 		return FALSE;
 	}
+	if(Config_Loaded)
+		eSTAR_Config_Destroy_Properties(Config_Properties);
+	Config_Properties = config_properties;
+	Config_Loaded = TRUE;
 	return TRUE;
 }
 
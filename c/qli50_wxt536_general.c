@@ -58,14 +58,14 @@ struct General_Struct
 
 /* external variables */
 /**
- * The error number.
+ * The error number. This is thread local, so each thread reports it's own errors.
  */
-int Qli50_Wxt536_Error_Number = 0;
+__thread int Qli50_Wxt536_Error_Number = 0;
 /**
- * The error string.
+ * The error string. This is thread local, so each thread reports it's own errors.
  * @see #QLI50_WXT536_ERROR_LENGTH
  */
-char Qli50_Wxt536_Error_String[QLI50_WXT536_ERROR_LENGTH];
+__thread char Qli50_Wxt536_Error_String[QLI50_WXT536_ERROR_LENGTH];
 
 /* internal variables */
 /**
@@ -193,6 +193,7 @@ void Qli50_Wxt536_Current_Time_String_Get(char *time_string,int string_length)
 {
 	struct timespec current_time;
 	struct tm *utc_time = NULL;
+	struct tm utc_time_buffer;
 	char ms_buff[16];
 	int ms;
 
@@ -204,7 +205,7 @@ void Qli50_Wxt536_Current_Time_String_Get(char *time_string,int string_length)
 		return;
 	}
 	clock_gettime(CLOCK_REALTIME,&current_time);
-	utc_time = gmtime(&(current_time.tv_sec));
+	utc_time = gmtime_r(&(current_time.tv_sec),&utc_time_buffer);
 	strftime(time_string,string_length,"%Y-%m-%dT%H:%M:%S",utc_time);
 	/*  add milliseconds to this string */
 	ms = (current_time.tv_nsec/QLI50_WXT536_ONE_MILLISECOND_NS);
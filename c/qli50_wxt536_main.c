@@ -13,6 +13,7 @@
 #include "qli50_wxt536_config.h"
 #include "qli50_wxt536_general.h"
 #include "qli50_wxt536_server.h"
+#include "qli50_wxt536_reactor.h"
 #include "qli50_wxt536_wxt536.h"
 
 /* internal variables */
@@ -41,8 +42,11 @@ static void Help(void);
  * <li>We call Qli50_Wxt536_Config_Load to load the config file.
  * <li>We call Qli50_Wxt536_Logging_Initialise to initialise logging.
  * <li>We call Qli50_Wxt536_Server_Initialise to configure the Qli50 server and open the Qli50 serial line.
- * <li>We call Qli50_Wxt536_Wxt536_Initialise to open a connection to the Vaisala Wxt536 weather station.
- * <li>We call Qli50_Wxt536_Server_Start to start waiting on the Qli50 serial line for Qli50 commands.
+ * <li>We call Qli50_Wxt536_Wxt536_Initialise to read the Wxt536 configuration, and start finding and configuring
+ *     the Vaisala Wxt536 weather station(s) in the background. A slow or absent Wxt536 does not stop the program.
+ * <li>We call Qli50_Wxt536_Reactor_Run to start the event loop, which waits on the Qli50 serial line for 
+ *     Qli50 commands at once, and periodically reads the Wxt536 sensors once they have been configured.
+ *     Sending the program SIGHUP makes the event loop reload the config file.
  * </ul>
  * @param argc The number of arguments to the program.
  * @param argv An array of argument strings.
@@ -52,8 +56,8 @@ static void Help(void);
  * @see qli50_wxt536_general.html#Qli50_Wxt536_General_Error
  * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Load
  * @see qli50_wxt536_server.html#Qli50_Wxt536_Server_Initialise
- * @see qli50_wxt536_server.html#Qli50_Wxt536_Server_Start
  * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Initialise
+ * @see qli50_wxt536_reactor.html#Qli50_Wxt536_Reactor_Run
  */
 int main(int argc, char *argv[])
 {
@@ -80,7 +84,7 @@ int main(int argc, char *argv[])
 		Qli50_Wxt536_Error();
 		return 4;
 	}
-	if(!Qli50_Wxt536_Server_Start())
+	if(!Qli50_Wxt536_Reactor_Run())
 	{
 		Qli50_Wxt536_Error();
 		return 5;
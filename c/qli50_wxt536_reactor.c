@@ -0,0 +1,279 @@
+/* qli50_wxt536_reactor.c
+** Weather monitoring system (qli50 -> wxt536 conversion), event loop multiplexing the Qli50 server and Wxt536
+** serial links.
+*/
+/**
+ * Event loop (reactor) that waits on both the Qli50 server serial link and the Wxt536 serial link using epoll,
+ * and dispatches to the Qli50 server and Wxt536 routines when either becomes readable, or when the Wxt536 polling
+ * state machine needs to run. A single thread can therefore reply to a Qli50 command whilst a Wxt536 data
+ * message request is outstanding. The Qli50 server is served whilst the Wxt536 link startup runs in the background,
+ * the Wxt536 serial link is only waited on once the startup has finished. Sending the program SIGHUP reloads
+ * the config file, without reopening either serial link.
+ * @author Chris Mottram
+ * @version $Revision$
+ */
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199506L
+
+#include <errno.h>   /* Error number definitions */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "qli50_wxt536_config.h"
+#include "qli50_wxt536_general.h"
+#include "qli50_wxt536_reactor.h"
+#include "qli50_wxt536_server.h"
+#include "qli50_wxt536_wxt536.h"
+#include "log_udp.h"
+
+/* defines */
+/**
+ * The maximum number of events returned by one call to epoll_wait. We only wait on three file descriptors.
+ */
+#define MAX_EVENT_COUNT           (3)
+
+/* enums */
+/**
+ * Enumeration identifying which serial link an epoll event is for. This is stored in the event's data.
+ * <ul>
+ * <li><b>REACTOR_SOURCE_QLI50_SERVER</b> The Qli50 server serial link.
+ * <li><b>REACTOR_SOURCE_WXT536</b> The Wxt536 serial link.
+ * <li><b>REACTOR_SOURCE_WXT536_STARTUP</b> The pipe the Wxt536 link startup thread signals when it has finished.
+ * </ul>
+ */
+enum Reactor_Source_Enum
+{
+	REACTOR_SOURCE_QLI50_SERVER=0,REACTOR_SOURCE_WXT536=1,REACTOR_SOURCE_WXT536_STARTUP=2
+};
+
+/* internal variables */
+/**
+ * Revision Control System identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The epoll instance file descriptor, or -1 if the reactor is not running.
+ */
+static int Epoll_Fd = -1;
+/**
+ * Set by Reactor_Signal_Handler when the program is sent SIGHUP, and cleared when the config file is reloaded.
+ */
+static volatile sig_atomic_t Reactor_Reload_Requested = FALSE;
+
+/* internal functions */
+static int Reactor_Fd_Add(int fd,enum Reactor_Source_Enum source);
+static void Reactor_Signal_Handler(int signal_number);
+static int Reactor_Reload(void);
+
+/* =======================================================
+** external functions
+** ======================================================= */
+/**
+ * Run the event loop. Both the Qli50 server and the Wxt536 connection must have been initialised first,
+ * though the Wxt536 link startup may still be running in the background.
+ * <ul>
+ * <li>We create an epoll instance, and add the Qli50 server serial link and Wxt536 startup file descriptors to it.
+ * <li>When the Wxt536 startup file descriptor is readable, we call Qli50_Wxt536_Wxt536_Startup_Finish. 
+ *     If the startup succeeded, we add the Wxt536 serial link file descriptor to the epoll instance. 
+ *     If it failed, the error is reported, and Qli50_Wxt536_Wxt536_Timer runs the startup again later.
+ * <li>We install Reactor_Signal_Handler as the SIGHUP handler, and block SIGHUP except whilst waiting in 
+ *     epoll_pwait, so a SIGHUP received just before waiting still interrupts the wait.
+ * <li>We then loop. If SIGHUP has been received (Reactor_Reload_Requested), and the Wxt536 startup thread is not
+ *     running (it reads the config file), we call Reactor_Reload to reload the config file.
+ *     We call Qli50_Wxt536_Wxt536_Timer to send any Wxt536 data message request due, and to find
+ *     out how long we can wait. We then call epoll_pwait for up to that long, and call Qli50_Wxt536_Server_Read or
+ *     Qli50_Wxt536_Wxt536_Read for each serial link that is readable.
+ * </ul>
+ * Errors from the handlers are reported, and the loop carries on. Normally, this routine does not return.
+ * @return The routine returns FALSE if the event loop cannot be started or epoll_wait fails.
+ *         Qli50_Wxt536_Error_Number and Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #MAX_EVENT_COUNT
+ * @see #Reactor_Source_Enum
+ * @see #Epoll_Fd
+ * @see #Reactor_Fd_Add
+ * @see #Reactor_Reload_Requested
+ * @see #Reactor_Signal_Handler
+ * @see #Reactor_Reload
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_server.html#Qli50_Wxt536_Server_Fd_Get
+ * @see qli50_wxt536_server.html#Qli50_Wxt536_Server_Read
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Startup_Fd_Get
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Startup_Finish
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Startup_Running_Get
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Fd_Get
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Read
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Timer
+ */
+int Qli50_Wxt536_Reactor_Run(void)
+{
+	struct epoll_event event_list[MAX_EVENT_COUNT];
+	struct sigaction signal_action;
+	sigset_t reload_signal_set,wait_signal_set;
+	int event_count,i,timeout_ms,epoll_errno,signal_errno;
+
+	Qli50_Wxt536_Error_Number = 0;
+#if LOGGING > 1
+	Qli50_Wxt536_Log("Reactor","qli50_wxt536_reactor.c",LOG_VERBOSITY_INTERMEDIATE,
+			 "Qli50_Wxt536_Reactor_Run:Started.");
+#endif /* LOGGING */
+	Epoll_Fd = epoll_create(MAX_EVENT_COUNT);
+	if(Epoll_Fd < 0)
+	{
+		epoll_errno = errno;
+		Qli50_Wxt536_Error_Number = 300;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Reactor_Run:epoll_create failed (%d:%s).",
+			epoll_errno,strerror(epoll_errno));
+		return FALSE;
+	}
+	if(!Reactor_Fd_Add(Qli50_Wxt536_Server_Fd_Get(),REACTOR_SOURCE_QLI50_SERVER))
+		return FALSE;
+	if(!Reactor_Fd_Add(Qli50_Wxt536_Wxt536_Startup_Fd_Get(),REACTOR_SOURCE_WXT536_STARTUP))
+		return FALSE;
+	/* reload the config file when sent SIGHUP */
+	memset(&signal_action,0,sizeof(struct sigaction));
+	signal_action.sa_handler = Reactor_Signal_Handler;
+	sigemptyset(&(signal_action.sa_mask));
+	if(sigaction(SIGHUP,&signal_action,NULL) != 0)
+	{
+		signal_errno = errno;
+		Qli50_Wxt536_Error_Number = 303;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Reactor_Run:sigaction failed (%d:%s).",
+			signal_errno,strerror(signal_errno));
+		return FALSE;
+	}
+	/* only deliver SIGHUP whilst waiting, so it cannot arrive between checking for it and waiting */
+	sigemptyset(&reload_signal_set);
+	sigaddset(&reload_signal_set,SIGHUP);
+	signal_errno = pthread_sigmask(SIG_BLOCK,&reload_signal_set,&wait_signal_set);
+	if(signal_errno != 0)
+	{
+		Qli50_Wxt536_Error_Number = 304;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Reactor_Run:pthread_sigmask failed (%d:%s).",
+			signal_errno,strerror(signal_errno));
+		return FALSE;
+	}
+	sigdelset(&wait_signal_set,SIGHUP);
+	while(TRUE)
+	{
+		/* the startup thread reads the config file, so wait for it to finish before reloading it */
+		if(Reactor_Reload_Requested&&(Qli50_Wxt536_Wxt536_Startup_Running_Get() == FALSE))
+		{
+			Reactor_Reload_Requested = FALSE;
+			if(!Reactor_Reload())
+				Qli50_Wxt536_Error();
+		}
+		if(!Qli50_Wxt536_Wxt536_Timer(&timeout_ms))
+			Qli50_Wxt536_Error();
+		event_count = epoll_pwait(Epoll_Fd,event_list,MAX_EVENT_COUNT,timeout_ms,&wait_signal_set);
+		if(event_count < 0)
+		{
+			epoll_errno = errno;
+			if(epoll_errno == EINTR)
+				continue;
+			Qli50_Wxt536_Error_Number = 301;
+			sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Reactor_Run:epoll_pwait failed (%d:%s).",
+				epoll_errno,strerror(epoll_errno));
+			return FALSE;
+		}
+		for(i = 0; i < event_count; i++)
+		{
+			if(event_list[i].data.u32 == REACTOR_SOURCE_QLI50_SERVER)
+			{
+				if(!Qli50_Wxt536_Server_Read())
+					Qli50_Wxt536_Error();
+			}
+			else if(event_list[i].data.u32 == REACTOR_SOURCE_WXT536)
+			{
+				if(!Qli50_Wxt536_Wxt536_Read())
+					Qli50_Wxt536_Error();
+			}
+			else if(event_list[i].data.u32 == REACTOR_SOURCE_WXT536_STARTUP)
+			{
+				if(Qli50_Wxt536_Wxt536_Startup_Finish())
+				{
+					if(!Reactor_Fd_Add(Qli50_Wxt536_Wxt536_Fd_Get(),REACTOR_SOURCE_WXT536))
+						Qli50_Wxt536_Error();
+				}
+				else
+					Qli50_Wxt536_Error();
+			}
+		}
+	}
+	return TRUE;
+}
+
+/* =======================================================
+** internal functions
+** ======================================================= */
+/**
+ * Add a file descriptor to the epoll instance, waiting for it to become readable.
+ * @param fd The file descriptor to add.
+ * @param source Which serial link the file descriptor is for, stored in the event data.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Epoll_Fd
+ * @see #Reactor_Source_Enum
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+static int Reactor_Fd_Add(int fd,enum Reactor_Source_Enum source)
+{
+	struct epoll_event event;
+	int epoll_errno;
+
+	memset(&event,0,sizeof(struct epoll_event));
+	event.events = EPOLLIN;
+	event.data.u32 = source;
+	if(epoll_ctl(Epoll_Fd,EPOLL_CTL_ADD,fd,&event) != 0)
+	{
+		epoll_errno = errno;
+		Qli50_Wxt536_Error_Number = 302;
+		sprintf(Qli50_Wxt536_Error_String,"Reactor_Fd_Add:epoll_ctl failed to add fd %d for source %d (%d:%s).",
+			fd,source,epoll_errno,strerror(epoll_errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Signal handler for SIGHUP. This just sets Reactor_Reload_Requested, the config file is reloaded by the event loop.
+ * @param signal_number The signal received.
+ * @see #Reactor_Reload_Requested
+ */
+static void Reactor_Signal_Handler(int signal_number)
+{
+	Reactor_Reload_Requested = TRUE;
+}
+
+/**
+ * Reload the config file. We call Qli50_Wxt536_Config_Load to parse the config file again (if it cannot be parsed,
+ * the previous configuration is kept), and Qli50_Wxt536_Wxt536_Reload to apply the Wxt536 settings that have 
+ * changed. Neither serial link is reopened.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Load
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Reload
+ */
+static int Reactor_Reload(void)
+{
+#if LOGGING > 1
+	Qli50_Wxt536_Log("Reactor","qli50_wxt536_reactor.c",LOG_VERBOSITY_INTERMEDIATE,
+			 "Reactor_Reload:Reloading the config file.");
+#endif /* LOGGING */
+	if(!Qli50_Wxt536_Config_Load())
+		return FALSE;
+	if(!Qli50_Wxt536_Wxt536_Reload())
+		return FALSE;
+	return TRUE;
+}
@@ -20,12 +20,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "qli50_wxt536_config.h"
 #include "qli50_wxt536_general.h"
 #include "qli50_wxt536_server.h"
 #include "qli50_wxt536_wxt536.h"
+#include "wms_qli50_command.h"
 #include "wms_qli50_connection.h"
 #include "wms_qli50_server.h"
+#include "wms_serial_general.h"
+#include "wms_serial_serial.h"
 #include "log_udp.h"
 
 /* defines */
@@ -43,44 +47,81 @@ static char rcsid[] = "$Id$";
  * The filename used to store the serial device filename to connect the server code to.
  */
 static char Serial_Device_Filename[FILENAME_LENGTH];
+/**
+ * When (CLOCK_MONOTONIC) Qli50_Wxt536_Server_Initialise was called, used to measure the time to the first
+ * 'Send Results' reply.
+ */
+static struct timespec Server_Start_Time;
+/**
+ * A boolean, set TRUE when the first 'Send Results' command is received. Qli50_Wxt536_Server_Read then logs how 
+ * long after startup the reply was sent.
+ */
+static int Server_First_Reply_Pending = FALSE;
+/**
+ * A boolean, set TRUE once the time to the first 'Send Results' reply has been logged.
+ */
+static int Server_First_Reply_Sent = FALSE;
 
 /* internal functions */
 static void Server_Read_Sensor_Callback(char qli_id,char seq_id);
 static void Server_Send_Result_Callback(char qli_id,char seq_id,struct Wms_Qli50_Data_Struct *data);
+static unsigned int Server_Send_Result_Generation_Callback(char qli_id);
 static void Server_Par_Callback(char *return_parameter_string,int return_parameter_string_length);
 static void Server_Sta_Callback(char *return_string,int return_string_length);
+static int Server_Command_Wxt536(char *class,char *source,char *command_string);
+static void Server_Wxt536_Reply_Callback(char *reply_string);
 
 /* =======================================================
 ** external functions 
 ** ======================================================= */
 /**
- * Read the serial device filename from config, and then setup a connection to it. Also setup the server callbacks.
+ * Read the serial device filename from config, and then setup a connection to it. Also setup the server callbacks,
+ * and register the 'WXT' engineering command (Server_Command_Wxt536).
  * The configuration file must have previously been read, before calling this routine.
+ * The time is saved in Server_Start_Time, to measure the time to the first 'Send Results' reply.
  * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
  *         Qli50_Wxt536_Error_String will be set with a suitable error.
  * @see #FILENAME_LENGTH
  * @see #Serial_Device_Filename
+ * @see #Server_Start_Time
  * @see #Server_Read_Sensor_Callback
  * @see #Server_Send_Result_Callback
+ * @see #Server_Send_Result_Generation_Callback
  * @see #Server_Par_Callback
  * @see #Server_Sta_Callback
+ * @see #Server_Command_Wxt536
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
  * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_String_Get
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Int_Get
+ * @see ../qli50/cdocs/wms_qli50_connection.html#Wms_Qli50_Connection_Read_Timeout_Set
  * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Set_Read_Sensor_Callback
  * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Set_Send_Result_Callback
+ * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Set_Send_Result_Generation_Callback
  * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Set_Par_Callback
  * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Set_Sta_Callback
+ * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Command_Register
  * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Start
  */
 int Qli50_Wxt536_Server_Initialise(void)
 {
-	int retval;
+	int retval,read_timeout;
 
 	Qli50_Wxt536_Error_Number = 0;
+	clock_gettime(CLOCK_MONOTONIC,&Server_Start_Time);
 	/* get the serial device filename from config */
 	if(!Qli50_Wxt536_Config_String_Get("qli50.serial_device.name",Serial_Device_Filename,FILENAME_LENGTH))
 		return FALSE;
+	/* get how long the server waits for a command from the serial link */
+	if(!Qli50_Wxt536_Config_Int_Get("qli50.serial_device.read_timeout",&read_timeout))
+		return FALSE;
+	if(!Wms_Qli50_Connection_Read_Timeout_Set(read_timeout))
+	{
+		Qli50_Wxt536_Error_Number = 106;
+		sprintf(Qli50_Wxt536_Error_String,
+			"Qli50_Wxt536_Server_Initialise:Wms_Qli50_Connection_Read_Timeout_Set(%d) failed.",read_timeout);
+		return FALSE;
+	}
 	/* setup server callbacks */
 	if(!Wms_Qli50_Server_Set_Read_Sensor_Callback("Server","qli50_wxt536_server.c",Server_Read_Sensor_Callback))
 	{
@@ -96,6 +137,14 @@ int Qli50_Wxt536_Server_Initialise(void)
 			"Qli50_Wxt536_Server_Initialise:failed to set send result callback.");		
 		return FALSE;
 	}
+	if(!Wms_Qli50_Server_Set_Send_Result_Generation_Callback("Server","qli50_wxt536_server.c",
+								  Server_Send_Result_Generation_Callback))
+	{
+		Qli50_Wxt536_Error_Number = 107;
+		sprintf(Qli50_Wxt536_Error_String,
+			"Qli50_Wxt536_Server_Initialise:failed to set send result generation callback.");
+		return FALSE;
+	}
 	if(!Wms_Qli50_Server_Set_Par_Callback("Server","qli50_wxt536_server.c",Server_Par_Callback))
 	{
 		Qli50_Wxt536_Error_Number = 102;
@@ -110,6 +159,13 @@ int Qli50_Wxt536_Server_Initialise(void)
 			"Qli50_Wxt536_Server_Initialise:failed to set sta callback.");		
 		return FALSE;
 	}
+	if(!Wms_Qli50_Server_Command_Register("Server","qli50_wxt536_server.c","WXT",Server_Command_Wxt536))
+	{
+		Qli50_Wxt536_Error_Number = 108;
+		sprintf(Qli50_Wxt536_Error_String,
+			"Qli50_Wxt536_Server_Initialise:failed to register WXT command.");
+		return FALSE;
+	}
 	/* start the Qli50 server. This just opens the serial connection and configures it.
 	** It does not start the loop */
 	retval = Wms_Qli50_Server_Start("Server","qli50_wxt536_server.c",Serial_Device_Filename);
@@ -125,26 +181,51 @@ int Qli50_Wxt536_Server_Initialise(void)
 }
 
 /**
- * Routine to start the server loop, which reads Qli50 commands and processes them. Normally, this routine
- * does not return.
- * @return The routine nominally returns TRUE on sucess and FALSE on failure. In reality, the routine enters
- *         a loop that should never terminate.
+ * Return the file descriptor of the server's serial link, so an event loop can wait for it to become readable.
+ * Qli50_Wxt536_Server_Initialise must have been called first, to open the connection.
+ * @return The file descriptor of the Qli50 server serial link.
+ * @see ../qli50/cdocs/wms_qli50_connection.html#Wms_Qli50_Connection_Handle_Get
+ */
+int Qli50_Wxt536_Server_Fd_Get(void)
+{
+	return Wms_Qli50_Connection_Handle_Get()->Serial_Fd;
+}
+
+/**
+ * Routine to read and process any Qli50 commands received on the server's serial link, without waiting. 
+ * This should be called when the server's serial link is readable. When the first 'Send Results' reply has been 
+ * sent, we log how long it was since Qli50_Wxt536_Server_Initialise was called (the time to first reply).
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Server_Start_Time
+ * @see #Server_First_Reply_Pending
+ * @see #Server_First_Reply_Sent
+ * @see qli50_wxt536_general.html#fdifftime
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
- * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Loop
+ * @see ../qli50/cdocs/wms_qli50_server.html#Wms_Qli50_Server_Process_Input
  */
-int Qli50_Wxt536_Server_Start(void)
+int Qli50_Wxt536_Server_Read(void)
 {
-	int retval;
-	
+	struct timespec current_time;
+
 	Qli50_Wxt536_Error_Number = 0;
-	retval = Wms_Qli50_Server_Loop("Server","qli50_wxt536_server.c");
-	if(retval == FALSE)
+	if(!Wms_Qli50_Server_Process_Input("Server","qli50_wxt536_server.c"))
 	{
 		Qli50_Wxt536_Error_Number = 105;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Server_Start:Wms_Qli50_Server_Loop failed.");		
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Server_Read:Wms_Qli50_Server_Process_Input failed.");
 		return FALSE;
 	}
+	if(Server_First_Reply_Pending&&(Server_First_Reply_Sent == FALSE))
+	{
+		clock_gettime(CLOCK_MONOTONIC,&current_time);
+		Server_First_Reply_Sent = TRUE;
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Server","qli50_wxt536_server.c",LOG_VERBOSITY_TERSE,
+					"Qli50_Wxt536_Server_Read:First Send Results reply sent %.3f s after startup.",
+					fdifftime(current_time,Server_Start_Time));
+#endif /* LOGGING */
+	}
 	return TRUE;
 }
 
@@ -153,12 +234,12 @@ int Qli50_Wxt536_Server_Start(void)
 ** ======================================================= */
 /**
  * This routine should get called by the server loop when a 'Read Sensor' command is read from the server's serial
- * link. We call Qli50_Wxt536_Wxt536_Read_Sensors to tell the Wxt536 weather station to read it's sensors.
+ * link. The Wxt536 sensors are read continuously by the reactor, so there is nothing to do here:
+ * the subsequent 'Send Result' command returns a snapshot of the latest polled data.
  * @param qli_id A single character, representing the QLI Id of the Qli50 that is required to read it's sensors.
  * @param seq_id A single character, representing the QLI50 sequence id of the set of readings 
  *        the QLI50 is meant to take.
- * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Read_Sensors
- * @see qli50_wxt536_general.html#Qli50_Wxt536_Error
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Timer
  */
 static void Server_Read_Sensor_Callback(char qli_id,char seq_id)
 {
@@ -168,10 +249,6 @@ static void Server_Read_Sensor_Callback(char qli_id,char seq_id)
 				"Server_Read_Sensor_Callback invoked with qli_id '%c' and seq_id '%c'.",
 				qli_id,seq_id);
 #endif /* LOGGING */
-	if(!Qli50_Wxt536_Wxt536_Read_Sensors(qli_id,seq_id))
-	{
-		Qli50_Wxt536_Error();
-	}
 }
 
 /**
@@ -198,6 +275,22 @@ static void Server_Send_Result_Callback(char qli_id,char seq_id,struct Wms_Qli50
 	}
 }
 
+/**
+ * This routine gets called by the server loop when a 'Send Result' command is read from the server's serial
+ * link, to find out whether the data Server_Send_Result_Callback would return has changed since the last reply
+ * was formatted.
+ * As it is called for every 'Send Result' command, we also use it to note the first reply is being sent.
+ * @param qli_id A single character, representing the QLI Id of the Qli50 that is required to send it's results.
+ * @return The generation of the data, from Qli50_Wxt536_Wxt536_Send_Results_Generation_Get.
+ * @see #Server_First_Reply_Pending
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Send_Results_Generation_Get
+ */
+static unsigned int Server_Send_Result_Generation_Callback(char qli_id)
+{
+	Server_First_Reply_Pending = TRUE;
+	return Qli50_Wxt536_Wxt536_Send_Results_Generation_Get(qli_id);
+}
+
 /**
  * This routine should get called by the server loop when a 'PAR' command is read from the server's serial
  * link.
@@ -231,3 +324,75 @@ static void Server_Sta_Callback(char *return_string,int return_string_length)
 #endif /* LOGGING */
 	strcpy(return_string,"STATUS");
 }
+
+/**
+ * Handler for the 'WXT' engineering command, of the form "WXT &lt;wxt536 command&gt;" e.g. "WXT 0XU".
+ * This lets engineering tools send commands to the Wxt536s through the Qli50 serial link, whilst the Wxt536s
+ * are being polled. The Wxt536 command is queued using Qli50_Wxt536_Wxt536_Engineering_Command_Queue, and sent
+ * when the serial link to the Wxt536s is free. The reply is sent back by Server_Wxt536_Reply_Callback.
+ * If the command cannot be queued, we reply "WXT ERROR" at once.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE, errors are reported using Qli50_Wxt536_Error.
+ * @see #Server_Wxt536_Reply_Callback
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_wxt536.html#Qli50_Wxt536_Wxt536_Engineering_Command_Queue
+ */
+static int Server_Command_Wxt536(char *class,char *source,char *command_string)
+{
+	char wxt536_command_string[256];
+	int retval;
+
+	Qli50_Wxt536_Error_Number = 0;
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Server","qli50_wxt536_server.c",LOG_VERBOSITY_TERSE,
+				"Server_Command_Wxt536 invoked with '%s'.",command_string);
+#endif /* LOGGING */
+	retval = sscanf(command_string,"WXT %255s",wxt536_command_string);
+	if(retval != 1)
+	{
+		Qli50_Wxt536_Error_Number = 109;
+		sprintf(Qli50_Wxt536_Error_String,"Server_Command_Wxt536:Failed to parse WXT command '%s' (%d).",
+			command_string,retval);
+		Qli50_Wxt536_Error();
+		Server_Wxt536_Reply_Callback(NULL);
+		return TRUE;
+	}
+	if(!Qli50_Wxt536_Wxt536_Engineering_Command_Queue(wxt536_command_string,Server_Wxt536_Reply_Callback))
+	{
+		Qli50_Wxt536_Error();
+		Server_Wxt536_Reply_Callback(NULL);
+	}
+	return TRUE;
+}
+
+/**
+ * Routine called with the reply to a Wxt536 command queued by Server_Command_Wxt536. We send the reply back
+ * over the server's serial link as "WXT &lt;reply&gt;", or "WXT ERROR" if no reply was received.
+ * @param reply_string The reply from the Wxt536, or NULL if the command failed.
+ * @see #Server_Command_Wxt536
+ * @see ../qli50/cdocs/wms_qli50_connection.html#Wms_Qli50_Connection_Handle_Get
+ * @see ../serial/cdocs/wms_serial_serial.html#Wms_Serial_Write
+ * @see ../serial/cdocs/wms_serial_general.html#Wms_Serial_Error
+ */
+static void Server_Wxt536_Reply_Callback(char *reply_string)
+{
+	char reply_message_string[512];
+
+	if(reply_string != NULL)
+		sprintf(reply_message_string,"WXT %.255s%s",reply_string,TERMINATOR_CR);
+	else
+		sprintf(reply_message_string,"WXT ERROR%s",TERMINATOR_CR);
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Server","qli50_wxt536_server.c",LOG_VERBOSITY_TERSE,
+				"Server_Wxt536_Reply_Callback:Replying '%s'.",reply_message_string);
+#endif /* LOGGING */
+	if(!Wms_Serial_Write("Server","qli50_wxt536_server.c",Wms_Qli50_Connection_Handle_Get(),reply_message_string,
+			     strlen(reply_message_string)))
+	{
+		Wms_Serial_Error();
+	}
+}
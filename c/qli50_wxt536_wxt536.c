@@ -11,22 +11,29 @@
  */
 #define _POSIX_SOURCE 1
 /**
- * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ * This hash define is needed before including source files give us POSIX.1c/IEEE1003.1c-1995 (pthread) prototypes.
  */
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 199506L
 
 #include <errno.h>   /* Error number definitions */
+#include <fcntl.h>
 #include <math.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "qli50_wxt536_config.h"
 #include "qli50_wxt536_general.h"
 #include "qli50_wxt536_wxt536.h"
 #include "wms_qli50_command.h"
 #include "wms_wxt536_command.h"
 #include "wms_wxt536_connection.h"
+#include "wms_wxt536_general.h"
 #include "log_udp.h"
 
 /* defines */
@@ -34,6 +41,59 @@
  * How long the string holding the serial device name is.
  */
 #define FILENAME_LENGTH           (256)
+/**
+ * The maximum number of Wxt536s that can share the serial link (one per possible device address).
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#WXT536_COMMAND_DEVICE_ADDRESS_COUNT
+ */
+#define DEVICE_COUNT_MAX              (WXT536_COMMAND_DEVICE_ADDRESS_COUNT)
+/**
+ * The number of priority classes in the Wxt536 command queue.
+ * @see #Wxt536_Queue_Priority_Enum
+ */
+#define QUEUE_PRIORITY_COUNT          (4)
+/**
+ * The maximum number of commands waiting in each priority class of the Wxt536 command queue.
+ * Each data message request is queued at most once per Wxt536, and no priority class contains more than two
+ * data groups.
+ */
+#define QUEUE_LENGTH                  (2*DEVICE_COUNT_MAX)
+/**
+ * How long the string holding a queued command can be.
+ */
+#define QUEUE_COMMAND_LENGTH          (256)
+/**
+ * The number of individually polled data groups (data messages aR1 to aR5).
+ * @see #Wxt536_Message_Group_Enum
+ */
+#define MESSAGE_GROUP_COUNT           (5)
+/**
+ * The baud rate the Wxt536 serial link is opened at, and the Wxt536's factory default baud rate.
+ */
+#define BAUD_RATE_DEFAULT             (19200)
+/**
+ * The maximum number of baud rates in the "wxt536.baud_rate.list" config keyword.
+ */
+#define BAUD_RATE_COUNT_MAX           (8)
+/**
+ * How long to wait after changing the serial settings, before checking the Wxt536s reply with the new settings,
+ * in milliseconds.
+ */
+#define BAUD_RATE_SETTLE_TIME         (100)
+/**
+ * How close a setting read from a Wxt536 must be to the configured value for Wxt536_Device_Initialise 
+ * not to write it again. This matches the tolerance the wxt536 library uses to check a setting was written.
+ */
+#define SETTING_TOLERANCE             (0.1)
+/**
+ * A number stored at the start of the warm start snapshot file, to check it is one.
+ * @see #Wxt536_Snapshot_File_Struct
+ */
+#define SNAPSHOT_FILE_MAGIC           (0x57785336)
+/**
+ * The version of the warm start snapshot file layout.
+ * @see #Wxt536_Snapshot_File_Struct
+ */
+#define SNAPSHOT_FILE_VERSION         (1)
 
 /* enums */
 /**
@@ -49,26 +109,87 @@ enum Sensor_Type_Enum
 	SENSOR_TYPE_NONE, SENSOR_TYPE_WXT536, SENSOR_TYPE_DRD11A
 };
 
+/**
+ * The priority classes of the Wxt536 command queue, highest priority first. One of:
+ * <ul>
+ * <li>QUEUE_PRIORITY_WETNESS - The precipitation (aR3) and analogue (aR4, which includes the DRD11A wetness sensor)
+ *     data messages, which drive dome closure decisions, and the composite data message (aR0) that contains them.
+ * <li>QUEUE_PRIORITY_MEASUREMENT - The wind (aR1) and pressure/temperature/humidity (aR2) data messages.
+ * <li>QUEUE_PRIORITY_ENGINEERING - Engineering commands, queued by Qli50_Wxt536_Wxt536_Engineering_Command_Queue.
+ * <li>QUEUE_PRIORITY_HOUSEKEEPING - The supervisor (aR5) data message.
+ * </ul>
+ * @see #QUEUE_PRIORITY_COUNT
+ */
+enum Wxt536_Queue_Priority_Enum
+{
+	QUEUE_PRIORITY_WETNESS=0, QUEUE_PRIORITY_MEASUREMENT=1, QUEUE_PRIORITY_ENGINEERING=2,
+	QUEUE_PRIORITY_HOUSEKEEPING=3
+};
+
+/**
+ * The individually polled data groups, indexed by data message id minus one. One of:
+ * <ul>
+ * <li>MESSAGE_GROUP_WIND - The wind data (aR1).
+ * <li>MESSAGE_GROUP_PTH - The pressure/temperature/humidity data (aR2).
+ * <li>MESSAGE_GROUP_PRECIPITATION - The precipitation data (aR3).
+ * <li>MESSAGE_GROUP_ANALOGUE - The analogue data (aR4).
+ * <li>MESSAGE_GROUP_SUPERVISOR - The supervisor data (aR5).
+ * </ul>
+ * @see #MESSAGE_GROUP_COUNT
+ * @see #Wxt536_Message_Group_List
+ */
+enum Wxt536_Message_Group_Enum
+{
+	MESSAGE_GROUP_WIND=0, MESSAGE_GROUP_PTH=1, MESSAGE_GROUP_PRECIPITATION=2, MESSAGE_GROUP_ANALOGUE=3,
+	MESSAGE_GROUP_SUPERVISOR=4
+};
+
+/**
+ * The state of the serial link to one Wxt536, as seen by the link supervisor. One of:
+ * <ul>
+ * <li>LINK_STATE_CONNECTED - The Wxt536 is replying to it's data message requests.
+ * <li>LINK_STATE_DEGRADED - Some recent data message requests have failed, but fewer than 
+ *     Wxt536_Link_Failure_Limit in a row. The Wxt536 is still polled as normal.
+ * <li>LINK_STATE_PROBING - Wxt536_Link_Failure_Limit data message requests in a row have failed. The Wxt536 is 
+ *     no longer polled, instead an acknowledge active command is sent to it's cached device address, 
+ *     with an exponential backoff between attempts.
+ * <li>LINK_STATE_REINITIALISING - The Wxt536 has acknowledged a probe, and it's configuration is being checked 
+ *     before polling resumes. If it has lost it's configuration, the serial link startup is run again.
+ * </ul>
+ * @see #Wxt536_Link_State_Name_List
+ * @see #Wxt536_Link_Failure_Limit
+ */
+enum Wxt536_Link_State_Enum
+{
+	LINK_STATE_CONNECTED=0, LINK_STATE_DEGRADED=1, LINK_STATE_PROBING=2, LINK_STATE_REINITIALISING=3
+};
+
 /* internal structures */
 /**
- * Structure containing weather and system data read by the Wxt536, along with a timestamp describing when the 
- * values were last updated.
+ * Structure containing weather and system data read by the Wxt536, along with timestamps describing when each 
+ * field was last updated with a valid value. The Wxt536 can report individual fields as invalid, so each field
+ * goes out of date on it's own.
  * <dl>
  * <dt>Wind_Data</dt> <dd>An instance of Wxt536_Command_Wind_Data_Struct containg the read wind data.</dd>
- * <dt>Wind_Timestamp</dt> <dd>A timestamp indicating when the last successful wind data was read.</dd>
+ * <dt>Wind_Timestamp</dt> <dd>A list of timestamps, indexed by Wxt536_Command_Wind_Field_Enum, indicating when
+ *                             each wind field was last successfully read.</dd>
  * <dt>Pressure_Temp_Humidity_Data</dt> <dd>An instance of Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct 
  *                                containg pressure, temperature and humidity data from the Wxt536.</dd>
- * <dt>Pressure_Temp_Humidity_Timestamp</dt> <dd>A timestamp indicating when the last successful 
- *                                pressure/temperature/humidity data was read.</dd>
+ * <dt>Pressure_Temp_Humidity_Timestamp</dt> <dd>A list of timestamps, indexed by 
+ *                                Wxt536_Command_Pressure_Temperature_Humidity_Field_Enum, indicating when each 
+ *                                pressure/temperature/humidity field was last successfully read.</dd>
  * <dt>Rain_Data</dt> <dd>An instance of Wxt536_Command_Precipitation_Data_Struct containing the read rain data 
  *                        from the Wxt536.</dd>
- * <dt>Rain_Timestamp</dt> <dd>A timestamp indicating when the last successful rain data was read.</dd>
+ * <dt>Rain_Timestamp</dt> <dd>A list of timestamps, indexed by Wxt536_Command_Precipitation_Field_Enum, 
+ *                             indicating when each rain field was last successfully read.</dd>
  * <dt>Supervisor_Data</dt> <dd>An instance of Wxt536_Command_Supervisor_Data_Struct containing internal data 
  *                to the Wxt536 weather station, heater temperature/voltage, supply and reference voltages etc...</dd>
- * <dt>Supervisor_Timestamp</dt> <dd>A timestamp indicating when the last successful supervisor data was read.</dd>
+ * <dt>Supervisor_Timestamp</dt> <dd>A list of timestamps, indexed by Wxt536_Command_Supervisor_Field_Enum, 
+ *                                   indicating when each supervisor field was last successfully read.</dd>
  * <dt>Analogue_Data</dt> <dd>An instance of Wxt536_Command_Analogue_Data_Struct containing analogue data 
  *     from sensors externally connected to the Wxt536 i.e. the external rain sensor, the solar radiation sensor.</dd>
- * <dt>Analogue_Timestamp</dt> <dd>A timestamp indicating when the last successful analogue data was read.</dd>
+ * <dt>Analogue_Timestamp</dt> <dd>A list of timestamps, indexed by Wxt536_Command_Analogue_Field_Enum, 
+ *                                 indicating when each analogue field was last successfully read.</dd>
  * <dt></dt> <dd></dd>
  * <dt></dt> <dd></dd>
  * </dl>
@@ -81,15 +202,246 @@ enum Sensor_Type_Enum
 struct Wxt536_Data_Struct
 {
 	struct Wxt536_Command_Wind_Data_Struct Wind_Data;
-	struct timespec Wind_Timestamp;
+	struct timespec Wind_Timestamp[WXT536_COMMAND_WIND_FIELD_COUNT];
 	struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct Pressure_Temp_Humidity_Data;
-	struct timespec Pressure_Temp_Humidity_Timestamp;
+	struct timespec Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_PRESSURE_TEMPERATURE_HUMIDITY_FIELD_COUNT];
 	struct Wxt536_Command_Precipitation_Data_Struct Rain_Data;
-	struct timespec Rain_Timestamp;
+	struct timespec Rain_Timestamp[WXT536_COMMAND_PRECIPITATION_FIELD_COUNT];
 	struct Wxt536_Command_Supervisor_Data_Struct Supervisor_Data;
-	struct timespec Supervisor_Timestamp;
+	struct timespec Supervisor_Timestamp[WXT536_COMMAND_SUPERVISOR_FIELD_COUNT];
 	struct Wxt536_Command_Analogue_Data_Struct Analogue_Data;
-	struct timespec Analogue_Timestamp;
+	struct timespec Analogue_Timestamp[WXT536_COMMAND_ANALOGUE_FIELD_COUNT];
+};
+
+/**
+ * The published copy of a Wxt536's data, with a count of how many times it has been published.
+ * It is only used by the event loop thread: Wxt536_Data_Update (and Wxt536_Snapshot_Restore) publish to it, and 
+ * the Qli50 'Send Results' handler reads it, all from Qli50_Wxt536_Reactor_Run. The startup thread never touches it,
+ * as Send Results uses the warm start snapshot file until the startup has finished. So no locking is needed.
+ * <dl>
+ * <dt>Sequence</dt> <dd>The generation number of the published data, incremented each time it is published.</dd>
+ * <dt>Data</dt> <dd>The published Wxt536_Data_Struct.</dd>
+ * </dl>
+ * @see #Wxt536_Data_Struct
+ * @see #Wxt536_Data_Snapshot_Get
+ * @see #Wxt536_Data_Snapshot_Publish
+ */
+struct Wxt536_Data_Snapshot_Struct
+{
+	unsigned int Sequence;
+	struct Wxt536_Data_Struct Data;
+};
+
+/**
+ * Structure holding the state of one Wxt536 on the serial link. Several Wxt536s can share an RS-485 bus, 
+ * each with it's own device address.
+ * <dl>
+ * <dt>Address</dt> <dd>A character representing the device address of the Wxt536.</dd>
+ * <dt>RS485_Line_Delay</dt> <dd>How long the Wxt536 waits before replying to a command, in milliseconds. 
+ *     This is read from the Wxt536's communication settings when RS-485 is enabled, and is otherwise zero.</dd>
+ * <dt>Message_Data</dt> <dd>The data decoded from the Wxt536's data messages by Qli50_Wxt536_Wxt536_Read. 
+ *     This is kept between messages, so fields the Wxt536 reports as invalid keep their last valid value.</dd>
+ * <dt>Data</dt> <dd>An instance of Wxt536_Data_Snapshot_Struct containing the last set of data read from 
+ *     the Wxt536.</dd>
+ * <dt>Comms_Settings</dt> <dd>The Wxt536's communication settings, as cached by Wxt536_Device_Initialise. 
+ *     The link supervisor compares these with the Wxt536's settings when it reappears, to decide whether 
+ *     the Wxt536 needs configuring again.</dd>
+ * <dt>CRC_Enable</dt> <dd>A boolean, TRUE if the Wxt536 is using a CRC protocol ('a' or 'p'), so commands to it
+ *     are sent (and it's replies checked) with a CRC. The Wxt536 library's CRC setting is set from this before 
+ *     each exchange with the Wxt536, so each Wxt536 on the serial link keeps it's own CRC mode.</dd>
+ * <dt>Link_State</dt> <dd>The state of the serial link to this Wxt536, as seen by the link supervisor.</dd>
+ * <dt>Failure_Count</dt> <dd>The number of requests to this Wxt536 that have failed in a row.</dd>
+ * <dt>Recovery_Backoff</dt> <dd>Whilst probing, how long to wait between probes, in decimal seconds.</dd>
+ * <dt>Next_Recovery_Time</dt> <dd>Whilst probing, when the next probe is due (measured using CLOCK_MONOTONIC).</dd>
+ * <dt>Probe_Queued</dt> <dd>A boolean, TRUE if a probe (or, whilst reinitialising, a communication settings 
+ *     query) has been queued for this Wxt536, and has not yet been replied to (or failed).</dd>
+ * </dl>
+ * @see #Wxt536_Data_Snapshot_Struct
+ * @see #Wxt536_Link_State_Enum
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wxt536_Command_Composite_Data_Struct
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wxt536_Command_Comms_Settings_Struct
+ */
+struct Wxt536_Device_Struct
+{
+	char Address;
+	int RS485_Line_Delay;
+	struct Wxt536_Command_Composite_Data_Struct Message_Data;
+	struct Wxt536_Data_Snapshot_Struct Data;
+	struct Wxt536_Command_Comms_Settings_Struct Comms_Settings;
+	int CRC_Enable;
+	enum Wxt536_Link_State_Enum Link_State;
+	int Failure_Count;
+	double Recovery_Backoff;
+	struct timespec Next_Recovery_Time;
+	int Probe_Queued;
+};
+
+/**
+ * One Wxt536's data, as saved in the warm start snapshot file.
+ * <dl>
+ * <dt>Sequence</dt> <dd>Incremented before and after the slot is written, so it is odd whilst the slot is 
+ *     being written. A slot left with an odd Sequence (the process died whilst writing it) is not used.</dd>
+ * <dt>Address</dt> <dd>The device address of the Wxt536 the data was read from.</dd>
+ * <dt>Data</dt> <dd>The Wxt536's last published data, including the (CLOCK_REALTIME) time each field was read.</dd>
+ * </dl>
+ * @see #Wxt536_Data_Struct
+ * @see #Wxt536_Snapshot_File_Struct
+ */
+struct Wxt536_Snapshot_Slot_Struct
+{
+	unsigned int Sequence;
+	char Address;
+	struct Wxt536_Data_Struct Data;
+};
+
+/**
+ * The layout of the warm start snapshot file, which is memory mapped.
+ * <dl>
+ * <dt>Magic</dt> <dd>SNAPSHOT_FILE_MAGIC.</dd>
+ * <dt>Version</dt> <dd>SNAPSHOT_FILE_VERSION.</dd>
+ * <dt>Slot_Size</dt> <dd>The size of a Wxt536_Snapshot_Slot_Struct, in case a new build changes the data layout.</dd>
+ * <dt>Device_Count</dt> <dd>The number of Wxt536s on the serial link when the file was last written.</dd>
+ * <dt>Slot_List</dt> <dd>The data of each Wxt536, in Wxt536_Device_List order.</dd>
+ * </dl>
+ * @see #SNAPSHOT_FILE_MAGIC
+ * @see #SNAPSHOT_FILE_VERSION
+ * @see #DEVICE_COUNT_MAX
+ * @see #Wxt536_Snapshot_Slot_Struct
+ */
+struct Wxt536_Snapshot_File_Struct
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned int Slot_Size;
+	int Device_Count;
+	struct Wxt536_Snapshot_Slot_Struct Slot_List[DEVICE_COUNT_MAX];
+};
+
+/**
+ * Structure holding a command waiting in (or taken from) the Wxt536 command queue.
+ * <dl>
+ * <dt>Device_Index</dt> <dd>The index in Wxt536_Device_List of the Wxt536 the command is sent to.</dd>
+ * <dt>Message_Id</dt> <dd>The data message id requested (0..5), or -1 for an engineering command.</dd>
+ * <dt>Command_String</dt> <dd>The command to send, without a terminator (e.g. "0R3").</dd>
+ * <dt>Reply_Callback</dt> <dd>For engineering commands, the routine called with the reply.</dd>
+ * <dt>Queue_Time</dt> <dd>When the command was queued (measured using CLOCK_MONOTONIC).</dd>
+ * </dl>
+ * @see #QUEUE_COMMAND_LENGTH
+ * @see #Wxt536_Device_List
+ */
+struct Wxt536_Queue_Entry_Struct
+{
+	int Device_Index;
+	int Message_Id;
+	char Command_String[QUEUE_COMMAND_LENGTH];
+	Qli50_Wxt536_Wxt536_Reply_Callback_T Reply_Callback;
+	struct timespec Queue_Time;
+};
+
+/**
+ * Structure holding one priority class of the Wxt536 command queue, a first in first out ring buffer of commands,
+ * and statistics on how long commands waited in it.
+ * <dl>
+ * <dt>Entry_List</dt> <dd>The ring buffer of queued commands.</dd>
+ * <dt>Head</dt> <dd>The index in Entry_List of the oldest queued command.</dd>
+ * <dt>Count</dt> <dd>The number of queued commands.</dd>
+ * <dt>Wait_Count</dt> <dd>The number of commands taken from the queue since the statistics were last logged.</dd>
+ * <dt>Wait_Total</dt> <dd>The total time those commands waited in the queue, in decimal seconds.</dd>
+ * <dt>Wait_Max</dt> <dd>The longest time one of those commands waited in the queue, in decimal seconds.</dd>
+ * </dl>
+ * @see #QUEUE_LENGTH
+ * @see #Wxt536_Queue_Entry_Struct
+ */
+struct Wxt536_Queue_Struct
+{
+	struct Wxt536_Queue_Entry_Struct Entry_List[QUEUE_LENGTH];
+	int Head;
+	int Count;
+	int Wait_Count;
+	double Wait_Total;
+	double Wait_Max;
+};
+
+/**
+ * Structure holding the polling schedule of one individually polled data group.
+ * <dl>
+ * <dt>Name</dt> <dd>The name of the data group, used to construct it's config keywords, and for logging.</dd>
+ * <dt>Poll_Period</dt> <dd>How often the data group is polled, in decimal seconds. This is the configured
+ *     period, rounded up to a whole number of Update_Interval.</dd>
+ * <dt>Max_Datum_Age</dt> <dd>The maximum age of a datum in this data group before it is deemed stale data, 
+ *     in decimal seconds.</dd>
+ * <dt>Update_Interval</dt> <dd>How often the Wxt536s update the data group's values, in decimal seconds 
+ *     (the longest interval of any Wxt536 on the serial link), or 0.0 if not known.</dd>
+ * <dt>Next_Poll_Time</dt> <dd>When the data group is next due to be polled (measured using CLOCK_MONOTONIC),
+ *     or zero before the first poll.</dd>
+ * </dl>
+ * @see #Wxt536_Message_Group_List
+ */
+struct Wxt536_Message_Group_Struct
+{
+	char *Name;
+	double Poll_Period;
+	double Max_Datum_Age;
+	double Update_Interval;
+	struct timespec Next_Poll_Time;
+};
+
+/**
+ * Structure holding the settings that can be changed whilst the program is running, by reloading the config file
+ * (Qli50_Wxt536_Wxt536_Reload). They are read from the config file into one of these (Wxt536_Tuning_Get) and
+ * checked, before being swapped with the settings in use (Wxt536_Tuning_Swap) all at once.
+ * <dl>
+ * <dt>Poll_Period</dt> <dd>How often the composite data message is polled (Wxt536_Poll_Period).</dd>
+ * <dt>Group_Poll_Period_List</dt> <dd>How often each data group is polled, indexed by Wxt536_Message_Group_Enum.</dd>
+ * <dt>Group_Max_Datum_Age_List</dt> <dd>The maximum datum age of each data group, indexed by 
+ *     Wxt536_Message_Group_Enum.</dd>
+ * <dt>Analogue_Input_Update_Interval</dt> <dd>Wxt536_Analogue_Input_Update_Interval.</dd>
+ * <dt>Analogue_Input_Averaging_Time</dt> <dd>Wxt536_Analogue_Input_Averaging_Time.</dd>
+ * <dt>Pyranometer_Gain</dt> <dd>Wxt536_Pyranometer_Gain.</dd>
+ * <dt>CMP3_Pyranometer_Sensitivity</dt> <dd>CMP3_Pyranometer_Sensitivity.</dd>
+ * <dt>Digital_Surface_Wet_Sensor</dt> <dd>Digital_Surface_Wet_Sensor.</dd>
+ * <dt>Analogue_Surface_Wet_Sensor</dt> <dd>Analogue_Surface_Wet_Sensor.</dd>
+ * <dt>Digital_Surface_Wet_Drd11a_Threshold</dt> <dd>Digital_Surface_Wet_Drd11a_Threshold.</dd>
+ * <dt>Analogue_Surface_Wet_Drd11a_Wet_Point</dt> <dd>Analogue_Surface_Wet_Drd11a_Wet_Point.</dd>
+ * <dt>Analogue_Surface_Wet_Drd11a_Scale</dt> <dd>Analogue_Surface_Wet_Drd11a_Scale.</dd>
+ * <dt>Analogue_Surface_Wet_Wxt536_Scale</dt> <dd>Analogue_Surface_Wet_Wxt536_Scale.</dd>
+ * <dt>Qli50_Internal_Current_Fake</dt> <dd>Qli50_Internal_Current_Fake.</dd>
+ * <dt>Qli50_Internal_Temperature_Fake</dt> <dd>Qli50_Internal_Temperature_Fake.</dd>
+ * <dt>Qli50_Reference_Temperature_Fake</dt> <dd>Qli50_Reference_Temperature_Fake.</dd>
+ * <dt>Automatic_Composite_Interval</dt> <dd>Wxt536_Automatic_Composite_Interval.</dd>
+ * <dt>Link_Failure_Limit</dt> <dd>Wxt536_Link_Failure_Limit.</dd>
+ * <dt>Link_Backoff_Min</dt> <dd>Wxt536_Link_Backoff_Min.</dd>
+ * <dt>Link_Backoff_Max</dt> <dd>Wxt536_Link_Backoff_Max.</dd>
+ * </dl>
+ * @see #MESSAGE_GROUP_COUNT
+ * @see #Wxt536_Message_Group_Enum
+ * @see #Wxt536_Message_Group_List
+ * @see #Sensor_Type_Enum
+ * @see #Wxt536_Tuning_Get
+ * @see #Wxt536_Tuning_Swap
+ */
+struct Wxt536_Tuning_Struct
+{
+	double Poll_Period;
+	double Group_Poll_Period_List[MESSAGE_GROUP_COUNT];
+	double Group_Max_Datum_Age_List[MESSAGE_GROUP_COUNT];
+	double Analogue_Input_Update_Interval;
+	double Analogue_Input_Averaging_Time;
+	double Pyranometer_Gain;
+	double CMP3_Pyranometer_Sensitivity;
+	enum Sensor_Type_Enum Digital_Surface_Wet_Sensor;
+	enum Sensor_Type_Enum Analogue_Surface_Wet_Sensor;
+	double Digital_Surface_Wet_Drd11a_Threshold;
+	double Analogue_Surface_Wet_Drd11a_Wet_Point;
+	double Analogue_Surface_Wet_Drd11a_Scale;
+	double Analogue_Surface_Wet_Wxt536_Scale;
+	int Qli50_Internal_Current_Fake;
+	int Qli50_Internal_Temperature_Fake;
+	int Qli50_Reference_Temperature_Fake;
+	int Automatic_Composite_Interval;
+	int Link_Failure_Limit;
+	double Link_Backoff_Min;
+	double Link_Backoff_Max;
 };
 
 /* internal variables */
@@ -102,18 +454,255 @@ static char rcsid[] = "$Id$";
  */
 static char Serial_Device_Filename[FILENAME_LENGTH];
 /**
- * A character representing the device address of the Wxt536.
+ * The list of Wxt536s on the serial link, in the order they were configured (or found). 
+ * Device n returns it's data to Qli50 'Send Results' requests for QLI Id 'A'+n.
+ * @see #Wxt536_Device_Struct
+ * @see #DEVICE_COUNT_MAX
+ * @see #Wxt536_Device_Count
  */
-static char Wxt536_Device_Address;
+static struct Wxt536_Device_Struct Wxt536_Device_List[DEVICE_COUNT_MAX];
 /**
- * An instance of Wxt536_Data_Struct containing the last set of data read from the Wxt536.
- * @see #Wxt536_Data_Struct
+ * The number of Wxt536s in Wxt536_Device_List.
+ * @see #Wxt536_Device_List
+ */
+static int Wxt536_Device_Count = 0;
+/**
+ * A boolean, if TRUE the serial link is an RS-485 bus, and the serial driver's half-duplex direction control
+ * is enabled.
+ */
+static int Wxt536_RS485_Enable = FALSE;
+/**
+ * How long to wait for each device address to reply when scanning for Wxt536s on the serial link, in milliseconds.
+ */
+static int Wxt536_Device_Address_Scan_Timeout = 100;
+/**
+ * A boolean, if TRUE we probe for the serial settings and protocol the Wxt536 is using at startup, and put it back to
+ * the default serial settings, in case it has been power cycled or reconfigured by hand.
+ * @see #Wxt536_Probe
+ */
+static int Wxt536_Probe_Enable = FALSE;
+/**
+ * A boolean, if TRUE we try to move the Wxt536s to a faster baud rate at startup.
+ * @see #Wxt536_Baud_Rate_Upgrade
+ */
+static int Wxt536_Baud_Rate_Upgrade_Enable = FALSE;
+/**
+ * The baud rates we try to move the Wxt536s to at startup, fastest first.
+ * @see #BAUD_RATE_COUNT_MAX
+ * @see #Wxt536_Baud_Rate_Count
+ */
+static int Wxt536_Baud_Rate_List[BAUD_RATE_COUNT_MAX];
+/**
+ * The number of baud rates in Wxt536_Baud_Rate_List.
+ * @see #Wxt536_Baud_Rate_List
+ */
+static int Wxt536_Baud_Rate_Count = 0;
+/**
+ * The baud rate the Wxt536s (and the serial link) are currently using.
+ * @see #BAUD_RATE_DEFAULT
+ */
+static int Wxt536_Baud_Rate = BAUD_RATE_DEFAULT;
+/**
+ * How often we poll the composite data message (aR0) from each Wxt536 into it's Data, in decimal seconds,
+ * when Wxt536_Composite_Data_Enable is set. This is also how often the command queue statistics are logged.
+ * @see #Wxt536_Composite_Data_Enable
+ */
+static double Wxt536_Poll_Period = 2.0;
+/**
+ * The polling schedule and maximum datum age of each data group, indexed by Wxt536_Message_Group_Enum.
+ * When Wxt536_Composite_Data_Enable is FALSE, each data group is polled on it's own schedule.
+ * @see #Wxt536_Message_Group_Struct
+ * @see #Wxt536_Message_Group_Enum
+ * @see #MESSAGE_GROUP_COUNT
+ */
+static struct Wxt536_Message_Group_Struct Wxt536_Message_Group_List[MESSAGE_GROUP_COUNT] = 
+{
+	{"wind",2.0,10.0,0.0,{0,0L}},
+	{"pth",2.0,10.0,0.0,{0,0L}},
+	{"precipitation",2.0,10.0,0.0,{0,0L}},
+	{"analogue",2.0,10.0,0.0,{0,0L}},
+	{"supervisor",2.0,10.0,0.0,{0,0L}}
+};
+/**
+ * When the composite data message (aR0) is next due to be polled (measured using CLOCK_MONOTONIC),
+ * or zero before the first poll.
+ * @see #Wxt536_Poll_Period
+ */
+static struct timespec Wxt536_Composite_Next_Poll_Time;
+/**
+ * When the command queue statistics are next due to be logged (measured using CLOCK_MONOTONIC),
+ * or zero before the scheduler starts.
+ * @see #Wxt536_Poll_Period
  */
-static struct Wxt536_Data_Struct Wxt536_Data;
+static struct timespec Wxt536_Statistics_Next_Log_Time;
 /**
- * The maximum age of a datum read from the Wxt536 before it is deemed stale data, in decimal seconds.
+ * A boolean, if TRUE we poll all the Wxt536 data in one exchange using the composite data message (aR0),
+ * otherwise it reads the wind, pressure/temperature/humidity, precipitation, supervisor and analogue data
+ * using individual data messages.
  */
-static double Max_Datum_Age;
+static int Wxt536_Composite_Data_Enable = TRUE;
+/**
+ * A boolean, TRUE if the Wxt536 is configured to use automatic (unpolled) protocol ('A' or 'a'). 
+ * In this mode the Wxt536 sends data messages on it's own schedule, and Qli50_Wxt536_Wxt536_Read streams them
+ * into it's device Data rather than polling for data.
+ * @see #Qli50_Wxt536_Wxt536_Read
+ */
+static int Wxt536_Automatic_Mode = FALSE;
+/**
+ * When in automatic mode with composite data enabled, how often the Wxt536 sends the composite data message (aR0),
+ * in integer seconds.
+ */
+static int Wxt536_Automatic_Composite_Interval = 2;
+/**
+ * How long to wait for the reply to a data message request, in milliseconds.
+ * This is also the Wxt536 connection's read timeout.
+ */
+static int Wxt536_Read_Timeout = 1000;
+/**
+ * The polled protocol the Wxt536s are configured with ('P' or 'p'), kept so the link supervisor can configure 
+ * a Wxt536 again if it loses it's configuration.
+ * @see #Wxt536_Device_Initialise
+ */
+static char Wxt536_Polled_Protocol = WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_POLLED;
+/**
+ * The protocol the Wxt536s use once configured (this differs from Wxt536_Polled_Protocol in automatic mode).
+ * @see #Wxt536_Device_Initialise
+ */
+static char Wxt536_Protocol = WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_POLLED;
+/**
+ * How many requests to a Wxt536 must fail in a row before the link supervisor stops polling it, 
+ * and starts probing for it instead.
+ * @see #Wxt536_Link_State_Enum
+ */
+static int Wxt536_Link_Failure_Limit = 3;
+/**
+ * How long the link supervisor waits before the first probe of a Wxt536 that has stopped replying, 
+ * in decimal seconds. The wait doubles after each failed probe, up to Wxt536_Link_Backoff_Max.
+ */
+static double Wxt536_Link_Backoff_Min = 1.0;
+/**
+ * The longest the link supervisor waits between probes of a Wxt536 that has stopped replying, in decimal seconds.
+ */
+static double Wxt536_Link_Backoff_Max = 60.0;
+/**
+ * The name of each link supervisor state, for logging.
+ * @see #Wxt536_Link_State_Enum
+ */
+static char *Wxt536_Link_State_Name_List[] = {"connected","degraded","probing","reinitialising"};
+/**
+ * A boolean, TRUE once the serial link startup (Wxt536_Startup) has succeeded and the Wxt536s are being polled.
+ * Until then, Qli50_Wxt536_Wxt536_Send_Results returns QLI50_ERROR_NO_MEASUREMENT values, and 
+ * Qli50_Wxt536_Wxt536_Timer only restarts a failed startup. Only used by the event loop thread.
+ * @see #Qli50_Wxt536_Wxt536_Startup_Finish
+ */
+static int Wxt536_Startup_Done = FALSE;
+/**
+ * A boolean, TRUE whilst the startup thread (Wxt536_Startup_Thread) is running. Whilst it is, the startup thread
+ * owns the Wxt536 serial link and the device list, and the event loop thread must not touch them.
+ */
+static int Wxt536_Startup_Running = FALSE;
+/**
+ * The thread id of the startup thread.
+ * @see #Wxt536_Startup_Thread
+ */
+static pthread_t Wxt536_Startup_Thread_Id;
+/**
+ * A pipe, the startup thread writes a byte to the write end (index 1) when it has finished. The event loop waits
+ * for the read end (index 0) to become readable, and then calls Qli50_Wxt536_Wxt536_Startup_Finish.
+ */
+static int Wxt536_Startup_Pipe[2] = {-1,-1};
+/**
+ * Whether the last run of Wxt536_Startup succeeded (TRUE) or failed (FALSE). Set by the startup thread.
+ */
+static int Wxt536_Startup_Status = FALSE;
+/**
+ * The error number the startup thread's Wxt536_Startup failed with. The error number/string are thread local,
+ * so the startup thread copies them here for the event loop thread to report.
+ */
+static int Wxt536_Startup_Error_Number = 0;
+/**
+ * The error string the startup thread's Wxt536_Startup failed with.
+ * @see #Wxt536_Startup_Error_Number
+ */
+static char Wxt536_Startup_Error_String[QLI50_WXT536_ERROR_LENGTH];
+/**
+ * How long to wait before running a failed startup again, in decimal seconds. 
+ * This starts at Wxt536_Link_Backoff_Min and doubles after each failure, up to Wxt536_Link_Backoff_Max.
+ */
+static double Wxt536_Startup_Backoff = 1.0;
+/**
+ * When (CLOCK_MONOTONIC) to run a failed startup again.
+ */
+static struct timespec Wxt536_Startup_Retry_Time;
+/**
+ * When (CLOCK_MONOTONIC) Qli50_Wxt536_Wxt536_Initialise was called, so we can log how long it was before 
+ * the Wxt536 data became available.
+ */
+static struct timespec Wxt536_Startup_Start_Time;
+/**
+ * A boolean, set by Wxt536_Link_Comms_Settings_Reply when a reinitialising Wxt536 has lost it's configuration.
+ * Qli50_Wxt536_Wxt536_Timer then calls Wxt536_Link_Restart, once the reply's request is complete.
+ * @see #Wxt536_Link_Comms_Settings_Reply
+ * @see #Wxt536_Link_Restart
+ */
+static int Wxt536_Link_Restart_Requested = FALSE;
+/**
+ * A boolean, whether to save the Wxt536 data to a warm start snapshot file, and reload it at startup.
+ */
+static int Wxt536_Snapshot_Enable = FALSE;
+/**
+ * The filename of the warm start snapshot file.
+ */
+static char Wxt536_Snapshot_Filename[FILENAME_LENGTH];
+/**
+ * The memory mapped warm start snapshot file, or NULL if it is not in use.
+ * @see #Wxt536_Snapshot_File_Struct
+ */
+static struct Wxt536_Snapshot_File_Struct *Wxt536_Snapshot_File = NULL;
+/**
+ * The Wxt536 command queue, one first in first out queue per priority class, indexed by Wxt536_Queue_Priority_Enum.
+ * All commands sent to the Wxt536s by the bus scheduler (Qli50_Wxt536_Wxt536_Timer) are taken from here, 
+ * highest priority first.
+ * @see #Wxt536_Queue_Struct
+ * @see #Wxt536_Queue_Priority_Enum
+ * @see #QUEUE_PRIORITY_COUNT
+ */
+static struct Wxt536_Queue_Struct Wxt536_Queue_List[QUEUE_PRIORITY_COUNT];
+/**
+ * The name of each priority class of the Wxt536 command queue, for logging.
+ * @see #Wxt536_Queue_Priority_Enum
+ */
+static char *Wxt536_Queue_Priority_Name_List[QUEUE_PRIORITY_COUNT] = {"wetness","measurement","engineering",
+									"housekeeping"};
+/**
+ * A boolean, TRUE if a command has been sent to a Wxt536 and we are waiting for it's reply.
+ * @see #Wxt536_Request
+ */
+static int Wxt536_Request_Outstanding = FALSE;
+/**
+ * The outstanding (or last) command sent to a Wxt536. Data messages received are parsed for the Wxt536 
+ * with index Wxt536_Request.Device_Index in Wxt536_Device_List.
+ * @see #Wxt536_Queue_Entry_Struct
+ * @see #Wxt536_Device_List
+ */
+static struct Wxt536_Queue_Entry_Struct Wxt536_Request;
+/**
+ * The time (measured using CLOCK_MONOTONIC) to stop waiting for a reply to the outstanding request.
+ * @see #Wxt536_Request
+ */
+static struct timespec Wxt536_Request_Deadline;
+/**
+ * A boolean, TRUE if the outstanding request has already been resent once, because it's reply failed it's
+ * CRC check.
+ * @see #Wxt536_Request
+ * @see #Wxt536_Request_Resend
+ */
+static int Wxt536_Request_Resent = FALSE;
+/**
+ * The time (measured using CLOCK_MONOTONIC) the current data refresh started, i.e. when data message requests
+ * were last queued whilst no other data message requests were waiting.
+ */
+static struct timespec Wxt536_Poll_Cycle_Start_Time;
 /**
  * Configure how often the Wxt536 updates it's analogue input values, in decimal seconds. 
  * It defaults to updating these every minute,
@@ -185,368 +774,623 @@ static int Qli50_Internal_Temperature_Fake = FALSE;
  * An integer (as a boolean). Should we fake the qli50 reference temperature data, or return QLI50_ERROR_NO_MEASUREMENT?
  */
 static int Qli50_Reference_Temperature_Fake = FALSE;
+/**
+ * How many times the settings in use have been changed by Wxt536_Tuning_Swap. Some of these settings 
+ * (e.g. the pyranometer gain and the surface wet sensor scaling) change the Send Results reply without the Wxt536
+ * data changing, so this is added into the generation returned by Qli50_Wxt536_Wxt536_Send_Results_Generation_Get.
+ * @see #Wxt536_Tuning_Swap
+ * @see #Qli50_Wxt536_Wxt536_Send_Results_Generation_Get
+ */
+static unsigned int Wxt536_Tuning_Generation = 0;
 
 /* internal functions */
+static int Wxt536_Startup_Begin(void);
+static void *Wxt536_Startup_Thread(void *user_arg);
+static int Wxt536_Startup(int *connection_open);
+static int Wxt536_Snapshot_Open(void);
+static void Wxt536_Snapshot_Load(char qli_id,struct Wxt536_Data_Struct *wxt536_data);
+static void Wxt536_Snapshot_Restore(void);
+static void Wxt536_Snapshot_Save(int device_index,struct Wxt536_Data_Struct *wxt536_data);
+static int Wxt536_Snapshot_Slot_Read(struct Wxt536_Snapshot_Slot_Struct *slot,char *address,
+				     struct Wxt536_Data_Struct *wxt536_data);
+static int Wxt536_Device_List_Get(void);
+static int Wxt536_Probe(void);
+static int Wxt536_Baud_Rate_Upgrade(void);
+static int Wxt536_Baud_Rate_List_Get(void);
+static int Wxt536_Baud_Rate_Find(void);
+static int Wxt536_Baud_Rate_Switch(int baud_rate);
+static int Wxt536_Baud_Rate_Verify(void);
+static void Wxt536_Serial_Settle(void);
+static int Wxt536_Device_Initialise(struct Wxt536_Device_Struct *device,char polled_protocol,char protocol);
+static int Wxt536_Device_Index_Get(char qli_id);
+static int Wxt536_Update_Interval_Get(struct Wxt536_Device_Struct *device);
+static int Wxt536_Poll_Schedule_Check(void);
+static int Wxt536_Poll_Queue(struct timespec current_time,int *poll_timeout);
+static int Wxt536_Poll_Due(struct timespec current_time,double poll_period,struct timespec *next_poll_time,
+			   struct timespec *poll_time);
+static int Wxt536_Poll_Message_Queue(int message_id,struct timespec poll_time);
+static int Wxt536_Link_Supervise(struct timespec current_time,int *recovery_timeout);
+static void Wxt536_Link_Probe_Reply(char *reply_string);
+static void Wxt536_Link_Comms_Settings_Reply(char *reply_string);
+static int Wxt536_Link_Restart(void);
+static void Wxt536_Link_Success(int device_index);
+static void Wxt536_Link_Failure(int device_index,struct timespec current_time);
+static void Wxt536_Link_State_Set(int device_index,enum Wxt536_Link_State_Enum link_state);
+static void Wxt536_Queue_Purge(int device_index);
+static void Wxt536_Queue_Statistics_Log(void);
+static enum Wxt536_Queue_Priority_Enum Wxt536_Message_Priority_Get(int message_id);
+static int Wxt536_Queue_Add(enum Wxt536_Queue_Priority_Enum priority,int device_index,int message_id,
+			    char *command_string,Qli50_Wxt536_Wxt536_Reply_Callback_T reply_callback,
+			    struct timespec queue_time);
+static int Wxt536_Queue_Next(struct timespec current_time,struct Wxt536_Queue_Entry_Struct *entry);
+static int Wxt536_Request_Send(struct timespec current_time,int *reply_timeout);
+static int Wxt536_Request_Resend(void);
+static void Wxt536_Request_Complete(void);
+static int Wxt536_Message_Data_Mask_Get(int message_id);
+static void Wxt536_Data_Update(struct Wxt536_Device_Struct *device,
+			       struct Wxt536_Command_Composite_Data_Struct *message_data,int data_mask);
+static void Wxt536_Timestamp_List_Update(struct timespec *timestamp_list,int field_count,unsigned int valid_mask,
+					 struct timespec current_time);
+static int Wxt536_Milliseconds_Until(struct timespec current_time,struct timespec end_time);
+static void Wxt536_Time_Add(struct timespec *time,double seconds);
+static unsigned int Wxt536_Data_Snapshot_Get(struct Wxt536_Data_Snapshot_Struct *snapshot,
+					     struct Wxt536_Data_Struct *wxt536_data);
+static void Wxt536_Data_Snapshot_Publish(struct Wxt536_Data_Snapshot_Struct *snapshot,
+					 struct Wxt536_Data_Struct *wxt536_data);
+static int Wxt536_Tuning_Get(struct Wxt536_Tuning_Struct *tuning);
+static void Wxt536_Tuning_Swap(struct Wxt536_Tuning_Struct *tuning);
+static void Wxt536_Reload_Restart_Check(void);
+static int Wxt536_Reload_Settings_Queue(struct Wxt536_Tuning_Struct *previous_tuning);
+static void Wxt536_Reload_Setting_Reply(char *reply_string);
 static int Wxt536_Config_Sensor_Get(char *keyword,enum Sensor_Type_Enum *sensor);
 static double Wxt536_Calculate_Dew_Point(struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct pth_data);
 static int Wxt536_Pyranometer_Volts_To_Watts_M2(double voltage);
-static void Wxt536_Digital_Surface_Wet_Set(struct timespec current_time,
+static void Wxt536_Digital_Surface_Wet_Set(struct timespec current_time,struct Wxt536_Data_Struct *wxt536_data,
 					   struct Wms_Qli50_Data_Value *digital_surface_wet_value);
-static void Wxt536_Analogue_Surface_Wet_Set(struct timespec current_time,
+static void Wxt536_Analogue_Surface_Wet_Set(struct timespec current_time,struct Wxt536_Data_Struct *wxt536_data,
 					    struct Wms_Qli50_Data_Value *analogue_surface_wet_value);
 
 /* =======================================================
 ** external functions 
 ** ======================================================= */
 /**
- * Initialise the connection to the Vaisala Wxt536 weather station.
+ * Initialise the connection to the Vaisala Wxt536 weather station(s). This routine only reads the configuration,
+ * and then starts the serial link startup (Wxt536_Startup) in a background thread, so the Qli50 server can
+ * reply to commands (with QLI50_ERROR_NO_MEASUREMENT values) whilst a slow (or absent) Wxt536 is found and configured.
+ * When the startup thread has finished, the file descriptor returned by Qli50_Wxt536_Wxt536_Startup_Fd_Get becomes
+ * readable, and Qli50_Wxt536_Wxt536_Startup_Finish should be called.
  * <ul>
  * <li>We get the serial device filename from the config file (keyword "wxt536.serial_device.name").
  *     This is stored in Serial_Device_Filename.
- * <li>We open connection to the Wxt536 by calling Wms_Wxt536_Connection_Open with the previously discovered
- *     serial device filename.
- * <li>We call Wms_Wxt536_Command_Device_Address_Get to get the Wxt536 device address for this device, and store it in 
- *     Wxt536_Device_Address.
+ * <li>We get how long to wait for a reply from the Wxt536 from the config file
+ *     (keyword "wxt536.serial_device.read_timeout"). This is stored in Wxt536_Read_Timeout.
+ * <li>We retrieve whether the serial link is an RS-485 bus from the config file (keyword "wxt536.rs485.enable"),
+ *     and store it in Wxt536_RS485_Enable.
+ * <li>We retrieve whether to probe for the Wxt536's serial settings and protocol from the config file
+ *     (keyword "wxt536.probe.enable"), and store it in Wxt536_Probe_Enable.
+ * <li>We retrieve whether to move the Wxt536s to a faster baud rate from the config file
+ *     (keyword "wxt536.baud_rate.upgrade.enable"), and store it in Wxt536_Baud_Rate_Upgrade_Enable.
  * <li>We retrieve the Wxt536 protocol to use from the config file (keyword "wxt536.protocol").
- * <li>We call Wms_Wxt536_Command_Comms_Settings_Protocol_Set to set the protocol to use with the Wxt536.
- * <li>We retrieve the Max_Datum_Age from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We retrieve the Wxt536_Analogue_Input_Update_Interval from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We retrieve the Wxt536_Analogue_Input_Averaging_Time from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We configure the Wxt536 to use the analogue input settings by calling Wms_Wxt536_Command_Analogue_Input_Settings_Set.
- * <li>We retrieve the Wxt536_Pyranometer_Gain from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We configure the Wxt536 to use the pyranometer gain by calling Wms_Wxt536_Command_Solar_Radiation_Gain_Set.
- * <li>We retrieve the CMP3_Pyranometer_Sensitivity from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We retrieve the Digital_Surface_Wet_Sensor from the config file using Wxt536_Config_Sensor_Get.
- * <li>We retrieve the Analogue_Surface_Wet_Sensor from the config file using Wxt536_Config_Sensor_Get.
- * <li>We retrieve the Digital_Surface_Wet_Drd11a_Threshold from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We retrieve the Analogue_Surface_Wet_Drd11a_Wet_Point from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We retrieve the Analogue_Surface_Wet_Drd11a_Scale from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We retrieve the Analogue_Surface_Wet_Wxt536_Scale from the config file using Qli50_Wxt536_Config_Double_Get.
- * <li>We check whether to fake the Qli50 internal current or return no measurement, 
- *     by retrieving 'qli50.internal_current.fake' from the config file and assigning it to Qli50_Internal_Current_Fake.
- * <li>We check whether to fake the Qli50 internal temperature or return no measurement, 
- *     by retrieving 'qli50.internal_temperature.fake' from the config file and assigning it to Qli50_Internal_Temperature_Fake.
- * <li>We check whether to fake the Qli50 reference temperature or return no measurement, 
- *     by retrieving 'qli50.reference_temperature.fake' from the config file and assigning it to Qli50_Reference_Temperature_Fake.
+ *     If this is automatic ('A' or 'a'), we set Wxt536_Automatic_Mode, and configure the Wxt536 using the
+ *     equivalent polled protocol ('P' or 'p'), switching to the automatic protocol at the end of initialisation.
+ * <li>We retrieve the Wxt536_Composite_Data_Enable from the config file using Qli50_Wxt536_Config_Boolean_Get.
+ * <li>We call Wxt536_Tuning_Get to retrieve (and check) the settings that can be changed by reloading the config 
+ *     file: the poll periods and maximum datum ages, the Wxt536 analogue input and pyranometer settings, 
+ *     the surface wetness sensors, which Qli50 values to fake, the automatic mode composite data interval,
+ *     and the link supervisor settings. We then start using them, by calling Wxt536_Tuning_Swap. 
+ *     The link supervisor backoff is also used between attempts to run a failed startup again.
+ * <li>We retrieve whether to keep a warm start snapshot of the Wxt536 data from the config file 
+ *     (keyword "wxt536.snapshot.enable"), and if so it's filename (keyword "wxt536.snapshot.filename").
+ *     We then call Wxt536_Snapshot_Open to map it, and reload the data saved by the last run. Failing to open
+ *     the snapshot file is logged, and the program carries on without it.
+ * <li>We create Wxt536_Startup_Pipe, and call Wxt536_Startup_Begin to start the startup thread.
  * </ul>
  * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
- *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ *         Qli50_Wxt536_Error_String will be set with a suitable error. A Wxt536 that cannot be found or configured
+ *         is not a failure here, it is reported by Qli50_Wxt536_Wxt536_Startup_Finish.
  * @see #FILENAME_LENGTH
  * @see #Serial_Device_Filename
- * @see #Wxt536_Device_Address
- * @see #Max_Datum_Age
- * @see #Wxt536_Analogue_Input_Update_Interval
- * @see #Wxt536_Analogue_Input_Averaging_Time
- * @see #Wxt536_Pyranometer_Gain
- * @see #CMP3_Pyranometer_Sensitivity
- * @see #Sensor_Type_Enum
- * @see #Digital_Surface_Wet_Sensor
- * @see #Analogue_Surface_Wet_Sensor
- * @see #Digital_Surface_Wet_Drd11a_Threshold
- * @see #Analogue_Surface_Wet_Drd11a_Wet_Point
- * @see #Analogue_Surface_Wet_Drd11a_Scale
- * @see #Analogue_Surface_Wet_Wxt536_Scale
- * @see #Qli50_Internal_Current_Fake
- * @see #Qli50_Internal_Temperature_Fake
- * @see #Qli50_Reference_Temperature_Fake
- * @see #Wxt536_Config_Sensor_Get
+ * @see #Wxt536_RS485_Enable
+ * @see #Wxt536_Probe_Enable
+ * @see #Wxt536_Baud_Rate_Upgrade_Enable
+ * @see #Wxt536_Read_Timeout
+ * @see #Wxt536_Message_Group_List
+ * @see #MESSAGE_GROUP_COUNT
+ * @see #Wxt536_Composite_Data_Enable
+ * @see #Wxt536_Automatic_Mode
+ * @see #Wxt536_Polled_Protocol
+ * @see #Wxt536_Protocol
+ * @see #Wxt536_Tuning_Struct
+ * @see #Wxt536_Tuning_Get
+ * @see #Wxt536_Tuning_Swap
+ * @see #Wxt536_Link_Backoff_Min
+ * @see #Wxt536_Startup_Pipe
+ * @see #Wxt536_Startup_Backoff
+ * @see #Wxt536_Startup_Start_Time
+ * @see #Wxt536_Startup_Begin
+ * @see #Wxt536_Snapshot_Enable
+ * @see #Wxt536_Snapshot_Filename
+ * @see #Wxt536_Snapshot_Open
+ * @see #Qli50_Wxt536_Wxt536_Startup_Fd_Get
+ * @see #Qli50_Wxt536_Wxt536_Startup_Finish
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
  * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_String_Get
  * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Double_Get
- * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Open
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Device_Address_Get
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Protocol_Set
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Solar_Radiation_Gain_Set
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Analogue_Input_Settings_Set
  */
 int Qli50_Wxt536_Wxt536_Initialise(void)
 {
+	struct Wxt536_Tuning_Struct tuning;
 	char protocol_string[32];
-	char protocol;
-	
+	int i,pipe_errno;
+
 	Qli50_Wxt536_Error_Number = 0;
+	clock_gettime(CLOCK_MONOTONIC,&Wxt536_Startup_Start_Time);
 #if LOGGING > 1
 	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
 				"Qli50_Wxt536_Wxt536_Initialise:Started.");
 #endif /* LOGGING */
 	/* get the serial device filename from config */
-#if LOGGING > 5
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-				"Qli50_Wxt536_Wxt536_Initialise:Opening connection to Wxt536.");
-#endif /* LOGGING */
 	if(!Qli50_Wxt536_Config_String_Get("wxt536.serial_device.name",Serial_Device_Filename,FILENAME_LENGTH))
 		return FALSE;
-	if(!Wms_Wxt536_Connection_Open("Wxt536","qli50_wxt536_wxt536.c",Serial_Device_Filename))
-	{
-		Qli50_Wxt536_Error_Number = 200;
-		sprintf(Qli50_Wxt536_Error_String,
-			"Qli50_Wxt536_Wxt536_Initialise:Wms_Wxt536_Connection_Open(%s) failed.",
-			Serial_Device_Filename);		
+	/* get how long to wait for a reply from the Wxt536 */
+	if(!Qli50_Wxt536_Config_Int_Get("wxt536.serial_device.read_timeout",&Wxt536_Read_Timeout))
 		return FALSE;
-	}
-	/* get the device address of the connected Wxt536, and store for later use. */
-#if LOGGING > 5
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-				"Qli50_Wxt536_Wxt536_Initialise:Get Wxt536 device address.");
-#endif /* LOGGING */
-	if(!Wms_Wxt536_Command_Device_Address_Get("Wxt536","qli50_wxt536_wxt536.c",&Wxt536_Device_Address))
-	{
-		Qli50_Wxt536_Error_Number = 201;
-		sprintf(Qli50_Wxt536_Error_String,
-			"Qli50_Wxt536_Wxt536_Initialise: Failed to retrieve Wxt536 device address.");		
+	/* is the serial link an RS-485 bus? */
+	if(!Qli50_Wxt536_Config_Boolean_Get("wxt536.rs485.enable",&Wxt536_RS485_Enable))
 		return FALSE;
-	}
-	/* ensure the protocol is setup correctly. */
-#if LOGGING > 5
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-				"Qli50_Wxt536_Wxt536_Initialise:Set the Wxt536 device protocol.");
-#endif /* LOGGING */
+	/* should we probe for the Wxt536's serial settings, in case it has been power cycled or reconfigured? */
+	if(!Qli50_Wxt536_Config_Boolean_Get("wxt536.probe.enable",&Wxt536_Probe_Enable))
+		return FALSE;
+	/* should we try to move the Wxt536s to a faster baud rate? */
+	if(!Qli50_Wxt536_Config_Boolean_Get("wxt536.baud_rate.upgrade.enable",&Wxt536_Baud_Rate_Upgrade_Enable))
+		return FALSE;
+	/* get the protocol to use. */
 	if(!Qli50_Wxt536_Config_String_Get("wxt536.protocol",protocol_string,31))
 		return FALSE;
 	if(strlen(protocol_string) > 1)
 	{
 		Qli50_Wxt536_Error_Number = 203;
 		sprintf(Qli50_Wxt536_Error_String,
-			"Qli50_Wxt536_Wxt536_Initialise: Protocol string '%s' was too long.",protocol_string);		
-		return FALSE;
-	}
-	protocol = protocol_string[0];
-	if(!Wms_Wxt536_Command_Comms_Settings_Protocol_Set("Wxt536","qli50_wxt536_wxt536.c",
-							   Wxt536_Device_Address,protocol))
-	{
-		Qli50_Wxt536_Error_Number = 204;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Initialise: "
-			"Failed to set the communication protocol to '%c' "
-			"for Wxt536 device address '%c'.",protocol,Wxt536_Device_Address);		
+			"Qli50_Wxt536_Wxt536_Initialise: Protocol string '%s' was too long.",protocol_string);
 		return FALSE;
 	}
-	/* get the maximum datum age in seconds */
-	if(!Qli50_Wxt536_Config_Double_Get("wxt536.max_datum_age",&Max_Datum_Age))
+	/* In automatic mode the Wxt536 can send data messages at any time. Configure it using the equivalent polled
+	** protocol, and switch to automatic mode once the configuration is complete. */
+	Wxt536_Automatic_Mode = ((protocol_string[0] == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_AUTOMATIC)||
+				 (protocol_string[0] == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_AUTOMATIC_CRC));
+	Wxt536_Protocol = protocol_string[0];
+	if(protocol_string[0] == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_AUTOMATIC)
+		Wxt536_Polled_Protocol = WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_POLLED;
+	else if(protocol_string[0] == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_AUTOMATIC_CRC)
+		Wxt536_Polled_Protocol = WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_POLLED_CRC;
+	else
+		Wxt536_Polled_Protocol = protocol_string[0];
+	/* should we use the composite data message to read all the data in one go? */
+	if(!Qli50_Wxt536_Config_Boolean_Get("wxt536.composite_data.enable",&Wxt536_Composite_Data_Enable))
 		return FALSE;
-	/* get the Wxt536 analogue input settings */
-#if LOGGING > 5
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-				"Qli50_Wxt536_Wxt536_Initialise:Set the Wxt536 analogue inpuit settings.");
-#endif /* LOGGING */
-	if(!Qli50_Wxt536_Config_Double_Get("wxt536.analogue_input.update_interval",&Wxt536_Analogue_Input_Update_Interval))
+	/* get the settings that can be changed by reloading the config file, and start using them */
+	if(!Wxt536_Tuning_Get(&tuning))
 		return FALSE;
-	if(!Qli50_Wxt536_Config_Double_Get("wxt536.analogue_input.averaging_time",&Wxt536_Analogue_Input_Averaging_Time))
+	Wxt536_Tuning_Swap(&tuning);
+	for(i = 0; i < MESSAGE_GROUP_COUNT; i++)
+		Wxt536_Message_Group_List[i].Update_Interval = 0.0;
+	Wxt536_Startup_Backoff = Wxt536_Link_Backoff_Min;
+	/* reload the data saved before the last restart, so we can reply with it whilst the Wxt536s are configured */
+	if(!Qli50_Wxt536_Config_Boolean_Get("wxt536.snapshot.enable",&Wxt536_Snapshot_Enable))
 		return FALSE;
-	/* set the wxt536 to use the configured analogue input settings */
-	if(!Wms_Wxt536_Command_Analogue_Input_Settings_Set("Wxt536","qli50_wxt536_wxt536.c",Wxt536_Device_Address,
-							   Wxt536_Analogue_Input_Update_Interval,
-							   Wxt536_Analogue_Input_Averaging_Time))
+	if(Wxt536_Snapshot_Enable)
 	{
-		Qli50_Wxt536_Error_Number = 214;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Initialise: "
-			"Failed to set the anagloue input settings to update interval %.3f s, "
-			"averaging time %.3f s for Wxt536 device address '%c'.",
-			Wxt536_Analogue_Input_Update_Interval,Wxt536_Analogue_Input_Averaging_Time,Wxt536_Device_Address);
-		return FALSE;
+		if(!Qli50_Wxt536_Config_String_Get("wxt536.snapshot.filename",Wxt536_Snapshot_Filename,
+						   FILENAME_LENGTH))
+			return FALSE;
+		if(!Wxt536_Snapshot_Open())
+			Qli50_Wxt536_Error();
 	}
-	/* get the Wxt536 pyranometer gain */
-#if LOGGING > 5
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-				"Qli50_Wxt536_Wxt536_Initialise:Set the Wxt536 pyranometer gain.");
-#endif /* LOGGING */
-	if(!Qli50_Wxt536_Config_Double_Get("wxt536.pyranometer.gain",&Wxt536_Pyranometer_Gain))
-		return FALSE;
-	/* set the wxt536 to use the configured gain */
-	if(!Wms_Wxt536_Command_Solar_Radiation_Gain_Set("Wxt536","qli50_wxt536_wxt536.c",Wxt536_Device_Address,
-							Wxt536_Pyranometer_Gain))
+	/* find and configure the Wxt536s in the background, and tell the event loop when we have finished */
+	if(pipe(Wxt536_Startup_Pipe) != 0)
 	{
-		Qli50_Wxt536_Error_Number = 213;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Initialise: "
-			"Failed to set the pyranometer gain to '%.3f' for Wxt536 device address '%c'.",
-			Wxt536_Pyranometer_Gain,Wxt536_Device_Address);		
+		pipe_errno = errno;
+		Qli50_Wxt536_Error_Number = 257;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Initialise:pipe failed (%d:%s).",
+			pipe_errno,strerror(pipe_errno));
 		return FALSE;
 	}
-#if LOGGING > 5
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-				"Qli50_Wxt536_Wxt536_Initialise:Get the Wxt536 internal configuration.");
-#endif /* LOGGING */
-	/* get the CMP3 pyranometer sensitivity in uV/W/m^2*/
-	if(!Qli50_Wxt536_Config_Double_Get("cmp3.pyranometer.sensitivity",&CMP3_Pyranometer_Sensitivity))
-		return FALSE;
-	/* get which sensor to use for the digital surface wet determination */
-	if(!Wxt536_Config_Sensor_Get("digital.surface.wet.sensor",&Digital_Surface_Wet_Sensor))
-		return FALSE;
-	/* get which sensor to use for the analogue surface wet determination */
-	if(!Wxt536_Config_Sensor_Get("analogue.surface.wet.sensor",&Analogue_Surface_Wet_Sensor))
-		return FALSE;
-	/* get the digital surface wet drd11a threashold in volts */
-	if(!Qli50_Wxt536_Config_Double_Get("digital.surface.wet.drd11a.threshold",&Digital_Surface_Wet_Drd11a_Threshold))
-		return FALSE;
-	/* get the analogue surface wet drd11a wet-point voltage */
-	if(!Qli50_Wxt536_Config_Double_Get("analogue.surface.wet.drd11a.wetpoint",&Analogue_Surface_Wet_Drd11a_Wet_Point))
-		return FALSE;
-	/* get the analogue surface wet drd11a scaling factor */
-	if(!Qli50_Wxt536_Config_Double_Get("analogue.surface.wet.drd11a.scale",&Analogue_Surface_Wet_Drd11a_Scale))
-		return FALSE;
-	/* get the analogue surface wet wxt536 scaling factor */
-	if(!Qli50_Wxt536_Config_Double_Get("analogue.surface.wet.wxt536.scale",&Analogue_Surface_Wet_Wxt536_Scale))
-		return FALSE;
-	/* Should we fake the qli50 internal current data, or return QLI50_ERROR_NO_MEASUREMENT? */
-	if(!Qli50_Wxt536_Config_Boolean_Get("qli50.internal_current.fake",&Qli50_Internal_Current_Fake))
-		return FALSE;
-	 /* Should we fake the qli50 internal temperature data, or return QLI50_ERROR_NO_MEASUREMENT? */
-	if(!Qli50_Wxt536_Config_Boolean_Get("qli50.internal_temperature.fake",&Qli50_Internal_Temperature_Fake))
-		return FALSE;
-	 /* Should we fake the qli50 reference temperature data, or return QLI50_ERROR_NO_MEASUREMENT? */
-	if(!Qli50_Wxt536_Config_Boolean_Get("qli50.reference_temperature.fake",&Qli50_Reference_Temperature_Fake))
+	if(!Wxt536_Startup_Begin())
 		return FALSE;
 #if LOGGING > 1
 	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
-				"Qli50_Wxt536_Wxt536_Initialise:Finished.");
-#endif /* LOGGING */	
+				"Qli50_Wxt536_Wxt536_Initialise:Finished, Wxt536 link startup running in the background.");
+#endif /* LOGGING */
 	return TRUE;
 }
 
 /**
- * Close the previously opened connection to the Vaisala Wxt536 weather station.
- * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
- *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * Return the file descriptor the startup thread signals when it has finished, so an event loop can wait for it
+ * to become readable, and then call Qli50_Wxt536_Wxt536_Startup_Finish.
+ * Qli50_Wxt536_Wxt536_Initialise must have been called first, to create it.
+ * @return The read end of Wxt536_Startup_Pipe.
+ * @see #Wxt536_Startup_Pipe
+ * @see #Qli50_Wxt536_Wxt536_Startup_Finish
+ */
+int Qli50_Wxt536_Wxt536_Startup_Fd_Get(void)
+{
+	return Wxt536_Startup_Pipe[0];
+}
+
+/**
+ * Finish the serial link startup. This should be called when the file descriptor returned by
+ * Qli50_Wxt536_Wxt536_Startup_Fd_Get is readable, i.e. the startup thread has finished.
+ * <ul>
+ * <li>We read the byte the startup thread wrote to Wxt536_Startup_Pipe, and join the startup thread.
+ * <li>If Wxt536_Startup failed, we copy the startup thread's error into Qli50_Wxt536_Error_Number/String,
+ *     and set Wxt536_Startup_Retry_Time, so Qli50_Wxt536_Wxt536_Timer runs the startup again after
+ *     Wxt536_Startup_Backoff seconds. The backoff doubles after each failure, up to Wxt536_Link_Backoff_Max.
+ * <li>Otherwise, we call Wxt536_Snapshot_Restore to start each Wxt536's data from the warm start snapshot, 
+ *     set Wxt536_Startup_Done so the Wxt536s are polled, and log how long it took for the Wxt536 link
+ *     to become available.
+ * </ul>
+ * @return The routine returns TRUE if the Wxt536 link is now available (and it's file descriptor, returned by
+ *         Qli50_Wxt536_Wxt536_Fd_Get, should be waited on), and FALSE if the startup failed. If it fails,
+ *         Qli50_Wxt536_Error_Number and Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Startup_Pipe
+ * @see #Wxt536_Startup_Thread_Id
+ * @see #Wxt536_Startup_Running
+ * @see #Wxt536_Startup_Status
+ * @see #Wxt536_Startup_Error_Number
+ * @see #Wxt536_Startup_Error_String
+ * @see #Wxt536_Startup_Done
+ * @see #Wxt536_Startup_Backoff
+ * @see #Wxt536_Startup_Retry_Time
+ * @see #Wxt536_Startup_Start_Time
+ * @see #Wxt536_Link_Backoff_Max
+ * @see #Wxt536_Snapshot_Restore
+ * @see #Wxt536_Time_Add
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
- * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Close
+ * @see qli50_wxt536_general.html#fdifftime
  */
-int Qli50_Wxt536_Wxt536_Close(void)
+int Qli50_Wxt536_Wxt536_Startup_Finish(void)
 {
+	struct timespec current_time;
+	char signal_byte;
+
 	Qli50_Wxt536_Error_Number = 0;
-	if(!Wms_Wxt536_Connection_Close("Wxt536","qli50_wxt536_wxt536.c"))
+	if(read(Wxt536_Startup_Pipe[0],&signal_byte,1) != 1)
 	{
-		Qli50_Wxt536_Error_Number = 202;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Close:Wms_Wxt536_Connection_Close() failed.");
+		Qli50_Wxt536_Error_Number = 259;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Startup_Finish:Failed to read startup pipe.");
 		return FALSE;
-	}	
+	}
+	if(Wxt536_Startup_Running)
+	{
+		pthread_join(Wxt536_Startup_Thread_Id,NULL);
+		Wxt536_Startup_Running = FALSE;
+	}
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	if(Wxt536_Startup_Status == FALSE)
+	{
+		Wxt536_Startup_Retry_Time = current_time;
+		Wxt536_Time_Add(&Wxt536_Startup_Retry_Time,Wxt536_Startup_Backoff);
+		Qli50_Wxt536_Error_Number = Wxt536_Startup_Error_Number;
+		sprintf(Qli50_Wxt536_Error_String,
+			"Qli50_Wxt536_Wxt536_Startup_Finish:Startup failed, retrying in %.3f s:%.900s",
+			Wxt536_Startup_Backoff,Wxt536_Startup_Error_String);
+		Wxt536_Startup_Backoff *= 2.0;
+		if(Wxt536_Startup_Backoff > Wxt536_Link_Backoff_Max)
+			Wxt536_Startup_Backoff = Wxt536_Link_Backoff_Max;
+		return FALSE;
+	}
+	Wxt536_Snapshot_Restore();
+	Wxt536_Startup_Done = TRUE;
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Qli50_Wxt536_Wxt536_Startup_Finish:Wxt536 link available %.3f s after initialisation.",
+				fdifftime(current_time,Wxt536_Startup_Start_Time));
+#endif /* LOGGING */
 	return TRUE;
 }
 
 /**
- * Process a 'Read Sensors' command received by the Qli50 server. This involves reading all the weather station sensors
- * that have values required by the 'Send Results' command.
- * @param qli_id A single character, representing the QLI Id of the Qli50 that is required to read it's sensors.
- * @param seq_id A single character, representing the QLI50 sequence id of the set of readings 
- *        the QLI50 is meant to take.
+ * Return the file descriptor of the serial link to the Wxt536, so an event loop can wait for it to become readable.
+ * This is only valid once Qli50_Wxt536_Wxt536_Startup_Finish has returned TRUE, as the connection is opened by the
+ * startup thread.
+ * @return The file descriptor of the Wxt536 serial link.
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Handle_Get
+ */
+int Qli50_Wxt536_Wxt536_Fd_Get(void)
+{
+	return Wms_Wxt536_Connection_Handle_Get()->Serial_Fd;
+}
+
+/**
+ * Handle data received from the Wxt536. This should be called when the Wxt536 serial link is readable.
+ * If the outstanding request is an engineering command, we read it's reply line using 
+ * Wms_Wxt536_Command_Reply_Read, pass it to the command's reply callback, and the request is complete.
+ * Otherwise we call Wms_Wxt536_Command_Data_Message_Read (without waiting) to read and parse each complete line 
+ * received from the Wxt536 the last request was sent to, and update that device's data with any data groups 
+ * it contains using Wxt536_Data_Update. In automatic mode (with only one Wxt536) these are the data messages 
+ * the Wxt536 sends on it's own schedule. When polling, if the line contains the data requested by the 
+ * outstanding request, the request is complete and Qli50_Wxt536_Wxt536_Timer will send the next one.
+ * Lines from other device addresses are ignored. If a reply fails it's CRC check, the outstanding request is 
+ * resent once (Wxt536_Request_Resend), if it fails again the request times out (or an engineering command's 
+ * reply callback is called with NULL). The remaining buffered lines are still processed, but the corrupt reply is
+ * reported by returning FALSE. Receiving data from a Wxt536 marks it's link as connected (Wxt536_Link_Success).
  * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
  *         Qli50_Wxt536_Error_String will be set with a suitable error.
- * @see #Wxt536_Device_Address
- * @see #Wxt536_Data
- * @see #Wxt536_Data_Struct
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Struct
+ * @see #Wxt536_Request
+ * @see #Wxt536_Request_Outstanding
+ * @see #Wxt536_Data_Update
+ * @see #Wxt536_Message_Data_Mask_Get
+ * @see #Wxt536_Request_Complete
+ * @see #Wxt536_Request_Resend
+ * @see #Wxt536_Request_Resent
+ * @see #Wxt536_Link_Success
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
  * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Wind_Data_Get
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Precipitation_Data_Get
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Supervisor_Data_Get
- * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Analogue_Data_Get
+ * @see ../serial/cdocs/wms_serial_serial.html#WMS_SERIAL_READ_TIMEOUT_NONE
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Data_Message_Read
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Data_Message_Buffered
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Reply_Read
  */
-int Qli50_Wxt536_Wxt536_Read_Sensors(char qli_id,char seq_id)
+int Qli50_Wxt536_Wxt536_Read(void)
 {
-	struct Wxt536_Command_Wind_Data_Struct wind_data;
-	struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct pressure_temp_humidity_data;
-	struct Wxt536_Command_Precipitation_Data_Struct rain_data;
-	struct Wxt536_Command_Supervisor_Data_Struct supervisor_data;
-	struct Wxt536_Command_Analogue_Data_Struct analogue_data;
-	int retval;
+	struct Wxt536_Device_Struct *device = NULL;
+	char reply_string[QUEUE_COMMAND_LENGTH];
+	int data_mask,bytes_read,retval;
 
-	retval = TRUE;
 	Qli50_Wxt536_Error_Number = 0;
-#if LOGGING > 1
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
-				"Qli50_Wxt536_Wxt536_Read_Sensors invoked with qli_id '%c' and seq_id '%c'.",
-				qli_id,seq_id);
-#endif /* LOGGING */
-	/* read wind data */
-#if LOGGING > 1
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,"Reading Wxt536 wind data.");
-#endif /* LOGGING */
-	if(Wms_Wxt536_Command_Wind_Data_Get("Wxt536","qli50_wxt536_wxt536.c",Wxt536_Device_Address,&wind_data))
-	{
-		Wxt536_Data.Wind_Data = wind_data;
-		clock_gettime(CLOCK_REALTIME,&(Wxt536_Data.Wind_Timestamp));
-	}
-	else
+	retval = TRUE;
+	device = &(Wxt536_Device_List[Wxt536_Request.Device_Index]);
+	Wms_Wxt536_Command_CRC_Enable_Set(device->CRC_Enable);
+	do
 	{
-		Qli50_Wxt536_Error_Number = 205;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Read_Sensors:Reading Wind data failed.");
-		retval = FALSE;
+		if(Wxt536_Request_Outstanding&&(Wxt536_Request.Message_Id == -1))
+		{
+			if(!Wms_Wxt536_Command_Reply_Read("Wxt536","qli50_wxt536_wxt536.c",WMS_SERIAL_READ_TIMEOUT_NONE,
+							  reply_string,QUEUE_COMMAND_LENGTH,&bytes_read))
+			{
+				/* resend the command once if it's reply was corrupt */
+				if((Wms_Wxt536_Get_Error_Number() == 182)&&(Wxt536_Request_Resent == FALSE))
+				{
+					if(!Wxt536_Request_Resend())
+						return FALSE;
+					retval = FALSE;
+					continue;
+				}
+				Qli50_Wxt536_Error_Number = 232;
+				sprintf(Qli50_Wxt536_Error_String,
+					"Qli50_Wxt536_Wxt536_Read:Reading reply to engineering command '%s' failed.",
+					Wxt536_Request.Command_String);
+				Wxt536_Request.Reply_Callback(NULL);
+				Wxt536_Request_Complete();
+				return FALSE;
+			}
+			if(bytes_read > 0)
+			{
+				Wxt536_Request.Reply_Callback(reply_string);
+				Wxt536_Request_Complete();
+			}
+			continue;
+		}
+		if(!Wms_Wxt536_Command_Data_Message_Read("Wxt536","qli50_wxt536_wxt536.c",device->Address,
+							 WMS_SERIAL_READ_TIMEOUT_NONE,&(device->Message_Data),&data_mask))
+		{
+			if(Wms_Wxt536_Get_Error_Number() != 181)
+			{
+				Qli50_Wxt536_Error_Number = 221;
+				sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Read:Reading data message failed.");
+				return FALSE;
+			}
+			/* a corrupt data message. Request the data again once, and carry on with any buffered lines */
+			if(Wxt536_Request_Outstanding&&(Wxt536_Request.Message_Id != -1)&&(Wxt536_Request_Resent == FALSE))
+			{
+				if(!Wxt536_Request_Resend())
+					return FALSE;
+			}
+			else
+			{
+				Qli50_Wxt536_Error_Number = 267;
+				sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Read:Discarding corrupt data message.");
+			}
+			retval = FALSE;
+			continue;
+		}
+		if(data_mask != 0)
+		{
+			Wxt536_Data_Update(device,&(device->Message_Data),data_mask);
+			Wxt536_Link_Success(Wxt536_Request.Device_Index);
+			if(Wxt536_Request_Outstanding&&
+			   (data_mask & Wxt536_Message_Data_Mask_Get(Wxt536_Request.Message_Id)))
+				Wxt536_Request_Complete();
+		}
 	}
-	/* read pressure/temperature/humidity data */
-#if LOGGING > 1
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-				"Reading Wxt536 pressure/temperature/humidity data.");
-#endif /* LOGGING */
-	if(Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get("Wxt536","qli50_wxt536_wxt536.c",
-								     Wxt536_Device_Address,&pressure_temp_humidity_data))
+	while(Wms_Wxt536_Command_Data_Message_Buffered());
+	return retval;
+}
+
+/**
+ * Drive the Wxt536 polling state machine (the bus scheduler). This should be called each time round the event loop.
+ * Until the serial link startup has succeeded (Wxt536_Startup_Done), the startup thread owns the serial link,
+ * and all we do is start the startup thread again (Wxt536_Startup_Begin) when a failed startup's 
+ * Wxt536_Startup_Retry_Time is reached.
+ * In automatic mode the Wxt536 sends data on it's own, so there is nothing to do.
+ * Otherwise:
+ * <ul>
+ * <li>If a request is outstanding, and it's reply has not arrived by Wxt536_Request_Deadline, we give up on it
+ *     (an engineering command's reply callback is called with NULL), and return an error. A failed data message
+ *     request is reported to the link supervisor (Wxt536_Link_Failure).
+ * <li>If a Wxt536 that has come back has lost it's configuration (Wxt536_Link_Restart_Requested), we call 
+ *     Wxt536_Link_Restart to run the serial link startup again in the startup thread, and return.
+ * <li>We call Wxt536_Link_Supervise to probe for, and reinitialise, Wxt536s that have stopped replying.
+ *     Data message requests are not queued for these Wxt536s, so the other Wxt536s on the serial link
+ *     (and the Qli50 server) are not held up waiting for replies that will not come. If this fails 
+ *     (a command queue is full), the Wxt536s are still polled, and the error is returned at the end.
+ * <li>We call Wxt536_Poll_Queue to queue the data message requests that are due. Each data group 
+ *     (or the composite data message) is polled on it's own fixed schedule (measured using CLOCK_MONOTONIC).
+ * <li>If no request is outstanding, we take the highest priority command from the Wxt536 command queue 
+ *     (Wxt536_Queue_Next) and send it, using Wms_Wxt536_Command_Data_Message_Request for data message requests, 
+ *     and Wms_Wxt536_Command for engineering commands. We then wait up to Wxt536_Read_Timeout 
+ *     (plus the Wxt536's RS485_Line_Delay) for the reply. Each command is sent as soon as the previous reply 
+ *     arrives, so the bus is never idle whilst commands are queued.
+ * </ul>
+ * Requests that have not been sent by the time they are next due stay queued (Wxt536_Queue_Add does not 
+ * queue them twice), so when the serial link is too slow to send every request each poll period, 
+ * the lower priority requests are delayed, rather than the wetness data.
+ * @param timeout_ms The address of an integer, on return set to how long the event loop can wait (in milliseconds)
+ *        before calling this routine again, or -1 if it need not be called until some data is received.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error. timeout_ms is always set.
+ * @see #Wxt536_Startup_Done
+ * @see #Wxt536_Startup_Running
+ * @see #Wxt536_Startup_Retry_Time
+ * @see #Wxt536_Startup_Begin
+ * @see #Wxt536_Automatic_Mode
+ * @see #Wxt536_Read_Timeout
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Request_Outstanding
+ * @see #Wxt536_Request
+ * @see #Wxt536_Request_Deadline
+ * @see #Wxt536_Poll_Queue
+ * @see #Wxt536_Queue_Add
+ * @see #Wxt536_Queue_Next
+ * @see #Wxt536_Request_Send
+ * @see #Wxt536_Request_Resent
+ * @see #Wxt536_Request_Complete
+ * @see #Wxt536_Milliseconds_Until
+ * @see #Wxt536_Link_Supervise
+ * @see #Wxt536_Link_Failure
+ * @see #Wxt536_Link_Restart_Requested
+ * @see #Wxt536_Link_Restart
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_general.html#fdifftime
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Data_Message_Request
+ */
+int Qli50_Wxt536_Wxt536_Timer(int *timeout_ms)
+{
+	struct timespec current_time;
+	int retval,supervise_retval,reply_timeout,poll_timeout,recovery_timeout;
+
+	Qli50_Wxt536_Error_Number = 0;
+	(*timeout_ms) = -1;
+	if(Wxt536_Startup_Done == FALSE)
 	{
-		Wxt536_Data.Pressure_Temp_Humidity_Data = pressure_temp_humidity_data;
-		clock_gettime(CLOCK_REALTIME,&(Wxt536_Data.Pressure_Temp_Humidity_Timestamp));
+		/* the startup thread owns the serial link, or we are waiting to run a failed startup again */
+		if(Wxt536_Startup_Running)
+			return TRUE;
+		clock_gettime(CLOCK_MONOTONIC,&current_time);
+		(*timeout_ms) = Wxt536_Milliseconds_Until(current_time,Wxt536_Startup_Retry_Time);
+		if((*timeout_ms) > 0)
+			return TRUE;
+		(*timeout_ms) = -1;
+		return Wxt536_Startup_Begin();
 	}
-	else
+	if(Wxt536_Automatic_Mode)
+		return TRUE;
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	if(Wxt536_Request_Outstanding)
 	{
-		Qli50_Wxt536_Error_Number = 206;
+		(*timeout_ms) = Wxt536_Milliseconds_Until(current_time,Wxt536_Request_Deadline);
+		if((*timeout_ms) > 0)
+			return TRUE;
+		/* give up on this request, and move on to the next one */
+		if(Wxt536_Request.Message_Id == -1)
+			Wxt536_Request.Reply_Callback(NULL);
+		else
+			Wxt536_Link_Failure(Wxt536_Request.Device_Index,current_time);
+		Wxt536_Request_Complete();
+		(*timeout_ms) = 0;
+		Qli50_Wxt536_Error_Number = 223;
 		sprintf(Qli50_Wxt536_Error_String,
-			"Qli50_Wxt536_Wxt536_Read_Sensors:Reading Pressure/Temperature/Humidity data failed.");
-		retval = FALSE;
-	}
-	/* read rain data */
-#if LOGGING > 1
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,"Reading Wxt536 rain data.");
-#endif /* LOGGING */
-	if(Wms_Wxt536_Command_Precipitation_Data_Get("Wxt536","qli50_wxt536_wxt536.c",Wxt536_Device_Address,&rain_data))
-	{
-		Wxt536_Data.Rain_Data = rain_data;
-		clock_gettime(CLOCK_REALTIME,&(Wxt536_Data.Rain_Timestamp));
+			"Qli50_Wxt536_Wxt536_Timer:Timed out after %d ms waiting for reply to '%s'.",
+			Wxt536_Read_Timeout+Wxt536_Device_List[Wxt536_Request.Device_Index].RS485_Line_Delay,
+			Wxt536_Request.Command_String);
+		return FALSE;
 	}
-	else
+	/* a Wxt536 has lost it's configuration, configure the Wxt536s again in the startup thread */
+	if(Wxt536_Link_Restart_Requested)
+		return Wxt536_Link_Restart();
+	/* probe for (and reinitialise) Wxt536s that have stopped replying. A failure here is returned once
+	** the other Wxt536s have been polled */
+	supervise_retval = Wxt536_Link_Supervise(current_time,&recovery_timeout);
+	/* queue the data message requests that are now due */
+	if(!Wxt536_Poll_Queue(current_time,&poll_timeout))
 	{
-		Qli50_Wxt536_Error_Number = 207;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Read_Sensors:Reading Rain data failed.");
-		retval = FALSE;
+		(*timeout_ms) = poll_timeout;
+		return FALSE;
 	}
-	/* read supervisor data (internal temperatures/voltages) */
-#if LOGGING > 1
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,"Reading Wxt536 supervisor data.");
-#endif /* LOGGING */
-	if(Wms_Wxt536_Command_Supervisor_Data_Get("Wxt536","qli50_wxt536_wxt536.c",Wxt536_Device_Address,&supervisor_data))
+	if((recovery_timeout >= 0)&&(recovery_timeout < poll_timeout))
+		poll_timeout = recovery_timeout;
+	/* send the highest priority queued command, if any */
+	if(!Wxt536_Queue_Next(current_time,&Wxt536_Request))
 	{
-		Wxt536_Data.Supervisor_Data = supervisor_data;
-		clock_gettime(CLOCK_REALTIME,&(Wxt536_Data.Supervisor_Timestamp));
+		(*timeout_ms) = poll_timeout;
+		return supervise_retval;
 	}
-	else
+	Wxt536_Request_Resent = FALSE;
+	retval = Wxt536_Request_Send(current_time,&reply_timeout);
+	Wxt536_Request_Outstanding = TRUE;
+	if(retval == FALSE)
 	{
-		Qli50_Wxt536_Error_Number = 208;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Read_Sensors:Reading Supervisor data failed.");
-		retval = FALSE;
+		if(Wxt536_Request.Message_Id == -1)
+			Wxt536_Request.Reply_Callback(NULL);
+		else
+			Wxt536_Link_Failure(Wxt536_Request.Device_Index,current_time);
+		Wxt536_Request_Complete();
+		(*timeout_ms) = 0;
+		Qli50_Wxt536_Error_Number = 224;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Timer:Sending '%s' failed.",
+			Wxt536_Request.Command_String);
+		return FALSE;
 	}
-	/* read external analogue data (external rain sensor/pyranometer) */
-#if LOGGING > 1
-	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,"Reading Wxt536 analogue data.");
-#endif /* LOGGING */
-	if(Wms_Wxt536_Command_Analogue_Data_Get("Wxt536","qli50_wxt536_wxt536.c",Wxt536_Device_Address,&analogue_data))
+	(*timeout_ms) = reply_timeout;
+	return supervise_retval;
+}
+
+/**
+ * Close the previously opened connection to the Vaisala Wxt536 weather station. If the startup thread is still
+ * running, we wait for it to finish first.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Close
+ */
+int Qli50_Wxt536_Wxt536_Close(void)
+{
+	Qli50_Wxt536_Error_Number = 0;
+	if(Wxt536_Startup_Running)
 	{
-		Wxt536_Data.Analogue_Data = analogue_data;
-		clock_gettime(CLOCK_REALTIME,&(Wxt536_Data.Analogue_Timestamp));
+		pthread_join(Wxt536_Startup_Thread_Id,NULL);
+		Wxt536_Startup_Running = FALSE;
+		if(Wxt536_Startup_Status == FALSE)
+			return TRUE;
 	}
-	else
+	else if(Wxt536_Startup_Done == FALSE)
+		return TRUE;
+	if(!Wms_Wxt536_Connection_Close("Wxt536","qli50_wxt536_wxt536.c"))
 	{
-		Qli50_Wxt536_Error_Number = 209;
-		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Read_Sensors:Reading Analogue data failed.");
-		retval = FALSE;
-	}
-#if LOGGING > 1
-	Qli50_Wxt536_Log("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
-				"Qli50_Wxt536_Wxt536_Read_Sensors finished.");
-#endif /* LOGGING */
-	return retval;
+		Qli50_Wxt536_Error_Number = 202;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Close:Wms_Wxt536_Connection_Close() failed.");
+		return FALSE;
+	}	
+	return TRUE;
 }
 
 /**
  * Process a 'Send Results' command received by the Qli50 server. This fills in the supplied instance
- * of Wms_Qli50_Data_Struct with data obtained fromm a previous 'Read Sensor' command, converting any
- * units as necessary and noting any out of date datums.
+ * of Wms_Qli50_Data_Struct with data obtained from a snapshot of the data read from the Wxt536, converting any
+ * units as necessary and noting any out of date datums. The snapshot is taken using Wxt536_Data_Snapshot_Get,
+ * so this routine never waits on the Wxt536 serial link. When there are several Wxt536s on the serial link,
+ * the qli_id selects which one's data is returned (see Wxt536_Device_Index_Get). Until the serial link startup
+ * has succeeded (Wxt536_Startup_Done) the data comes from the warm start snapshot saved before the last restart
+ * (Wxt536_Snapshot_Load), if there is one. Otherwise every datum is returned as QLI50_ERROR_NO_MEASUREMENT 
+ * (apart from those faked from the config). Either way, data older than it's data group's Max_Datum_Age
+ * is returned as QLI50_ERROR_NO_MEASUREMENT.
  * @param qli_id A single character, representing the QLI Id of the Qli50 that is required to read it's sensors.
  * @param seq_id A single character, representing the QLI50 sequence id of the set of readings 
  *        the QLI50 is meant to take.
@@ -554,9 +1398,13 @@ int Qli50_Wxt536_Wxt536_Read_Sensors(char qli_id,char seq_id)
  *       a reply to the Qli50 'Send Results' command.
  * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
  *         Qli50_Wxt536_Error_String will be set with a suitable error.
- * @see #Wxt536_Data
+ * @see #Wxt536_Startup_Done
+ * @see #Wxt536_Snapshot_Load
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Index_Get
  * @see #Wxt536_Data_Struct
- * @see #Max_Datum_Age
+ * @see #Wxt536_Data_Snapshot_Get
+ * @see #Wxt536_Message_Group_List
  * @see #Wxt536_Calculate_Dew_Point
  * @see #Wxt536_Pyranometer_Volts_to_Watts_M2
  * @see #Wxt536_Digital_Surface_Wet_Set
@@ -575,6 +1423,7 @@ int Qli50_Wxt536_Wxt536_Read_Sensors(char qli_id,char seq_id)
  */
 int Qli50_Wxt536_Wxt536_Send_Results(char qli_id,char seq_id,struct Wms_Qli50_Data_Struct *data)
 {
+	struct Wxt536_Data_Struct wxt536_data;
 	struct timespec current_time;
 
 #if LOGGING > 1
@@ -582,88 +1431,140 @@ int Qli50_Wxt536_Wxt536_Send_Results(char qli_id,char seq_id,struct Wms_Qli50_Da
 				"Qli50_Wxt536_Wxt536_Send_Results invoked with qli_id '%c' and seq_id '%c'.",
 				qli_id,seq_id);
 #endif /* LOGGING */
+	/* take a copy of the data read from the Wxt536. Before the startup has finished, 
+	** the startup thread owns the device list, so use the data saved before the last restart (if any). */
+	if(Wxt536_Startup_Done)
+		Wxt536_Data_Snapshot_Get(&(Wxt536_Device_List[Wxt536_Device_Index_Get(qli_id)].Data),&wxt536_data);
+	else
+		Wxt536_Snapshot_Load(qli_id,&wxt536_data);
 	/* get the current time */
 	clock_gettime(CLOCK_REALTIME,&current_time);
-	/* pressure/temperature/humidity */
-	if(fdifftime(current_time,Wxt536_Data.Pressure_Temp_Humidity_Timestamp) < Max_Datum_Age)
+	/* air temperature in degrees centigrade. */
+	if(fdifftime(current_time,wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_AIR_TEMPERATURE]) <
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_PTH].Max_Datum_Age)
 	{
-		/* air temperature in degrees centigrade. */
 		data->Temperature.Type = DATA_TYPE_DOUBLE;
-		data->Temperature.Value.DValue = Wxt536_Data.Pressure_Temp_Humidity_Data.Air_Temperature;
-		/* relative humidity in % */
-		data->Humidity.Type = DATA_TYPE_DOUBLE;
-		data->Humidity.Value.DValue = Wxt536_Data.Pressure_Temp_Humidity_Data.Relative_Humidity;
-		/* air pressure in hPa/mbar */
-		data->Air_Pressure.Type = DATA_TYPE_DOUBLE;
-		data->Air_Pressure.Value.DValue = Wxt536_Data.Pressure_Temp_Humidity_Data.Air_Pressure;
-		/* Calculate the Dew point from the temperature and relative humidity */
-		data->Dew_Point.Type = DATA_TYPE_DOUBLE;
-		data->Dew_Point.Value.DValue = Wxt536_Calculate_Dew_Point(Wxt536_Data.Pressure_Temp_Humidity_Data);
+		data->Temperature.Value.DValue = wxt536_data.Pressure_Temp_Humidity_Data.Air_Temperature;
+	}
+	else
+	{
 #if LOGGING > 1
 		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-	   "Qli50_Wxt536_Wxt536_Send_Results: Dew point %.2f C calculated from Air temperature %.2f C and Humidity %.2f %.",
-					data->Dew_Point.Value.DValue,
-					Wxt536_Data.Pressure_Temp_Humidity_Data.Air_Temperature,
-					Wxt536_Data.Pressure_Temp_Humidity_Data.Relative_Humidity);
+			      "Qli50_Wxt536_Wxt536_Send_Results: Air temperature data out of date (%.2f s).",
+			      fdifftime(current_time,
+				 wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_AIR_TEMPERATURE]));
 #endif /* LOGGING */
+		data->Temperature.Type = DATA_TYPE_ERROR;
+		data->Temperature.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
+	}
+	/* relative humidity in % */
+	if(fdifftime(current_time,wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_RELATIVE_HUMIDITY]) <
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_PTH].Max_Datum_Age)
+	{
+		data->Humidity.Type = DATA_TYPE_DOUBLE;
+		data->Humidity.Value.DValue = wxt536_data.Pressure_Temp_Humidity_Data.Relative_Humidity;
 	}
 	else
 	{
 #if LOGGING > 1
 		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-			      "Qli50_Wxt536_Wxt536_Send_Results: Pressure/temperature/humidity data out of date (%.2f s).",
-			      fdifftime(current_time,Wxt536_Data.Pressure_Temp_Humidity_Timestamp));
+			      "Qli50_Wxt536_Wxt536_Send_Results: Relative humidity data out of date (%.2f s).",
+			      fdifftime(current_time,
+				 wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_RELATIVE_HUMIDITY]));
 #endif /* LOGGING */
-		data->Temperature.Type = DATA_TYPE_ERROR;
-		data->Temperature.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
 		data->Humidity.Type = DATA_TYPE_ERROR;
 		data->Humidity.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
+	}
+	/* air pressure in hPa/mbar */
+	if(fdifftime(current_time,wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_AIR_PRESSURE]) <
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_PTH].Max_Datum_Age)
+	{
+		data->Air_Pressure.Type = DATA_TYPE_DOUBLE;
+		data->Air_Pressure.Value.DValue = wxt536_data.Pressure_Temp_Humidity_Data.Air_Pressure;
+	}
+	else
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+			      "Qli50_Wxt536_Wxt536_Send_Results: Air pressure data out of date (%.2f s).",
+			      fdifftime(current_time,
+				 wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_AIR_PRESSURE]));
+#endif /* LOGGING */
 		data->Air_Pressure.Type = DATA_TYPE_ERROR;
 		data->Air_Pressure.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
+	}
+	/* Calculate the Dew point from the temperature and relative humidity, if they are both up to date */
+	if((data->Temperature.Type == DATA_TYPE_DOUBLE)&&(data->Humidity.Type == DATA_TYPE_DOUBLE))
+	{
+		data->Dew_Point.Type = DATA_TYPE_DOUBLE;
+		data->Dew_Point.Value.DValue = Wxt536_Calculate_Dew_Point(wxt536_data.Pressure_Temp_Humidity_Data);
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+	   "Qli50_Wxt536_Wxt536_Send_Results: Dew point %.2f C calculated from Air temperature %.2f C and Humidity %.2f %.",
+					data->Dew_Point.Value.DValue,
+					wxt536_data.Pressure_Temp_Humidity_Data.Air_Temperature,
+					wxt536_data.Pressure_Temp_Humidity_Data.Relative_Humidity);
+#endif /* LOGGING */
+	}
+	else
+	{
 		data->Dew_Point.Type = DATA_TYPE_ERROR;
 		data->Dew_Point.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
 	}
-	/* wind speed / direction */
-	if(fdifftime(current_time,Wxt536_Data.Wind_Timestamp) < Max_Datum_Age)
+	/* wind speed in m/s, currently using wxt536's average value */
+	if(fdifftime(current_time,wxt536_data.Wind_Timestamp[WXT536_COMMAND_WIND_SPEED_AVERAGE]) <
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_WIND].Max_Datum_Age)
 	{
-		/* wind speed in m/s, currently using wxt536's average value */
 		data->Wind_Speed.Type = DATA_TYPE_DOUBLE;
-		data->Wind_Speed.Value.DValue = Wxt536_Data.Wind_Data.Wind_Speed_Average;
-		/* wind direction in degrees, currently using wxt536's average value */
-		data->Wind_Direction.Type = DATA_TYPE_INT;
-		data->Wind_Direction.Value.IValue = Wxt536_Data.Wind_Data.Wind_Direction_Average;
+		data->Wind_Speed.Value.DValue = wxt536_data.Wind_Data.Wind_Speed_Average;
 	}
 	else
 	{
 #if LOGGING > 1
 		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
-			      "Qli50_Wxt536_Wxt536_Send_Results: Wind data out of date (%.2f s).",
-			      fdifftime(current_time,Wxt536_Data.Wind_Timestamp));
+			      "Qli50_Wxt536_Wxt536_Send_Results: Wind speed data out of date (%.2f s).",
+			      fdifftime(current_time,wxt536_data.Wind_Timestamp[WXT536_COMMAND_WIND_SPEED_AVERAGE]));
 #endif /* LOGGING */
 		data->Wind_Speed.Type = DATA_TYPE_ERROR;
 		data->Wind_Speed.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
+	}
+	/* wind direction in degrees, currently using wxt536's average value */
+	if(fdifftime(current_time,wxt536_data.Wind_Timestamp[WXT536_COMMAND_WIND_DIRECTION_AVERAGE]) <
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_WIND].Max_Datum_Age)
+	{
+		data->Wind_Direction.Type = DATA_TYPE_INT;
+		data->Wind_Direction.Value.IValue = wxt536_data.Wind_Data.Wind_Direction_Average;
+	}
+	else
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+			      "Qli50_Wxt536_Wxt536_Send_Results: Wind direction data out of date (%.2f s).",
+			      fdifftime(current_time,wxt536_data.Wind_Timestamp[WXT536_COMMAND_WIND_DIRECTION_AVERAGE]));
+#endif /* LOGGING */
 		data->Wind_Direction.Type = DATA_TYPE_ERROR;
 		data->Wind_Direction.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
 	}
 	/* QLI50 digital surface wetness, valid range 2..5. Output is an open collector, active low signal responds to rain. 
 	** Rain is held on for 2 minutes. 
 	** Basically, should be 0v when wet, and 5v when dry. */
-	Wxt536_Digital_Surface_Wet_Set(current_time,&(data->Digital_Surface_Wet));
+	Wxt536_Digital_Surface_Wet_Set(current_time,&wxt536_data,&(data->Digital_Surface_Wet));
 	/* analogue surface wetness, valid range 0..10. Actual DRD11A is 1v fully wet, 3v fully dry
 	** I think it's actually in percent, therefore 0..10% count as dry, above that it's wet */
-	Wxt536_Analogue_Surface_Wet_Set(current_time,&(data->Analogue_Surface_Wet));
+	Wxt536_Analogue_Surface_Wet_Set(current_time,&wxt536_data,&(data->Analogue_Surface_Wet));
 	/* pyranometer */
-	if(fdifftime(current_time,Wxt536_Data.Analogue_Timestamp) < Max_Datum_Age)
+	if(fdifftime(current_time,wxt536_data.Analogue_Timestamp[WXT536_COMMAND_SOLAR_RADIATION_VOLTAGE]) < 
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_ANALOGUE].Max_Datum_Age)
 	{
 		/* the Wxt536 pyranometer is connected to the analogue input. The Solar_Radiation_Voltage is in
 		** volts (multiplied by the gain).
 		** The Qli50 supplies Light as an integer, in Watts per metre squared. */
 		data->Light.Type = DATA_TYPE_INT;
-		data->Light.Value.IValue = Wxt536_Pyranometer_Volts_To_Watts_M2(Wxt536_Data.Analogue_Data.Solar_Radiation_Voltage);
+		data->Light.Value.IValue = Wxt536_Pyranometer_Volts_To_Watts_M2(wxt536_data.Analogue_Data.Solar_Radiation_Voltage);
 #if LOGGING > 5
 		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERY_VERBOSE,
 			      "Qli50_Wxt536_Wxt536_Send_Results: Pyranometer %d W/m^2 from %.5f v.",
-					data->Light.Value.IValue,Wxt536_Data.Analogue_Data.Solar_Radiation_Voltage);
+					data->Light.Value.IValue,wxt536_data.Analogue_Data.Solar_Radiation_Voltage);
 #endif /* LOGGING */
 	}
 	else
@@ -671,23 +1572,25 @@ int Qli50_Wxt536_Wxt536_Send_Results(char qli_id,char seq_id,struct Wms_Qli50_Da
 #if LOGGING > 1
 		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
 			      "Qli50_Wxt536_Wxt536_Send_Results: Pyranometer data out of date (%.2f s).",
-			      fdifftime(current_time,Wxt536_Data.Analogue_Timestamp));
+			      fdifftime(current_time,
+					wxt536_data.Analogue_Timestamp[WXT536_COMMAND_SOLAR_RADIATION_VOLTAGE]));
 #endif /* LOGGING */
 		data->Light.Type = DATA_TYPE_ERROR;
 		data->Light.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
 	}
-	if(fdifftime(current_time,Wxt536_Data.Supervisor_Timestamp) < Max_Datum_Age)
+	if(fdifftime(current_time,wxt536_data.Supervisor_Timestamp[WXT536_COMMAND_SUPPLY_VOLTAGE]) <
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_SUPERVISOR].Max_Datum_Age)
 	{
 		/* QLI50 internal voltage is the primary power voltage - which is the Wxt536 supply voltage */
 		data->Internal_Voltage.Type = DATA_TYPE_DOUBLE;
-		data->Internal_Voltage.Value.DValue = Wxt536_Data.Supervisor_Data.Supply_Voltage;
+		data->Internal_Voltage.Value.DValue = wxt536_data.Supervisor_Data.Supply_Voltage;
 	}
 	else
 	{
 #if LOGGING > 1
 		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
 			      "Qli50_Wxt536_Wxt536_Send_Results: Internal data out of date (%.2f s).",
-			      fdifftime(current_time,Wxt536_Data.Supervisor_Timestamp));
+			      fdifftime(current_time,wxt536_data.Supervisor_Timestamp[WXT536_COMMAND_SUPPLY_VOLTAGE]));
 #endif /* LOGGING */
 		data->Internal_Voltage.Type = DATA_TYPE_ERROR;
 		data->Internal_Voltage.Value.Error_Code = QLI50_ERROR_NO_MEASUREMENT;
@@ -739,9 +1642,2905 @@ int Qli50_Wxt536_Wxt536_Send_Results(char qli_id,char seq_id,struct Wms_Qli50_Da
 	return TRUE;
 }
 
-/* =======================================================
-** internal functions 
-** ======================================================= */
+/**
+ * Return the generation of the data Qli50_Wxt536_Wxt536_Send_Results would currently return for the
+ * specified qli_id. This changes when
+ * new Wxt536 data is published, when the settings in use are changed by reloading the config file, 
+ * and when a datum Qli50_Wxt536_Wxt536_Send_Results uses becomes older than
+ * it's data group's Max_Datum_Age (and would be returned as QLI50_ERROR_NO_MEASUREMENT). The Qli50 server 
+ * uses this to decide whether it's cached Send Results reply is still valid.
+ * @param qli_id A single character, representing the QLI Id of the Qli50 whose data is required.
+ * @return The generation, the sum of the published data's sequence number and Wxt536_Tuning_Generation 
+ *         (both only ever increase, so the sum changes whenever either does), combined with a bit per out of 
+ *         date datum.
+ * @see #Wxt536_Tuning_Generation
+ * @see #Wxt536_Startup_Done
+ * @see #Wxt536_Snapshot_Load
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Index_Get
+ * @see #Wxt536_Data_Snapshot_Get
+ * @see #Wxt536_Message_Group_List
+ * @see qli50_wxt536_general.html#fdifftime
+ */
+unsigned int Qli50_Wxt536_Wxt536_Send_Results_Generation_Get(char qli_id)
+{
+	struct Wxt536_Data_Struct wxt536_data;
+	struct timespec current_time;
+	unsigned int generation;
+
+	if(Wxt536_Startup_Done)
+	{
+		generation = (Wxt536_Data_Snapshot_Get(&(Wxt536_Device_List[Wxt536_Device_Index_Get(qli_id)].Data),
+						       &wxt536_data)+Wxt536_Tuning_Generation) << 9;
+	}
+	else
+	{
+		Wxt536_Snapshot_Load(qli_id,&wxt536_data);
+		generation = Wxt536_Tuning_Generation << 9;
+	}
+	clock_gettime(CLOCK_REALTIME,&current_time);
+	if(fdifftime(current_time,wxt536_data.Wind_Timestamp[WXT536_COMMAND_WIND_SPEED_AVERAGE]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_WIND].Max_Datum_Age)
+		generation |= (1<<0);
+	if(fdifftime(current_time,wxt536_data.Wind_Timestamp[WXT536_COMMAND_WIND_DIRECTION_AVERAGE]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_WIND].Max_Datum_Age)
+		generation |= (1<<1);
+	if(fdifftime(current_time,wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_AIR_TEMPERATURE]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_PTH].Max_Datum_Age)
+		generation |= (1<<2);
+	if(fdifftime(current_time,wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_RELATIVE_HUMIDITY]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_PTH].Max_Datum_Age)
+		generation |= (1<<3);
+	if(fdifftime(current_time,wxt536_data.Pressure_Temp_Humidity_Timestamp[WXT536_COMMAND_AIR_PRESSURE]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_PTH].Max_Datum_Age)
+		generation |= (1<<4);
+	if(fdifftime(current_time,wxt536_data.Rain_Timestamp[WXT536_COMMAND_RAIN_INTENSITY]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_PRECIPITATION].Max_Datum_Age)
+		generation |= (1<<5);
+	if(fdifftime(current_time,wxt536_data.Supervisor_Timestamp[WXT536_COMMAND_SUPPLY_VOLTAGE]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_SUPERVISOR].Max_Datum_Age)
+		generation |= (1<<6);
+	if(fdifftime(current_time,wxt536_data.Analogue_Timestamp[WXT536_COMMAND_ULTRASONIC_LEVEL_VOLTAGE]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_ANALOGUE].Max_Datum_Age)
+		generation |= (1<<7);
+	if(fdifftime(current_time,wxt536_data.Analogue_Timestamp[WXT536_COMMAND_SOLAR_RADIATION_VOLTAGE]) >=
+	   Wxt536_Message_Group_List[MESSAGE_GROUP_ANALOGUE].Max_Datum_Age)
+		generation |= (1<<8);
+	return generation;
+}
+
+/**
+ * Queue an engineering command to send to a Wxt536. Rather than sending the command at once (and colliding with 
+ * the data message requests on the serial link), the command is added to the QUEUE_PRIORITY_ENGINEERING class 
+ * of the Wxt536 command queue, and sent by the bus scheduler (Qli50_Wxt536_Wxt536_Timer) after any queued
+ * wetness and measurement data requests. When it's reply is received, Qli50_Wxt536_Wxt536_Read calls 
+ * reply_callback with the reply line. If the command cannot be sent, or no reply is received within 
+ * Wxt536_Read_Timeout, reply_callback is called with NULL. Engineering commands cannot be queued in automatic mode,
+ * as the replies cannot be told apart from the data messages the Wxt536 sends on it's own schedule, 
+ * or before the serial link startup has succeeded.
+ * @param command_string The command to send, without a terminator (e.g. "0XU"). 
+ *        The command starts with the device address of the Wxt536 it is sent to.
+ * @param reply_callback The routine to call with the reply to the command.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #QUEUE_COMMAND_LENGTH
+ * @see #QUEUE_LENGTH
+ * @see #Wxt536_Startup_Done
+ * @see #Wxt536_Automatic_Mode
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_Queue_Priority_Name_List
+ * @see #Wxt536_Queue_Add
+ * @see #Qli50_Wxt536_Wxt536_Timer
+ * @see #Qli50_Wxt536_Wxt536_Read
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+int Qli50_Wxt536_Wxt536_Engineering_Command_Queue(char *command_string,
+						  Qli50_Wxt536_Wxt536_Reply_Callback_T reply_callback)
+{
+	struct timespec current_time;
+	int device_index,i;
+
+	Qli50_Wxt536_Error_Number = 0;
+	if((command_string == NULL)||(reply_callback == NULL))
+	{
+		Qli50_Wxt536_Error_Number = 234;
+		sprintf(Qli50_Wxt536_Error_String,
+			"Qli50_Wxt536_Wxt536_Engineering_Command_Queue:command_string or reply_callback was NULL.");
+		return FALSE;
+	}
+	if((strlen(command_string) < 1)||(strlen(command_string) >= QUEUE_COMMAND_LENGTH))
+	{
+		Qli50_Wxt536_Error_Number = 235;
+		sprintf(Qli50_Wxt536_Error_String,
+			"Qli50_Wxt536_Wxt536_Engineering_Command_Queue:Command '%.32s' has illegal length %lu.",
+			command_string,strlen(command_string));
+		return FALSE;
+	}
+	if(Wxt536_Startup_Done == FALSE)
+	{
+		Qli50_Wxt536_Error_Number = 260;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Engineering_Command_Queue:"
+			"Cannot send '%s' until the Wxt536 link startup has finished.",command_string);
+		return FALSE;
+	}
+	if(Wxt536_Automatic_Mode)
+	{
+		Qli50_Wxt536_Error_Number = 236;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Engineering_Command_Queue:"
+			"Cannot send '%s' when the Wxt536 is in automatic mode.",command_string);
+		return FALSE;
+	}
+	/* find the Wxt536 the command is addressed to, for it's RS-485 line delay */
+	device_index = 0;
+	for(i = 0; i < Wxt536_Device_Count; i++)
+	{
+		if(Wxt536_Device_List[i].Address == command_string[0])
+			device_index = i;
+	}
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	if(!Wxt536_Queue_Add(QUEUE_PRIORITY_ENGINEERING,device_index,-1,command_string,reply_callback,current_time))
+	{
+		Qli50_Wxt536_Error_Number = 237;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Engineering_Command_Queue:"
+			"Failed to queue '%s', the %s command queue is full (%d commands).",command_string,
+			Wxt536_Queue_Priority_Name_List[QUEUE_PRIORITY_ENGINEERING],QUEUE_LENGTH);
+		return FALSE;
+	}
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Qli50_Wxt536_Wxt536_Engineering_Command_Queue:Queued '%s'.",command_string);
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Return whether the serial link startup thread is running. Whilst it is, the startup thread reads the 
+ * config file (e.g. the device address list), so the config file must not be reloaded.
+ * @return TRUE if the startup thread is running, FALSE otherwise.
+ * @see #Wxt536_Startup_Running
+ * @see #Qli50_Wxt536_Wxt536_Reload
+ */
+int Qli50_Wxt536_Wxt536_Startup_Running_Get(void)
+{
+	return Wxt536_Startup_Running;
+}
+
+/**
+ * Apply the settings in a reloaded config file, without reopening the serial link. The config file must already 
+ * have been parsed again (Qli50_Wxt536_Config_Load), and the startup thread must not be running.
+ * <ul>
+ * <li>We call Wxt536_Tuning_Get to read the settings that can be changed whilst running, and check them. 
+ *     If any are illegal, we fail and the settings in use are kept.
+ * <li>We call Wxt536_Reload_Restart_Check to log any changed settings that only take effect after a restart.
+ * <li>We call Wxt536_Tuning_Swap to swap the new settings in, all at once.
+ * <li>If the serial link startup has finished, we call Wxt536_Poll_Schedule_Check to check the polling schedule
+ *     against the new settings (if it fails, the previous settings are swapped back in), and 
+ *     Wxt536_Reload_Settings_Queue to queue commands writing any changed Wxt536 settings. Otherwise the next 
+ *     startup configures the Wxt536s with the new settings.
+ * </ul>
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Tuning_Struct
+ * @see #Wxt536_Startup_Running
+ * @see #Wxt536_Startup_Done
+ * @see #Wxt536_Tuning_Get
+ * @see #Wxt536_Tuning_Swap
+ * @see #Wxt536_Reload_Restart_Check
+ * @see #Wxt536_Reload_Settings_Queue
+ * @see #Wxt536_Poll_Schedule_Check
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Load
+ */
+int Qli50_Wxt536_Wxt536_Reload(void)
+{
+	struct Wxt536_Tuning_Struct tuning;
+
+	Qli50_Wxt536_Error_Number = 0;
+#if LOGGING > 1
+	Qli50_Wxt536_Log("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+			 "Qli50_Wxt536_Wxt536_Reload:Started.");
+#endif /* LOGGING */
+	if(Wxt536_Startup_Running)
+	{
+		Qli50_Wxt536_Error_Number = 265;
+		sprintf(Qli50_Wxt536_Error_String,"Qli50_Wxt536_Wxt536_Reload:"
+			"Cannot reload the config whilst the Wxt536 link startup is running.");
+		return FALSE;
+	}
+	if(!Wxt536_Tuning_Get(&tuning))
+		return FALSE;
+	Wxt536_Reload_Restart_Check();
+	/* after the swap, tuning holds the previous settings */
+	Wxt536_Tuning_Swap(&tuning);
+	if(Wxt536_Startup_Done)
+	{
+		if(!Wxt536_Poll_Schedule_Check())
+		{
+			Wxt536_Tuning_Swap(&tuning);
+			return FALSE;
+		}
+		if(!Wxt536_Reload_Settings_Queue(&tuning))
+			return FALSE;
+	}
+#if LOGGING > 1
+	Qli50_Wxt536_Log("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+			 "Qli50_Wxt536_Wxt536_Reload:Finished.");
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/* =======================================================
+** internal functions 
+** ======================================================= */
+/**
+ * Start the serial link startup (Wxt536_Startup) in a background thread (Wxt536_Startup_Thread).
+ * Whilst it is running the startup thread owns the Wxt536 serial link, so Wxt536_Startup_Running is set.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Startup_Thread
+ * @see #Wxt536_Startup_Thread_Id
+ * @see #Wxt536_Startup_Running
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+static int Wxt536_Startup_Begin(void)
+{
+	int retval;
+
+#if LOGGING > 1
+	Qli50_Wxt536_Log("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+			 "Wxt536_Startup_Begin:Starting the Wxt536 link startup thread.");
+#endif /* LOGGING */
+	Wxt536_Startup_Running = TRUE;
+	retval = pthread_create(&Wxt536_Startup_Thread_Id,NULL,Wxt536_Startup_Thread,NULL);
+	if(retval != 0)
+	{
+		Wxt536_Startup_Running = FALSE;
+		Qli50_Wxt536_Error_Number = 258;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Startup_Begin:pthread_create failed (%d:%s).",
+			retval,strerror(retval));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * The startup thread. We block all signals in this thread, so they (e.g. the SIGHUP that reloads the config file)
+ * are handled by the event loop thread, and do not interrupt the serial link startup.
+ * We call Wxt536_Startup to find and configure the Wxt536s. If this fails, we copy the 
+ * (thread local) error into Wxt536_Startup_Error_Number/String and close the serial link, so the startup can be 
+ * run again. We then write a byte to Wxt536_Startup_Pipe, to tell the event loop we have finished.
+ * @param user_arg Unused.
+ * @return The routine always returns NULL.
+ * @see #Wxt536_Startup
+ * @see #Wxt536_Startup_Status
+ * @see #Wxt536_Startup_Error_Number
+ * @see #Wxt536_Startup_Error_String
+ * @see #Wxt536_Startup_Pipe
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Close
+ */
+static void *Wxt536_Startup_Thread(void *user_arg)
+{
+	sigset_t signal_set;
+	char signal_byte = 'S';
+	int connection_open = FALSE;
+
+	sigfillset(&signal_set);
+	pthread_sigmask(SIG_BLOCK,&signal_set,NULL);
+	Wxt536_Startup_Status = Wxt536_Startup(&connection_open);
+	if(Wxt536_Startup_Status == FALSE)
+	{
+		Wxt536_Startup_Error_Number = Qli50_Wxt536_Error_Number;
+		strcpy(Wxt536_Startup_Error_String,Qli50_Wxt536_Error_String);
+		if(connection_open)
+			Wms_Wxt536_Connection_Close("Wxt536","qli50_wxt536_wxt536.c");
+	}
+	if(write(Wxt536_Startup_Pipe[1],&signal_byte,1) != 1)
+	{
+		Qli50_Wxt536_Error_Number = 261;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Startup_Thread:Failed to write startup pipe.");
+		Qli50_Wxt536_Error();
+	}
+	return NULL;
+}
+
+/**
+ * Find and configure the Wxt536s on the serial link. This is called from the startup thread, and can take
+ * a long time (or fail) if the Wxt536s are slow to reply, or absent. Qli50_Wxt536_Wxt536_Initialise must have
+ * read the configuration first.
+ * <ul>
+ * <li>We set the connection's read timeout to Wxt536_Read_Timeout using Wms_Wxt536_Connection_Read_Timeout_Set.
+ * <li>We open connection to the Wxt536 by calling Wms_Wxt536_Connection_Open with Serial_Device_Filename.
+ * <li>If Wxt536_RS485_Enable is set, we enable half-duplex direction control by calling
+ *     Wms_Wxt536_Connection_RS485_Set.
+ * <li>If Wxt536_Probe_Enable is set, we call Wxt536_Probe to find the Wxt536 and put it back to the default 
+ *     serial settings.
+ * <li>If Wxt536_Baud_Rate_Upgrade_Enable is set, we call Wxt536_Baud_Rate_Upgrade, which finds the Wxt536s and
+ *     moves them to the fastest configured baud rate that works. Otherwise we call Wxt536_Device_List_Get to
+ *     find the device addresses of the Wxt536s on the serial link, and store them in Wxt536_Device_List.
+ * <li>Automatic mode can only be used with one Wxt536, otherwise several Wxt536s would send data at once.
+ * <li>We configure each Wxt536 in Wxt536_Device_List by calling Wxt536_Device_Initialise, and mark it's link
+ *     as connected.
+ * <li>We call Wxt536_Poll_Schedule_Check to align the data group poll periods with the Wxt536 update intervals,
+ *     and check the data will not go stale between polls.
+ * <li>We log how long the Wxt536 link startup took.
+ * </ul>
+ * @param connection_open The address of an integer, set to TRUE once the serial link has been opened, so the caller
+ *        knows to close it if the startup fails.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Serial_Device_Filename
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_RS485_Enable
+ * @see #Wxt536_Probe_Enable
+ * @see #Wxt536_Baud_Rate_Upgrade_Enable
+ * @see #Wxt536_Read_Timeout
+ * @see #Wxt536_Automatic_Mode
+ * @see #Wxt536_Polled_Protocol
+ * @see #Wxt536_Protocol
+ * @see #Wxt536_Device_List_Get
+ * @see #Wxt536_Probe
+ * @see #Wxt536_Baud_Rate_Upgrade
+ * @see #Wxt536_Device_Initialise
+ * @see #Wxt536_Poll_Schedule_Check
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_general.html#fdifftime
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Open
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Read_Timeout_Set
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_RS485_Set
+ */
+static int Wxt536_Startup(int *connection_open)
+{
+	struct timespec start_time,end_time;
+	int i;
+
+	Qli50_Wxt536_Error_Number = 0;
+	clock_gettime(CLOCK_MONOTONIC,&start_time);
+#if LOGGING > 5
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+				"Wxt536_Startup:Opening connection to Wxt536.");
+#endif /* LOGGING */
+	if(!Wms_Wxt536_Connection_Read_Timeout_Set(Wxt536_Read_Timeout))
+	{
+		Qli50_Wxt536_Error_Number = 222;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Startup:Wms_Wxt536_Connection_Read_Timeout_Set(%d) failed.",
+			Wxt536_Read_Timeout);
+		return FALSE;
+	}
+	if(!Wms_Wxt536_Connection_Open("Wxt536","qli50_wxt536_wxt536.c",Serial_Device_Filename))
+	{
+		Qli50_Wxt536_Error_Number = 200;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Startup:Wms_Wxt536_Connection_Open(%s) failed.",
+			Serial_Device_Filename);
+		return FALSE;
+	}
+	(*connection_open) = TRUE;
+	if(Wxt536_RS485_Enable)
+	{
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Startup:Enable RS-485 direction control.");
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Connection_RS485_Set("Wxt536","qli50_wxt536_wxt536.c",TRUE))
+		{
+			Qli50_Wxt536_Error_Number = 225;
+			sprintf(Qli50_Wxt536_Error_String,
+				"Wxt536_Startup:Failed to enable RS-485 direction control on '%s'.",
+				Serial_Device_Filename);
+			return FALSE;
+		}
+	}
+	if(Wxt536_Probe_Enable)
+	{
+		if(!Wxt536_Probe())
+			return FALSE;
+	}
+	/* get the device addresses of the connected Wxt536s, and store for later use. */
+	if(Wxt536_Baud_Rate_Upgrade_Enable)
+	{
+		if(!Wxt536_Baud_Rate_Upgrade())
+			return FALSE;
+	}
+	else
+	{
+		if(!Wxt536_Device_List_Get())
+			return FALSE;
+	}
+	if(Wxt536_Automatic_Mode&&(Wxt536_Device_Count > 1))
+	{
+		Qli50_Wxt536_Error_Number = 230;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Startup: "
+			"Automatic protocol '%c' cannot be used with %d Wxt536s on one serial link.",
+			Wxt536_Protocol,Wxt536_Device_Count);
+		return FALSE;
+	}
+	/* configure each Wxt536 */
+	for(i = 0; i < Wxt536_Device_Count; i++)
+	{
+		if(!Wxt536_Device_Initialise(&(Wxt536_Device_List[i]),Wxt536_Polled_Protocol,Wxt536_Protocol))
+			return FALSE;
+		Wxt536_Device_List[i].Link_State = LINK_STATE_CONNECTED;
+		Wxt536_Device_List[i].Failure_Count = 0;
+		Wxt536_Device_List[i].Probe_Queued = FALSE;
+	}
+	/* align the data group poll periods with the Wxt536 update intervals */
+	if(!Wxt536_Poll_Schedule_Check())
+		return FALSE;
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Startup:Finished, Wxt536 link startup took %.3f s.",
+				fdifftime(end_time,start_time));
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Find the device addresses of the Wxt536s on the serial link, and store them in Wxt536_Device_List.
+ * The device addresses are retrieved from the config file (keyword "wxt536.device_address.list"), which is one of:
+ * <ul>
+ * <li><b>?</b> There is one Wxt536 on the serial link, and we get it's device address using 
+ *     Wms_Wxt536_Command_Device_Address_Get.
+ * <li><b>*</b> We scan every possible device address for Wxt536s using Wms_Wxt536_Command_Device_Address_Scan,
+ *     waiting Wxt536_Device_Address_Scan_Timeout milliseconds (keyword "wxt536.device_address.scan_timeout") 
+ *     for each address to reply.
+ * <li>Otherwise, a list of the device addresses of the Wxt536s on the serial link, e.g. "012".
+ * </ul>
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #DEVICE_COUNT_MAX
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_Device_Address_Scan_Timeout
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_String_Get
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Int_Get
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#WXT536_COMMAND_DEVICE_ADDRESS_LIST
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Device_Address_Get
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Device_Address_Scan
+ */
+static int Wxt536_Device_List_Get(void)
+{
+	char device_address_list[DEVICE_COUNT_MAX+2];
+	int i;
+
+	if(!Qli50_Wxt536_Config_String_Get("wxt536.device_address.list",device_address_list,DEVICE_COUNT_MAX+1))
+		return FALSE;
+	if(strcmp(device_address_list,"?") == 0)
+	{
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Device_List_Get:Get Wxt536 device address.");
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Command_Device_Address_Get("Wxt536","qli50_wxt536_wxt536.c",&(device_address_list[0])))
+		{
+			Qli50_Wxt536_Error_Number = 201;
+			sprintf(Qli50_Wxt536_Error_String,
+				"Wxt536_Device_List_Get: Failed to retrieve Wxt536 device address.");		
+			return FALSE;
+		}
+		device_address_list[1] = '\0';
+	}
+	else if(strcmp(device_address_list,"*") == 0)
+	{
+		if(!Qli50_Wxt536_Config_Int_Get("wxt536.device_address.scan_timeout",
+						&Wxt536_Device_Address_Scan_Timeout))
+			return FALSE;
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Device_List_Get:Scan for Wxt536 device addresses (%d ms per address).",
+					Wxt536_Device_Address_Scan_Timeout);
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Command_Device_Address_Scan("Wxt536","qli50_wxt536_wxt536.c",
+							   Wxt536_Device_Address_Scan_Timeout,device_address_list,
+							   DEVICE_COUNT_MAX,&i))
+		{
+			Qli50_Wxt536_Error_Number = 226;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_List_Get: Failed to scan for Wxt536 device addresses.");
+			return FALSE;
+		}
+		device_address_list[i] = '\0';
+	}
+	Wxt536_Device_Count = strlen(device_address_list);
+	if(Wxt536_Device_Count < 1)
+	{
+		Qli50_Wxt536_Error_Number = 227;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_List_Get: No Wxt536s found.");
+		return FALSE;
+	}
+	if(Wxt536_Device_Count > DEVICE_COUNT_MAX)
+	{
+		Qli50_Wxt536_Error_Number = 228;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_List_Get: Too many device addresses in '%s'.",
+			device_address_list);
+		Wxt536_Device_Count = 0;
+		return FALSE;
+	}
+	for(i = 0; i < Wxt536_Device_Count; i++)
+	{
+		if(strchr(WXT536_COMMAND_DEVICE_ADDRESS_LIST,device_address_list[i]) == NULL)
+		{
+			Qli50_Wxt536_Error_Number = 229;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_List_Get: Illegal device address '%c' in '%s'.",
+				device_address_list[i],device_address_list);
+			Wxt536_Device_Count = 0;
+			return FALSE;
+		}
+		Wxt536_Device_List[i].Address = device_address_list[i];
+		Wxt536_Device_List[i].RS485_Line_Delay = 0;
+		/* until the Wxt536 is initialised, assume it uses the CRC mode found whilst probing the serial link */
+		Wxt536_Device_List[i].CRC_Enable = Wms_Wxt536_Command_CRC_Enable_Get();
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Device_List_Get:Wxt536 %d has device address '%c' (QLI Id '%c').",
+					i,Wxt536_Device_List[i].Address,'A'+i);
+#endif /* LOGGING */
+	}
+	return TRUE;
+}
+
+/**
+ * Find the serial settings and protocol the Wxt536 is using, in case it has been power cycled or reconfigured by hand,
+ * and put it back to the default serial settings (BAUD_RATE_DEFAULT, 8 data bits, no parity, 1 stop bit) 
+ * the rest of the initialisation expects. The protocol is put back later, by Wxt536_Device_Initialise.
+ * <ul>
+ * <li>We retrieve how long to wait for each probe to be answered from the config file 
+ *     (keyword "wxt536.probe.timeout").
+ * <li>We retrieve the device addresses from the config file (keyword "wxt536.device_address.list"). If this is
+ *     '?' or '*' we probe for a single Wxt536 at any device address, otherwise we probe for the first listed
+ *     device address.
+ * <li>We call Wms_Wxt536_Command_Comms_Probe to find the Wxt536's serial settings and protocol. This leaves the 
+ *     connection using the Wxt536's serial settings.
+ * <li>If these are not the default serial settings, we call Wms_Wxt536_Command_Comms_Settings_Serial_Set to 
+ *     put the Wxt536 back to the default serial settings, switch the connection to match using 
+ *     Wms_Wxt536_Connection_Baud_Rate_Set and Wms_Wxt536_Connection_Framing_Set, call Wxt536_Serial_Settle,
+ *     and check the Wxt536 acknowledges commands using Wms_Wxt536_Command_Ack_Active.
+ * </ul>
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #BAUD_RATE_DEFAULT
+ * @see #DEVICE_COUNT_MAX
+ * @see #Wxt536_Baud_Rate
+ * @see #Wxt536_Serial_Settle
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_String_Get
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Int_Get
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Probe
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Serial_Set
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Ack_Active
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Baud_Rate_Set
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Framing_Set
+ */
+static int Wxt536_Probe(void)
+{
+	struct Wxt536_Command_Comms_Settings_Struct comms_settings;
+	char device_address_list[DEVICE_COUNT_MAX+2];
+	char device_address;
+	int probe_timeout;
+
+	if(!Qli50_Wxt536_Config_Int_Get("wxt536.probe.timeout",&probe_timeout))
+		return FALSE;
+	if(!Qli50_Wxt536_Config_String_Get("wxt536.device_address.list",device_address_list,DEVICE_COUNT_MAX+1))
+		return FALSE;
+	if((strcmp(device_address_list,"?") == 0)||(strcmp(device_address_list,"*") == 0))
+		device_address = '?';
+	else
+		device_address = device_address_list[0];
+#if LOGGING > 5
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+				"Wxt536_Probe:Probing for Wxt536 '%c' (%d ms per probe).",device_address,probe_timeout);
+#endif /* LOGGING */
+	if(!Wms_Wxt536_Command_Comms_Probe("Wxt536","qli50_wxt536_wxt536.c",device_address,probe_timeout,
+					   &comms_settings))
+	{
+		Qli50_Wxt536_Error_Number = 247;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Probe: Failed to find Wxt536 '%c'.",device_address);
+		return FALSE;
+	}
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Probe:Wxt536 '%c' is using %d %d%c%d and protocol '%c'.",comms_settings.Address,
+				comms_settings.Baud_Rate,comms_settings.Data_Bits,comms_settings.Parity,
+				comms_settings.Stop_Bits,comms_settings.Protocol);
+#endif /* LOGGING */
+	if((comms_settings.Baud_Rate == BAUD_RATE_DEFAULT)&&(comms_settings.Data_Bits == 8)&&
+	   (comms_settings.Parity == 'N')&&(comms_settings.Stop_Bits == 1))
+	{
+		Wxt536_Baud_Rate = BAUD_RATE_DEFAULT;
+		return TRUE;
+	}
+	/* put the Wxt536 back to the default serial settings */
+	if(!Wms_Wxt536_Command_Comms_Settings_Serial_Set("Wxt536","qli50_wxt536_wxt536.c",comms_settings.Address,
+							 BAUD_RATE_DEFAULT,8,'N',1))
+	{
+		Qli50_Wxt536_Error_Number = 248;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Probe: Failed to set Wxt536 '%c' to %d 8N1.",
+			comms_settings.Address,BAUD_RATE_DEFAULT);
+		return FALSE;
+	}
+	if((!Wms_Wxt536_Connection_Baud_Rate_Set("Wxt536","qli50_wxt536_wxt536.c",BAUD_RATE_DEFAULT))||
+	   (!Wms_Wxt536_Connection_Framing_Set("Wxt536","qli50_wxt536_wxt536.c",8,'N',1)))
+	{
+		Qli50_Wxt536_Error_Number = 249;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Probe: Failed to set the serial link to %d 8N1.",
+			BAUD_RATE_DEFAULT);
+		return FALSE;
+	}
+	Wxt536_Baud_Rate = BAUD_RATE_DEFAULT;
+	Wxt536_Serial_Settle();
+	if(!Wms_Wxt536_Command_Ack_Active("Wxt536","qli50_wxt536_wxt536.c",comms_settings.Address))
+	{
+		Qli50_Wxt536_Error_Number = 250;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Probe: Wxt536 '%c' did not acknowledge at %d 8N1.",
+			comms_settings.Address,BAUD_RATE_DEFAULT);
+		return FALSE;
+	}
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Probe:Wxt536 '%c' is back to %d 8N1.",comms_settings.Address,BAUD_RATE_DEFAULT);
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Find the Wxt536s on the serial link, and move them to the fastest baud rate in Wxt536_Baud_Rate_List that works.
+ * <ul>
+ * <li>We call Wxt536_Baud_Rate_List_Get to retrieve the baud rates to try from the config file.
+ * <li>We call Wxt536_Baud_Rate_Find to find the baud rate the Wxt536s are currently using. A previous run
+ *     may have left them at one of the baud rates in Wxt536_Baud_Rate_List.
+ * <li>We try each baud rate in Wxt536_Baud_Rate_List faster than Wxt536_Baud_Rate in turn, by calling 
+ *     Wxt536_Baud_Rate_Switch. This tells each Wxt536 to change baud rate, changes the serial link's baud rate,
+ *     and checks every Wxt536 still acknowledges commands. We stop at the first baud rate that works.
+ * <li>If a baud rate does not work (for instance, the cable cannot support it), we call Wxt536_Baud_Rate_Switch 
+ *     again to move the Wxt536s back to the previous baud rate, and try the next one.
+ * </ul>
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Baud_Rate_List
+ * @see #Wxt536_Baud_Rate_Count
+ * @see #Wxt536_Baud_Rate
+ * @see #Wxt536_Baud_Rate_List_Get
+ * @see #Wxt536_Baud_Rate_Find
+ * @see #Wxt536_Baud_Rate_Switch
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+static int Wxt536_Baud_Rate_Upgrade(void)
+{
+	int i,previous_baud_rate;
+
+	if(!Wxt536_Baud_Rate_List_Get())
+		return FALSE;
+	if(!Wxt536_Baud_Rate_Find())
+		return FALSE;
+	for(i = 0; i < Wxt536_Baud_Rate_Count; i++)
+	{
+		if(Wxt536_Baud_Rate_List[i] <= Wxt536_Baud_Rate)
+			continue;
+		previous_baud_rate = Wxt536_Baud_Rate;
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Baud_Rate_Upgrade:Trying to move the Wxt536s from %d to %d baud.",
+					previous_baud_rate,Wxt536_Baud_Rate_List[i]);
+#endif /* LOGGING */
+		if(Wxt536_Baud_Rate_Switch(Wxt536_Baud_Rate_List[i]))
+			break;
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Baud_Rate_Upgrade:%d baud failed (%d:%s), moving back to %d baud.",
+					Wxt536_Baud_Rate_List[i],Qli50_Wxt536_Error_Number,Qli50_Wxt536_Error_String,
+					previous_baud_rate);
+#endif /* LOGGING */
+		if(!Wxt536_Baud_Rate_Switch(previous_baud_rate))
+		{
+			Qli50_Wxt536_Error_Number = 243;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Baud_Rate_Upgrade: "
+				"Failed to move the Wxt536s back to %d baud after %d baud failed.",
+				previous_baud_rate,Wxt536_Baud_Rate_List[i]);
+			return FALSE;
+		}
+	}
+	Qli50_Wxt536_Error_Number = 0;
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Baud_Rate_Upgrade:The Wxt536s are using %d baud.",Wxt536_Baud_Rate);
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Retrieve the baud rates to try moving the Wxt536s to from the config file (keyword "wxt536.baud_rate.list"),
+ * a whitespace separated list of baud rates, fastest first, e.g. "115200 57600 38400". 
+ * Each baud rate must be one the Wxt536 supports.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #BAUD_RATE_COUNT_MAX
+ * @see #Wxt536_Baud_Rate_List
+ * @see #Wxt536_Baud_Rate_Count
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_String_Get
+ */
+static int Wxt536_Baud_Rate_List_Get(void)
+{
+	char baud_rate_list_string[256];
+	char *token_string = NULL;
+	int baud_rate;
+
+	if(!Qli50_Wxt536_Config_String_Get("wxt536.baud_rate.list",baud_rate_list_string,255))
+		return FALSE;
+	Wxt536_Baud_Rate_Count = 0;
+	token_string = strtok(baud_rate_list_string," \t");
+	while(token_string != NULL)
+	{
+		if(Wxt536_Baud_Rate_Count >= BAUD_RATE_COUNT_MAX)
+		{
+			Qli50_Wxt536_Error_Number = 241;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Baud_Rate_List_Get: Too many baud rates (max %d).",
+				BAUD_RATE_COUNT_MAX);
+			return FALSE;
+		}
+		if((sscanf(token_string,"%d",&baud_rate) != 1)||((baud_rate != 1200)&&(baud_rate != 2400)&&
+								  (baud_rate != 4800)&&(baud_rate != 9600)&&
+								  (baud_rate != 19200)&&(baud_rate != 38400)&&
+								  (baud_rate != 57600)&&(baud_rate != 115200)))
+		{
+			Qli50_Wxt536_Error_Number = 242;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Baud_Rate_List_Get: Illegal baud rate '%s'.",
+				token_string);
+			return FALSE;
+		}
+		Wxt536_Baud_Rate_List[Wxt536_Baud_Rate_Count++] = baud_rate;
+		token_string = strtok(NULL," \t");
+	}
+	return TRUE;
+}
+
+/**
+ * Find the baud rate the Wxt536s are currently using. We try BAUD_RATE_DEFAULT first, and then each baud rate in 
+ * Wxt536_Baud_Rate_List. At each baud rate, we change the serial link's baud rate using 
+ * Wms_Wxt536_Connection_Baud_Rate_Set, call Wxt536_Device_List_Get to find the Wxt536s, and call 
+ * Wxt536_Baud_Rate_Verify to check they all acknowledge commands. Once Wxt536_Device_List_Get has found some
+ * Wxt536s at one baud rate, we reuse that device list at the remaining baud rates rather than looking for the
+ * Wxt536s again (with a device address list of '*', that would rescan every device address).
+ * If none of the baud rates work, the serial link is left at BAUD_RATE_DEFAULT.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #BAUD_RATE_DEFAULT
+ * @see #Wxt536_Baud_Rate_List
+ * @see #Wxt536_Baud_Rate_Count
+ * @see #Wxt536_Baud_Rate
+ * @see #Wxt536_Device_List_Get
+ * @see #Wxt536_Baud_Rate_Verify
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Baud_Rate_Set
+ */
+static int Wxt536_Baud_Rate_Find(void)
+{
+	int i,baud_rate,device_list_found = FALSE;
+
+	for(i = -1; i < Wxt536_Baud_Rate_Count; i++)
+	{
+		if(i < 0)
+			baud_rate = BAUD_RATE_DEFAULT;
+		else if(Wxt536_Baud_Rate_List[i] == BAUD_RATE_DEFAULT)
+			continue;
+		else
+			baud_rate = Wxt536_Baud_Rate_List[i];
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Baud_Rate_Find:Looking for the Wxt536s at %d baud.",baud_rate);
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Connection_Baud_Rate_Set("Wxt536","qli50_wxt536_wxt536.c",baud_rate))
+		{
+			Qli50_Wxt536_Error_Number = 244;
+			sprintf(Qli50_Wxt536_Error_String,
+				"Wxt536_Baud_Rate_Find: Failed to set the serial link to %d baud.",baud_rate);
+			return FALSE;
+		}
+		Wxt536_Baud_Rate = baud_rate;
+		if(!device_list_found)
+		{
+			if(!Wxt536_Device_List_Get())
+				continue;
+			device_list_found = TRUE;
+		}
+		if(Wxt536_Baud_Rate_Verify())
+		{
+#if LOGGING > 1
+			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+						"Wxt536_Baud_Rate_Find:Found the Wxt536s at %d baud.",baud_rate);
+#endif /* LOGGING */
+			return TRUE;
+		}
+	}
+	if(Wms_Wxt536_Connection_Baud_Rate_Set("Wxt536","qli50_wxt536_wxt536.c",BAUD_RATE_DEFAULT))
+		Wxt536_Baud_Rate = BAUD_RATE_DEFAULT;
+	Qli50_Wxt536_Error_Number = 245;
+	sprintf(Qli50_Wxt536_Error_String,"Wxt536_Baud_Rate_Find: No Wxt536s found at any baud rate.");
+	return FALSE;
+}
+
+/**
+ * Move the Wxt536s on the serial link to a new baud rate. We tell each Wxt536 in Wxt536_Device_List to use the
+ * new baud rate using Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set (a Wxt536 that does not reply may already 
+ * have changed baud rate, so we carry on regardless), change the serial link's baud rate using 
+ * Wms_Wxt536_Connection_Baud_Rate_Set, call Wxt536_Serial_Settle to let the Wxt536s switch, and call 
+ * Wxt536_Baud_Rate_Verify to check every Wxt536 acknowledges commands at the new baud rate.
+ * @param baud_rate The baud rate to move to.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_Baud_Rate
+ * @see #Wxt536_Serial_Settle
+ * @see #Wxt536_Baud_Rate_Verify
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Baud_Rate_Set
+ */
+static int Wxt536_Baud_Rate_Switch(int baud_rate)
+{
+	int i;
+
+	for(i = 0; i < Wxt536_Device_Count; i++)
+	{
+		if(!Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set("Wxt536","qli50_wxt536_wxt536.c",
+								    Wxt536_Device_List[i].Address,baud_rate))
+		{
+#if LOGGING > 1
+			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+						"Wxt536_Baud_Rate_Switch:Wxt536 '%c' did not acknowledge %d baud.",
+						Wxt536_Device_List[i].Address,baud_rate);
+#endif /* LOGGING */
+		}
+	}
+	if(!Wms_Wxt536_Connection_Baud_Rate_Set("Wxt536","qli50_wxt536_wxt536.c",baud_rate))
+	{
+		Qli50_Wxt536_Error_Number = 244;
+		sprintf(Qli50_Wxt536_Error_String,
+			"Wxt536_Baud_Rate_Switch: Failed to set the serial link to %d baud.",baud_rate);
+		return FALSE;
+	}
+	Wxt536_Baud_Rate = baud_rate;
+	Wxt536_Serial_Settle();
+	return Wxt536_Baud_Rate_Verify();
+}
+
+/**
+ * Check every Wxt536 in Wxt536_Device_List acknowledges commands at the current baud rate, 
+ * using Wms_Wxt536_Command_Ack_Active.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_Baud_Rate
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Ack_Active
+ */
+static int Wxt536_Baud_Rate_Verify(void)
+{
+	int i;
+
+	for(i = 0; i < Wxt536_Device_Count; i++)
+	{
+		if(!Wms_Wxt536_Command_Ack_Active("Wxt536","qli50_wxt536_wxt536.c",Wxt536_Device_List[i].Address))
+		{
+			Qli50_Wxt536_Error_Number = 246;
+			sprintf(Qli50_Wxt536_Error_String,
+				"Wxt536_Baud_Rate_Verify: Wxt536 '%c' did not acknowledge at %d baud.",
+				Wxt536_Device_List[i].Address,Wxt536_Baud_Rate);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Wait BAUD_RATE_SETTLE_TIME milliseconds after changing the serial settings of the Wxt536s and the serial link,
+ * to give the Wxt536s time to switch before we talk to them again.
+ * @see #BAUD_RATE_SETTLE_TIME
+ */
+static void Wxt536_Serial_Settle(void)
+{
+	struct timespec settle_time;
+
+	settle_time.tv_sec = 0;
+	settle_time.tv_nsec = BAUD_RATE_SETTLE_TIME*1000000L;
+	nanosleep(&settle_time,NULL);
+}
+
+/**
+ * Configure one of the Wxt536s on the serial link. The Wxt536 stores it's settings in non-volatile memory,
+ * so most are read first, and only written if they differ from the configuration. This saves a round trip
+ * (and a non-volatile memory write on the Wxt536) for each setting that is already correct.
+ * <ul>
+ * <li>We set the Wxt536 library's CRC use from the device's CRC_Enable, using Wms_Wxt536_Command_CRC_Enable_Set.
+ * <li>We retrieve the Wxt536's communication settings using Wms_Wxt536_Command_Comms_Settings_Get, and cache them
+ *     in the device's Comms_Settings (for the link supervisor). If Wxt536_RS485_Enable is set, we store 
+ *     the Wxt536's RS-485 line delay in the device's RS485_Line_Delay. 
+ *     The poll scheduler allows for this delay when waiting for replies.
+ * <li>If the Wxt536 is not using the polled protocol, we call Wms_Wxt536_Command_Comms_Settings_Protocol_Set 
+ *     to set it. Otherwise we call Wms_Wxt536_Command_CRC_Enable_Set, so commands use a CRC if the protocol 
+ *     requires one.
+ * <li>If Wxt536_Composite_Data_Enable is TRUE, we call Wms_Wxt536_Command_Composite_Data_Configure to configure 
+ *     the composite data message fields (this only changes the fields that differ).
+ * <li>We retrieve the Wxt536's analogue input settings using Wms_Wxt536_Command_Analogue_Input_Settings_Get, and
+ *     if they differ from Wxt536_Analogue_Input_Update_Interval and Wxt536_Analogue_Input_Averaging_Time,
+ *     we set them using Wms_Wxt536_Command_Analogue_Input_Settings_Set.
+ * <li>We retrieve the Wxt536's solar radiation gain using Wms_Wxt536_Command_Solar_Radiation_Gain_Get, and if it
+ *     differs from Wxt536_Pyranometer_Gain, we set it using Wms_Wxt536_Command_Solar_Radiation_Gain_Set.
+ * <li>If the data groups are polled individually (neither Wxt536_Composite_Data_Enable nor Wxt536_Automatic_Mode
+ *     are set), we call Wxt536_Update_Interval_Get to retrieve how often the Wxt536 updates each data group.
+ * <li>If Wxt536_Automatic_Mode is set, we call Wms_Wxt536_Command_Comms_Settings_Composite_Interval_Set to set 
+ *     the composite data message repeat interval (or turn it off, if Wxt536_Composite_Data_Enable is FALSE),
+ *     if it differs. We then call Wms_Wxt536_Command_Comms_Settings_Protocol_Set to switch the Wxt536 
+ *     into automatic mode.
+ * <li>We save the library's resulting CRC use in the device's CRC_Enable.
+ * </ul>
+ * How long the configuration took, and how many settings were written, is logged.
+ * @param device The address of the Wxt536_Device_Struct describing the Wxt536 to configure.
+ * @param polled_protocol The polled protocol to configure the Wxt536 with ('P' or 'p').
+ * @param protocol The protocol to use once the Wxt536 is configured. This differs from polled_protocol 
+ *        in automatic mode.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Device_Struct
+ * @see #Wxt536_RS485_Enable
+ * @see #Wxt536_Composite_Data_Enable
+ * @see #Wxt536_Automatic_Mode
+ * @see #Wxt536_Automatic_Composite_Interval
+ * @see #Wxt536_Analogue_Input_Update_Interval
+ * @see #Wxt536_Analogue_Input_Averaging_Time
+ * @see #Wxt536_Pyranometer_Gain
+ * @see #Wxt536_Update_Interval_Get
+ * @see #SETTING_TOLERANCE
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_general.html#fdifftime
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Get
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Protocol_Set
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_CRC_Enable_Set
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Solar_Radiation_Gain_Get
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Solar_Radiation_Gain_Set
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Analogue_Input_Settings_Get
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Analogue_Input_Settings_Set
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Composite_Data_Configure
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Composite_Interval_Set
+ */
+static int Wxt536_Device_Initialise(struct Wxt536_Device_Struct *device,char polled_protocol,char protocol)
+{
+	struct timespec start_time,end_time;
+	double update_interval,averaging_time,gain;
+	int composite_interval,write_count;
+
+	clock_gettime(CLOCK_MONOTONIC,&start_time);
+	write_count = 0;
+	if(!Wms_Wxt536_Command_CRC_Enable_Set(device->CRC_Enable))
+	{
+		Qli50_Wxt536_Error_Number = 271;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+			"Failed to set the CRC use for Wxt536 device address '%c'.",device->Address);
+		return FALSE;
+	}
+	/* get the Wxt536's protocol, and how long it waits before replying on the RS-485 bus */
+	if(!Wms_Wxt536_Command_Comms_Settings_Get("Wxt536","qli50_wxt536_wxt536.c",device->Address,
+						  &(device->Comms_Settings)))
+	{
+		Qli50_Wxt536_Error_Number = 231;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+			"Failed to get the communication settings for Wxt536 device address '%c'.",
+			device->Address);
+		return FALSE;
+	}
+	if(Wxt536_RS485_Enable)
+	{
+		device->RS485_Line_Delay = device->Comms_Settings.RS485_Line_Delay;
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Device_Initialise:Wxt536 device address '%c' has RS-485 line delay %d ms.",
+					device->Address,device->RS485_Line_Delay);
+#endif /* LOGGING */
+	}
+	/* ensure the protocol is setup correctly. */
+	if(device->Comms_Settings.Protocol != polled_protocol)
+	{
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Device_Initialise:Set the Wxt536 device address '%c' protocol "
+					"from '%c' to '%c'.",device->Address,device->Comms_Settings.Protocol,
+					polled_protocol);
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Command_Comms_Settings_Protocol_Set("Wxt536","qli50_wxt536_wxt536.c",device->Address,
+								   polled_protocol))
+		{
+			Qli50_Wxt536_Error_Number = 204;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+				"Failed to set the communication protocol to '%c' "
+				"for Wxt536 device address '%c'.",polled_protocol,device->Address);		
+			return FALSE;
+		}
+		device->Comms_Settings.Protocol = polled_protocol;
+		write_count++;
+	}
+	else
+	{
+		/* the protocol was not set, so tell the library whether it uses a CRC */
+		if(!Wms_Wxt536_Command_CRC_Enable_Set(polled_protocol == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_POLLED_CRC))
+		{
+			Qli50_Wxt536_Error_Number = 255;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+				"Failed to set the CRC use for protocol '%c'.",polled_protocol);
+			return FALSE;
+		}
+	}
+	if(Wxt536_Composite_Data_Enable)
+	{
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Device_Initialise:Configure the Wxt536 composite data message.");
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Command_Composite_Data_Configure("Wxt536","qli50_wxt536_wxt536.c",device->Address))
+		{
+			Qli50_Wxt536_Error_Number = 217;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+				"Failed to configure the composite data message for Wxt536 device address '%c'.",
+				device->Address);
+			return FALSE;
+		}
+	}
+	/* set the wxt536 to use the configured analogue input settings, if it is not already */
+	if(!Wms_Wxt536_Command_Analogue_Input_Settings_Get("Wxt536","qli50_wxt536_wxt536.c",device->Address,
+							   &update_interval,&averaging_time))
+	{
+		Qli50_Wxt536_Error_Number = 252;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+			"Failed to get the analogue input settings for Wxt536 device address '%c'.",device->Address);
+		return FALSE;
+	}
+	if((fabs(update_interval-Wxt536_Analogue_Input_Update_Interval) > SETTING_TOLERANCE)||
+	   (fabs(averaging_time-Wxt536_Analogue_Input_Averaging_Time) > SETTING_TOLERANCE))
+	{
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Device_Initialise:Set the Wxt536 analogue input settings "
+					"(were update interval %.3f s, averaging time %.3f s).",update_interval,averaging_time);
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Command_Analogue_Input_Settings_Set("Wxt536","qli50_wxt536_wxt536.c",device->Address,
+								   Wxt536_Analogue_Input_Update_Interval,
+								   Wxt536_Analogue_Input_Averaging_Time))
+		{
+			Qli50_Wxt536_Error_Number = 214;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+				"Failed to set the anagloue input settings to update interval %.3f s, "
+				"averaging time %.3f s for Wxt536 device address '%c'.",
+				Wxt536_Analogue_Input_Update_Interval,Wxt536_Analogue_Input_Averaging_Time,
+				device->Address);
+			return FALSE;
+		}
+		write_count++;
+	}
+	/* set the wxt536 to use the configured gain, if it is not already */
+	if(!Wms_Wxt536_Command_Solar_Radiation_Gain_Get("Wxt536","qli50_wxt536_wxt536.c",device->Address,&gain))
+	{
+		Qli50_Wxt536_Error_Number = 256;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+			"Failed to get the pyranometer gain for Wxt536 device address '%c'.",device->Address);
+		return FALSE;
+	}
+	if(fabs(gain-Wxt536_Pyranometer_Gain) > SETTING_TOLERANCE)
+	{
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Device_Initialise:Set the Wxt536 pyranometer gain (was %.3f).",gain);
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Command_Solar_Radiation_Gain_Set("Wxt536","qli50_wxt536_wxt536.c",device->Address,
+								Wxt536_Pyranometer_Gain))
+		{
+			Qli50_Wxt536_Error_Number = 213;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+				"Failed to set the pyranometer gain to '%.3f' for Wxt536 device address '%c'.",
+				Wxt536_Pyranometer_Gain,device->Address);		
+			return FALSE;
+		}
+		write_count++;
+	}
+	/* find out how often the Wxt536 updates each individually polled data group */
+	if((Wxt536_Composite_Data_Enable == FALSE)&&(Wxt536_Automatic_Mode == FALSE))
+	{
+		if(!Wxt536_Update_Interval_Get(device))
+			return FALSE;
+	}
+	/* if configured, switch the Wxt536 into automatic mode now it is configured */
+	if(Wxt536_Automatic_Mode)
+	{
+		composite_interval = Wxt536_Composite_Data_Enable ? Wxt536_Automatic_Composite_Interval : 0;
+		if(device->Comms_Settings.Composite_Repeat_Interval != composite_interval)
+		{
+#if LOGGING > 5
+			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+						"Wxt536_Device_Initialise:Set the Wxt536 composite data interval to %d s.",
+						composite_interval);
+#endif /* LOGGING */
+			if(!Wms_Wxt536_Command_Comms_Settings_Composite_Interval_Set("Wxt536","qli50_wxt536_wxt536.c",
+										     device->Address,composite_interval))
+			{
+				Qli50_Wxt536_Error_Number = 219;
+				sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+					"Failed to set the composite data interval to %d s for Wxt536 device address '%c'.",
+					composite_interval,device->Address);
+				return FALSE;
+			}
+			device->Comms_Settings.Composite_Repeat_Interval = composite_interval;
+			write_count++;
+		}
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Device_Initialise:Switch the Wxt536 to automatic protocol '%c'.",
+					protocol);
+#endif /* LOGGING */
+		if(!Wms_Wxt536_Command_Comms_Settings_Protocol_Set("Wxt536","qli50_wxt536_wxt536.c",
+								   device->Address,protocol))
+		{
+			Qli50_Wxt536_Error_Number = 220;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Device_Initialise: "
+				"Failed to set the communication protocol to '%c' "
+				"for Wxt536 device address '%c'.",protocol,device->Address);		
+			return FALSE;
+		}
+		device->Comms_Settings.Protocol = protocol;
+		write_count++;
+	}
+	/* setting the protocol also set the library's CRC use, keep it with this Wxt536 */
+	device->CRC_Enable = Wms_Wxt536_Command_CRC_Enable_Get();
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Device_Initialise:Wxt536 device address '%c' configured in %.3f s "
+				"(%d setting(s) written).",device->Address,fdifftime(end_time,start_time),write_count);
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Return which Wxt536 in Wxt536_Device_List returns data for the specified Qli50 QLI Id. Device n returns data 
+ * for QLI Id 'A'+n. Any other QLI Id (including every QLI Id when there is only one Wxt536) uses the first Wxt536.
+ * @param qli_id A single character, representing the QLI Id of the Qli50.
+ * @return The index in Wxt536_Device_List of the Wxt536 to use.
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ */
+static int Wxt536_Device_Index_Get(char qli_id)
+{
+	if((qli_id >= 'A')&&((qli_id-'A') < Wxt536_Device_Count))
+		return qli_id-'A';
+	return 0;
+}
+
+/**
+ * Retrieve how often a Wxt536 updates each individually polled data group, using 
+ * Wms_Wxt536_Command_Update_Interval_Get. Each data group's Update_Interval in Wxt536_Message_Group_List is set
+ * to the longest interval of any Wxt536 on the serial link. The precipitation data is not updated at a regular
+ * interval, so it's Update_Interval is left unknown.
+ * @param device The address of the Wxt536_Device_Struct describing the Wxt536 to query.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Device_Struct
+ * @see #Wxt536_Message_Group_List
+ * @see #MESSAGE_GROUP_COUNT
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Update_Interval_Get
+ */
+static int Wxt536_Update_Interval_Get(struct Wxt536_Device_Struct *device)
+{
+	double update_interval;
+	int group_index;
+
+	for(group_index = 0; group_index < MESSAGE_GROUP_COUNT; group_index++)
+	{
+		if(group_index == MESSAGE_GROUP_PRECIPITATION)
+			continue;
+		if(!Wms_Wxt536_Command_Update_Interval_Get("Wxt536","qli50_wxt536_wxt536.c",device->Address,
+							   group_index+1,&update_interval))
+		{
+			Qli50_Wxt536_Error_Number = 239;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Update_Interval_Get: "
+				"Failed to get the %s update interval for Wxt536 device address '%c'.",
+				Wxt536_Message_Group_List[group_index].Name,device->Address);
+			return FALSE;
+		}
+#if LOGGING > 5
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+					"Wxt536_Update_Interval_Get:Wxt536 device address '%c' updates it's %s data "
+					"every %.3f s.",device->Address,Wxt536_Message_Group_List[group_index].Name,
+					update_interval);
+#endif /* LOGGING */
+		if(update_interval > Wxt536_Message_Group_List[group_index].Update_Interval)
+			Wxt536_Message_Group_List[group_index].Update_Interval = update_interval;
+	}
+	return TRUE;
+}
+
+/**
+ * Finish setting up the polling schedule, once the Wxt536s have been configured. In automatic mode the Wxt536s
+ * send data on their own schedule, so there is nothing to do. Otherwise:
+ * <ul>
+ * <li>When the data groups are polled individually, each data group's Poll_Period is rounded up to a whole 
+ *     number of it's Update_Interval (if known). Polling more often than the Wxt536 updates the data 
+ *     just reads the same values again, and polling at a whole multiple of the update interval keeps 
+ *     the age of the data read consistent from poll to poll.
+ * <li>We check each data group's Max_Datum_Age is longer than the period it is polled at (Wxt536_Poll_Period 
+ *     when Wxt536_Composite_Data_Enable is set), otherwise the data would go stale between polls.
+ * </ul>
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Automatic_Mode
+ * @see #Wxt536_Composite_Data_Enable
+ * @see #Wxt536_Poll_Period
+ * @see #Wxt536_Message_Group_List
+ * @see #MESSAGE_GROUP_COUNT
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+static int Wxt536_Poll_Schedule_Check(void)
+{
+	struct Wxt536_Message_Group_Struct *group = NULL;
+	double poll_period,update_count;
+	int group_index;
+
+	if(Wxt536_Automatic_Mode)
+		return TRUE;
+	for(group_index = 0; group_index < MESSAGE_GROUP_COUNT; group_index++)
+	{
+		group = &(Wxt536_Message_Group_List[group_index]);
+		if(Wxt536_Composite_Data_Enable)
+			poll_period = Wxt536_Poll_Period;
+		else
+		{
+			if(group->Update_Interval > 0.0)
+			{
+				/* allow for the configured period being a rounded multiple of the update interval */
+				update_count = ceil((group->Poll_Period/group->Update_Interval)-0.001);
+				if(update_count < 1.0)
+					update_count = 1.0;
+				group->Poll_Period = update_count*group->Update_Interval;
+			}
+#if LOGGING > 1
+			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+						"Wxt536_Poll_Schedule_Check:Polling %s data every %.3f s "
+						"(update interval %.3f s).",group->Name,group->Poll_Period,
+						group->Update_Interval);
+#endif /* LOGGING */
+			poll_period = group->Poll_Period;
+		}
+		if(group->Max_Datum_Age <= poll_period)
+		{
+			Qli50_Wxt536_Error_Number = 240;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Poll_Schedule_Check: "
+				"%s maximum datum age %.3f s must be longer than it's poll period %.3f s.",
+				group->Name,group->Max_Datum_Age,poll_period);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Queue the data message requests that are due. If Wxt536_Composite_Data_Enable is set, the composite data 
+ * message (aR0) is polled every Wxt536_Poll_Period, otherwise each data group in Wxt536_Message_Group_List 
+ * is polled every it's Poll_Period. The command queue statistics are logged every Wxt536_Poll_Period.
+ * @param current_time The current time (measured using CLOCK_MONOTONIC).
+ * @param poll_timeout The address of an integer, on return set to the number of milliseconds until the next 
+ *        data message request (or statistics log) is due.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Composite_Data_Enable
+ * @see #Wxt536_Poll_Period
+ * @see #Wxt536_Composite_Next_Poll_Time
+ * @see #Wxt536_Statistics_Next_Log_Time
+ * @see #Wxt536_Message_Group_List
+ * @see #MESSAGE_GROUP_COUNT
+ * @see #Wxt536_Poll_Due
+ * @see #Wxt536_Poll_Message_Queue
+ * @see #Wxt536_Queue_Statistics_Log
+ * @see #Wxt536_Milliseconds_Until
+ */
+static int Wxt536_Poll_Queue(struct timespec current_time,int *poll_timeout)
+{
+	struct Wxt536_Message_Group_Struct *group = NULL;
+	struct timespec poll_time;
+	int group_index,timeout;
+
+	if(Wxt536_Poll_Due(current_time,Wxt536_Poll_Period,&Wxt536_Statistics_Next_Log_Time,&poll_time))
+		Wxt536_Queue_Statistics_Log();
+	(*poll_timeout) = Wxt536_Milliseconds_Until(current_time,Wxt536_Statistics_Next_Log_Time);
+	if(Wxt536_Composite_Data_Enable)
+	{
+		if(Wxt536_Poll_Due(current_time,Wxt536_Poll_Period,&Wxt536_Composite_Next_Poll_Time,&poll_time))
+		{
+			if(!Wxt536_Poll_Message_Queue(0,poll_time))
+				return FALSE;
+		}
+		timeout = Wxt536_Milliseconds_Until(current_time,Wxt536_Composite_Next_Poll_Time);
+		if(timeout < (*poll_timeout))
+			(*poll_timeout) = timeout;
+		return TRUE;
+	}
+	for(group_index = 0; group_index < MESSAGE_GROUP_COUNT; group_index++)
+	{
+		group = &(Wxt536_Message_Group_List[group_index]);
+		if(Wxt536_Poll_Due(current_time,group->Poll_Period,&(group->Next_Poll_Time),&poll_time))
+		{
+			if(!Wxt536_Poll_Message_Queue(group_index+1,poll_time))
+				return FALSE;
+		}
+		timeout = Wxt536_Milliseconds_Until(current_time,group->Next_Poll_Time);
+		if(timeout < (*poll_timeout))
+			(*poll_timeout) = timeout;
+	}
+	return TRUE;
+}
+
+/**
+ * Check whether a poll is due on a fixed schedule. Polls are due at next_poll_time, next_poll_time + poll_period,
+ * next_poll_time + 2*poll_period, and so on, measured using CLOCK_MONOTONIC. Each poll is scheduled from 
+ * the previous due time, rather than from when the previous poll actually happened, so late polls 
+ * do not accumulate into drift. If due times have been missed altogether (the event loop was busy), 
+ * they are skipped, rather than polled in a burst.
+ * @param current_time The current time (measured using CLOCK_MONOTONIC).
+ * @param poll_period The time between polls, in decimal seconds.
+ * @param next_poll_time The address of the time the next poll is due. If this is zero, the schedule 
+ *        starts at current_time. If a poll is due, on return this is advanced to the following due time 
+ *        after current_time.
+ * @param poll_time The address of a timespec, if a poll is due, on return set to when it was due.
+ * @return The routine returns TRUE if a poll is due, and FALSE if it is not.
+ * @see #Wxt536_Time_Add
+ * @see qli50_wxt536_general.html#fdifftime
+ */
+static int Wxt536_Poll_Due(struct timespec current_time,double poll_period,struct timespec *next_poll_time,
+			   struct timespec *poll_time)
+{
+	double late_time;
+	int missed_count;
+
+	if((next_poll_time->tv_sec == 0)&&(next_poll_time->tv_nsec == 0))
+		(*next_poll_time) = current_time;
+	late_time = fdifftime(current_time,(*next_poll_time));
+	if(late_time < 0.0)
+		return FALSE;
+	missed_count = (int)(late_time/poll_period);
+#if LOGGING > 1
+	if(missed_count > 0)
+	{
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Poll_Due:Skipped %d poll(s) with period %.3f s.",missed_count,poll_period);
+	}
+#endif /* LOGGING */
+	(*poll_time) = (*next_poll_time);
+	Wxt536_Time_Add(poll_time,((double)missed_count)*poll_period);
+	(*next_poll_time) = (*poll_time);
+	Wxt536_Time_Add(next_poll_time,poll_period);
+	return TRUE;
+}
+
+/**
+ * Queue a data message request to each Wxt536, in the priority class returned by Wxt536_Message_Priority_Get.
+ * Wxt536s the link supervisor is probing for or reinitialising are skipped.
+ * If no other data message requests were waiting, a new data refresh starts, and Wxt536_Poll_Cycle_Start_Time
+ * is set.
+ * @param message_id The data message id, 0 (composite data) to 5 (supervisor data).
+ * @param poll_time When the poll was due (measured using CLOCK_MONOTONIC). This is used as the requests' 
+ *        Queue_Time, so the command queue statistics include how late the poll was queued.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_Queue_List
+ * @see #Wxt536_Poll_Cycle_Start_Time
+ * @see #Wxt536_Link_State_Enum
+ * @see #Wxt536_Message_Priority_Get
+ * @see #Wxt536_Queue_Add
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+static int Wxt536_Poll_Message_Queue(int message_id,struct timespec poll_time)
+{
+	char command_string[QUEUE_COMMAND_LENGTH];
+	int priority,queue_count,device_index;
+
+	queue_count = 0;
+	for(priority = 0; priority < QUEUE_PRIORITY_COUNT; priority++)
+	{
+		if(priority != QUEUE_PRIORITY_ENGINEERING)
+			queue_count += Wxt536_Queue_List[priority].Count;
+	}
+	if(queue_count == 0)
+		Wxt536_Poll_Cycle_Start_Time = poll_time;
+	/* interleave the requests to each Wxt536, apart from those the link supervisor is recovering */
+	for(device_index = 0; device_index < Wxt536_Device_Count; device_index++)
+	{
+		if(Wxt536_Device_List[device_index].Link_State >= LINK_STATE_PROBING)
+			continue;
+		sprintf(command_string,"%cR%d",Wxt536_Device_List[device_index].Address,message_id);
+		if(!Wxt536_Queue_Add(Wxt536_Message_Priority_Get(message_id),device_index,message_id,
+				     command_string,NULL,poll_time))
+		{
+			Qli50_Wxt536_Error_Number = 233;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Poll_Message_Queue:Failed to queue '%s'.",
+				command_string);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * The link supervisor. This is called by Qli50_Wxt536_Wxt536_Timer when no request is outstanding.
+ * <ul>
+ * <li>For each Wxt536 in LINK_STATE_PROBING whose Next_Recovery_Time has arrived, we queue a probe: an acknowledge
+ *     active command to the Wxt536's cached device address (e.g. "0"), which Wxt536_Link_Probe_Reply handles. 
+ *     This is one short serial exchange, sent and waited for by the bus scheduler like any other command, 
+ *     so the Qli50 server keeps answering whilst we wait.
+ * <li>For each Wxt536 in LINK_STATE_REINITIALISING (it has acknowledged a probe), we queue a communication 
+ *     settings query (e.g. "0XU") in the same way, which Wxt536_Link_Comms_Settings_Reply handles. 
+ * </ul>
+ * If a command cannot be queued, the error is recorded and we carry on with the other Wxt536s.
+ * @param current_time The current time (measured using CLOCK_MONOTONIC).
+ * @param recovery_timeout The address of an integer, on return set to the number of milliseconds until the next 
+ *        probe is due, or -1 if no probes are due.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_Link_State_Enum
+ * @see #Wxt536_Link_Probe_Reply
+ * @see #Wxt536_Link_Comms_Settings_Reply
+ * @see #Wxt536_Queue_Add
+ * @see #Wxt536_Milliseconds_Until
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_general.html#fdifftime
+ */
+static int Wxt536_Link_Supervise(struct timespec current_time,int *recovery_timeout)
+{
+	struct Wxt536_Device_Struct *device = NULL;
+	char command_string[QUEUE_COMMAND_LENGTH];
+	int device_index,timeout,retval;
+
+	(*recovery_timeout) = -1;
+	retval = TRUE;
+	for(device_index = 0; device_index < Wxt536_Device_Count; device_index++)
+	{
+		device = &(Wxt536_Device_List[device_index]);
+		if(device->Probe_Queued)
+			continue;
+		if(device->Link_State == LINK_STATE_REINITIALISING)
+		{
+#if LOGGING > 5
+			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+						"Wxt536_Link_Supervise:Checking the configuration of Wxt536 device address '%c'.",
+						device->Address);
+#endif /* LOGGING */
+			sprintf(command_string,"%cXU",device->Address);
+			if(!Wxt536_Queue_Add(QUEUE_PRIORITY_HOUSEKEEPING,device_index,-1,command_string,
+					     Wxt536_Link_Comms_Settings_Reply,current_time))
+			{
+				Qli50_Wxt536_Error_Number = 254;
+				sprintf(Qli50_Wxt536_Error_String,"Wxt536_Link_Supervise:"
+					"Failed to queue '%s', the %s command queue is full.",command_string,
+					Wxt536_Queue_Priority_Name_List[QUEUE_PRIORITY_HOUSEKEEPING]);
+				retval = FALSE;
+				continue;
+			}
+			device->Probe_Queued = TRUE;
+		}
+		else if(device->Link_State == LINK_STATE_PROBING)
+		{
+			if(fdifftime(current_time,device->Next_Recovery_Time) >= 0.0)
+			{
+#if LOGGING > 5
+				Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+							"Wxt536_Link_Supervise:Probing for Wxt536 device address '%c'.",
+							device->Address);
+#endif /* LOGGING */
+				sprintf(command_string,"%c",device->Address);
+				if(!Wxt536_Queue_Add(QUEUE_PRIORITY_HOUSEKEEPING,device_index,-1,command_string,
+						     Wxt536_Link_Probe_Reply,current_time))
+				{
+					Qli50_Wxt536_Error_Number = 253;
+					sprintf(Qli50_Wxt536_Error_String,"Wxt536_Link_Supervise:"
+						"Failed to queue probe '%s', the %s command queue is full.",command_string,
+						Wxt536_Queue_Priority_Name_List[QUEUE_PRIORITY_HOUSEKEEPING]);
+					retval = FALSE;
+					continue;
+				}
+				device->Probe_Queued = TRUE;
+			}
+			else
+			{
+				timeout = Wxt536_Milliseconds_Until(current_time,device->Next_Recovery_Time);
+				if(((*recovery_timeout) < 0)||(timeout < (*recovery_timeout)))
+					(*recovery_timeout) = timeout;
+			}
+		}
+	}
+	return retval;
+}
+
+/**
+ * The reply callback for link supervisor probes (acknowledge active commands) queued by Wxt536_Link_Supervise.
+ * The probed Wxt536 is the outstanding request's device. If the reply starts with the Wxt536's device address,
+ * the Wxt536 is back and is put into LINK_STATE_REINITIALISING, otherwise the probe has failed and 
+ * Wxt536_Link_Failure schedules the next one.
+ * @param reply_string The reply to the probe, or NULL if no reply was received.
+ * @see #Wxt536_Request
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Link_Supervise
+ * @see #Wxt536_Link_State_Set
+ * @see #Wxt536_Link_Failure
+ */
+static void Wxt536_Link_Probe_Reply(char *reply_string)
+{
+	struct Wxt536_Device_Struct *device = NULL;
+	struct timespec current_time;
+
+	device = &(Wxt536_Device_List[Wxt536_Request.Device_Index]);
+	device->Probe_Queued = FALSE;
+	if((reply_string != NULL)&&(reply_string[0] == device->Address))
+	{
+		Wxt536_Link_State_Set(Wxt536_Request.Device_Index,LINK_STATE_REINITIALISING);
+		return;
+	}
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	Wxt536_Link_Failure(Wxt536_Request.Device_Index,current_time);
+}
+
+/**
+ * The reply callback for the communication settings queries (aXU) queued by Wxt536_Link_Supervise for a 
+ * reinitialising Wxt536. The queried Wxt536 is the outstanding request's device. The Wxt536 keeps it's settings 
+ * over a power cycle, so we parse the reply (Wms_Wxt536_Command_Comms_Settings_Parse) and compare the protocol
+ * and RS-485 line delay with those cached in the device's Comms_Settings:
+ * <ul>
+ * <li>If there is no reply, or it cannot be parsed, the Wxt536 goes back to probing with a longer backoff 
+ *     (Wxt536_Link_Failure).
+ * <li>If they match, the Wxt536 has kept it's configuration, and is polled again (Wxt536_Link_Success).
+ * <li>Otherwise (e.g. it has been reset to it's factory settings, or reconfigured by hand) it has to be configured
+ *     again, which takes many serial exchanges. We set Wxt536_Link_Restart_Requested, so 
+ *     Qli50_Wxt536_Wxt536_Timer hands this to the startup thread (Wxt536_Link_Restart) once this request 
+ *     is complete, rather than the event loop waiting on the serial link.
+ * </ul>
+ * @param reply_string The reply to the query, or NULL if no reply was received.
+ * @see #Wxt536_Request
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Struct
+ * @see #Wxt536_Link_Supervise
+ * @see #Wxt536_Link_Success
+ * @see #Wxt536_Link_Failure
+ * @see #Wxt536_Link_Restart_Requested
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Parse
+ */
+static void Wxt536_Link_Comms_Settings_Reply(char *reply_string)
+{
+	struct Wxt536_Device_Struct *device = NULL;
+	struct Wxt536_Command_Comms_Settings_Struct comms_settings;
+	struct timespec current_time;
+
+	device = &(Wxt536_Device_List[Wxt536_Request.Device_Index]);
+	device->Probe_Queued = FALSE;
+	if((reply_string == NULL)||
+	   (!Wms_Wxt536_Command_Comms_Settings_Parse("Wxt536","qli50_wxt536_wxt536.c",reply_string,&comms_settings)))
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Link_Comms_Settings_Reply:"
+					"Failed to get the communication settings for Wxt536 device address '%c'.",
+					device->Address);
+#endif /* LOGGING */
+		clock_gettime(CLOCK_MONOTONIC,&current_time);
+		Wxt536_Link_Failure(Wxt536_Request.Device_Index,current_time);
+		return;
+	}
+	if((comms_settings.Protocol == device->Comms_Settings.Protocol)&&
+	   (comms_settings.RS485_Line_Delay == device->Comms_Settings.RS485_Line_Delay))
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Link_Comms_Settings_Reply:Wxt536 device address '%c' kept it's configuration.",
+					device->Address);
+#endif /* LOGGING */
+		Wxt536_Link_Success(Wxt536_Request.Device_Index);
+		return;
+	}
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Link_Comms_Settings_Reply:Wxt536 device address '%c' has protocol '%c' "
+				"(expected '%c'), configuring the Wxt536s again.",device->Address,comms_settings.Protocol,
+				device->Comms_Settings.Protocol);
+#endif /* LOGGING */
+	Wxt536_Link_Restart_Requested = TRUE;
+}
+
+/**
+ * Run the serial link startup again, because a Wxt536 has lost it's configuration. Configuring a Wxt536 takes 
+ * many serial exchanges, so this is done by the startup thread (as when the program starts), and the event loop
+ * carries on serving the Qli50 server meanwhile (from the warm start snapshot, if there is one).
+ * This is called by Qli50_Wxt536_Wxt536_Timer when no request is outstanding.
+ * <ul>
+ * <li>The queued data message requests and housekeeping commands are removed (engineering commands stay queued, 
+ *     and are sent once the startup has finished).
+ * <li>We close the serial link (this also removes it from the event loop), and clear Wxt536_Startup_Done.
+ * <li>We call Wxt536_Startup_Begin to start the startup thread. When it has finished, the event loop calls 
+ *     Qli50_Wxt536_Wxt536_Startup_Finish as usual, and a failed startup is retried with a backoff.
+ * </ul>
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Link_Restart_Requested
+ * @see #Wxt536_Queue_List
+ * @see #QUEUE_PRIORITY_COUNT
+ * @see #Wxt536_Startup_Done
+ * @see #Wxt536_Startup_Start_Time
+ * @see #Wxt536_Startup_Backoff
+ * @see #Wxt536_Startup_Retry_Time
+ * @see #Wxt536_Link_Backoff_Min
+ * @see #Wxt536_Startup_Begin
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see ../wxt536/cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Close
+ */
+static int Wxt536_Link_Restart(void)
+{
+	int priority;
+
+	Wxt536_Link_Restart_Requested = FALSE;
+#if LOGGING > 1
+	Qli50_Wxt536_Log("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+			 "Wxt536_Link_Restart:Running the Wxt536 link startup again.");
+#endif /* LOGGING */
+	for(priority = 0; priority < QUEUE_PRIORITY_COUNT; priority++)
+	{
+		if(priority != QUEUE_PRIORITY_ENGINEERING)
+			Wxt536_Queue_List[priority].Count = 0;
+	}
+	Wxt536_Startup_Done = FALSE;
+	clock_gettime(CLOCK_MONOTONIC,&Wxt536_Startup_Start_Time);
+	Wxt536_Startup_Retry_Time = Wxt536_Startup_Start_Time;
+	Wxt536_Startup_Backoff = Wxt536_Link_Backoff_Min;
+	if(!Wms_Wxt536_Connection_Close("Wxt536","qli50_wxt536_wxt536.c"))
+	{
+		Qli50_Wxt536_Error_Number = 270;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Link_Restart:Wms_Wxt536_Connection_Close() failed.");
+		return FALSE;
+	}
+	return Wxt536_Startup_Begin();
+}
+
+/**
+ * A Wxt536 has replied to a data message request (or been reinitialised). It's failure count and recovery 
+ * backoff are reset, and it's link is marked as connected.
+ * @param device_index The index in Wxt536_Device_List of the Wxt536.
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Link_State_Set
+ * @see #Wxt536_Link_Backoff_Min
+ */
+static void Wxt536_Link_Success(int device_index)
+{
+	Wxt536_Device_List[device_index].Failure_Count = 0;
+	Wxt536_Device_List[device_index].Recovery_Backoff = Wxt536_Link_Backoff_Min;
+	Wxt536_Link_State_Set(device_index,LINK_STATE_CONNECTED);
+}
+
+/**
+ * A request to a Wxt536 has failed. The Wxt536's failure count is incremented, and:
+ * <ul>
+ * <li>If the Wxt536 is connected or degraded, it is marked as degraded, unless Wxt536_Link_Failure_Limit requests 
+ *     have now failed in a row. In that case we stop polling it (it's queued data message requests are purged 
+ *     using Wxt536_Queue_Purge), and start probing for it after Wxt536_Link_Backoff_Min seconds.
+ * <li>If the Wxt536 is being probed for (or reinitialised), the recovery backoff is doubled 
+ *     (up to Wxt536_Link_Backoff_Max) and the next probe scheduled.
+ * </ul>
+ * @param device_index The index in Wxt536_Device_List of the Wxt536.
+ * @param current_time The current time (measured using CLOCK_MONOTONIC).
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Link_State_Enum
+ * @see #Wxt536_Link_Failure_Limit
+ * @see #Wxt536_Link_Backoff_Min
+ * @see #Wxt536_Link_Backoff_Max
+ * @see #Wxt536_Link_State_Set
+ * @see #Wxt536_Queue_Purge
+ * @see #Wxt536_Time_Add
+ */
+static void Wxt536_Link_Failure(int device_index,struct timespec current_time)
+{
+	struct Wxt536_Device_Struct *device = NULL;
+
+	device = &(Wxt536_Device_List[device_index]);
+	device->Failure_Count++;
+	if(device->Link_State < LINK_STATE_PROBING)
+	{
+		if(device->Failure_Count < Wxt536_Link_Failure_Limit)
+		{
+			Wxt536_Link_State_Set(device_index,LINK_STATE_DEGRADED);
+			return;
+		}
+		Wxt536_Queue_Purge(device_index);
+		device->Recovery_Backoff = Wxt536_Link_Backoff_Min;
+		Wxt536_Link_State_Set(device_index,LINK_STATE_PROBING);
+	}
+	else
+	{
+		device->Recovery_Backoff *= 2.0;
+		if(device->Recovery_Backoff > Wxt536_Link_Backoff_Max)
+			device->Recovery_Backoff = Wxt536_Link_Backoff_Max;
+		Wxt536_Link_State_Set(device_index,LINK_STATE_PROBING);
+	}
+	device->Probe_Queued = FALSE;
+	device->Next_Recovery_Time = current_time;
+	Wxt536_Time_Add(&(device->Next_Recovery_Time),device->Recovery_Backoff);
+#if LOGGING > 5
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+				"Wxt536_Link_Failure:Wxt536 device address '%c' has failed %d request(s) in a row, "
+				"next probe in %.3f s.",device->Address,device->Failure_Count,device->Recovery_Backoff);
+#endif /* LOGGING */
+}
+
+/**
+ * Change the link state of a Wxt536, logging the change.
+ * @param device_index The index in Wxt536_Device_List of the Wxt536.
+ * @param link_state The new link state.
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Link_State_Enum
+ * @see #Wxt536_Link_State_Name_List
+ */
+static void Wxt536_Link_State_Set(int device_index,enum Wxt536_Link_State_Enum link_state)
+{
+	struct Wxt536_Device_Struct *device = NULL;
+
+	device = &(Wxt536_Device_List[device_index]);
+	if(device->Link_State == link_state)
+		return;
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Link_State_Set:Wxt536 device address '%c' link is now %s (was %s).",
+				device->Address,Wxt536_Link_State_Name_List[link_state],
+				Wxt536_Link_State_Name_List[device->Link_State]);
+#endif /* LOGGING */
+	device->Link_State = link_state;
+}
+
+/**
+ * Log how long commands waited in each priority class of the Wxt536 command queue since the statistics 
+ * were last logged, and reset the statistics. This includes how late the poll that queued them was.
+ * @see #Wxt536_Queue_List
+ * @see #Wxt536_Queue_Priority_Name_List
+ * @see #QUEUE_PRIORITY_COUNT
+ */
+static void Wxt536_Queue_Statistics_Log(void)
+{
+	int priority;
+
+	for(priority = 0; priority < QUEUE_PRIORITY_COUNT; priority++)
+	{
+#if LOGGING > 1
+		if(Wxt536_Queue_List[priority].Wait_Count > 0)
+		{
+			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+						"Wxt536_Queue_Statistics_Log:%s commands waited %.3f s on average, "
+						"%.3f s worst (%d sent, %d queued).",
+						Wxt536_Queue_Priority_Name_List[priority],
+						Wxt536_Queue_List[priority].Wait_Total/
+						((double)Wxt536_Queue_List[priority].Wait_Count),
+						Wxt536_Queue_List[priority].Wait_Max,Wxt536_Queue_List[priority].Wait_Count,
+						Wxt536_Queue_List[priority].Count);
+		}
+#endif /* LOGGING */
+		Wxt536_Queue_List[priority].Wait_Count = 0;
+		Wxt536_Queue_List[priority].Wait_Total = 0.0;
+		Wxt536_Queue_List[priority].Wait_Max = 0.0;
+	}
+}
+
+/**
+ * Return which priority class of the Wxt536 command queue a data message request is sent in.
+ * @param message_id The data message id, 0 (composite data) to 5 (supervisor data).
+ * @return The priority class. The precipitation (aR3) and analogue (aR4) data, and the composite data (aR0) 
+ *         that contains them, are QUEUE_PRIORITY_WETNESS. The wind (aR1) and pressure/temperature/humidity (aR2)
+ *         data are QUEUE_PRIORITY_MEASUREMENT. The supervisor data (aR5) is QUEUE_PRIORITY_HOUSEKEEPING.
+ * @see #Wxt536_Queue_Priority_Enum
+ */
+static enum Wxt536_Queue_Priority_Enum Wxt536_Message_Priority_Get(int message_id)
+{
+	switch(message_id)
+	{
+		case 1:
+		case 2:
+			return QUEUE_PRIORITY_MEASUREMENT;
+		case 5:
+			return QUEUE_PRIORITY_HOUSEKEEPING;
+		default:
+			return QUEUE_PRIORITY_WETNESS;
+	}
+}
+
+/**
+ * Add a command to the end of a priority class of the Wxt536 command queue. A data message request 
+ * (message_id not -1) that is already queued for the same Wxt536 is not queued again, it keeps it's place 
+ * (and Queue_Time) in the queue.
+ * @param priority Which priority class to queue the command in.
+ * @param device_index The index in Wxt536_Device_List of the Wxt536 the command is sent to.
+ * @param message_id The data message id requested (0..5), or -1 for an engineering command.
+ * @param command_string The command to send, without a terminator. This must be shorter than QUEUE_COMMAND_LENGTH.
+ * @param reply_callback For engineering commands, the routine to call with the reply, otherwise NULL.
+ * @param queue_time The current time (measured using CLOCK_MONOTONIC).
+ * @return The routine returns TRUE if the command was queued (or was already queued), 
+ *         and FALSE if the priority class is full.
+ * @see #Wxt536_Queue_List
+ * @see #Wxt536_Queue_Struct
+ * @see #Wxt536_Queue_Entry_Struct
+ * @see #QUEUE_LENGTH
+ */
+static int Wxt536_Queue_Add(enum Wxt536_Queue_Priority_Enum priority,int device_index,int message_id,
+			    char *command_string,Qli50_Wxt536_Wxt536_Reply_Callback_T reply_callback,
+			    struct timespec queue_time)
+{
+	struct Wxt536_Queue_Struct *queue = NULL;
+	struct Wxt536_Queue_Entry_Struct *entry = NULL;
+	int i;
+
+	queue = &(Wxt536_Queue_List[priority]);
+	if(message_id != -1)
+	{
+		for(i = 0; i < queue->Count; i++)
+		{
+			entry = &(queue->Entry_List[(queue->Head+i)%QUEUE_LENGTH]);
+			if((entry->Device_Index == device_index)&&(entry->Message_Id == message_id))
+				return TRUE;
+		}
+	}
+	if(queue->Count >= QUEUE_LENGTH)
+		return FALSE;
+	entry = &(queue->Entry_List[(queue->Head+queue->Count)%QUEUE_LENGTH]);
+	entry->Device_Index = device_index;
+	entry->Message_Id = message_id;
+	strcpy(entry->Command_String,command_string);
+	entry->Reply_Callback = reply_callback;
+	entry->Queue_Time = queue_time;
+	queue->Count++;
+	return TRUE;
+}
+
+/**
+ * Take the next command from the Wxt536 command queue: the oldest command in the highest priority class 
+ * that has any commands queued. The time the command waited in the queue is added to it's priority class's
+ * statistics.
+ * @param current_time The current time (measured using CLOCK_MONOTONIC).
+ * @param entry The address of a Wxt536_Queue_Entry_Struct, on a successful return filled in with the command.
+ * @return The routine returns TRUE if a command was taken from the queue, and FALSE if the queue is empty.
+ * @see #Wxt536_Queue_List
+ * @see #Wxt536_Queue_Struct
+ * @see #Wxt536_Queue_Entry_Struct
+ * @see #QUEUE_PRIORITY_COUNT
+ * @see #QUEUE_LENGTH
+ * @see qli50_wxt536_general.html#fdifftime
+ */
+static int Wxt536_Queue_Next(struct timespec current_time,struct Wxt536_Queue_Entry_Struct *entry)
+{
+	struct Wxt536_Queue_Struct *queue = NULL;
+	double wait_time;
+	int priority;
+
+	for(priority = 0; priority < QUEUE_PRIORITY_COUNT; priority++)
+	{
+		queue = &(Wxt536_Queue_List[priority]);
+		if(queue->Count > 0)
+		{
+			(*entry) = queue->Entry_List[queue->Head];
+			queue->Head = (queue->Head+1)%QUEUE_LENGTH;
+			queue->Count--;
+			wait_time = fdifftime(current_time,entry->Queue_Time);
+			queue->Wait_Count++;
+			queue->Wait_Total += wait_time;
+			if(wait_time > queue->Wait_Max)
+				queue->Wait_Max = wait_time;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/**
+ * Remove the data message requests queued for a Wxt536 from the Wxt536 command queue. The link supervisor
+ * does this when it stops polling a Wxt536, so the other Wxt536s on the serial link are not held up by requests
+ * that will time out. Engineering commands stay queued.
+ * @param device_index The index in Wxt536_Device_List of the Wxt536.
+ * @see #Wxt536_Queue_List
+ * @see #Wxt536_Queue_Struct
+ * @see #QUEUE_PRIORITY_COUNT
+ * @see #QUEUE_LENGTH
+ */
+static void Wxt536_Queue_Purge(int device_index)
+{
+	struct Wxt536_Queue_Struct *queue = NULL;
+	struct Wxt536_Queue_Entry_Struct *entry = NULL;
+	int priority,i,count;
+
+	for(priority = 0; priority < QUEUE_PRIORITY_COUNT; priority++)
+	{
+		queue = &(Wxt536_Queue_List[priority]);
+		count = 0;
+		for(i = 0; i < queue->Count; i++)
+		{
+			entry = &(queue->Entry_List[(queue->Head+i)%QUEUE_LENGTH]);
+			if((entry->Device_Index == device_index)&&(entry->Message_Id != -1))
+				continue;
+			queue->Entry_List[(queue->Head+count)%QUEUE_LENGTH] = (*entry);
+			count++;
+		}
+		queue->Count = count;
+	}
+}
+
+/**
+ * Send the command in Wxt536_Request to it's Wxt536, using Wms_Wxt536_Command_Data_Message_Request for data message
+ * requests, and Wms_Wxt536_Command (without waiting for the reply) for engineering commands. The Wxt536 library's
+ * CRC setting is set from the Wxt536's CRC_Enable first, and is used when the reply is read.
+ * Wxt536_Request_Deadline is set to when we stop waiting for the reply.
+ * @param current_time The current time (measured using CLOCK_MONOTONIC).
+ * @param reply_timeout The address of an integer, on return set to how long we wait for the reply, in milliseconds.
+ * @return The routine returns TRUE on success and FALSE if sending the command failed.
+ * @see #Wxt536_Request
+ * @see #Wxt536_Request_Deadline
+ * @see #Wxt536_Read_Timeout
+ * @see #Wxt536_Device_List
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Data_Message_Request
+ */
+static int Wxt536_Request_Send(struct timespec current_time,int *reply_timeout)
+{
+	int retval;
+
+#if LOGGING > 5
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+				"Wxt536_Request_Send:Sending '%s'.",Wxt536_Request.Command_String);
+#endif /* LOGGING */
+	Wms_Wxt536_Command_CRC_Enable_Set(Wxt536_Device_List[Wxt536_Request.Device_Index].CRC_Enable);
+	if(Wxt536_Request.Message_Id == -1)
+		retval = Wms_Wxt536_Command("Wxt536","qli50_wxt536_wxt536.c",Wxt536_Request.Command_String,NULL,0);
+	else
+	{
+		retval = Wms_Wxt536_Command_Data_Message_Request("Wxt536","qli50_wxt536_wxt536.c",
+								 Wxt536_Device_List[Wxt536_Request.Device_Index].Address,
+								 Wxt536_Request.Message_Id);
+	}
+	/* the Wxt536 waits for it's RS-485 line delay before replying */
+	(*reply_timeout) = Wxt536_Read_Timeout+Wxt536_Device_List[Wxt536_Request.Device_Index].RS485_Line_Delay;
+	Wxt536_Request_Deadline = current_time;
+	Wxt536_Request_Deadline.tv_sec += (*reply_timeout)/1000;
+	Wxt536_Request_Deadline.tv_nsec += ((*reply_timeout)%1000)*QLI50_WXT536_ONE_MILLISECOND_NS;
+	if(Wxt536_Request_Deadline.tv_nsec >= QLI50_WXT536_ONE_SECOND_NS)
+	{
+		Wxt536_Request_Deadline.tv_sec++;
+		Wxt536_Request_Deadline.tv_nsec -= QLI50_WXT536_ONE_SECOND_NS;
+	}
+	return retval;
+}
+
+/**
+ * The reply to the outstanding request failed it's CRC check, so send the request again (once), 
+ * with a new reply deadline. If resending fails, the request is failed as it would be in 
+ * Qli50_Wxt536_Wxt536_Timer. In either case Qli50_Wxt536_Error_Number and Qli50_Wxt536_Error_String are set, 
+ * so the corrupt reply is reported.
+ * @return The routine returns TRUE if the request was resent, and FALSE if resending it failed.
+ * @see #Wxt536_Request
+ * @see #Wxt536_Request_Resent
+ * @see #Wxt536_Request_Send
+ * @see #Wxt536_Request_Complete
+ * @see #Wxt536_Link_Failure
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+static int Wxt536_Request_Resend(void)
+{
+	struct timespec current_time;
+	int reply_timeout;
+
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	Wxt536_Request_Resent = TRUE;
+	if(!Wxt536_Request_Send(current_time,&reply_timeout))
+	{
+		if(Wxt536_Request.Message_Id == -1)
+			Wxt536_Request.Reply_Callback(NULL);
+		else
+			Wxt536_Link_Failure(Wxt536_Request.Device_Index,current_time);
+		Wxt536_Request_Complete();
+		Qli50_Wxt536_Error_Number = 268;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Request_Resend:Resending '%s' after a corrupt reply failed.",
+			Wxt536_Request.Command_String);
+		return FALSE;
+	}
+	Qli50_Wxt536_Error_Number = 269;
+	sprintf(Qli50_Wxt536_Error_String,"Wxt536_Request_Resend:Reply to '%s' failed CRC check, resent it.",
+		Wxt536_Request.Command_String);
+	return TRUE;
+}
+
+/**
+ * The outstanding request has been replied to (or has failed). Mark no request as outstanding, so 
+ * Qli50_Wxt536_Wxt536_Timer will send the next queued command. When the last data message request queued 
+ * is complete, the time taken by the poll cycle is logged.
+ * @see #Wxt536_Request_Outstanding
+ * @see #Wxt536_Request
+ * @see #Wxt536_Queue_List
+ * @see #Wxt536_Poll_Cycle_Start_Time
+ * @see qli50_wxt536_general.html#fdifftime
+ */
+static void Wxt536_Request_Complete(void)
+{
+#if LOGGING > 1
+	struct timespec current_time;
+	int priority,queue_count;
+#endif /* LOGGING */
+
+	Wxt536_Request_Outstanding = FALSE;
+#if LOGGING > 1
+	queue_count = 0;
+	for(priority = 0; priority < QUEUE_PRIORITY_COUNT; priority++)
+	{
+		if(priority != QUEUE_PRIORITY_ENGINEERING)
+			queue_count += Wxt536_Queue_List[priority].Count;
+	}
+	if((Wxt536_Request.Message_Id != -1)&&(queue_count == 0))
+	{
+		clock_gettime(CLOCK_MONOTONIC,&current_time);
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Request_Complete:Data refresh took %.3f s.",
+					fdifftime(current_time,Wxt536_Poll_Cycle_Start_Time));
+	}
+#endif /* LOGGING */
+}
+
+/**
+ * Return the data groups a reply to the specified data message request updates.
+ * @param message_id The data message id, 0 (composite data) to 5 (supervisor data).
+ * @return A bit mask of WXT536_COMMAND_DATA_* bits. The composite data message (aR0) can update any data group.
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#WXT536_COMMAND_DATA_WIND
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#WXT536_COMMAND_DATA_PRECIPITATION
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#WXT536_COMMAND_DATA_SUPERVISOR
+ * @see ../wxt536/cdocs/wms_wxt536_command.html#WXT536_COMMAND_DATA_ANALOGUE
+ */
+static int Wxt536_Message_Data_Mask_Get(int message_id)
+{
+	switch(message_id)
+	{
+		case 1:
+			return WXT536_COMMAND_DATA_WIND;
+		case 2:
+			return WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY;
+		case 3:
+			return WXT536_COMMAND_DATA_PRECIPITATION;
+		case 4:
+			return WXT536_COMMAND_DATA_ANALOGUE;
+		case 5:
+			return WXT536_COMMAND_DATA_SUPERVISOR;
+		default:
+			return WXT536_COMMAND_DATA_WIND|WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY|
+				WXT536_COMMAND_DATA_PRECIPITATION|WXT536_COMMAND_DATA_SUPERVISOR|
+				WXT536_COMMAND_DATA_ANALOGUE;
+	}
+}
+
+/**
+ * Update the data groups in a Wxt536's data received in a data message. We start from a copy of the device's 
+ * currently published data, update the data groups contained in the message, timestamp the fields that were valid 
+ * (using each group's Valid_Mask), and publish them using Wxt536_Data_Snapshot_Publish. The published data is
+ * also saved to the warm start snapshot file using Wxt536_Snapshot_Save.
+ * @param device The address of the Wxt536_Device_Struct of the Wxt536 that sent the data message.
+ * @param message_data The address of a Wxt536_Command_Composite_Data_Struct containing the data received.
+ *        Fields that were not valid in the message should contain their last valid value.
+ * @param data_mask Which data groups in message_data were received, a bit mask of WXT536_COMMAND_DATA_* bits.
+ * @see #Wxt536_Device_Struct
+ * @see #Wxt536_Data_Struct
+ * @see #Wxt536_Data_Snapshot_Get
+ * @see #Wxt536_Data_Snapshot_Publish
+ * @see #Wxt536_Snapshot_Save
+ * @see #Wxt536_Timestamp_List_Update
+ */
+static void Wxt536_Data_Update(struct Wxt536_Device_Struct *device,
+			       struct Wxt536_Command_Composite_Data_Struct *message_data,int data_mask)
+{
+	struct Wxt536_Data_Struct wxt536_data;
+	struct timespec current_time;
+
+	clock_gettime(CLOCK_REALTIME,&current_time);
+	Wxt536_Data_Snapshot_Get(&(device->Data),&wxt536_data);
+	if(data_mask & WXT536_COMMAND_DATA_WIND)
+	{
+		wxt536_data.Wind_Data = message_data->Wind_Data;
+		Wxt536_Timestamp_List_Update(wxt536_data.Wind_Timestamp,WXT536_COMMAND_WIND_FIELD_COUNT,
+					     message_data->Wind_Data.Valid_Mask,current_time);
+	}
+	if(data_mask & WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY)
+	{
+		wxt536_data.Pressure_Temp_Humidity_Data = message_data->Pressure_Temperature_Humidity_Data;
+		Wxt536_Timestamp_List_Update(wxt536_data.Pressure_Temp_Humidity_Timestamp,
+					     WXT536_COMMAND_PRESSURE_TEMPERATURE_HUMIDITY_FIELD_COUNT,
+					     message_data->Pressure_Temperature_Humidity_Data.Valid_Mask,current_time);
+	}
+	if(data_mask & WXT536_COMMAND_DATA_PRECIPITATION)
+	{
+		wxt536_data.Rain_Data = message_data->Precipitation_Data;
+		Wxt536_Timestamp_List_Update(wxt536_data.Rain_Timestamp,WXT536_COMMAND_PRECIPITATION_FIELD_COUNT,
+					     message_data->Precipitation_Data.Valid_Mask,current_time);
+	}
+	if(data_mask & WXT536_COMMAND_DATA_SUPERVISOR)
+	{
+		wxt536_data.Supervisor_Data = message_data->Supervisor_Data;
+		Wxt536_Timestamp_List_Update(wxt536_data.Supervisor_Timestamp,WXT536_COMMAND_SUPERVISOR_FIELD_COUNT,
+					     message_data->Supervisor_Data.Valid_Mask,current_time);
+	}
+	if(data_mask & WXT536_COMMAND_DATA_ANALOGUE)
+	{
+		wxt536_data.Analogue_Data = message_data->Analogue_Data;
+		Wxt536_Timestamp_List_Update(wxt536_data.Analogue_Timestamp,WXT536_COMMAND_ANALOGUE_FIELD_COUNT,
+					     message_data->Analogue_Data.Valid_Mask,current_time);
+	}
+	Wxt536_Data_Snapshot_Publish(&(device->Data),&wxt536_data);
+	Wxt536_Snapshot_Save(device-Wxt536_Device_List,&wxt536_data);
+#if LOGGING > 5
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+				"Wxt536_Data_Update:Published data groups 0x%x for Wxt536 device address '%c'.",
+				data_mask,device->Address);
+#endif /* LOGGING */
+}
+
+/**
+ * Set the timestamp of each field in a data group that was valid in a data message to current_time.
+ * Fields that were not valid keep their previous timestamp, and so eventually go out of date.
+ * @param timestamp_list The list of field timestamps to update.
+ * @param field_count The number of elements in timestamp_list.
+ * @param valid_mask The data group's Valid_Mask, bit n is set if field n was valid.
+ * @param current_time The time to set the timestamp of the valid fields to.
+ * @see #Wxt536_Data_Update
+ */
+static void Wxt536_Timestamp_List_Update(struct timespec *timestamp_list,int field_count,unsigned int valid_mask,
+					 struct timespec current_time)
+{
+	int i;
+
+	for(i = 0; i < field_count; i++)
+	{
+		if(valid_mask & (1<<i))
+			timestamp_list[i] = current_time;
+	}
+}
+
+/**
+ * Return the number of milliseconds from current_time until end_time, rounded up, or zero if end_time has passed.
+ * @param current_time The current time.
+ * @param end_time The time to compute the interval to.
+ * @return The number of milliseconds.
+ * @see qli50_wxt536_general.html#fdifftime
+ */
+static int Wxt536_Milliseconds_Until(struct timespec current_time,struct timespec end_time)
+{
+	double remaining_time;
+
+	remaining_time = fdifftime(end_time,current_time);
+	if(remaining_time <= 0.0)
+		return 0;
+	return (int)ceil(remaining_time*1000.0);
+}
+
+/**
+ * Add a number of seconds to a time.
+ * @param time The address of the timespec to add to.
+ * @param seconds The number of decimal seconds to add, which must not be negative.
+ * @see qli50_wxt536_general.html#QLI50_WXT536_ONE_SECOND_NS
+ */
+static void Wxt536_Time_Add(struct timespec *time,double seconds)
+{
+	time_t whole_seconds;
+
+	whole_seconds = (time_t)seconds;
+	time->tv_sec += whole_seconds;
+	time->tv_nsec += (long)((seconds-((double)whole_seconds))*((double)QLI50_WXT536_ONE_SECOND_NS));
+	while(time->tv_nsec >= QLI50_WXT536_ONE_SECOND_NS)
+	{
+		time->tv_sec++;
+		time->tv_nsec -= QLI50_WXT536_ONE_SECOND_NS;
+	}
+}
+
+/**
+ * Take a copy of a Wxt536's published data. This must only be called from the event loop thread, 
+ * like Wxt536_Data_Snapshot_Publish.
+ * @param snapshot The address of the Wxt536_Data_Snapshot_Struct to copy (a device's Data).
+ * @param wxt536_data The address of a Wxt536_Data_Struct to copy the published data into.
+ * @return The sequence number (generation) of the copied data.
+ * @see #Wxt536_Device_Struct
+ * @see #Wxt536_Data_Snapshot_Struct
+ */
+static unsigned int Wxt536_Data_Snapshot_Get(struct Wxt536_Data_Snapshot_Struct *snapshot,
+					     struct Wxt536_Data_Struct *wxt536_data)
+{
+	(*wxt536_data) = snapshot->Data;
+	return snapshot->Sequence;
+}
+
+/**
+ * Publish a new set of Wxt536 data. This must only be called from the event loop thread (by Wxt536_Data_Update
+ * and Wxt536_Snapshot_Restore). We copy the data, and increment the sequence number so the Qli50 server's 
+ * cached Send Results reply is rebuilt.
+ * @param snapshot The address of the Wxt536_Data_Snapshot_Struct to publish the data in (a device's Data).
+ * @param wxt536_data The address of a Wxt536_Data_Struct containing the data to publish.
+ * @see #Wxt536_Device_Struct
+ * @see #Wxt536_Data_Snapshot_Struct
+ */
+static void Wxt536_Data_Snapshot_Publish(struct Wxt536_Data_Snapshot_Struct *snapshot,
+					 struct Wxt536_Data_Struct *wxt536_data)
+{
+	snapshot->Data = (*wxt536_data);
+	snapshot->Sequence++;
+}
+
+/**
+ * Open (creating it if needed) and memory map the warm start snapshot file Wxt536_Snapshot_Filename.
+ * If the file is the wrong size, or was not written by this version of the program (it's Magic, Version or 
+ * Slot_Size do not match), it's contents are cleared. Otherwise the data saved before the last restart is kept,
+ * for Wxt536_Snapshot_Load and Wxt536_Snapshot_Restore to use.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error, and Wxt536_Snapshot_File is left NULL.
+ * @see #SNAPSHOT_FILE_MAGIC
+ * @see #SNAPSHOT_FILE_VERSION
+ * @see #Wxt536_Snapshot_File_Struct
+ * @see #Wxt536_Snapshot_Slot_Struct
+ * @see #Wxt536_Snapshot_Filename
+ * @see #Wxt536_Snapshot_File
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+static int Wxt536_Snapshot_Open(void)
+{
+	struct Wxt536_Snapshot_File_Struct *snapshot_file = NULL;
+	struct stat file_stat;
+	void *mapped_address = NULL;
+	int fd,file_errno,valid;
+
+	fd = open(Wxt536_Snapshot_Filename,O_RDWR|O_CREAT,0644);
+	if(fd < 0)
+	{
+		file_errno = errno;
+		Qli50_Wxt536_Error_Number = 262;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Snapshot_Open:Failed to open '%s' (%d:%s).",
+			Wxt536_Snapshot_Filename,file_errno,strerror(file_errno));
+		return FALSE;
+	}
+	valid = ((fstat(fd,&file_stat) == 0)&&(file_stat.st_size == sizeof(struct Wxt536_Snapshot_File_Struct)));
+	if((valid == FALSE)&&(ftruncate(fd,sizeof(struct Wxt536_Snapshot_File_Struct)) != 0))
+	{
+		file_errno = errno;
+		close(fd);
+		Qli50_Wxt536_Error_Number = 263;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Snapshot_Open:Failed to resize '%s' to %lu bytes (%d:%s).",
+			Wxt536_Snapshot_Filename,sizeof(struct Wxt536_Snapshot_File_Struct),file_errno,
+			strerror(file_errno));
+		return FALSE;
+	}
+	mapped_address = mmap(NULL,sizeof(struct Wxt536_Snapshot_File_Struct),PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+	file_errno = errno;
+	/* the mapping stays valid after the file descriptor is closed */
+	close(fd);
+	if(mapped_address == MAP_FAILED)
+	{
+		Qli50_Wxt536_Error_Number = 264;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Snapshot_Open:Failed to memory map '%s' (%d:%s).",
+			Wxt536_Snapshot_Filename,file_errno,strerror(file_errno));
+		return FALSE;
+	}
+	snapshot_file = (struct Wxt536_Snapshot_File_Struct *)mapped_address;
+	if((valid == FALSE)||(snapshot_file->Magic != SNAPSHOT_FILE_MAGIC)||
+	   (snapshot_file->Version != SNAPSHOT_FILE_VERSION)||
+	   (snapshot_file->Slot_Size != sizeof(struct Wxt536_Snapshot_Slot_Struct))||
+	   (snapshot_file->Device_Count < 0)||(snapshot_file->Device_Count > DEVICE_COUNT_MAX))
+	{
+		memset(snapshot_file,0,sizeof(struct Wxt536_Snapshot_File_Struct));
+		snapshot_file->Magic = SNAPSHOT_FILE_MAGIC;
+		snapshot_file->Version = SNAPSHOT_FILE_VERSION;
+		snapshot_file->Slot_Size = sizeof(struct Wxt536_Snapshot_Slot_Struct);
+		snapshot_file->Device_Count = 0;
+	}
+	Wxt536_Snapshot_File = snapshot_file;
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Snapshot_Open:Opened '%s', containing data for %d Wxt536(s).",
+				Wxt536_Snapshot_Filename,Wxt536_Snapshot_File->Device_Count);
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Copy the data saved in the warm start snapshot file for the Wxt536 that returns data for the specified QLI Id,
+ * using the Wxt536 list saved in the file (see Wxt536_Device_Index_Get). This is used before the serial link startup
+ * has finished. If there is no snapshot file, or no valid data for the Wxt536, the data is cleared (all the 
+ * timestamps are zero, so every datum is out of date).
+ * @param qli_id A single character, representing the QLI Id of the Qli50.
+ * @param wxt536_data The address of a Wxt536_Data_Struct to copy the saved data into.
+ * @see #Wxt536_Snapshot_File
+ * @see #Wxt536_Snapshot_Slot_Struct
+ * @see #Wxt536_Snapshot_Slot_Read
+ * @see #Wxt536_Device_Index_Get
+ */
+static void Wxt536_Snapshot_Load(char qli_id,struct Wxt536_Data_Struct *wxt536_data)
+{
+	struct Wxt536_Snapshot_Slot_Struct *slot = NULL;
+	int slot_index;
+
+	memset(wxt536_data,0,sizeof(struct Wxt536_Data_Struct));
+	if((Wxt536_Snapshot_File == NULL)||(Wxt536_Snapshot_File->Device_Count < 1))
+		return;
+	slot_index = 0;
+	if((qli_id >= 'A')&&((qli_id-'A') < Wxt536_Snapshot_File->Device_Count))
+		slot_index = qli_id-'A';
+	slot = &(Wxt536_Snapshot_File->Slot_List[slot_index]);
+	if(!Wxt536_Snapshot_Slot_Read(slot,NULL,wxt536_data))
+		memset(wxt536_data,0,sizeof(struct Wxt536_Data_Struct));
+}
+
+/**
+ * Start each Wxt536's data from the data saved in the warm start snapshot file for the same device address, 
+ * so fields the Wxt536 has not been polled for since the restart are returned until they are older than their 
+ * data group's Max_Datum_Age. The saved data is published in the device's Data, and also copied into it's 
+ * Message_Data, so fields not valid in the first data messages keep their saved values. The snapshot file is
+ * then rewritten in the current Wxt536_Device_List order. This is called from Qli50_Wxt536_Wxt536_Startup_Finish,
+ * once the startup thread has found the Wxt536s.
+ * @see #Wxt536_Snapshot_File
+ * @see #Wxt536_Snapshot_Slot_Struct
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_Data_Snapshot_Publish
+ * @see #Wxt536_Snapshot_Slot_Read
+ * @see #Wxt536_Snapshot_Save
+ */
+static void Wxt536_Snapshot_Restore(void)
+{
+	struct Wxt536_Data_Struct saved_data_list[DEVICE_COUNT_MAX];
+	struct Wxt536_Data_Struct slot_data;
+	struct Wxt536_Device_Struct *device = NULL;
+	int restored_list[DEVICE_COUNT_MAX];
+	char slot_address;
+	int i,j,restore_count;
+
+	if(Wxt536_Snapshot_File == NULL)
+		return;
+	/* find each Wxt536's saved data before rewriting any of the slots */
+	for(i = 0; i < Wxt536_Device_Count; i++)
+	{
+		restored_list[i] = FALSE;
+		for(j = 0; j < Wxt536_Snapshot_File->Device_Count; j++)
+		{
+			if(Wxt536_Snapshot_Slot_Read(&(Wxt536_Snapshot_File->Slot_List[j]),&slot_address,&slot_data)&&
+			   (slot_address == Wxt536_Device_List[i].Address))
+			{
+				saved_data_list[i] = slot_data;
+				restored_list[i] = TRUE;
+				break;
+			}
+		}
+	}
+	restore_count = 0;
+	for(i = 0; i < Wxt536_Device_Count; i++)
+	{
+		device = &(Wxt536_Device_List[i]);
+		if(restored_list[i])
+		{
+			Wxt536_Data_Snapshot_Publish(&(device->Data),&(saved_data_list[i]));
+			device->Message_Data.Wind_Data = saved_data_list[i].Wind_Data;
+			device->Message_Data.Pressure_Temperature_Humidity_Data = 
+				saved_data_list[i].Pressure_Temp_Humidity_Data;
+			device->Message_Data.Precipitation_Data = saved_data_list[i].Rain_Data;
+			device->Message_Data.Supervisor_Data = saved_data_list[i].Supervisor_Data;
+			device->Message_Data.Analogue_Data = saved_data_list[i].Analogue_Data;
+			Wxt536_Snapshot_Save(i,&(saved_data_list[i]));
+			restore_count++;
+		}
+		else
+		{
+			memset(&(saved_data_list[i]),0,sizeof(struct Wxt536_Data_Struct));
+			Wxt536_Snapshot_Save(i,&(saved_data_list[i]));
+		}
+	}
+	Wxt536_Snapshot_File->Device_Count = Wxt536_Device_Count;
+#if LOGGING > 1
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				"Wxt536_Snapshot_Restore:Restored saved data for %d of %d Wxt536(s).",
+				restore_count,Wxt536_Device_Count);
+#endif /* LOGGING */
+}
+
+/**
+ * Save a Wxt536's published data in it's slot of the warm start snapshot file. The slot's Sequence is odd whilst 
+ * the data is being copied, so a slot the process died whilst writing is not reloaded. A release fence after the 
+ * odd Sequence keeps the data stores behind it, and the release store of the even Sequence keeps them ahead of it.
+ * The file is memory mapped, so the data survives the process restarting (but not necessarily the machine 
+ * restarting).
+ * @param device_index The index in Wxt536_Device_List of the Wxt536.
+ * @param wxt536_data The address of the Wxt536_Data_Struct to save.
+ * @see #Wxt536_Snapshot_File
+ * @see #Wxt536_Snapshot_Slot_Struct
+ * @see #Wxt536_Device_List
+ */
+static void Wxt536_Snapshot_Save(int device_index,struct Wxt536_Data_Struct *wxt536_data)
+{
+	struct Wxt536_Snapshot_Slot_Struct *slot = NULL;
+
+	if(Wxt536_Snapshot_File == NULL)
+		return;
+	slot = &(Wxt536_Snapshot_File->Slot_List[device_index]);
+	__atomic_store_n(&(slot->Sequence),(slot->Sequence|1),__ATOMIC_RELAXED);
+	/* stop the data stores below being moved ahead of the odd Sequence */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	slot->Address = Wxt536_Device_List[device_index].Address;
+	slot->Data = (*wxt536_data);
+	__atomic_store_n(&(slot->Sequence),slot->Sequence+1,__ATOMIC_RELEASE);
+}
+
+/**
+ * Copy a slot of the warm start snapshot file, if it holds complete data. The slot's Sequence is read before
+ * and after the copy: if it is odd (the slot was being written, when the process died or by Wxt536_Snapshot_Save) 
+ * or it changed during the copy, the copy is rejected.
+ * @param slot The address of the Wxt536_Snapshot_Slot_Struct to read.
+ * @param address The address of a character to copy the slot's device address into, or NULL.
+ * @param wxt536_data The address of a Wxt536_Data_Struct to copy the slot's data into.
+ * @return The routine returns TRUE if the copy is complete, and FALSE if it is not and should not be used.
+ * @see #Wxt536_Snapshot_Slot_Struct
+ * @see #Wxt536_Snapshot_Save
+ */
+static int Wxt536_Snapshot_Slot_Read(struct Wxt536_Snapshot_Slot_Struct *slot,char *address,
+				     struct Wxt536_Data_Struct *wxt536_data)
+{
+	unsigned int start_sequence,end_sequence;
+
+	start_sequence = __atomic_load_n(&(slot->Sequence),__ATOMIC_ACQUIRE);
+	if((start_sequence & 1) != 0)
+		return FALSE;
+	if(address != NULL)
+		(*address) = slot->Address;
+	(*wxt536_data) = slot->Data;
+	/* stop the data loads above being moved after the second Sequence load */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	end_sequence = __atomic_load_n(&(slot->Sequence),__ATOMIC_RELAXED);
+	return (start_sequence == end_sequence);
+}
+
+/**
+ * Read the settings that can be changed whilst the program is running from the config file, and check them.
+ * This is used by Qli50_Wxt536_Wxt536_Initialise, and by Qli50_Wxt536_Wxt536_Reload when the config file 
+ * is reloaded.
+ * <ul>
+ * <li>We retrieve the composite data message poll period (keyword "wxt536.poll.period"), and check it is positive.
+ * <li>For each data group in Wxt536_Message_Group_List, we retrieve it's poll period
+ *     (keyword "wxt536.&lt;name&gt;.poll.period") and check it is positive, and it's maximum datum age
+ *     (keyword "wxt536.&lt;name&gt;.max_datum_age") and check it is positive. Wxt536_Poll_Schedule_Check
+ *     is not used before the startup has finished, so this is the only check a reload gets then.
+ * <li>We retrieve the Wxt536 analogue input update interval and averaging time 
+ *     (keywords "wxt536.analogue_input.update_interval" and "wxt536.analogue_input.averaging_time").
+ * <li>We retrieve the Wxt536 pyranometer gain (keyword "wxt536.pyranometer.gain") and the CMP3 pyranometer
+ *     sensitivity (keyword "cmp3.pyranometer.sensitivity").
+ * <li>We retrieve which sensors to use for the surface wetness (keywords "digital.surface.wet.sensor" and 
+ *     "analogue.surface.wet.sensor") using Wxt536_Config_Sensor_Get, and their thresholds and scaling factors.
+ * <li>We retrieve whether to fake the Qli50 internal current, internal temperature and reference temperature,
+ *     or return no measurement (keywords "qli50.internal_current.fake", "qli50.internal_temperature.fake" and
+ *     "qli50.reference_temperature.fake").
+ * <li>If Wxt536_Automatic_Mode is set, we retrieve how often the Wxt536 sends the composite data message
+ *     (keyword "wxt536.automatic.composite_interval"). Otherwise the current setting is kept.
+ * <li>We retrieve the link supervisor settings (keywords "wxt536.link.failure_limit",
+ *     "wxt536.link.backoff.min" and "wxt536.link.backoff.max"), and check them.
+ * </ul>
+ * @param tuning The address of a Wxt536_Tuning_Struct to fill in with the settings.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Tuning_Struct
+ * @see #Wxt536_Message_Group_List
+ * @see #MESSAGE_GROUP_COUNT
+ * @see #Wxt536_Automatic_Mode
+ * @see #Wxt536_Automatic_Composite_Interval
+ * @see #Wxt536_Config_Sensor_Get
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Int_Get
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Double_Get
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Boolean_Get
+ */
+static int Wxt536_Tuning_Get(struct Wxt536_Tuning_Struct *tuning)
+{
+	char keyword[64];
+	int i;
+
+	/* get how often we should poll the Wxt536 sensors, in seconds */
+	if(!Qli50_Wxt536_Config_Double_Get("wxt536.poll.period",&(tuning->Poll_Period)))
+		return FALSE;
+	if(tuning->Poll_Period <= 0.0)
+	{
+		Qli50_Wxt536_Error_Number = 215;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Tuning_Get: Illegal poll period %.3f s.",tuning->Poll_Period);
+		return FALSE;
+	}
+	/* get how often each data group is polled, and the maximum age of it's data, in seconds */
+	for(i = 0; i < MESSAGE_GROUP_COUNT; i++)
+	{
+		sprintf(keyword,"wxt536.%s.poll.period",Wxt536_Message_Group_List[i].Name);
+		if(!Qli50_Wxt536_Config_Double_Get(keyword,&(tuning->Group_Poll_Period_List[i])))
+			return FALSE;
+		if(tuning->Group_Poll_Period_List[i] <= 0.0)
+		{
+			Qli50_Wxt536_Error_Number = 238;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Tuning_Get: Illegal %s poll period %.3f s.",
+				Wxt536_Message_Group_List[i].Name,tuning->Group_Poll_Period_List[i]);
+			return FALSE;
+		}
+		sprintf(keyword,"wxt536.%s.max_datum_age",Wxt536_Message_Group_List[i].Name);
+		if(!Qli50_Wxt536_Config_Double_Get(keyword,&(tuning->Group_Max_Datum_Age_List[i])))
+			return FALSE;
+		if(tuning->Group_Max_Datum_Age_List[i] <= 0.0)
+		{
+			Qli50_Wxt536_Error_Number = 272;
+			sprintf(Qli50_Wxt536_Error_String,"Wxt536_Tuning_Get: Illegal %s maximum datum age %.3f s.",
+				Wxt536_Message_Group_List[i].Name,tuning->Group_Max_Datum_Age_List[i]);
+			return FALSE;
+		}
+	}
+	/* get the Wxt536 analogue input settings */
+	if(!Qli50_Wxt536_Config_Double_Get("wxt536.analogue_input.update_interval",
+					   &(tuning->Analogue_Input_Update_Interval)))
+		return FALSE;
+	if(!Qli50_Wxt536_Config_Double_Get("wxt536.analogue_input.averaging_time",
+					   &(tuning->Analogue_Input_Averaging_Time)))
+		return FALSE;
+	/* get the Wxt536 pyranometer gain */
+	if(!Qli50_Wxt536_Config_Double_Get("wxt536.pyranometer.gain",&(tuning->Pyranometer_Gain)))
+		return FALSE;
+	/* get the CMP3 pyranometer sensitivity in uV/W/m^2*/
+	if(!Qli50_Wxt536_Config_Double_Get("cmp3.pyranometer.sensitivity",&(tuning->CMP3_Pyranometer_Sensitivity)))
+		return FALSE;
+	/* get which sensor to use for the digital surface wet determination */
+	if(!Wxt536_Config_Sensor_Get("digital.surface.wet.sensor",&(tuning->Digital_Surface_Wet_Sensor)))
+		return FALSE;
+	/* get which sensor to use for the analogue surface wet determination */
+	if(!Wxt536_Config_Sensor_Get("analogue.surface.wet.sensor",&(tuning->Analogue_Surface_Wet_Sensor)))
+		return FALSE;
+	/* get the digital surface wet drd11a threashold in volts */
+	if(!Qli50_Wxt536_Config_Double_Get("digital.surface.wet.drd11a.threshold",
+					   &(tuning->Digital_Surface_Wet_Drd11a_Threshold)))
+		return FALSE;
+	/* get the analogue surface wet drd11a wet-point voltage */
+	if(!Qli50_Wxt536_Config_Double_Get("analogue.surface.wet.drd11a.wetpoint",
+					   &(tuning->Analogue_Surface_Wet_Drd11a_Wet_Point)))
+		return FALSE;
+	/* get the analogue surface wet drd11a scaling factor */
+	if(!Qli50_Wxt536_Config_Double_Get("analogue.surface.wet.drd11a.scale",
+					   &(tuning->Analogue_Surface_Wet_Drd11a_Scale)))
+		return FALSE;
+	/* get the analogue surface wet wxt536 scaling factor */
+	if(!Qli50_Wxt536_Config_Double_Get("analogue.surface.wet.wxt536.scale",
+					   &(tuning->Analogue_Surface_Wet_Wxt536_Scale)))
+		return FALSE;
+	/* Should we fake the qli50 internal current data, or return QLI50_ERROR_NO_MEASUREMENT? */
+	if(!Qli50_Wxt536_Config_Boolean_Get("qli50.internal_current.fake",&(tuning->Qli50_Internal_Current_Fake)))
+		return FALSE;
+	 /* Should we fake the qli50 internal temperature data, or return QLI50_ERROR_NO_MEASUREMENT? */
+	if(!Qli50_Wxt536_Config_Boolean_Get("qli50.internal_temperature.fake",
+					    &(tuning->Qli50_Internal_Temperature_Fake)))
+		return FALSE;
+	 /* Should we fake the qli50 reference temperature data, or return QLI50_ERROR_NO_MEASUREMENT? */
+	if(!Qli50_Wxt536_Config_Boolean_Get("qli50.reference_temperature.fake",
+					    &(tuning->Qli50_Reference_Temperature_Fake)))
+		return FALSE;
+	/* in automatic mode, how often should the Wxt536 send the composite data message */
+	tuning->Automatic_Composite_Interval = Wxt536_Automatic_Composite_Interval;
+	if(Wxt536_Automatic_Mode)
+	{
+		if(!Qli50_Wxt536_Config_Int_Get("wxt536.automatic.composite_interval",
+						&(tuning->Automatic_Composite_Interval)))
+			return FALSE;
+	}
+	/* get how the link supervisor recovers Wxt536s that stop replying */
+	if(!Qli50_Wxt536_Config_Int_Get("wxt536.link.failure_limit",&(tuning->Link_Failure_Limit)))
+		return FALSE;
+	if(!Qli50_Wxt536_Config_Double_Get("wxt536.link.backoff.min",&(tuning->Link_Backoff_Min)))
+		return FALSE;
+	if(!Qli50_Wxt536_Config_Double_Get("wxt536.link.backoff.max",&(tuning->Link_Backoff_Max)))
+		return FALSE;
+	if((tuning->Link_Failure_Limit < 1)||(tuning->Link_Backoff_Min <= 0.0)||
+	   (tuning->Link_Backoff_Max < tuning->Link_Backoff_Min))
+	{
+		Qli50_Wxt536_Error_Number = 251;
+		sprintf(Qli50_Wxt536_Error_String,"Wxt536_Tuning_Get: "
+			"Illegal link failure limit %d or backoff %.3f s .. %.3f s.",tuning->Link_Failure_Limit,
+			tuning->Link_Backoff_Min,tuning->Link_Backoff_Max);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Swap the settings in tuning with the settings in use. On return, tuning holds the previous settings, 
+ * so calling this again puts them back. This is only called from the event loop thread (which is the only thread
+ * that uses these settings once the startup thread has finished), so the Qli50 server never sees a mixture of 
+ * the old and new settings. Wxt536_Tuning_Generation is incremented, so the Qli50 server's cached Send Results
+ * reply (which may depend on the previous settings) is no longer used.
+ * @param tuning The address of a Wxt536_Tuning_Struct holding the settings to use.
+ * @see #Wxt536_Tuning_Struct
+ * @see #Wxt536_Tuning_Generation
+ * @see #Wxt536_Poll_Period
+ * @see #Wxt536_Message_Group_List
+ * @see #MESSAGE_GROUP_COUNT
+ * @see #Wxt536_Analogue_Input_Update_Interval
+ * @see #Wxt536_Analogue_Input_Averaging_Time
+ * @see #Wxt536_Pyranometer_Gain
+ * @see #CMP3_Pyranometer_Sensitivity
+ * @see #Digital_Surface_Wet_Sensor
+ * @see #Analogue_Surface_Wet_Sensor
+ * @see #Digital_Surface_Wet_Drd11a_Threshold
+ * @see #Analogue_Surface_Wet_Drd11a_Wet_Point
+ * @see #Analogue_Surface_Wet_Drd11a_Scale
+ * @see #Analogue_Surface_Wet_Wxt536_Scale
+ * @see #Qli50_Internal_Current_Fake
+ * @see #Qli50_Internal_Temperature_Fake
+ * @see #Qli50_Reference_Temperature_Fake
+ * @see #Wxt536_Automatic_Composite_Interval
+ * @see #Wxt536_Link_Failure_Limit
+ * @see #Wxt536_Link_Backoff_Min
+ * @see #Wxt536_Link_Backoff_Max
+ */
+static void Wxt536_Tuning_Swap(struct Wxt536_Tuning_Struct *tuning)
+{
+	struct Wxt536_Tuning_Struct previous_tuning;
+	int i;
+
+	previous_tuning.Poll_Period = Wxt536_Poll_Period;
+	for(i = 0; i < MESSAGE_GROUP_COUNT; i++)
+	{
+		previous_tuning.Group_Poll_Period_List[i] = Wxt536_Message_Group_List[i].Poll_Period;
+		previous_tuning.Group_Max_Datum_Age_List[i] = Wxt536_Message_Group_List[i].Max_Datum_Age;
+	}
+	previous_tuning.Analogue_Input_Update_Interval = Wxt536_Analogue_Input_Update_Interval;
+	previous_tuning.Analogue_Input_Averaging_Time = Wxt536_Analogue_Input_Averaging_Time;
+	previous_tuning.Pyranometer_Gain = Wxt536_Pyranometer_Gain;
+	previous_tuning.CMP3_Pyranometer_Sensitivity = CMP3_Pyranometer_Sensitivity;
+	previous_tuning.Digital_Surface_Wet_Sensor = Digital_Surface_Wet_Sensor;
+	previous_tuning.Analogue_Surface_Wet_Sensor = Analogue_Surface_Wet_Sensor;
+	previous_tuning.Digital_Surface_Wet_Drd11a_Threshold = Digital_Surface_Wet_Drd11a_Threshold;
+	previous_tuning.Analogue_Surface_Wet_Drd11a_Wet_Point = Analogue_Surface_Wet_Drd11a_Wet_Point;
+	previous_tuning.Analogue_Surface_Wet_Drd11a_Scale = Analogue_Surface_Wet_Drd11a_Scale;
+	previous_tuning.Analogue_Surface_Wet_Wxt536_Scale = Analogue_Surface_Wet_Wxt536_Scale;
+	previous_tuning.Qli50_Internal_Current_Fake = Qli50_Internal_Current_Fake;
+	previous_tuning.Qli50_Internal_Temperature_Fake = Qli50_Internal_Temperature_Fake;
+	previous_tuning.Qli50_Reference_Temperature_Fake = Qli50_Reference_Temperature_Fake;
+	previous_tuning.Automatic_Composite_Interval = Wxt536_Automatic_Composite_Interval;
+	previous_tuning.Link_Failure_Limit = Wxt536_Link_Failure_Limit;
+	previous_tuning.Link_Backoff_Min = Wxt536_Link_Backoff_Min;
+	previous_tuning.Link_Backoff_Max = Wxt536_Link_Backoff_Max;
+	Wxt536_Poll_Period = tuning->Poll_Period;
+	for(i = 0; i < MESSAGE_GROUP_COUNT; i++)
+	{
+		Wxt536_Message_Group_List[i].Poll_Period = tuning->Group_Poll_Period_List[i];
+		Wxt536_Message_Group_List[i].Max_Datum_Age = tuning->Group_Max_Datum_Age_List[i];
+	}
+	Wxt536_Analogue_Input_Update_Interval = tuning->Analogue_Input_Update_Interval;
+	Wxt536_Analogue_Input_Averaging_Time = tuning->Analogue_Input_Averaging_Time;
+	Wxt536_Pyranometer_Gain = tuning->Pyranometer_Gain;
+	CMP3_Pyranometer_Sensitivity = tuning->CMP3_Pyranometer_Sensitivity;
+	Digital_Surface_Wet_Sensor = tuning->Digital_Surface_Wet_Sensor;
+	Analogue_Surface_Wet_Sensor = tuning->Analogue_Surface_Wet_Sensor;
+	Digital_Surface_Wet_Drd11a_Threshold = tuning->Digital_Surface_Wet_Drd11a_Threshold;
+	Analogue_Surface_Wet_Drd11a_Wet_Point = tuning->Analogue_Surface_Wet_Drd11a_Wet_Point;
+	Analogue_Surface_Wet_Drd11a_Scale = tuning->Analogue_Surface_Wet_Drd11a_Scale;
+	Analogue_Surface_Wet_Wxt536_Scale = tuning->Analogue_Surface_Wet_Wxt536_Scale;
+	Qli50_Internal_Current_Fake = tuning->Qli50_Internal_Current_Fake;
+	Qli50_Internal_Temperature_Fake = tuning->Qli50_Internal_Temperature_Fake;
+	Qli50_Reference_Temperature_Fake = tuning->Qli50_Reference_Temperature_Fake;
+	Wxt536_Automatic_Composite_Interval = tuning->Automatic_Composite_Interval;
+	Wxt536_Link_Failure_Limit = tuning->Link_Failure_Limit;
+	Wxt536_Link_Backoff_Min = tuning->Link_Backoff_Min;
+	Wxt536_Link_Backoff_Max = tuning->Link_Backoff_Max;
+	(*tuning) = previous_tuning;
+	Wxt536_Tuning_Generation++;
+}
+
+/**
+ * Log a warning for each setting in the reloaded config file that has changed, but only takes effect 
+ * when the program is restarted, as it would mean reopening or reconfiguring the serial link. 
+ * These are the Wxt536 serial device name and read timeout, whether the serial link is an RS-485 bus, 
+ * the Wxt536 protocol, and whether the composite data message is used.
+ * Settings only used by the serial link startup (such as the device address list) are used by the next startup.
+ * @see #Serial_Device_Filename
+ * @see #Wxt536_Read_Timeout
+ * @see #Wxt536_RS485_Enable
+ * @see #Wxt536_Protocol
+ * @see #Wxt536_Composite_Data_Enable
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_String_Get
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Int_Get
+ * @see qli50_wxt536_config.html#Qli50_Wxt536_Config_Boolean_Get
+ */
+static void Wxt536_Reload_Restart_Check(void)
+{
+	char serial_device_filename[FILENAME_LENGTH];
+	char protocol_string[32];
+	int read_timeout,rs485_enable,composite_data_enable;
+
+	if(Qli50_Wxt536_Config_String_Get("wxt536.serial_device.name",serial_device_filename,FILENAME_LENGTH)&&
+	   (strcmp(serial_device_filename,Serial_Device_Filename) != 0))
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Reload_Restart_Check:Serial device '%s' needs a restart to take effect.",
+					serial_device_filename);
+#endif /* LOGGING */
+	}
+	if(Qli50_Wxt536_Config_Int_Get("wxt536.serial_device.read_timeout",&read_timeout)&&
+	   (read_timeout != Wxt536_Read_Timeout))
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Reload_Restart_Check:Read timeout %d ms needs a restart to take effect.",
+					read_timeout);
+#endif /* LOGGING */
+	}
+	if(Qli50_Wxt536_Config_Boolean_Get("wxt536.rs485.enable",&rs485_enable)&&
+	   (rs485_enable != Wxt536_RS485_Enable))
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Reload_Restart_Check:RS-485 enable %d needs a restart to take effect.",
+					rs485_enable);
+#endif /* LOGGING */
+	}
+	if(Qli50_Wxt536_Config_String_Get("wxt536.protocol",protocol_string,31)&&
+	   (protocol_string[0] != Wxt536_Protocol))
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Reload_Restart_Check:Protocol '%s' needs a restart to take effect.",
+					protocol_string);
+#endif /* LOGGING */
+	}
+	if(Qli50_Wxt536_Config_Boolean_Get("wxt536.composite_data.enable",&composite_data_enable)&&
+	   (composite_data_enable != Wxt536_Composite_Data_Enable))
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Reload_Restart_Check:Composite data enable %d needs a restart "
+					"to take effect.",composite_data_enable);
+#endif /* LOGGING */
+	}
+	/* the config routines set the error when a keyword is missing, which is not an error here */
+	Qli50_Wxt536_Error_Number = 0;
+}
+
+/**
+ * Write the Wxt536 settings that have changed in a reloaded config file to each Wxt536. Only the changed settings
+ * are written: the analogue input update interval and averaging time ("aIU,I=&lt;interval&gt;,A=&lt;time&gt;"),
+ * and the pyranometer gain ("aIB,G=&lt;gain&gt;"). The commands are added to the QUEUE_PRIORITY_HOUSEKEEPING 
+ * class of the Wxt536 command queue, so they are sent by the bus scheduler between data message requests, 
+ * and Wxt536_Reload_Setting_Reply logs the replies. In automatic mode commands cannot be queued 
+ * (their replies cannot be told apart from the data messages), so the changed settings 
+ * (including the composite data interval) are written the next time the Wxt536 is configured.
+ * @param previous_tuning The address of a Wxt536_Tuning_Struct holding the settings in use before the reload.
+ * @return The routine returns TRUE on success and FALSE on failure. If it fails, Qli50_Wxt536_Error_Number and
+ *         Qli50_Wxt536_Error_String will be set with a suitable error.
+ * @see #Wxt536_Tuning_Struct
+ * @see #SETTING_TOLERANCE
+ * @see #QUEUE_COMMAND_LENGTH
+ * @see #Wxt536_Automatic_Mode
+ * @see #Wxt536_Analogue_Input_Update_Interval
+ * @see #Wxt536_Analogue_Input_Averaging_Time
+ * @see #Wxt536_Pyranometer_Gain
+ * @see #Wxt536_Automatic_Composite_Interval
+ * @see #Wxt536_Device_List
+ * @see #Wxt536_Device_Count
+ * @see #Wxt536_Queue_Priority_Name_List
+ * @see #Wxt536_Queue_Add
+ * @see #Wxt536_Reload_Setting_Reply
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_Number
+ * @see qli50_wxt536_general.html#Qli50_Wxt536_Error_String
+ */
+static int Wxt536_Reload_Settings_Queue(struct Wxt536_Tuning_Struct *previous_tuning)
+{
+	struct timespec current_time;
+	char command_string[2][QUEUE_COMMAND_LENGTH];
+	int analogue_input_changed,gain_changed,composite_interval_changed,command_count,device_index,i;
+
+	analogue_input_changed = ((fabs(previous_tuning->Analogue_Input_Update_Interval-
+					Wxt536_Analogue_Input_Update_Interval) > SETTING_TOLERANCE)||
+				  (fabs(previous_tuning->Analogue_Input_Averaging_Time-
+					Wxt536_Analogue_Input_Averaging_Time) > SETTING_TOLERANCE));
+	gain_changed = (fabs(previous_tuning->Pyranometer_Gain-Wxt536_Pyranometer_Gain) > SETTING_TOLERANCE);
+	composite_interval_changed = (previous_tuning->Automatic_Composite_Interval != 
+				      Wxt536_Automatic_Composite_Interval);
+	if((analogue_input_changed == FALSE)&&(gain_changed == FALSE)&&(composite_interval_changed == FALSE))
+		return TRUE;
+	if(Wxt536_Automatic_Mode)
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+				 "Wxt536_Reload_Settings_Queue:Changed Wxt536 settings cannot be written in automatic mode, "
+				 "they will be written when the Wxt536s are next configured.");
+#endif /* LOGGING */
+		return TRUE;
+	}
+	clock_gettime(CLOCK_MONOTONIC,&current_time);
+	for(device_index = 0; device_index < Wxt536_Device_Count; device_index++)
+	{
+		command_count = 0;
+		if(analogue_input_changed)
+		{
+			sprintf(command_string[command_count++],"%cIU,I=%.3f,A=%.3f",
+				Wxt536_Device_List[device_index].Address,Wxt536_Analogue_Input_Update_Interval,
+				Wxt536_Analogue_Input_Averaging_Time);
+		}
+		if(gain_changed)
+		{
+			sprintf(command_string[command_count++],"%cIB,G=%.3f",Wxt536_Device_List[device_index].Address,
+				Wxt536_Pyranometer_Gain);
+		}
+		for(i = 0; i < command_count; i++)
+		{
+			if(!Wxt536_Queue_Add(QUEUE_PRIORITY_HOUSEKEEPING,device_index,-1,command_string[i],
+					     Wxt536_Reload_Setting_Reply,current_time))
+			{
+				Qli50_Wxt536_Error_Number = 266;
+				sprintf(Qli50_Wxt536_Error_String,"Wxt536_Reload_Settings_Queue:"
+					"Failed to queue '%s', the %s command queue is full.",command_string[i],
+					Wxt536_Queue_Priority_Name_List[QUEUE_PRIORITY_HOUSEKEEPING]);
+				return FALSE;
+			}
+#if LOGGING > 1
+			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+						"Wxt536_Reload_Settings_Queue:Queued '%s'.",command_string[i]);
+#endif /* LOGGING */
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * The reply callback for the setting commands queued by Wxt536_Reload_Settings_Queue. The command sent is the
+ * outstanding request's Command_String. We log the reply, or that no reply was received (the setting is then
+ * written the next time the Wxt536 is configured, as Wxt536_Device_Initialise writes settings that differ).
+ * @param reply_string The reply to the setting command, or NULL if no reply was received.
+ * @see #Wxt536_Request
+ * @see #Wxt536_Reload_Settings_Queue
+ */
+static void Wxt536_Reload_Setting_Reply(char *reply_string)
+{
+	if(reply_string == NULL)
+	{
+#if LOGGING > 1
+		Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_INTERMEDIATE,
+					"Wxt536_Reload_Setting_Reply:No reply to '%s'.",Wxt536_Request.Command_String);
+#endif /* LOGGING */
+		return;
+	}
+#if LOGGING > 5
+	Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERBOSE,
+				"Wxt536_Reload_Setting_Reply:'%s' replied '%s'.",Wxt536_Request.Command_String,
+				reply_string);
+#endif /* LOGGING */
+}
+
 /**
  * Routine to retrieve a sensor type from the config file.
  * @param keyword The keyword with a sensor type value.
@@ -842,11 +4641,11 @@ static int Wxt536_Pyranometer_Volts_To_Watts_M2(double voltage)
  * We will replace that (when using the Wxt536 piezzo sensor) with the Rain intensity in mm/h.
  * @param current_time An instance of struct timespec representing the current time, we use this to compare
  *        with the data timestamps to ensure the data has not gone out of date.
+ * @param wxt536_data The address of a snapshot of a Wxt536's data to use when computing the value.
  * @param digital_surface_wet_value The instance of Wms_Qli50_Data_Value to fill in with the QLI50 digital surface wet
  *        value to return.
- * @see #Wxt536_Data
  * @see #Wxt536_Data_Struct
- * @see #Max_Datum_Age
+ * @see #Wxt536_Message_Group_List
  * @see #Digital_Surface_Wet_Sensor
  * @see #Digital_Surface_Wet_Drd11a_Threshold
  * @see ../qli50/cdocs/wms_qli50_command.html#QLI50_ERROR_NO_MEASUREMENT
@@ -854,27 +4653,28 @@ static int Wxt536_Pyranometer_Volts_To_Watts_M2(double voltage)
  * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Precipitation_Data_Get
  * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Analogue_Data_Get
  */
-static void Wxt536_Digital_Surface_Wet_Set(struct timespec current_time,
+static void Wxt536_Digital_Surface_Wet_Set(struct timespec current_time,struct Wxt536_Data_Struct *wxt536_data,
 					   struct Wms_Qli50_Data_Value *digital_surface_wet_value)
 {
 	/* do we want to use the wxt536 piezo sensor to determine this? */
 	if(Digital_Surface_Wet_Sensor == SENSOR_TYPE_WXT536)
 	{
-		/* if the precipitation timestamp is new enough use precipitation */
-		if(fdifftime(current_time,Wxt536_Data.Rain_Timestamp) < Max_Datum_Age)
+		/* if the rain intensity timestamp is new enough use precipitation */
+		if(fdifftime(current_time,wxt536_data->Rain_Timestamp[WXT536_COMMAND_RAIN_INTENSITY]) <
+		   Wxt536_Message_Group_List[MESSAGE_GROUP_PRECIPITATION].Max_Datum_Age)
 		{
 #if LOGGING > 1
 			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERY_VERBOSE,
 						"Wxt536_Digital_Surface_Wet_Set:"
 						"Using Wxt536 Piezo rain sensor with rain intensity %.2f mm/h "
 						"and hail intensity %.2f hits/cm^2h.",
-						Wxt536_Data.Rain_Data.Rain_Intensity,Wxt536_Data.Rain_Data.Hail_Intensity);
+						wxt536_data->Rain_Data.Rain_Intensity,wxt536_data->Rain_Data.Hail_Intensity);
 #endif /* LOGGING */
 			/* digital surface wetness type was INT, can I arbitarily change it to DOUBLE? */
 			digital_surface_wet_value->Type = DATA_TYPE_DOUBLE;
-			digital_surface_wet_value->Value.DValue = Wxt536_Data.Rain_Data.Rain_Intensity;
+			digital_surface_wet_value->Value.DValue = wxt536_data->Rain_Data.Rain_Intensity;
 			/*
-			if((Wxt536_Data.Rain_Data.Rain_Intensity > 0.0)||(Wxt536_Data.Rain_Data.Hail_Intensity > 0.0))
+			if((wxt536_data->Rain_Data.Rain_Intensity > 0.0)||(wxt536_data->Rain_Data.Hail_Intensity > 0.0))
 			{
 				digital_surface_wet_value->Type = DATA_TYPE_INT;
 				digital_surface_wet_value->Value.IValue = 0;*/ /* wet */
@@ -895,20 +4695,21 @@ static void Wxt536_Digital_Surface_Wet_Set(struct timespec current_time,
 	/* do we want to use the drd11a sensor to determine this? */
 	else if(Digital_Surface_Wet_Sensor == SENSOR_TYPE_DRD11A)
 	{
-		/* if the analogue timestamp is new enough use the DRD11A */
-		if(fdifftime(current_time,Wxt536_Data.Analogue_Timestamp) < Max_Datum_Age)
+		/* if the ultrasonic level timestamp is new enough use the DRD11A */
+		if(fdifftime(current_time,wxt536_data->Analogue_Timestamp[WXT536_COMMAND_ULTRASONIC_LEVEL_VOLTAGE]) <
+		   Wxt536_Message_Group_List[MESSAGE_GROUP_ANALOGUE].Max_Datum_Age)
 		{
 #if LOGGING > 1
 			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERY_VERBOSE,
 						"Wxt536_Digital_Surface_Wet_Set:"
 						"Using DRD11A rain sensor with voltage %.3f v (3v dry, 1v wet).",
-						Wxt536_Data.Analogue_Data.Ultrasonic_Level_Voltage);
+						wxt536_data->Analogue_Data.Ultrasonic_Level_Voltage);
 #endif /* LOGGING */
 			/* The DRD11A analogue output is connected to the Ultrasonic Level analogue input.
 			** The DRD11A analogue output should read 3v fully dry, 1v fully wet. 
 			** The weather station is expecting the digital surface wet value to be as per the
 			** DRD11A DSW, active low corresponds to rain, 2-5v is 'dry'. */
-			if(Wxt536_Data.Analogue_Data.Ultrasonic_Level_Voltage < Digital_Surface_Wet_Drd11a_Threshold)
+			if(wxt536_data->Analogue_Data.Ultrasonic_Level_Voltage < Digital_Surface_Wet_Drd11a_Threshold)
 			{
 				digital_surface_wet_value->Type = DATA_TYPE_INT;
 				digital_surface_wet_value->Value.IValue = 0; /* wet */
@@ -941,11 +4742,11 @@ static void Wxt536_Digital_Surface_Wet_Set(struct timespec current_time,
  * the Wms counts 0..10 as dry and above that as wet (i.e. the Wms goes into suspend above 10%).
  * @param current_time An instance of struct timespec representing the current time, we use this to compare
  *        with the data timestamps to ensure the data has not gone out of date.
+ * @param wxt536_data The address of a snapshot of a Wxt536's data to use when computing the value.
  * @param analogue_surface_wet_value The instance of Wms_Qli50_Data_Value to fill in with the QLI50 analogue surface wet
  *        value to return.
- * @see #Wxt536_Data
  * @see #Wxt536_Data_Struct
- * @see #Max_Datum_Age
+ * @see #Wxt536_Message_Group_List
  * @see #Analogue_Surface_Wet_Sensor
  * @see #Analogue_Surface_Wet_Drd11a_Wet_Point
  * @see #Analogue_Surface_Wet_Drd11a_Scale
@@ -955,19 +4756,20 @@ static void Wxt536_Digital_Surface_Wet_Set(struct timespec current_time,
  * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Precipitation_Data_Get
  * @see ../wxt536/cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Analogue_Data_Get
  */
-static void Wxt536_Analogue_Surface_Wet_Set(struct timespec current_time,
+static void Wxt536_Analogue_Surface_Wet_Set(struct timespec current_time,struct Wxt536_Data_Struct *wxt536_data,
 					    struct Wms_Qli50_Data_Value *analogue_surface_wet_value)
 {
 	/* do we want to use the drd11a sensor to determine this? */
 	if(Analogue_Surface_Wet_Sensor == SENSOR_TYPE_DRD11A)
 	{
-		/* if the analogue timestamp is new enough use the DRD11A */
-		if(fdifftime(current_time,Wxt536_Data.Analogue_Timestamp) < Max_Datum_Age)
+		/* if the ultrasonic level timestamp is new enough use the DRD11A */
+		if(fdifftime(current_time,wxt536_data->Analogue_Timestamp[WXT536_COMMAND_ULTRASONIC_LEVEL_VOLTAGE]) <
+		   Wxt536_Message_Group_List[MESSAGE_GROUP_ANALOGUE].Max_Datum_Age)
 		{
 			/* The DRD11A is connected to the Ultrasonic Level analogue input.
 			** This should read 3v fully dry, 1v fully wet. */
 			analogue_surface_wet_value->Type = DATA_TYPE_INT;
-			analogue_surface_wet_value->Value.IValue = 100-(int)((Wxt536_Data.Analogue_Data.Ultrasonic_Level_Voltage-Analogue_Surface_Wet_Drd11a_Wet_Point)*Analogue_Surface_Wet_Drd11a_Scale);
+			analogue_surface_wet_value->Value.IValue = 100-(int)((wxt536_data->Analogue_Data.Ultrasonic_Level_Voltage-Analogue_Surface_Wet_Drd11a_Wet_Point)*Analogue_Surface_Wet_Drd11a_Scale);
 			if(analogue_surface_wet_value->Value.IValue < 0)
 				analogue_surface_wet_value->Value.IValue = 0;
 			if(analogue_surface_wet_value->Value.IValue > 100)
@@ -977,7 +4779,7 @@ static void Wxt536_Analogue_Surface_Wet_Set(struct timespec current_time,
 						"Wxt536_Analogue_Surface_Wet_Set:"
 						"Using DRD11A rain sensor with voltage %.3f v (3v dry, 1v wet), "
 						"using wet point %.3f v and scale %.2f, giving value %d %%.",
-						Wxt536_Data.Analogue_Data.Ultrasonic_Level_Voltage,
+						wxt536_data->Analogue_Data.Ultrasonic_Level_Voltage,
 						Analogue_Surface_Wet_Drd11a_Wet_Point,Analogue_Surface_Wet_Drd11a_Scale,
 						analogue_surface_wet_value->Value.IValue);
 #endif /* LOGGING */
@@ -992,14 +4794,15 @@ static void Wxt536_Analogue_Surface_Wet_Set(struct timespec current_time,
 	/* do we want to use the wxt536 piezo sensor to determine this? */
 	else if(Analogue_Surface_Wet_Sensor == SENSOR_TYPE_WXT536)
 	{
-		/* if the precipitation timestamp is new enough use precipitation */
-		if(fdifftime(current_time,Wxt536_Data.Rain_Timestamp) < Max_Datum_Age)
+		/* if the rain intensity timestamp is new enough use precipitation */
+		if(fdifftime(current_time,wxt536_data->Rain_Timestamp[WXT536_COMMAND_RAIN_INTENSITY]) <
+		   Wxt536_Message_Group_List[MESSAGE_GROUP_PRECIPITATION].Max_Datum_Age)
 		{
 			analogue_surface_wet_value->Type = DATA_TYPE_INT;
 			/* rain intensity is measured in mm/h. We and scale it (with range checking) with 
 			** Analogue_Surface_Wet_Wxt536_Scale. A Analogue_Surface_Wet_Wxt536_Scale value of 100.0 
 			** means a rain intensity of 1mm/h converts to an analaogue wetness of 100%  */
-			analogue_surface_wet_value->Value.IValue = (int)(Wxt536_Data.Rain_Data.Rain_Intensity*
+			analogue_surface_wet_value->Value.IValue = (int)(wxt536_data->Rain_Data.Rain_Intensity*
 									 Analogue_Surface_Wet_Wxt536_Scale);
 			if(analogue_surface_wet_value->Value.IValue < 0)
 				analogue_surface_wet_value->Value.IValue = 0;
@@ -1009,7 +4812,7 @@ static void Wxt536_Analogue_Surface_Wet_Set(struct timespec current_time,
 			Qli50_Wxt536_Log_Format("Wxt536","qli50_wxt536_wxt536.c",LOG_VERBOSITY_VERY_VERBOSE,
 						"Wxt536_Analogue_Surface_Wet_Set:"
 						"Using Wxt536 Piezo rain sensor with rain intensity %.3f mm/h giving value %d %%.",
-						Wxt536_Data.Rain_Data.Rain_Intensity,
+						wxt536_data->Rain_Data.Rain_Intensity,
 						analogue_surface_wet_value->Value.IValue);
 #endif /* LOGGING */
 		}
@@ -58,7 +58,7 @@ extern void Qli50_Wxt536_Log_Filter_Level_Set(int level);
 extern int Qli50_Wxt536_Log_Filter_Level_Absolute(char *class,char *source,int level,char *string);
 
 /* external variables */
-extern int Qli50_Wxt536_Error_Number;
-extern char Qli50_Wxt536_Error_String[];
+extern __thread int Qli50_Wxt536_Error_Number;
+extern __thread char Qli50_Wxt536_Error_String[];
 
 #endif
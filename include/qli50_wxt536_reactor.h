@@ -0,0 +1,8 @@
+/* qli50_wxt536_reactor.h
+ */
+#ifndef QLI50_WXT536_REACTOR_H
+#define QLI50_WXT536_REACTOR_H
+
+extern int Qli50_Wxt536_Reactor_Run(void);
+
+#endif
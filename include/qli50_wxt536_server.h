@@ -4,6 +4,7 @@
 #define QLI50_WXT536_SERVER_H
 
 extern int Qli50_Wxt536_Server_Initialise(void);
-extern int Qli50_Wxt536_Server_Start(void);
+extern int Qli50_Wxt536_Server_Fd_Get(void);
+extern int Qli50_Wxt536_Server_Read(void);
 
 #endif
@@ -5,9 +5,24 @@
 
 #include "wms_qli50_command.h" /* for declaration of Wms_Qli50_Data_Struct */
 
+/**
+ * Typedef for a function pointer to be invoked with the reply to a queued engineering command, 
+ * or with NULL if no reply was received.
+ */
+typedef void (*Qli50_Wxt536_Wxt536_Reply_Callback_T)(char *reply_string);
+
 extern int Qli50_Wxt536_Wxt536_Initialise(void);
+extern int Qli50_Wxt536_Wxt536_Startup_Fd_Get(void);
+extern int Qli50_Wxt536_Wxt536_Startup_Finish(void);
+extern int Qli50_Wxt536_Wxt536_Startup_Running_Get(void);
+extern int Qli50_Wxt536_Wxt536_Fd_Get(void);
+extern int Qli50_Wxt536_Wxt536_Read(void);
+extern int Qli50_Wxt536_Wxt536_Timer(int *timeout_ms);
 extern int Qli50_Wxt536_Wxt536_Close(void);
-extern int Qli50_Wxt536_Wxt536_Read_Sensors(char qli_id,char seq_id);
+extern int Qli50_Wxt536_Wxt536_Reload(void);
 extern int Qli50_Wxt536_Wxt536_Send_Results(char qli_id,char seq_id,struct Wms_Qli50_Data_Struct *data);
+extern unsigned int Qli50_Wxt536_Wxt536_Send_Results_Generation_Get(char qli_id);
+extern int Qli50_Wxt536_Wxt536_Engineering_Command_Queue(char *command_string,
+							 Qli50_Wxt536_Wxt536_Reply_Callback_T reply_callback);
 
 #endif
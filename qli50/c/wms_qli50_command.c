@@ -55,7 +55,7 @@ static int Parse_Reply_Data_Value(char *class,char *source,char *ch_ptr,char *na
  *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
  * @see #TERMINATOR_CR
  * @see #TERMINATOR_CRLF
- * @see wms_qli50_connection.html#Wms_Qli50_Serial_Handle
+ * @see wms_qli50_connection.html#Wms_Qli50_Connection_Handle_Get
  * @see wms_qli50_general.html#Wms_Qli50_Log
  * @see wms_qli50_general.html#Wms_Qli50_Log_Format
  * @see wms_qli50_general.html#Wms_Qli50_Error_Number
@@ -92,7 +92,7 @@ int Wms_Qli50_Command(char *class,char *source,char *command_string,
 	Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Qli50_Command(%s): Writing '%s' to serial handle.",
 			     command_string,message);
 #endif /* LOGGING */
-	if(!Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,message,strlen(message)))
+	if(!Wms_Serial_Write(class,source,Wms_Qli50_Connection_Handle_Get(),message,strlen(message)))
 	{
 		Wms_Qli50_Error_Number = 102;
 		sprintf(Wms_Qli50_Error_String,"Wms_Qli50_Command:Failed to write command string '%s'.",
@@ -108,7 +108,8 @@ int Wms_Qli50_Command(char *class,char *source,char *command_string,
 			sprintf(Wms_Qli50_Error_String,"Wms_Qli50_Command:reply terminator string is NULL.");
 			return FALSE;
 		}
-		if(!Wms_Serial_Read_Line(class,source,Wms_Qli50_Serial_Handle,reply_terminator,message,255,&bytes_read))
+		if(!Wms_Serial_Read_Line(class,source,Wms_Qli50_Connection_Handle_Get(),reply_terminator,message,255,
+					 WMS_SERIAL_READ_TIMEOUT_DEFAULT,&bytes_read))
 		{
 			Wms_Qli50_Error_Number = 103;
 			sprintf(Wms_Qli50_Error_String,"Wms_Qli50_Command:Failed to read reply line.");
@@ -308,7 +309,7 @@ int Wms_Qli50_Command_Par(char *class,char *source,char *reply_string,int reply_
 	
 	strcpy(command_string,"PAR");
 	strcat(command_string,TERMINATOR_CR);
-	if(!Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,command_string,strlen(command_string)))
+	if(!Wms_Serial_Write(class,source,Wms_Qli50_Connection_Handle_Get(),command_string,strlen(command_string)))
 	{
 		Wms_Qli50_Log_Fix_Control_Chars(command_string,fixed_command_string);
 		Wms_Qli50_Error_Number = 112;
@@ -325,8 +326,8 @@ int Wms_Qli50_Command_Par(char *class,char *source,char *reply_string,int reply_
 	done = FALSE;
 	while(done == FALSE)
 	{
-		retval = Wms_Serial_Read_Line(class,source,Wms_Qli50_Serial_Handle,TERMINATOR_CR,message,255,
-					      &bytes_read);
+		retval = Wms_Serial_Read_Line(class,source,Wms_Qli50_Connection_Handle_Get(),TERMINATOR_CR,message,255,
+					      WMS_SERIAL_READ_TIMEOUT_DEFAULT,&bytes_read);
 		message[bytes_read] = '\0';
 		if(reply_string != NULL)
 		{
@@ -392,7 +393,7 @@ int Wms_Qli50_Command_Sta(char *class,char *source,char *reply_string,int reply_
 
 	strcpy(command_string,"STA");
 	strcat(command_string,TERMINATOR_CR);
-	if(!Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,command_string,strlen(command_string)))
+	if(!Wms_Serial_Write(class,source,Wms_Qli50_Connection_Handle_Get(),command_string,strlen(command_string)))
 	{
 		Wms_Qli50_Log_Fix_Control_Chars(command_string,fixed_command_string);
 		Wms_Qli50_Error_Number = 114;
@@ -409,8 +410,8 @@ int Wms_Qli50_Command_Sta(char *class,char *source,char *reply_string,int reply_
 	done = FALSE;
 	while(done == FALSE)
 	{
-		retval = Wms_Serial_Read_Line(class,source,Wms_Qli50_Serial_Handle,TERMINATOR_CR,message,255,
-					      &bytes_read);
+		retval = Wms_Serial_Read_Line(class,source,Wms_Qli50_Connection_Handle_Get(),TERMINATOR_CR,message,255,
+					      WMS_SERIAL_READ_TIMEOUT_DEFAULT,&bytes_read);
 		message[bytes_read] = '\0';
 		if(reply_string != NULL)
 		{
@@ -29,10 +29,18 @@
 #include "wms_qli50_general.h"
 #include "wms_qli50_connection.h"
 
+/* hash defines */
+/**
+ * The read timeout the connection is opened with, if Wms_Qli50_Connection_Read_Timeout_Set has not been used to set
+ * the serial handle's read timeout, in milliseconds.
+ */
+#define DEFAULT_READ_TIMEOUT (10000)
+
 
 /* external variables */
 /**
- * The handle we use (via the Wms Serial library) to open and close the serial port connection.
+ * The default handle we use (via the Wms Serial library) to open and close the serial port connection.
+ * @see #Connection_Handle
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Handle_T
  */
 Wms_Serial_Handle_T Wms_Qli50_Serial_Handle;
@@ -42,6 +50,15 @@ Wms_Serial_Handle_T Wms_Qli50_Serial_Handle;
  * Revision Control System identifier.
  */
 static char rcsid[] = "$Id$";
+/**
+ * The serial handle the calling thread's Qli50 library routines use. This is thread local, and defaults to
+ * Wms_Qli50_Serial_Handle. A thread can use another serial device by selecting it's own handle with
+ * Wms_Qli50_Connection_Handle_Set before opening the connection.
+ * @see #Wms_Qli50_Serial_Handle
+ * @see #Wms_Qli50_Connection_Handle_Set
+ * @see #Wms_Qli50_Connection_Handle_Get
+ */
+static __thread Wms_Serial_Handle_T *Connection_Handle = &Wms_Qli50_Serial_Handle;
 
 /* external functions */
 /**
@@ -51,7 +68,7 @@ static char rcsid[] = "$Id$";
  * @param source The source parameter for logging.
  * @param device_name The device filename (i.e. /dev/ttyS0) that the Qli50 is connected to.
  * @return We return TRUE if the connection is opened successfully, FALSE otherwise.
- * @see #Wms_Qli50_Serial_Handle
+ * @see #Connection_Handle
  * @see wms_wxt536_general.html#Wms_Qli50_Log
  * @see wms_wxt536_general.html#Wms_Qli50_Log_Format
  * @see ../../serial/cdocs/wms_serial_serial.html#WMS_SERIAL_DEVICE_NAME_STRING_LENGTH
@@ -60,6 +77,9 @@ static char rcsid[] = "$Id$";
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Input_Flags_Set
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Output_Flags_Set
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Control_Flags_Set
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Local_Flags_Set
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Timeout_Set
+ * @see #DEFAULT_READ_TIMEOUT
  */
 int Wms_Qli50_Connection_Open(char *class,char *source,char *device_name)
 {
@@ -80,37 +100,53 @@ int Wms_Qli50_Connection_Open(char *class,char *source,char *device_name)
 			strlen(device_name),WMS_SERIAL_DEVICE_NAME_STRING_LENGTH);
 		return FALSE;
 	}
-	strcpy(Wms_Qli50_Serial_Handle.Device_Name,device_name);
+	strcpy(Connection_Handle->Device_Name,device_name);
 	/* set baud rate to B1200 */
-	if(!Wms_Serial_Baud_Rate_Set(B1200))
+	if(!Wms_Serial_Baud_Rate_Set(Connection_Handle,B1200))
 	{
 		Wms_Qli50_Error_Number = 3;
 		sprintf(Wms_Qli50_Error_String,"Wms_Qli50_Connection_Open:Failed to configure baud rate to B1200.");
 		return FALSE;
 	}
 	/* Configure input flags to ignore parity bits */
-	if(!Wms_Serial_Input_Flags_Set(IGNPAR))
+	if(!Wms_Serial_Input_Flags_Set(Connection_Handle,IGNPAR))
 	{
 		Wms_Qli50_Error_Number = 4;
 		sprintf(Wms_Qli50_Error_String,
 			"Wms_Qli50_Connection_Open:Failed to configure input flags to IGNPAR.");
 		return FALSE;
 	}
-	if(!Wms_Serial_Output_Flags_Set(0))
+	if(!Wms_Serial_Output_Flags_Set(Connection_Handle,0))
 	{
 		Wms_Qli50_Error_Number = 5;
 		sprintf(Wms_Qli50_Error_String,
 			"Wms_Qli50_Connection_Open:Failed to configure output flags to 0.");
 		return FALSE;
 	}
-	if(!Wms_Serial_Control_Flags_Set(CS7|PARENB|CLOCAL|CREAD))
+	if(!Wms_Serial_Control_Flags_Set(Connection_Handle,CS7|PARENB|CLOCAL|CREAD))
 	{
 		Wms_Qli50_Error_Number = 6;
 		sprintf(Wms_Qli50_Error_String,
 			"Wms_Qli50_Connection_Open:Failed to configure control flags to CS8|CLOCAL|CREAD (8N1).");
 		return FALSE;
 	}
-	if(!Wms_Serial_Open(class,source,&Wms_Qli50_Serial_Handle))
+	if(!Wms_Serial_Local_Flags_Set(Connection_Handle,0))
+	{
+		Wms_Qli50_Error_Number = 11;
+		sprintf(Wms_Qli50_Error_String,
+			"Wms_Qli50_Connection_Open:Failed to configure local flags to 0.");
+		return FALSE;
+	}
+	/* a serial handle's read timeout is zero until it is set */
+	if((Connection_Handle->Read_Timeout < 1)&&
+	   (!Wms_Serial_Read_Timeout_Set(Connection_Handle,DEFAULT_READ_TIMEOUT)))
+	{
+		Wms_Qli50_Error_Number = 9;
+		sprintf(Wms_Qli50_Error_String,
+			"Wms_Qli50_Connection_Open:Failed to configure read timeout to %d ms.",DEFAULT_READ_TIMEOUT);
+		return FALSE;
+	}
+	if(!Wms_Serial_Open(class,source,Connection_Handle))
 	{
 		Wms_Qli50_Error_Number = 7;
 		sprintf(Wms_Qli50_Error_String,
@@ -128,7 +164,7 @@ int Wms_Qli50_Connection_Open(char *class,char *source,char *device_name)
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
  * @return We return TRUE if the connection is opened successfully, FALSE otherwise.
- * @see #Wms_Qli50_Serial_Handle
+ * @see #Connection_Handle
  * @see wms_wxt536_general.html#Wms_Qli50_Log
  * @see wms_wxt536_general.html#Wms_Qli50_Log_Format
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Close
@@ -138,7 +174,7 @@ int Wms_Qli50_Connection_Close(char *class,char *source)
 #if LOGGING > 0
 	Wms_Qli50_Log(class,source,LOG_VERBOSITY_INTERMEDIATE,"Wms_Qli50_Connection_Close:Started.");
 #endif /* LOGGING */
-	if(!Wms_Serial_Close(class,source,&Wms_Qli50_Serial_Handle))
+	if(!Wms_Serial_Close(class,source,Connection_Handle))
 	{
 		Wms_Qli50_Error_Number = 8;
 		sprintf(Wms_Qli50_Error_String,
@@ -150,3 +186,51 @@ int Wms_Qli50_Connection_Close(char *class,char *source)
 #endif /* LOGGING */
 	return TRUE;
 }
+
+/**
+ * Routine to set how long reads from the Qli50 wait for a reply, in milliseconds. This sets the read timeout of the
+ * calling thread's serial handle (Connection_Handle), so it is shared by every thread using that handle, and is kept
+ * when the connection is closed and opened again.
+ * @param timeout_ms The read timeout in milliseconds, which must be positive.
+ * @return We return TRUE if the timeout was set successfully, FALSE otherwise.
+ * @see #Connection_Handle
+ * @see wms_qli50_general.html#Wms_Qli50_Error_Number
+ * @see wms_qli50_general.html#Wms_Qli50_Error_String
+ */
+int Wms_Qli50_Connection_Read_Timeout_Set(int timeout_ms)
+{
+	if(timeout_ms < 1)
+	{
+		Wms_Qli50_Error_Number = 10;
+		sprintf(Wms_Qli50_Error_String,"Wms_Qli50_Connection_Read_Timeout_Set:Illegal timeout %d ms.",timeout_ms);
+		return FALSE;
+	}
+	Connection_Handle->Read_Timeout = timeout_ms;
+	return TRUE;
+}
+
+/**
+ * Routine to select the serial handle the calling thread's Qli50 library routines use. This allows several threads to
+ * each use a different serial device at once. The handle should be selected before the connection is opened.
+ * @param handle The address of the serial handle to use, or NULL to use the default handle, 
+ *        Wms_Qli50_Serial_Handle.
+ * @see #Connection_Handle
+ * @see #Wms_Qli50_Serial_Handle
+ */
+void Wms_Qli50_Connection_Handle_Set(Wms_Serial_Handle_T *handle)
+{
+	if(handle == NULL)
+		Connection_Handle = &Wms_Qli50_Serial_Handle;
+	else
+		Connection_Handle = handle;
+}
+
+/**
+ * Routine to get the serial handle the calling thread's Qli50 library routines use.
+ * @return The address of the serial handle.
+ * @see #Connection_Handle
+ */
+Wms_Serial_Handle_T *Wms_Qli50_Connection_Handle_Get(void)
+{
+	return Connection_Handle;
+}
@@ -61,14 +61,14 @@ struct General_Struct
 
 /* external variables */
 /**
- * The error number.
+ * The error number. This is thread local, so each thread reports it's own errors.
  */
-int Wms_Qli50_Error_Number = 0;
+__thread int Wms_Qli50_Error_Number = 0;
 /**
- * The error string.
+ * The error string. This is thread local, so each thread reports it's own errors.
  * @see #WMS_QLI50_ERROR_LENGTH
  */
-char Wms_Qli50_Error_String[WMS_QLI50_ERROR_LENGTH];
+__thread char Wms_Qli50_Error_String[WMS_QLI50_ERROR_LENGTH];
 
 /* internal variables */
 /**
@@ -159,10 +159,11 @@ void Wms_Qli50_Get_Current_Time_String(char *time_string,int string_length)
 {
 	time_t current_time;
 	struct tm *utc_time = NULL;
+	struct tm utc_time_buffer;
 
 	if(time(&current_time) > -1)
 	{
-		utc_time = gmtime(&current_time);
+		utc_time = gmtime_r(&current_time,&utc_time_buffer);
 		strftime(time_string,string_length,"%d/%m/%Y %H:%M:%S",utc_time);
 	}
 	else
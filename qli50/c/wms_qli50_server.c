@@ -17,6 +17,7 @@
  * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
  */
 #define _POSIX_C_SOURCE 199309L
+#include <ctype.h>
 #include <errno.h>   /* Error number definitions */
 #include <stdio.h>
 #include <stdlib.h>
@@ -29,22 +30,80 @@
 #include "wms_qli50_general.h"
 #include "wms_qli50_server.h"
 
+/* defines */
+/**
+ * The maximum length of a command token registered with the server, including the NULL terminator.
+ */
+#define SERVER_COMMAND_TOKEN_LENGTH  (16)
+/**
+ * The maximum number of commands that can be registered with the server.
+ */
+#define SERVER_COMMAND_COUNT         (32)
+/**
+ * The length of the buffer used to format a Send Results reply.
+ */
+#define SERVER_SEND_RESULT_LENGTH    (256)
+
 /* internal data types */
+/**
+ * Data structure holding one command registered with the server.
+ * <dl>
+ * <dt>Token</dt> <dd>The leading token identifying the command, either a single control character or a word.</dd>
+ * <dt>Token_Length</dt> <dd>The length of Token.</dd>
+ * <dt>Handler</dt> <dd>The function invoked when the command is received.</dd>
+ * <dt>Next</dt> <dd>The index in the command list of the next command whose token starts with the same byte, 
+ *     or -1 if there are no more.</dd>
+ * </dl>
+ * @see #SERVER_COMMAND_TOKEN_LENGTH
+ */
+struct Server_Command_Struct
+{
+	char Token[SERVER_COMMAND_TOKEN_LENGTH];
+	int Token_Length;
+	Wms_Qli50_Server_Command_Handler_T Handler;
+	int Next;
+};
+
 /**
  * Data structure holding local data for the server module.
  * <dl>
  * <dt>Read_Sensor_Callback</dt> <dd>The callback the server invokes when it receives a 'Read Sensor' request.</dd>
  * <dt>Send_Result_Callback</dt> <dd>The callback the server invokes when it receives a 'Send Result' request.</dd>
+ * <dt>Send_Result_Generation_Callback</dt> <dd>The callback the server invokes when it receives a 'Send Result' 
+ *     request, to find out whether the Send_Result_Cache is still valid.</dd>
  * <dt>Par_Callback</dt> <dd>The callback the server invokes when it receives a 'PAR' request.</dd>
  * <dt>Sta_Callback</dt> <dd>The callback the server invokes when it receives a 'STA' request.</dd>
+ * <dt>Command_List</dt> <dd>The list of commands registered with the server.</dd>
+ * <dt>Command_Count</dt> <dd>The number of commands in Command_List.</dd>
+ * <dt>Command_Index</dt> <dd>For each possible first byte of a command, one more than the index in Command_List
+ *     of the first command starting with that byte, or 0 if no command starts with that byte.</dd>
+ * <dt>Default_Commands_Registered</dt> <dd>A boolean, TRUE once the built in commands have been registered.</dd>
+ * <dt>Send_Result_Cache</dt> <dd>The last formatted Send Results reply. Only the seq_id header character
+ *     differs between replies to the same qli_id and data generation.</dd>
+ * <dt>Send_Result_Cache_Valid</dt> <dd>A boolean, TRUE if Send_Result_Cache contains a reply.</dd>
+ * <dt>Send_Result_Cache_Generation</dt> <dd>The data generation (returned by Send_Result_Generation_Callback) 
+ *     the reply in Send_Result_Cache was formatted from.</dd>
+ * <dt>Send_Result_Cache_Qli_Id</dt> <dd>The qli_id the reply in Send_Result_Cache was formatted for. 
+ *     The Send Result callback can return different data for each qli_id.</dd>
  * </dl>
+ * @see #SERVER_COMMAND_COUNT
+ * @see #Server_Command_Struct
  */
 struct Server_Struct
 {
 	Read_Sensor_Callback_T Read_Sensor_Callback;
 	Send_Result_Callback_T Send_Result_Callback;
+	Send_Result_Generation_Callback_T Send_Result_Generation_Callback;
 	Par_Callback_T Par_Callback;
 	Sta_Callback_T Sta_Callback;
+	struct Server_Command_Struct Command_List[SERVER_COMMAND_COUNT];
+	int Command_Count;
+	int Command_Index[256];
+	int Default_Commands_Registered;
+	char Send_Result_Cache[SERVER_SEND_RESULT_LENGTH];
+	int Send_Result_Cache_Valid;
+	unsigned int Send_Result_Cache_Generation;
+	char Send_Result_Cache_Qli_Id;
 };
 
 /* internal data */
@@ -59,6 +118,18 @@ static char rcsid[] = "$Id$";
 static struct Server_Struct Server_Data;
 
 /* internal functions */
+static int Server_Default_Commands_Register(void);
+static int Server_Command_Register(char *command_token,Wms_Qli50_Server_Command_Handler_T handler);
+static Wms_Qli50_Server_Command_Handler_T Server_Command_Find(char *command_string);
+static void Server_Reply(char *class,char *source,char *reply_message_string);
+static int Server_Command_Close(char *class,char *source,char *command_string);
+static int Server_Command_Echo(char *class,char *source,char *command_string);
+static int Server_Command_Open(char *class,char *source,char *command_string);
+static int Server_Command_Par(char *class,char *source,char *command_string);
+static int Server_Command_Reset(char *class,char *source,char *command_string);
+static int Server_Command_Sta(char *class,char *source,char *command_string);
+static int Server_Command_Read_Sensors(char *class,char *source,char *command_string);
+static int Server_Command_Send_Results(char *class,char *source,char *command_string);
 static int Server_Create_Send_Result_String(char qli_id,char seq_id,struct Wms_Qli50_Data_Struct data,
 					    char *message_string,int message_string_length);
 static int Server_Add_Result_To_String(char *name,struct Wms_Qli50_Data_Value data_value,int add_comma,
@@ -94,6 +165,27 @@ int Wms_Qli50_Server_Set_Read_Sensor_Callback(char *class,char *source,Read_Sens
 int Wms_Qli50_Server_Set_Send_Result_Callback(char *class,char *source,Send_Result_Callback_T callback)
 {
 	Server_Data.Send_Result_Callback = callback;
+	Server_Data.Send_Result_Cache_Valid = FALSE;
+	return TRUE;
+}
+
+/**
+ * Routine to set the callback invoked by the server when it receives a 'Send Result' request, to get the generation
+ * of the data the Send Result callback would return. When this callback is set, the server caches the formatted 
+ * reply, and only invokes the Send Result callback and re-formats the reply when the generation 
+ * (or the requested qli_id) changes. Otherwise, only the seq_id in the cached reply is updated for each request.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param callback A function pointer of type Send_Result_Generation_Callback_T, or NULL to format every reply.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #Server_Data
+ */
+int Wms_Qli50_Server_Set_Send_Result_Generation_Callback(char *class,char *source,
+							 Send_Result_Generation_Callback_T callback)
+{
+	Server_Data.Send_Result_Generation_Callback = callback;
+	Server_Data.Send_Result_Cache_Valid = FALSE;
 	return TRUE;
 }
 
@@ -134,7 +226,7 @@ int Wms_Qli50_Server_Set_Par_Callback(char *class,char *source,Par_Callback_T ca
  * @param device_name A string representing the device name of the serial device to open e.g. '/dev/ttyS0'.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
- * @see wms_wxt536_connection.html#Wms_Qli50_Serial_Handle
+ * @see wms_qli50_connection.html#Wms_Qli50_Connection_Handle_Get
  * @see wms_wxt536_connection.html#Wms_Qli50_Connection_Open
  * @see wms_wxt536_general.html#Wms_Qli50_Log
  * @see wms_wxt536_general.html#Wms_Qli50_Log_Format
@@ -157,15 +249,14 @@ int Wms_Qli50_Server_Start(char *class,char *source,char *device_name)
 
 /**
  * Routine to sit on the open serial port, reading lines of data (commands) terminatred by the terminator,
- * and based on the command returning a fake reply, or invoking a callback, or printing an error to stderr.
+ * and processing each one with Wms_Qli50_Server_Process_Command.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
- * @see #Server_Create_Send_Result_String
+ * @see #Wms_Qli50_Server_Process_Command
  * @see wms_wxt536_command.html#TERMINATOR_CR
- * @see wms_wxt536_command.html#Wms_Qli50_Data_Struct
- * @see wms_wxt536_connection.html#Wms_Qli50_Serial_Handle
+ * @see wms_qli50_connection.html#Wms_Qli50_Connection_Handle_Get
  * @see wms_wxt536_general.html#Wms_Qli50_Log
  * @see wms_wxt536_general.html#Wms_Qli50_Log_Format
  * @see wms_wxt536_general.html#Wms_Qli50_Error_Number
@@ -177,11 +268,7 @@ int Wms_Qli50_Server_Start(char *class,char *source,char *device_name)
  */
 int Wms_Qli50_Server_Loop(char *class,char *source)
 {
-	struct Wms_Qli50_Data_Struct data;
 	char command_message_string[256];
-	char reply_message_string[256];
-	char parameter_string[32];
-	char parameter_char,qli_id,seq_id;
 	int done,retval,bytes_read;
 
 #if LOGGING > 1
@@ -190,259 +277,606 @@ int Wms_Qli50_Server_Loop(char *class,char *source)
 	done = FALSE;
 	while(done == FALSE)
 	{
-		retval = Wms_Serial_Read_Line(class,source,Wms_Qli50_Serial_Handle,TERMINATOR_CR,
-					      command_message_string,255,&bytes_read);
+		retval = Wms_Serial_Read_Line(class,source,Wms_Qli50_Connection_Handle_Get(),TERMINATOR_CR,
+					      command_message_string,255,WMS_SERIAL_READ_TIMEOUT_DEFAULT,
+					      &bytes_read);
 		if(retval)
 		{
-#if LOGGING > 9
-			Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Read command message string '%s'.",
-					     command_message_string);
-#endif /* LOGGING */
-			if(strstr(command_message_string,"CLOSE") != NULL)
-			{
-#if LOGGING > 9
-				Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Detected 'CLOSE' command.");
-#endif /* LOGGING */
-				sprintf(reply_message_string,"LINE CLOSED%s",TERMINATOR_CR);
-#if LOGGING > 9
-				Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Reply String is '%s'.",
-						     reply_message_string);
-#endif /* LOGGING */
-				retval = Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,reply_message_string,
-							  strlen(reply_message_string));
-				if(retval == FALSE)
-				{
-					Wms_Serial_Error();
-				}
-			}/* end if command was "CLOSE" */
-			else if(strstr(command_message_string,"ECHO") != NULL)
-			{
-#if LOGGING > 9
-				Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Detected 'ECHO' command.");
+			Wms_Qli50_Server_Process_Command(class,source,command_message_string);
+		}/* end if command was read successfully */
+		else
+		{
+			/* don't print out read-line timeouts - this just means nothing was received within the 
+			** read timeout */
+			if(Wms_Serial_Error_Number != 10)
+				Wms_Serial_Error();
+		}
+	}/* end while */
+#if LOGGING > 1
+	Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,"Wms_Qli50_Server_Loop: Finished.");
 #endif /* LOGGING */
-				/* parse parameter */
-				retval = sscanf(command_message_string,"ECHO %31s",parameter_string);
-				if(retval == 1)
-				{
-					/* construct reply */
-					sprintf(reply_message_string,"ECHO %s%s",parameter_string,TERMINATOR_CR);
-#if LOGGING > 9
-					Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Reply String is '%s'.",
-							     reply_message_string);
+	return TRUE;
+}
+
+/**
+ * Routine to process any commands received by the server, without waiting. This is called by event driven 
+ * callers when the server's serial link is readable. All the data available is read, and each complete command 
+ * line is processed with Wms_Qli50_Server_Process_Command. Any partial command line is kept in the serial handle's
+ * read buffer, to be completed when more data arrives.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #Wms_Qli50_Server_Process_Command
+ * @see wms_wxt536_command.html#TERMINATOR_CR
+ * @see wms_qli50_connection.html#Wms_Qli50_Connection_Handle_Get
+ * @see wms_wxt536_general.html#Wms_Qli50_Error_Number
+ * @see wms_wxt536_general.html#Wms_Qli50_Error_String
+ * @see ../../serial/cdocs/wms_serial_serial.html#WMS_SERIAL_READ_TIMEOUT_NONE
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Line
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Line_Buffered
+ */
+int Wms_Qli50_Server_Process_Input(char *class,char *source)
+{
+	char command_message_string[256];
+	int bytes_read;
+
+	do
+	{
+		if(!Wms_Serial_Read_Line(class,source,Wms_Qli50_Connection_Handle_Get(),TERMINATOR_CR,
+					 command_message_string,255,WMS_SERIAL_READ_TIMEOUT_NONE,&bytes_read))
+		{
+			Wms_Qli50_Error_Number = 210;
+			sprintf(Wms_Qli50_Error_String,"Wms_Qli50_Server_Process_Input:Failed to read command line.");
+			return FALSE;
+		}
+		if(bytes_read > 0)
+			Wms_Qli50_Server_Process_Command(class,source,command_message_string);
+	}
+	while(Wms_Serial_Read_Line_Buffered(Wms_Qli50_Connection_Handle_Get(),TERMINATOR_CR));
+	return TRUE;
+}
+
+/**
+ * Routine to register a handler for a command received by the server. Commands are identified by their leading
+ * token: either a single control character (e.g. &lt;enq&gt;), whose parameters follow it directly, or a word
+ * (e.g. "PAR"), which must be followed by whitespace or the end of the command line. Registering a token that is
+ * already registered replaces it's handler, so applications can override the built in commands as well as
+ * add new ones.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_token The leading token identifying the command, 1 to (SERVER_COMMAND_TOKEN_LENGTH-1)
+ *        characters long.
+ * @param handler A function pointer of type Wms_Qli50_Server_Command_Handler_T, invoked with the command line
+ *        (starting at the token) when the command is received.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #SERVER_COMMAND_TOKEN_LENGTH
+ * @see #Server_Default_Commands_Register
+ * @see #Server_Command_Register
+ * @see wms_wxt536_general.html#Wms_Qli50_Log_Format
+ */
+int Wms_Qli50_Server_Command_Register(char *class,char *source,char *command_token,
+				      Wms_Qli50_Server_Command_Handler_T handler)
+{
+#if LOGGING > 1
+	Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,
+			     "Wms_Qli50_Server_Command_Register: Registering command '%s'.",command_token);
 #endif /* LOGGING */
-					retval = Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,reply_message_string,
-								  strlen(reply_message_string));
-					if(retval == FALSE)
-					{
-						Wms_Serial_Error();
-					}
-				}
-				else
-				{
-					Wms_Qli50_Error_Number = 200;
-					sprintf(Wms_Qli50_Error_String,
-						"Wms_Qli50_Server_Loop:Failed to parse ECHO command '%s' (%d).",
-						command_message_string,retval);
-					Wms_Qli50_Error();
-				}
-			}/* end if command was "ECHO" */
-			else if(strstr(command_message_string,"OPEN") != NULL)
-			{
+	if(!Server_Default_Commands_Register())
+		return FALSE;
+	return Server_Command_Register(command_token,handler);
+}
+
+/**
+ * Routine to process one command line read by the server. We skip any leading whitespace (for instance the line
+ * feed of a client using CRLF terminators), and look up the handler registered for the command's leading token.
+ * The registered commands are indexed by their first byte, so finding the handler takes one table lookup and
+ * (normally) one token comparison. The handler then returns a fake reply, or invokes a callback.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_message_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE. Unknown commands, and errors parsing or replying to a command, are
+ *         reported using Wms_Qli50_Error/Wms_Serial_Error, so the server carries on serving subsequent commands.
+ * @see #Server_Default_Commands_Register
+ * @see #Server_Command_Find
+ * @see wms_wxt536_general.html#Wms_Qli50_Log_Format
+ * @see wms_wxt536_general.html#Wms_Qli50_Error
+ * @see wms_wxt536_general.html#Wms_Qli50_Error_Number
+ * @see wms_wxt536_general.html#Wms_Qli50_Error_String
+ */
+int Wms_Qli50_Server_Process_Command(char *class,char *source,char *command_message_string)
+{
+	Wms_Qli50_Server_Command_Handler_T handler = NULL;
+	char *command_string = NULL;
+
 #if LOGGING > 9
-				Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Detected 'OPEN' command.");
+	Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Process_Command: Read command message string '%s'.",
+			     command_message_string);
 #endif /* LOGGING */
-				/* parse parameter */
-				retval = sscanf(command_message_string,"OPEN %c",&parameter_char);
-				if(retval == 1)
-				{
-					/* construct reply */
-					sprintf(reply_message_string,"%c OPENED FOR OPERATOR COMMANDS%s",parameter_char,TERMINATOR_CR);
+	if(!Server_Default_Commands_Register())
+	{
+		Wms_Qli50_Error();
+		return TRUE;
+	}
+	command_string = command_message_string;
+	while(((*command_string) != '\0')&&isspace((int)(*command_string)))
+		command_string++;
+	handler = Server_Command_Find(command_string);
+	if(handler == NULL) /* we don't know what this command is */
+	{
+		Wms_Qli50_Error_Number = 202;
+		sprintf(Wms_Qli50_Error_String,
+			"Wms_Qli50_Server_Process_Command:Failed to parse unknown command '%s'.",command_message_string);
+		Wms_Qli50_Error();
+		return TRUE;
+	}
+	if(!handler(class,source,command_string))
+		Wms_Qli50_Error();
+	return TRUE;
+}
+
+/* ==========================================
+** internal functions 
+** ========================================== */
+/**
+ * Register the server's built in command handlers, if they have not already been registered.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #Server_Data
+ * @see #Server_Command_Register
+ * @see #Server_Command_Close
+ * @see #Server_Command_Echo
+ * @see #Server_Command_Open
+ * @see #Server_Command_Par
+ * @see #Server_Command_Reset
+ * @see #Server_Command_Sta
+ * @see #Server_Command_Read_Sensors
+ * @see #Server_Command_Send_Results
+ * @see wms_wxt536_command.html#CHARACTER_SYN
+ * @see wms_wxt536_command.html#CHARACTER_ENQ
+ */
+static int Server_Default_Commands_Register(void)
+{
+	char control_token[2];
+
+	if(Server_Data.Default_Commands_Registered)
+		return TRUE;
+	Server_Data.Default_Commands_Registered = TRUE;
+	control_token[1] = '\0';
+	control_token[0] = CHARACTER_SYN;
+	if(!Server_Command_Register(control_token,Server_Command_Read_Sensors))
+		return FALSE;
+	control_token[0] = CHARACTER_ENQ;
+	if(!Server_Command_Register(control_token,Server_Command_Send_Results))
+		return FALSE;
+	if(!Server_Command_Register("CLOSE",Server_Command_Close))
+		return FALSE;
+	if(!Server_Command_Register("ECHO",Server_Command_Echo))
+		return FALSE;
+	if(!Server_Command_Register("OPEN",Server_Command_Open))
+		return FALSE;
+	if(!Server_Command_Register("PAR",Server_Command_Par))
+		return FALSE;
+	if(!Server_Command_Register("RESET",Server_Command_Reset))
+		return FALSE;
+	if(!Server_Command_Register("STA",Server_Command_Sta))
+		return FALSE;
+	return TRUE;
+}
+
+/**
+ * Add a command to the server's command table, or replace it's handler if the token is already registered.
+ * The command is linked onto the front of the chain of commands starting with the same byte.
+ * @param command_token The leading token identifying the command.
+ * @param handler The function to invoke when the command is received.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #SERVER_COMMAND_TOKEN_LENGTH
+ * @see #SERVER_COMMAND_COUNT
+ * @see #Server_Data
+ * @see #Server_Command_Struct
+ * @see wms_wxt536_general.html#Wms_Qli50_Error_Number
+ * @see wms_wxt536_general.html#Wms_Qli50_Error_String
+ */
+static int Server_Command_Register(char *command_token,Wms_Qli50_Server_Command_Handler_T handler)
+{
+	int index,first_byte;
+
+	if(command_token == NULL)
+	{
+		Wms_Qli50_Error_Number = 211;
+		sprintf(Wms_Qli50_Error_String,"Server_Command_Register:Command token was NULL.");
+		return FALSE;
+	}
+	if((strlen(command_token) < 1)||(strlen(command_token) >= SERVER_COMMAND_TOKEN_LENGTH))
+	{
+		Wms_Qli50_Error_Number = 212;
+		sprintf(Wms_Qli50_Error_String,"Server_Command_Register:Command token '%s' has illegal length %lu.",
+			command_token,strlen(command_token));
+		return FALSE;
+	}
+	if(handler == NULL)
+	{
+		Wms_Qli50_Error_Number = 213;
+		sprintf(Wms_Qli50_Error_String,"Server_Command_Register:Handler for command '%s' was NULL.",
+			command_token);
+		return FALSE;
+	}
+	first_byte = (unsigned char)(command_token[0]);
+	for(index = Server_Data.Command_Index[first_byte]-1; index >= 0; index = Server_Data.Command_List[index].Next)
+	{
+		if(strcmp(Server_Data.Command_List[index].Token,command_token) == 0)
+		{
+			Server_Data.Command_List[index].Handler = handler;
+			return TRUE;
+		}
+	}
+	if(Server_Data.Command_Count >= SERVER_COMMAND_COUNT)
+	{
+		Wms_Qli50_Error_Number = 214;
+		sprintf(Wms_Qli50_Error_String,"Server_Command_Register:Too many commands (%d) to register '%s'.",
+			Server_Data.Command_Count,command_token);
+		return FALSE;
+	}
+	index = Server_Data.Command_Count;
+	strcpy(Server_Data.Command_List[index].Token,command_token);
+	Server_Data.Command_List[index].Token_Length = strlen(command_token);
+	Server_Data.Command_List[index].Handler = handler;
+	Server_Data.Command_List[index].Next = Server_Data.Command_Index[first_byte]-1;
+	Server_Data.Command_Index[first_byte] = index+1;
+	Server_Data.Command_Count++;
+	return TRUE;
+}
+
+/**
+ * Find the handler registered for a command. We index Server_Data.Command_Index with the command's first byte,
+ * and walk the (usually single entry) chain of commands starting with that byte. A single character token
+ * matches on the first byte alone, a longer token must be followed by whitespace or the end of the command.
+ * @param command_string The command, starting at it's leading token.
+ * @return The handler registered for the command, or NULL if the command is not recognised.
+ * @see #Server_Data
+ * @see #Server_Command_Struct
+ */
+static Wms_Qli50_Server_Command_Handler_T Server_Command_Find(char *command_string)
+{
+	struct Server_Command_Struct *command = NULL;
+	int index;
+
+	for(index = Server_Data.Command_Index[(unsigned char)(command_string[0])]-1; index >= 0;
+	    index = command->Next)
+	{
+		command = &(Server_Data.Command_List[index]);
+		if(command->Token_Length == 1)
+			return command->Handler;
+		if((strncmp(command_string,command->Token,command->Token_Length) == 0)&&
+		   ((command_string[command->Token_Length] == '\0')||
+		    isspace((int)(command_string[command->Token_Length]))))
+			return command->Handler;
+	}
+	return NULL;
+}
+
+/**
+ * Write a reply to a command over the server's serial link. A failure to write is reported using
+ * Wms_Serial_Error, the server carries on serving subsequent commands.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param reply_message_string The reply to write, including any terminator.
+ * @see wms_qli50_connection.html#Wms_Qli50_Connection_Handle_Get
+ * @see wms_wxt536_general.html#Wms_Qli50_Log_Format
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Error
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Write
+ */
+static void Server_Reply(char *class,char *source,char *reply_message_string)
+{
 #if LOGGING > 9
-					Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Reply String is '%s'.",
-							     reply_message_string);
+	Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Server_Reply: Reply String is '%s'.",
+			     reply_message_string);
 #endif /* LOGGING */
-					retval = Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,reply_message_string,
-								  strlen(reply_message_string));
-					if(retval == FALSE)
-					{
-						Wms_Serial_Error();
-					}
-				}
-				else
-				{
-					Wms_Qli50_Error_Number = 201;
-					sprintf(Wms_Qli50_Error_String,
-						"Wms_Qli50_Server_Loop:Failed to parse OPEN command '%s' (%d).",
-						command_message_string,retval);
-					Wms_Qli50_Error();
-				}
-			}/* end if command was "OPEN" */
-			else if(strstr(command_message_string,"PAR") != NULL)
-			{
+	if(!Wms_Serial_Write(class,source,Wms_Qli50_Connection_Handle_Get(),reply_message_string,
+			     strlen(reply_message_string)))
+	{
+		Wms_Serial_Error();
+	}
+}
+
+/**
+ * Handler for the 'CLOSE' command. We reply "LINE CLOSED".
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE.
+ * @see #Server_Reply
+ * @see wms_wxt536_command.html#TERMINATOR_CR
+ */
+static int Server_Command_Close(char *class,char *source,char *command_string)
+{
+	char reply_message_string[256];
+
 #if LOGGING > 9
-				Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Detected 'PAR' command.");
+	Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Server_Command_Close: Detected 'CLOSE' command.");
 #endif /* LOGGING */
-				if(Server_Data.Par_Callback != NULL)
-					Server_Data.Par_Callback(reply_message_string,254);
-				else
-					strcpy(reply_message_string,"PARAMETERS");
-				strcat(reply_message_string,TERMINATOR_CR);
+	sprintf(reply_message_string,"LINE CLOSED%s",TERMINATOR_CR);
+	Server_Reply(class,source,reply_message_string);
+	return TRUE;
+}
+
+/**
+ * Handler for the 'ECHO' command. We reply with the command's parameter.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE if successful, and FALSE if the command could not be parsed
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #Server_Reply
+ * @see wms_wxt536_command.html#TERMINATOR_CR
+ */
+static int Server_Command_Echo(char *class,char *source,char *command_string)
+{
+	char reply_message_string[256];
+	char parameter_string[32];
+	int retval;
+
 #if LOGGING > 9
-				Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Reply String is '%s'.",
-						     reply_message_string);
+	Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Server_Command_Echo: Detected 'ECHO' command.");
 #endif /* LOGGING */
-				retval = Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,reply_message_string,
-							  strlen(reply_message_string));
-				if(retval == FALSE)
-				{
-					Wms_Serial_Error();
-				}
-			}/* end if command was "PAR" */
-			else if(strstr(command_message_string,"RESET") != NULL)
-			{
+	/* parse parameter */
+	retval = sscanf(command_string,"ECHO %31s",parameter_string);
+	if(retval != 1)
+	{
+		Wms_Qli50_Error_Number = 200;
+		sprintf(Wms_Qli50_Error_String,"Server_Command_Echo:Failed to parse ECHO command '%s' (%d).",
+			command_string,retval);
+		return FALSE;
+	}
+	/* construct reply */
+	sprintf(reply_message_string,"ECHO %s%s",parameter_string,TERMINATOR_CR);
+	Server_Reply(class,source,reply_message_string);
+	return TRUE;
+}
+
+/**
+ * Handler for the 'OPEN' command. We reply that the specified Qli50 is opened for operator commands.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE if successful, and FALSE if the command could not be parsed
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #Server_Reply
+ * @see wms_wxt536_command.html#TERMINATOR_CR
+ */
+static int Server_Command_Open(char *class,char *source,char *command_string)
+{
+	char reply_message_string[256];
+	char parameter_char;
+	int retval;
+
 #if LOGGING > 9
-				Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Detected 'RESET' command.");
+	Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Server_Command_Open: Detected 'OPEN' command.");
 #endif /* LOGGING */
-				sprintf(reply_message_string,"RESET COMMAND%s",TERMINATOR_CR);
+	/* parse parameter */
+	retval = sscanf(command_string,"OPEN %c",&parameter_char);
+	if(retval != 1)
+	{
+		Wms_Qli50_Error_Number = 201;
+		sprintf(Wms_Qli50_Error_String,"Server_Command_Open:Failed to parse OPEN command '%s' (%d).",
+			command_string,retval);
+		return FALSE;
+	}
+	/* construct reply */
+	sprintf(reply_message_string,"%c OPENED FOR OPERATOR COMMANDS%s",parameter_char,TERMINATOR_CR);
+	Server_Reply(class,source,reply_message_string);
+	return TRUE;
+}
+
+/**
+ * Handler for the 'PAR' command. We reply with the string returned by the PAR callback, or "PARAMETERS"
+ * if no callback is set.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE.
+ * @see #Server_Data
+ * @see #Server_Reply
+ * @see wms_wxt536_command.html#TERMINATOR_CR
+ */
+static int Server_Command_Par(char *class,char *source,char *command_string)
+{
+	char reply_message_string[256];
+
 #if LOGGING > 9
-				Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Reply String is '%s'.",
-						     reply_message_string);
+	Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Server_Command_Par: Detected 'PAR' command.");
 #endif /* LOGGING */
-				retval = Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,reply_message_string,
-							  strlen(reply_message_string));
-				if(retval == FALSE)
-				{
-					Wms_Serial_Error();
-				}
-			}/* end if command was "RESET" */
-			else if(strstr(command_message_string,"STA") != NULL)
-			{
+	if(Server_Data.Par_Callback != NULL)
+		Server_Data.Par_Callback(reply_message_string,254);
+	else
+		strcpy(reply_message_string,"PARAMETERS");
+	strcat(reply_message_string,TERMINATOR_CR);
+	Server_Reply(class,source,reply_message_string);
+	return TRUE;
+}
+
+/**
+ * Handler for the 'RESET' command. We reply "RESET COMMAND".
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE.
+ * @see #Server_Reply
+ * @see wms_wxt536_command.html#TERMINATOR_CR
+ */
+static int Server_Command_Reset(char *class,char *source,char *command_string)
+{
+	char reply_message_string[256];
+
 #if LOGGING > 9
-				Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Detected 'STA' command.");
+	Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Server_Command_Reset: Detected 'RESET' command.");
 #endif /* LOGGING */
-				if(Server_Data.Sta_Callback != NULL)
-					Server_Data.Sta_Callback(reply_message_string,254);
-				else
-					strcpy(reply_message_string,"STATUS");
-				strcat(reply_message_string,TERMINATOR_CR);
+	sprintf(reply_message_string,"RESET COMMAND%s",TERMINATOR_CR);
+	Server_Reply(class,source,reply_message_string);
+	return TRUE;
+}
+
+/**
+ * Handler for the 'STA' command. We reply with the string returned by the STA callback, or "STATUS"
+ * if no callback is set.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE.
+ * @see #Server_Data
+ * @see #Server_Reply
+ * @see wms_wxt536_command.html#TERMINATOR_CR
+ */
+static int Server_Command_Sta(char *class,char *source,char *command_string)
+{
+	char reply_message_string[256];
+
 #if LOGGING > 9
-				Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Reply String is '%s'.",
-						     reply_message_string);
+	Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Server_Command_Sta: Detected 'STA' command.");
 #endif /* LOGGING */
-				retval = Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,reply_message_string,
-							  strlen(reply_message_string));
-				if(retval == FALSE)
-				{
-					Wms_Serial_Error();
-				}
-			}/* end if command was "STA" */
-			else if(command_message_string[0] == CHARACTER_SYN) /* Read Sensors */
-			{
+	if(Server_Data.Sta_Callback != NULL)
+		Server_Data.Sta_Callback(reply_message_string,254);
+	else
+		strcpy(reply_message_string,"STATUS");
+	strcat(reply_message_string,TERMINATOR_CR);
+	Server_Reply(class,source,reply_message_string);
+	return TRUE;
+}
+
+/**
+ * Handler for the &lt;syn&gt; (Read Sensors) command. We invoke the Read Sensor callback, if one is set.
+ * There is no reply to a Read Sensors command.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE if successful, and FALSE if the command could not be parsed
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #Server_Data
+ */
+static int Server_Command_Read_Sensors(char *class,char *source,char *command_string)
+{
+	char parameter_char,qli_id,seq_id;
+	int retval;
+
 #if LOGGING > 9
-				Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Detected 'Read Sensors' command.");
+	Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Server_Command_Read_Sensors: Detected 'Read Sensors' command.");
 #endif /* LOGGING */
-				retval = sscanf(command_message_string,"%c%c%c",&parameter_char,&qli_id,&seq_id);
-				if(retval != 3)
-				{
-					Wms_Qli50_Error_Number = 203;
-					sprintf(Wms_Qli50_Error_String,
-						"Wms_Qli50_Server_Loop:Failed to parse Read Sensors command '%s' (%d).",
-						command_message_string,retval);
-					Wms_Qli50_Error();
-				}
-				if(Server_Data.Read_Sensor_Callback != NULL)
-					Server_Data.Read_Sensor_Callback(qli_id,seq_id);
-				/* there is no reply to a <syn> / read sensors command */
-			}/* end if command was <syn> / read sensors */
-			else if(command_message_string[0] == CHARACTER_ENQ) /* Send Results */
-			{
+	retval = sscanf(command_string,"%c%c%c",&parameter_char,&qli_id,&seq_id);
+	if(retval != 3)
+	{
+		Wms_Qli50_Error_Number = 203;
+		sprintf(Wms_Qli50_Error_String,
+			"Server_Command_Read_Sensors:Failed to parse Read Sensors command '%s' (%d).",
+			command_string,retval);
+		return FALSE;
+	}
+	if(Server_Data.Read_Sensor_Callback != NULL)
+		Server_Data.Read_Sensor_Callback(qli_id,seq_id);
+	/* there is no reply to a <syn> / read sensors command */
+	return TRUE;
+}
+
+/**
+ * Handler for the &lt;enq&gt; (Send Results) command. If the Send Result Generation callback is set, and
+ * returns the same generation (for the same qli_id) as the cached reply was formatted from, we just update 
+ * the seq_id in the cached reply and send it. Otherwise we get the data to return from the Send Result callback,
+ * (or some valid but bad weather data if no callback is set), format it using Server_Create_Send_Result_String,
+ * cache it (if the Send Result Generation callback is set), and send it.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param command_string The command line read from the server's serial link.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Qli50_Error_Number and Wms_Qli50_Error_String are filled in on failure).
+ * @see #Server_Data
+ * @see #Server_Reply
+ * @see #SERVER_SEND_RESULT_LENGTH
+ * @see #Server_Create_Send_Result_String
+ * @see wms_wxt536_command.html#Wms_Qli50_Data_Struct
+ */
+static int Server_Command_Send_Results(char *class,char *source,char *command_string)
+{
+	struct Wms_Qli50_Data_Struct data;
+	char parameter_char,qli_id,seq_id;
+	unsigned int generation = 0;
+	int retval;
+
 #if LOGGING > 9
-				Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Detected 'Send Results' command.");
+	Wms_Qli50_Log(class,source,LOG_VERBOSITY_VERBOSE,"Server_Command_Send_Results: Detected 'Send Results' command.");
 #endif /* LOGGING */
-				retval = sscanf(command_message_string,"%c%c%c",&parameter_char,&qli_id,&seq_id);
-				if(retval != 3)
-				{
-					Wms_Qli50_Error_Number = 204;
-					sprintf(Wms_Qli50_Error_String,
-						"Wms_Qli50_Server_Loop:Failed to parse Send Results command '%s' (%d).",
-						command_message_string,retval);
-					Wms_Qli50_Error();
-				}
-				if(Server_Data.Send_Result_Callback != NULL)
-					Server_Data.Send_Result_Callback(qli_id,seq_id,&data);
-				else
-				{
-					/* create some data to send back - valid but _bad_ weather in case the
-					** Send_Result_Callback is not set correctly in a 'real' situation. */
-					data.Temperature.Type = DATA_TYPE_DOUBLE;
-					data.Temperature.Value.DValue = 0.0;
-					data.Humidity.Type = DATA_TYPE_DOUBLE;
-					data.Humidity.Value.DValue = 99.0;
-					data.Dew_Point.Type = DATA_TYPE_DOUBLE;
-					data.Dew_Point.Value.DValue = 1.0;
-					data.Wind_Speed.Type = DATA_TYPE_DOUBLE;
-					data.Wind_Speed.Value.DValue = 20.0;
-					data.Wind_Direction.Type = DATA_TYPE_INT;
-					data.Wind_Direction.Value.IValue = 359;
-					data.Air_Pressure.Type = DATA_TYPE_DOUBLE;
-					data.Air_Pressure.Value.DValue = 768.0;
-					data.Digital_Surface_Wet.Type = DATA_TYPE_INT;
-					data.Digital_Surface_Wet.Value.IValue = 4;
-					data.Analogue_Surface_Wet.Type = DATA_TYPE_INT;
-					data.Analogue_Surface_Wet.Value.IValue = 98;
-					data.Light.Type = DATA_TYPE_INT;
-					data.Light.Value.IValue = 1000;
-					data.Internal_Voltage.Type = DATA_TYPE_DOUBLE;
-					data.Internal_Voltage.Value.DValue = 0.0;
-					data.Internal_Current.Type = DATA_TYPE_DOUBLE;
-					data.Internal_Current.Value.DValue = 0.0;
-					data.Internal_Temperature.Type = DATA_TYPE_DOUBLE;
-					data.Internal_Temperature.Value.DValue = 0.0;
-					data.Reference_Temperature.Type = DATA_TYPE_DOUBLE;
-					data.Reference_Temperature.Value.DValue = 0.0;
-				}
-				if(Server_Create_Send_Result_String(qli_id,seq_id,data,reply_message_string,254))
-				{
+	retval = sscanf(command_string,"%c%c%c",&parameter_char,&qli_id,&seq_id);
+	if(retval != 3)
+	{
+		Wms_Qli50_Error_Number = 204;
+		sprintf(Wms_Qli50_Error_String,
+			"Server_Command_Send_Results:Failed to parse Send Results command '%s' (%d).",
+			command_string,retval);
+		return FALSE;
+	}
+	if(Server_Data.Send_Result_Generation_Callback != NULL)
+	{
+		generation = Server_Data.Send_Result_Generation_Callback(qli_id);
+		if(Server_Data.Send_Result_Cache_Valid&&(generation == Server_Data.Send_Result_Cache_Generation)&&
+		   (qli_id == Server_Data.Send_Result_Cache_Qli_Id))
+		{
 #if LOGGING > 9
-					Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Qli50_Server_Loop: Reply String is '%s'.",
-							     reply_message_string);
+			Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,
+					     "Server_Command_Send_Results: Using cached reply for generation %u.",generation);
 #endif /* LOGGING */
-					retval = Wms_Serial_Write(class,source,Wms_Qli50_Serial_Handle,reply_message_string,
-								  strlen(reply_message_string));
-					if(retval == FALSE)
-					{
-						Wms_Serial_Error();
-					}
-				}
-				else
-				{
-					Wms_Qli50_Error();
-				}
-			}/* end if command was <enq> / send results */
-			else /* we don't know what this command is */
-			{
-				Wms_Qli50_Error_Number = 202;
-				sprintf(Wms_Qli50_Error_String,
-					"Wms_Qli50_Server_Loop:Failed to parse unknown command '%s'.",command_message_string);
-				Wms_Qli50_Error();
-			}
-		}/* end if command was read successfully */
-		else
-		{
-			/* don't print out read-line timeouts - this just means nothing was received for 10 seconds */
-			if(Wms_Serial_Error_Number != 10)
-				Wms_Serial_Error();
+			/* <soh><qli_id><seq_id><stx>... see Server_Create_Send_Result_String */
+			Server_Data.Send_Result_Cache[2] = seq_id;
+			Server_Reply(class,source,Server_Data.Send_Result_Cache);
+			return TRUE;
 		}
-	}/* end while */
-#if LOGGING > 1
-	Wms_Qli50_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,"Wms_Qli50_Server_Loop: Finished.");
-#endif /* LOGGING */
+	}
+	if(Server_Data.Send_Result_Callback != NULL)
+		Server_Data.Send_Result_Callback(qli_id,seq_id,&data);
+	else
+	{
+		/* create some data to send back - valid but _bad_ weather in case the
+		** Send_Result_Callback is not set correctly in a 'real' situation. */
+		data.Temperature.Type = DATA_TYPE_DOUBLE;
+		data.Temperature.Value.DValue = 0.0;
+		data.Humidity.Type = DATA_TYPE_DOUBLE;
+		data.Humidity.Value.DValue = 99.0;
+		data.Dew_Point.Type = DATA_TYPE_DOUBLE;
+		data.Dew_Point.Value.DValue = 1.0;
+		data.Wind_Speed.Type = DATA_TYPE_DOUBLE;
+		data.Wind_Speed.Value.DValue = 20.0;
+		data.Wind_Direction.Type = DATA_TYPE_INT;
+		data.Wind_Direction.Value.IValue = 359;
+		data.Air_Pressure.Type = DATA_TYPE_DOUBLE;
+		data.Air_Pressure.Value.DValue = 768.0;
+		data.Digital_Surface_Wet.Type = DATA_TYPE_INT;
+		data.Digital_Surface_Wet.Value.IValue = 4;
+		data.Analogue_Surface_Wet.Type = DATA_TYPE_INT;
+		data.Analogue_Surface_Wet.Value.IValue = 98;
+		data.Light.Type = DATA_TYPE_INT;
+		data.Light.Value.IValue = 1000;
+		data.Internal_Voltage.Type = DATA_TYPE_DOUBLE;
+		data.Internal_Voltage.Value.DValue = 0.0;
+		data.Internal_Current.Type = DATA_TYPE_DOUBLE;
+		data.Internal_Current.Value.DValue = 0.0;
+		data.Internal_Temperature.Type = DATA_TYPE_DOUBLE;
+		data.Internal_Temperature.Value.DValue = 0.0;
+		data.Reference_Temperature.Type = DATA_TYPE_DOUBLE;
+		data.Reference_Temperature.Value.DValue = 0.0;
+	}
+	Server_Data.Send_Result_Cache_Valid = FALSE;
+	if(!Server_Create_Send_Result_String(qli_id,seq_id,data,Server_Data.Send_Result_Cache,
+					     SERVER_SEND_RESULT_LENGTH-2))
+		return FALSE;
+	if(Server_Data.Send_Result_Generation_Callback != NULL)
+	{
+		Server_Data.Send_Result_Cache_Generation = generation;
+		Server_Data.Send_Result_Cache_Qli_Id = qli_id;
+		Server_Data.Send_Result_Cache_Valid = TRUE;
+	}
+	Server_Reply(class,source,Server_Data.Send_Result_Cache);
 	return TRUE;
 }
 
-/* ==========================================
-** internal functions 
-** ========================================== */
 /**
  * Internal routine to take the data in an instance of Wms_Qli50_Data_Struct, and turn it into a suitably formatted
  * string to reply to a Send Results message.
@@ -6,6 +6,9 @@
 
 extern int Wms_Qli50_Connection_Open(char *class,char *source,char *device_name);
 extern int Wms_Qli50_Connection_Close(char *class,char *source);
+extern int Wms_Qli50_Connection_Read_Timeout_Set(int timeout_ms);
+extern void Wms_Qli50_Connection_Handle_Set(Wms_Serial_Handle_T *handle);
+extern Wms_Serial_Handle_T *Wms_Qli50_Connection_Handle_Get(void);
 
 /* external variables */
 extern Wms_Serial_Handle_T Wms_Qli50_Serial_Handle;
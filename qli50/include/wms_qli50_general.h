@@ -50,7 +50,7 @@ extern int Wms_Qli50_Log_Filter_Level_Bitwise(char *class,char *source,int level
 extern void Wms_Qli50_Log_Fix_Control_Chars(char *input_string,char *output_string);
 
 /* external variables */
-extern int Wms_Qli50_Error_Number;
-extern char Wms_Qli50_Error_String[];
+extern __thread int Wms_Qli50_Error_Number;
+extern __thread char Wms_Qli50_Error_String[];
 
 #endif
@@ -15,6 +15,13 @@ typedef void (*Read_Sensor_Callback_T)(char qli_id,char seq_id);
  * Typedef for a function pointer to be invoked when a Send Results command is received by the server.
  */
 typedef void (*Send_Result_Callback_T)(char qli_id,char seq_id,struct Wms_Qli50_Data_Struct *data);
+/**
+ * Typedef for a function pointer invoked when a Send Results command is received by the server, to get the 
+ * generation of the data the Send Result callback would return for the specified qli_id. The generation must change 
+ * whenever that data would change, the server only invokes the Send Result callback (and formats a new reply) 
+ * when it does, or when the qli_id differs from the cached reply's.
+ */
+typedef unsigned int (*Send_Result_Generation_Callback_T)(char qli_id);
 	
 /**
  * Typedef for a function pointer to be invoked when a PAR command is received by the server.
@@ -24,12 +31,24 @@ typedef void (*Par_Callback_T)(char *return_parameter_string,int return_paramete
  * Typedef for a function pointer to be invoked when a STA (status) command is received by the server.
  */
 typedef void (*Sta_Callback_T)(char *return_string,int return_string_length);
+/**
+ * Typedef for a function pointer registered to handle a command received by the server. The handler is passed
+ * the command line, starting at the command's leading token. It should return TRUE on success, or set 
+ * Wms_Qli50_Error_Number / Wms_Qli50_Error_String and return FALSE on failure.
+ */
+typedef int (*Wms_Qli50_Server_Command_Handler_T)(char *class,char *source,char *command_string);
 	
 extern int Wms_Qli50_Server_Set_Read_Sensor_Callback(char *class,char *source,Read_Sensor_Callback_T callback);
 extern int Wms_Qli50_Server_Set_Send_Result_Callback(char *class,char *source,Send_Result_Callback_T callback);
+extern int Wms_Qli50_Server_Set_Send_Result_Generation_Callback(char *class,char *source,
+								Send_Result_Generation_Callback_T callback);
 extern int Wms_Qli50_Server_Set_Par_Callback(char *class,char *source,Par_Callback_T callback);
 extern int Wms_Qli50_Server_Set_Sta_Callback(char *class,char *source,Sta_Callback_T callback);
+extern int Wms_Qli50_Server_Command_Register(char *class,char *source,char *command_token,
+					     Wms_Qli50_Server_Command_Handler_T handler);
 extern int Wms_Qli50_Server_Start(char *class,char *source,char *device_name);
 extern int Wms_Qli50_Server_Loop(char *class,char *source);
+extern int Wms_Qli50_Server_Process_Input(char *class,char *source);
+extern int Wms_Qli50_Server_Process_Command(char *class,char *source,char *command_message_string);
 
 #endif
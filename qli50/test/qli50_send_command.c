@@ -0,0 +1,257 @@
+/* qli50_send_command.c
+** Open a connection to the Vaisala Qli50 (or the qli50_wxt536 program emulating one), send a command,
+** and wait for a reply.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log_udp.h"
+#include "wms_qli50_command.h"
+#include "wms_qli50_connection.h"
+#include "wms_qli50_general.h"
+#include "wms_serial_general.h"
+
+/**
+ * This program opens a connection to the Vaisala Qli50, sends a terminated command string, and waits for a reply.
+ * For instance, qli50_wxt536 accepts "WXT &lt;wxt536 command&gt;", and queues the Wxt536 command to send
+ * to the Wxt536s it is polling, so engineering commands can be sent whilst the program is running.
+ * @author $Author: cjm $
+ */
+/**
+ * Default log level.
+ */
+#define DEFAULT_LOG_LEVEL       (LOG_VERBOSITY_VERY_VERBOSE)
+
+/* internal variables */
+/**
+ * Revision control system identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The name of the serial device to open.
+ */
+char Serial_Device_Name[256];
+/**
+ * The command to send over the serial link.
+ */
+char Command_String[256];
+/**
+ * How long to wait for the reply, in milliseconds, or -1 to use the connection's default read timeout.
+ */
+int Timeout = -1;
+
+/* internal routines */
+static int Parse_Arguments(int argc, char *argv[]);
+static void Help(void);
+
+/**
+ * Main program.
+ * @param argc The number of arguments to the program.
+ * @param argv An array of argument strings.
+ * @return This function returns 0 if the program succeeds, and a positive integer if it fails.
+ * @see #DEFAULT_LOG_LEVEL
+ * @see #Serial_Device_Name
+ * @see #Command_String
+ * @see #Timeout
+ * @see #Parse_Arguments
+ * @see ../cdocs/wms_qli50_general.html#Wms_Qli50_Set_Log_Handler_Function
+ * @see ../cdocs/wms_qli50_general.html#Wms_Qli50_Log_Handler_Stdout
+ * @see ../cdocs/wms_qli50_general.html#Wms_Qli50_Set_Log_Filter_Function
+ * @see ../cdocs/wms_qli50_general.html#Wms_Qli50_Log_Filter_Level_Absolute
+ * @see ../cdocs/wms_qli50_general.html#Wms_Qli50_Set_Log_Filter_Level
+ * @see ../cdocs/wms_qli50_general.html#Wms_Qli50_Error
+ * @see ../cdocs/wms_qli50_general.html#Wms_Qli50_Log_Fix_Control_Chars
+ * @see ../cdocs/wms_qli50_connection.html#Wms_Qli50_Connection_Open
+ * @see ../cdocs/wms_qli50_connection.html#Wms_Qli50_Connection_Read_Timeout_Set
+ * @see ../cdocs/wms_qli50_connection.html#Wms_Qli50_Connection_Close
+ * @see ../cdocs/wms_qli50_command.html#Wms_Qli50_Command
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Handler_Function
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Log_Handler_Stdout
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Function
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Log_Filter_Level_Absolute
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Level
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Get_Error_Number
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Error
+ */
+int main(int argc, char *argv[])
+{
+	char reply_string[256];
+	char fixed_reply_string[256];
+
+	fprintf(stdout,"Qli50 Send Command\n");
+	/* initialise logging */
+	Wms_Qli50_Set_Log_Handler_Function(Wms_Qli50_Log_Handler_Stdout);
+	Wms_Qli50_Set_Log_Filter_Function(Wms_Qli50_Log_Filter_Level_Absolute);
+	Wms_Qli50_Set_Log_Filter_Level(DEFAULT_LOG_LEVEL);
+	Wms_Serial_Set_Log_Handler_Function(Wms_Serial_Log_Handler_Stdout);
+	Wms_Serial_Set_Log_Filter_Function(Wms_Serial_Log_Filter_Level_Absolute);
+	Wms_Serial_Set_Log_Filter_Level(DEFAULT_LOG_LEVEL);
+	fprintf(stdout,"Parsing Arguments.\n");
+	/* parse arguments */
+	if(!Parse_Arguments(argc,argv))
+		return 1;
+	/* open interface */
+	if(strlen(Serial_Device_Name) < 1)
+	{
+		fprintf(stdout,"Qli50 Send Command: Specify a serial device filename.\n");
+		return 2;
+	}
+	if(Timeout > 0)
+	{
+		if(!Wms_Qli50_Connection_Read_Timeout_Set(Timeout))
+		{
+			Wms_Qli50_Error();
+			return 2;
+		}
+	}
+	if(!Wms_Qli50_Connection_Open("Qli50 Send Command","qli50_send_command.c",Serial_Device_Name))
+	{
+		Wms_Qli50_Error();
+		if(Wms_Serial_Get_Error_Number() != 0)
+			Wms_Serial_Error();
+		return 3;
+	}
+	/* send command and read reply */
+	fprintf(stdout,"Sending '%s' to Qli50.\n",Command_String);
+	if(!Wms_Qli50_Command("Qli50 Send Command","qli50_send_command.c",Command_String,reply_string,255,
+			      TERMINATOR_CR))
+	{
+		Wms_Qli50_Error();
+		if(Wms_Serial_Get_Error_Number() != 0)
+			Wms_Serial_Error();
+		return 4;
+	}
+	Wms_Qli50_Log_Fix_Control_Chars(reply_string,fixed_reply_string);
+	fprintf(stdout,"%s\n",fixed_reply_string);
+	/* close interface */
+	if(!Wms_Qli50_Connection_Close("Qli50 Send Command","qli50_send_command.c"))
+	{
+		Wms_Qli50_Error();
+		if(Wms_Serial_Get_Error_Number() != 0)
+			Wms_Serial_Error();
+		return 5;
+	}
+	fprintf(stdout,"Qli50 Send Command:Finished.\n");
+	return 0;
+}
+
+/**
+ * Routine to parse command line arguments.
+ * @param argc The number of arguments sent to the program.
+ * @param argv An array of argument strings.
+ * @see #Help
+ * @see #Serial_Device_Name
+ * @see #Command_String
+ * @see #Timeout
+ * @see ../cdocs/wms_qli50_general.html#Wms_Qli50_Set_Log_Filter_Level
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Level
+ */
+static int Parse_Arguments(int argc, char *argv[])
+{
+	int i,retval,ivalue;
+
+	for(i=1;i<argc;i++)
+	{
+		if((strcmp(argv[i],"-c")==0)||(strcmp(argv[i],"-command")==0))
+		{
+			if((i+1)<argc)
+			{
+				strncpy(Command_String,argv[i+1],255);
+				Command_String[255] = '\0';
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Qli50 Send Command:Parse_Arguments:"
+					"You must specify a command to send.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-h")==0)||(strcmp(argv[i],"-help")==0))
+		{
+			Help();
+			exit(0);
+		}
+		else if((strcmp(argv[i],"-l")==0)||(strcmp(argv[i],"-log_level")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&ivalue);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Qli50 Send Command:Parse_Arguments:"
+						"Illegal log level %s.\n",argv[i+1]);
+					return FALSE;
+				}
+				Wms_Qli50_Set_Log_Filter_Level(ivalue);
+				Wms_Serial_Set_Log_Filter_Level(ivalue);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Qli50 Send Command:Parse_Arguments:"
+					"Log Level requires a number.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-se")==0)||(strcmp(argv[i],"-serial_device")==0))
+		{
+			if((i+1)<argc)
+			{
+				strcpy(Serial_Device_Name,argv[i+1]);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Qli50 Send Command:Parse_Arguments:"
+					"Device filename requires a filename.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-t")==0)||(strcmp(argv[i],"-timeout")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Timeout);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Qli50 Send Command:Parse_Arguments:"
+						"Illegal timeout %s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Qli50 Send Command:Parse_Arguments:"
+					"Timeout requires a number of milliseconds.\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			fprintf(stderr,"Qli50 Send Command:Parse_Arguments:argument '%s' not recognized.\n",
+				argv[i]);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Help routine.
+ */
+static void Help(void)
+{
+	fprintf(stdout,"Qli50 Send Command:Help.\n");
+	fprintf(stdout,"Qli50 Send Command sends a terminated command string to the Vaisala Qli50 and waits for a reply string.\n");
+	fprintf(stdout,"qli50_send_command [-serial_device|-se <filename>][-c[ommand] <string>][-t[imeout] <ms>]\n");
+	fprintf(stdout,"\t[-l[og_level] <number>][-h[elp]]\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t-serial_device specifies the serial device name.\n");
+	fprintf(stdout,"\te.g. /dev/ttyS0 for Linux.\n");
+	fprintf(stdout,"\t-command specifies the string to send. A terminator is added before transmission.\n");
+	fprintf(stdout,"\te.g. \"WXT 0XU\" to send an engineering command to a Wxt536 via qli50_wxt536.\n");
+	fprintf(stdout,"\t-timeout specifies how long to wait for the reply, in milliseconds.\n");
+	fprintf(stdout,"\t-log_level specifies the logging(0..5).\n");
+}
@@ -12,6 +12,10 @@
 #include <string.h>
 #include <strings.h>
 #include <fcntl.h>   /* File control definitions */
+#include <linux/serial.h> /* RS-485 configuration */
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
 #include <termios.h> /* POSIX terminal control definitions */
 #include <unistd.h>  /* UNIX standard function definitions */
 #include "log_udp.h"
@@ -20,134 +24,208 @@
 
 /* hash defines */
 /**
- * The number of times to attempt a read which returns 0 bytes read, before failing and timing out,
- * when trying to read a line of data using Wms_Serial_Read_Line.
+ * The default read timeout set by Wms_Serial_Handle_Initialise, in milliseconds.
  */
-#define READ_LINE_TIMEOUT (10)
-
-/* data types */
+#define DEFAULT_READ_TIMEOUT (10000)
 /**
- * Data structure containing default baud rates and flags, an instance of which is used
- * to initialise new serial connections.
- * <dl>
- * <dt>Baud_Rate</dt> <dd>The baud rate of the serial connection : usually B19200 or B9600 from termios.h.</dd>
- * <dt>Input_Flags</dt> <dd>Flags to or into c_iflag.</dd>
- * <dt>Output_Flags</dt> <dd>Flags to or into c_oflag.</dd>
- * <dt>Control_Flags</dt> <dd>Flags to or into c_cflag.</dd>
- * <dt>Local_Flags</dt> <dd>Flags to or into c_lflag.</dd>
- * </dl>
+ * The number of milliseconds in one second.
  */
-struct Serial_Attribute_Struct
-{
-	int Baud_Rate;
-	int Input_Flags;
-	int Output_Flags;
-	int Control_Flags;
-	int Local_Flags;
-};
+#define ONE_SECOND_MS        (1000)
 
 /* internal variables */
 /**
  * Revision Control System identifier.
  */
 static char rcsid[] = "$Id$";
+
+/* internal functions */
+static int Serial_Baud_Rate_Check(int baud_rate);
+static void Serial_Read_Buffer_Reset(Wms_Serial_Handle_T *handle);
+static int Serial_Read_Buffer_Scan(Wms_Serial_Handle_T *handle,char *terminator,int terminator_length);
+static void Serial_Read_Buffer_Extract(Wms_Serial_Handle_T *handle,char *message,int length);
+static void Serial_Deadline_Get(int timeout_ms,struct timespec *deadline);
+static int Serial_Wait_For_Data(char *class,char *source,Wms_Serial_Handle_T *handle,struct timespec deadline,
+				int *data_available);
+
+/* external functions */
 /**
- * Instance of Serial_Attribute_Struct containing attributes to initialise opened serial connections with:
+ * Initialise a serial handle's attributes to the defaults, and mark it as not open. A handle that is not a static
+ * variable should be initialised before it's attributes are set and it is opened. The defaults are:
  * <dl>
  * <dt>Baud_Rate</dt> <dd>B19200</dd>
  * <dt>Input_Flags</dt> <dd>IGNPAR</dd>
  * <dt>Output_Flags</dt> <dd>0</dd>
  * <dt>Control_Flags</dt> <dd>CS8 | CLOCAL | CREAD</dd>
  * <dt>Local_Flags</dt> <dd>0</dd>
+ * <dt>Read_Timeout</dt> <dd>DEFAULT_READ_TIMEOUT</dd>
  * </dl>
- * @see #Serial_Attribute_Struct
+ * @param handle The address of a Wms_Serial_Handle_T structure to initialise.
+ * @return TRUE if succeeded, FALSE otherwise.
+ * @see #Wms_Serial_Handle_T
+ * @see #DEFAULT_READ_TIMEOUT
+ * @see #Serial_Read_Buffer_Reset
  */
-static struct Serial_Attribute_Struct Serial_Attribute_Data = 
+int Wms_Serial_Handle_Initialise(Wms_Serial_Handle_T *handle)
 {
-	B19200,IGNPAR,0,CS8 | CLOCAL | CREAD, 0
-
-};
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 44;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Handle_Initialise: Device handle was NULL.");
+		return FALSE;
+	}
+	handle->Device_Name[0] = '\0';
+	handle->Serial_Fd = -1;
+	handle->Baud_Rate = B19200;
+	handle->Input_Flags = IGNPAR;
+	handle->Output_Flags = 0;
+	handle->Control_Flags = CS8 | CLOCAL | CREAD;
+	handle->Local_Flags = 0;
+	handle->Read_Timeout = DEFAULT_READ_TIMEOUT;
+	Serial_Read_Buffer_Reset(handle);
+	return TRUE;
+}
 
-/* external functions */
 /**
- * Set the baud rate to be set for subsequently opened serial handles.
+ * Set the baud rate the serial handle is configured with when it is next opened.
+ * @param handle The address of the Wms_Serial_Handle_T structure to configure.
  * @param baud_rate The baud rate to use, usually B9600 or B19200 from termios.h - man tcsetattr to see all of them.
  * @return TRUE if succeeded, FALSE otherwise.
- * @see #Serial_Attribute_Data
+ * @see #Wms_Serial_Handle_T
+ * @see #Serial_Baud_Rate_Check
  */
-int Wms_Serial_Baud_Rate_Set(int baud_rate)
+int Wms_Serial_Baud_Rate_Set(Wms_Serial_Handle_T *handle,int baud_rate)
 {
-	/* check baud rate.
-	** This is a subset of all allowable values, man tcsetattr to see all of them */
-	if((baud_rate != B1200)&&(baud_rate != B1800)&&(baud_rate != B2400)&&(baud_rate != B4800)&&
-	   (baud_rate != B9600)&&(baud_rate != B19200)&&(baud_rate != B38400)&&(baud_rate != B57600)&&
-	   (baud_rate != B115200))
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 45;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Baud_Rate_Set: Device handle was NULL.");
+		return FALSE;
+	}
+	if(!Serial_Baud_Rate_Check(baud_rate))
 	{
 		Wms_Serial_Error_Number = 15;
 		sprintf(Wms_Serial_Error_String,"Wms_Serial_Baud_Rate_Set: Illegal baud rate %d.",baud_rate);
 		return FALSE;
 	}
-	Serial_Attribute_Data.Baud_Rate = baud_rate;
+	handle->Baud_Rate = baud_rate;
 	return TRUE;
 }
 
 /**
- * Set the input flags to be set for subsequently opened serial handles.
+ * Set the input flags the serial handle is configured with when it is next opened.
+ * @param handle The address of the Wms_Serial_Handle_T structure to configure.
  * @param flags The input flags to use, default is IGNPAR from termios.h - man tcsetattr to see all of them.
  * @return TRUE if succeeded, FALSE otherwise.
- * @see #Serial_Attribute_Data
+ * @see #Wms_Serial_Handle_T
  */
-int Wms_Serial_Input_Flags_Set(int flags)
+int Wms_Serial_Input_Flags_Set(Wms_Serial_Handle_T *handle,int flags)
 {
-	Serial_Attribute_Data.Input_Flags = flags;
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 46;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Input_Flags_Set: Device handle was NULL.");
+		return FALSE;
+	}
+	handle->Input_Flags = flags;
 	return TRUE;
 }
 
 /**
- * Set the output flags to be set for subsequently opened serial handles.
+ * Set the output flags the serial handle is configured with when it is next opened.
+ * @param handle The address of the Wms_Serial_Handle_T structure to configure.
  * @param flags The input flags to use, default is 0 from termios.h - man tcsetattr to see all of them.
  * @return TRUE if succeeded, FALSE otherwise.
- * @see #Serial_Attribute_Data
+ * @see #Wms_Serial_Handle_T
  */
-int Wms_Serial_Output_Flags_Set(int flags)
+int Wms_Serial_Output_Flags_Set(Wms_Serial_Handle_T *handle,int flags)
 {
-	Serial_Attribute_Data.Output_Flags = flags;
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 47;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Output_Flags_Set: Device handle was NULL.");
+		return FALSE;
+	}
+	handle->Output_Flags = flags;
 	return TRUE;
 }
 
 /**
- * Set the control flags to be set for subsequently opened serial handles.
+ * Set the control flags the serial handle is configured with when it is next opened.
+ * @param handle The address of the Wms_Serial_Handle_T structure to configure.
  * @param flags The control flags to use, default is CS8 | CLOCAL | CREAD from termios.h - 
  *        man tcsetattr to see all of them.
  * @return TRUE if succeeded, FALSE otherwise.
- * @see #Serial_Attribute_Data
+ * @see #Wms_Serial_Handle_T
  */
-int Wms_Serial_Control_Flags_Set(int flags)
+int Wms_Serial_Control_Flags_Set(Wms_Serial_Handle_T *handle,int flags)
 {
-	Serial_Attribute_Data.Control_Flags = flags;
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 48;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Control_Flags_Set: Device handle was NULL.");
+		return FALSE;
+	}
+	handle->Control_Flags = flags;
 	return TRUE;
 }
 
 /**
- * Set the local flags to be set for subsequently opened serial handles.
+ * Set the local flags the serial handle is configured with when it is next opened.
+ * @param handle The address of the Wms_Serial_Handle_T structure to configure.
  * @param flags The local flags to use, default is 0 from termios.h - man tcsetattr to see all of them.
  * @return TRUE if succeeded, FALSE otherwise.
- * @see #Serial_Attribute_Data
+ * @see #Wms_Serial_Handle_T
+ */
+int Wms_Serial_Local_Flags_Set(Wms_Serial_Handle_T *handle,int flags)
+{
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 49;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Local_Flags_Set: Device handle was NULL.");
+		return FALSE;
+	}
+	handle->Local_Flags = flags;
+	return TRUE;
+}
+
+/**
+ * Set the serial handle's default read timeout. This is how long Wms_Serial_Read and Wms_Serial_Read_Line wait 
+ * for data, when called with a timeout_ms of WMS_SERIAL_READ_TIMEOUT_DEFAULT. It takes effect at once, whether or not
+ * the handle is open.
+ * @param handle The address of the Wms_Serial_Handle_T structure to configure.
+ * @param timeout_ms The timeout in milliseconds, default is DEFAULT_READ_TIMEOUT. This must be positive.
+ * @return TRUE if succeeded, FALSE otherwise.
+ * @see #Wms_Serial_Handle_T
+ * @see #DEFAULT_READ_TIMEOUT
  */
-int Wms_Serial_Local_Flags_Set(int flags)
+int Wms_Serial_Read_Timeout_Set(Wms_Serial_Handle_T *handle,int timeout_ms)
 {
-	Serial_Attribute_Data.Local_Flags = flags;
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 50;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Timeout_Set: Device handle was NULL.");
+		return FALSE;
+	}
+	if(timeout_ms < 1)
+	{
+		Wms_Serial_Error_Number = 28;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Timeout_Set: Illegal timeout %d ms.",timeout_ms);
+		return FALSE;
+	}
+	handle->Read_Timeout = timeout_ms;
 	return TRUE;
 }
 
 /**
- * Open the serial device, and configure accordingly,using default in Serial_Attribute_Data.
+ * Open the serial device, and configure it using the handle's attributes (Baud_Rate, Input_Flags, Output_Flags,
+ * Control_Flags and Local_Flags). The handle's read buffer is emptied, it's Read_Timeout is left as it is.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
  * @param handle The address of a Wms_Serial_Handle_T structure to fill in.
  * @return TRUE if succeeded, FALSE otherwise.
  * @see #Wms_Serial_Handle_T
- * @see #Serial_Attribute_Data
+ * @see #Wms_Serial_Handle_Initialise
+ * @see #Serial_Read_Buffer_Reset
  */
 int Wms_Serial_Open(char *class,char *source,Wms_Serial_Handle_T *handle)
 {
@@ -176,6 +254,8 @@ int Wms_Serial_Open(char *class,char *source,Wms_Serial_Handle_T *handle)
 	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,"Wms_Serial_Open with FD %d.",
 			     handle->Serial_Fd);
 #endif /* LOGGING */
+	/* nothing has been read yet */
+	Serial_Read_Buffer_Reset(handle);
 	/* get current serial options */
 	retval = tcgetattr(handle->Serial_Fd,&(handle->Serial_Options_Saved));
 	if(retval != 0)
@@ -189,18 +269,18 @@ int Wms_Serial_Open(char *class,char *source,Wms_Serial_Handle_T *handle)
 	/* initialise new serial options */
 	bzero(&(handle->Serial_Options), sizeof(handle->Serial_Options));
 	/* set control flags and baud rate */
-	handle->Serial_Options.c_cflag = Serial_Attribute_Data.Baud_Rate|Serial_Attribute_Data.Control_Flags;
+	handle->Serial_Options.c_cflag = handle->Baud_Rate|handle->Control_Flags;
 	/* select raw input, clear ICANON to switch off canonical mode (character not line input). */
-	handle->Serial_Options.c_lflag = Serial_Attribute_Data.Local_Flags & ~(ICANON);
+	handle->Serial_Options.c_lflag = handle->Local_Flags & ~(ICANON);
 	/* ignore parity errors */
-	handle->Serial_Options.c_iflag = Serial_Attribute_Data.Input_Flags;
+	handle->Serial_Options.c_iflag = handle->Input_Flags;
 	/* set raw output */
-	handle->Serial_Options.c_oflag = Serial_Attribute_Data.Output_Flags;
-	/* wait for up to 10 deciseconds before timing out input */
+	handle->Serial_Options.c_oflag = handle->Output_Flags;
+	/* reads return immediately, we use poll to wait for input with a millisecond timeout */
 	handle->Serial_Options.c_cc[VMIN]=0;
-	handle->Serial_Options.c_cc[VTIME]=10;
+	handle->Serial_Options.c_cc[VTIME]=0;
 	/* set input and output speeds again */
-	retval = cfsetispeed(&(handle->Serial_Options),Serial_Attribute_Data.Baud_Rate);
+	retval = cfsetispeed(&(handle->Serial_Options),handle->Baud_Rate);
 	if(retval != 0)
 	{
 		open_errno = errno;
@@ -209,7 +289,7 @@ int Wms_Serial_Open(char *class,char *source,Wms_Serial_Handle_T *handle)
 			strerror(open_errno));
 		return FALSE;
 	}
-	retval = cfsetospeed(&(handle->Serial_Options),Serial_Attribute_Data.Baud_Rate);
+	retval = cfsetospeed(&(handle->Serial_Options),handle->Baud_Rate);
 	if(retval != 0)
 	{
 		open_errno = errno;
@@ -282,6 +362,7 @@ int Wms_Serial_Open(char *class,char *source,Wms_Serial_Handle_T *handle)
  * @param handle The address of a Wms_Serial_Handle_T structure to close.
  * @return TRUE if succeeded, FALSE otherwise.
  * @see #Wms_Serial_Handle_T
+ * @see #Serial_Read_Buffer_Reset
  */
 int Wms_Serial_Close(char *class,char *source,Wms_Serial_Handle_T *handle)
 {
@@ -305,6 +386,7 @@ int Wms_Serial_Close(char *class,char *source,Wms_Serial_Handle_T *handle)
 #if LOGGING > 1
 	Wms_Serial_Log(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Serial_Close:Closing file descriptor.");
 #endif /* LOGGING */
+	Serial_Read_Buffer_Reset(handle);
 	retval = close(handle->Serial_Fd);
 	if(retval < 0)
 	{
@@ -320,20 +402,218 @@ int Wms_Serial_Close(char *class,char *source,Wms_Serial_Handle_T *handle)
 	return TRUE;
 }
 
+/**
+ * Routine to configure RS-485 half-duplex direction control on an opened serial link, using the Linux 
+ * TIOCSRS485 ioctl. When enabled, the serial driver asserts RTS (switching the RS-485 transceiver to transmit)
+ * whilst a message is being written, and releases it afterwards so the devices on the bus can reply.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param handle The address of a Wms_Serial_Handle_T containing the connection information to configure.
+ * @param enable A boolean, TRUE to enable RS-485 direction control, FALSE to disable it.
+ * @param delay_after_send_ms How long to keep the transmitter enabled after the last character is sent, 
+ *        in milliseconds. This must be shorter than the RS-485 line delay of the devices on the bus 
+ *        (the time they wait before replying), and is normally 0.
+ * @return TRUE if succeeded, FALSE otherwise. The routine fails if the serial device (or operating system) 
+ *         does not support RS-485 direction control.
+ * @see #Wms_Serial_Handle_T
+ */
+int Wms_Serial_RS485_Set(char *class,char *source,Wms_Serial_Handle_T *handle,int enable,int delay_after_send_ms)
+{
+#ifdef TIOCSRS485
+	struct serial_rs485 rs485_config;
+	int retval,ioctl_errno;
+#endif /* TIOCSRS485 */
+
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 32;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_RS485_Set: Device handle was NULL.");
+		return FALSE;
+	}
+	if(delay_after_send_ms < 0)
+	{
+		Wms_Serial_Error_Number = 33;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_RS485_Set: Illegal delay after send %d ms.",
+			delay_after_send_ms);
+		return FALSE;
+	}
+#if LOGGING > 1
+	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,
+			      "Wms_Serial_RS485_Set(%s,enable=%d,delay after send=%d ms).",
+			      handle->Device_Name,enable,delay_after_send_ms);
+#endif /* LOGGING */
+#ifdef TIOCSRS485
+	memset(&rs485_config,0,sizeof(struct serial_rs485));
+	if(enable)
+	{
+		rs485_config.flags = SER_RS485_ENABLED|SER_RS485_RTS_ON_SEND;
+		rs485_config.delay_rts_after_send = delay_after_send_ms;
+	}
+	retval = ioctl(handle->Serial_Fd,TIOCSRS485,&rs485_config);
+	if(retval < 0)
+	{
+		ioctl_errno = errno;
+		Wms_Serial_Error_Number = 34;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_RS485_Set: Device %s TIOCSRS485 failed (%d = %s).",
+			handle->Device_Name,ioctl_errno,strerror(ioctl_errno));
+		return FALSE;
+	}
+	return TRUE;
+#else
+	Wms_Serial_Error_Number = 35;
+	sprintf(Wms_Serial_Error_String,"Wms_Serial_RS485_Set: RS-485 direction control is not supported.");
+	return FALSE;
+#endif /* TIOCSRS485 */
+}
+
+/**
+ * Routine to change the baud rate of an opened serial link. Any output already written is sent at the old baud rate
+ * first. Input received at the old baud rate (and not yet read) is discarded, as it may be garbled.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param handle The address of a Wms_Serial_Handle_T containing the connection information to configure.
+ * @param baud_rate The baud rate to use, usually B9600 or B19200 from termios.h - man tcsetattr to see all of them.
+ * @return TRUE if succeeded, FALSE otherwise.
+ * @see #Wms_Serial_Handle_T
+ * @see #Serial_Baud_Rate_Check
+ * @see #Serial_Read_Buffer_Reset
+ */
+int Wms_Serial_Baud_Rate_Change(char *class,char *source,Wms_Serial_Handle_T *handle,int baud_rate)
+{
+	int retval,change_errno;
+
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 36;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Baud_Rate_Change: Device handle was NULL.");
+		return FALSE;
+	}
+	if(!Serial_Baud_Rate_Check(baud_rate))
+	{
+		Wms_Serial_Error_Number = 37;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Baud_Rate_Change: Illegal baud rate %d.",baud_rate);
+		return FALSE;
+	}
+#if LOGGING > 1
+	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,"Wms_Serial_Baud_Rate_Change(%s,%d).",
+			      handle->Device_Name,baud_rate);
+#endif /* LOGGING */
+	retval = cfsetispeed(&(handle->Serial_Options),baud_rate);
+	if(retval != 0)
+	{
+		change_errno = errno;
+		Wms_Serial_Error_Number = 38;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Baud_Rate_Change: cfsetispeed failed (%d = %s).",
+			change_errno,strerror(change_errno));
+		return FALSE;
+	}
+	retval = cfsetospeed(&(handle->Serial_Options),baud_rate);
+	if(retval != 0)
+	{
+		change_errno = errno;
+		Wms_Serial_Error_Number = 39;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Baud_Rate_Change: cfsetospeed failed (%d = %s).",
+			change_errno,strerror(change_errno));
+		return FALSE;
+	}
+	/* TCSADRAIN waits for pending output to be sent at the old baud rate */
+	retval = tcsetattr(handle->Serial_Fd,TCSADRAIN,&(handle->Serial_Options));
+	if(retval != 0)
+	{
+		change_errno = errno;
+		Wms_Serial_Error_Number = 40;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Baud_Rate_Change: tcsetattr failed (%d = %s).",
+			change_errno,strerror(change_errno));
+		return FALSE;
+	}
+	tcflush(handle->Serial_Fd,TCIFLUSH);
+	Serial_Read_Buffer_Reset(handle);
+	return TRUE;
+}
+
+/**
+ * Routine to change the character framing (data bits, parity and stop bits) of an opened serial link. 
+ * Any output already written is sent with the old framing first. Input received with the old framing 
+ * (and not yet read) is discarded, as it may be garbled.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param handle The address of a Wms_Serial_Handle_T containing the connection information to configure.
+ * @param data_bits The number of data bits per character, 7 or 8.
+ * @param parity The parity to use, one of 'N' (none), 'E' (even) or 'O' (odd).
+ * @param stop_bits The number of stop bits per character, 1 or 2.
+ * @return TRUE if succeeded, FALSE otherwise.
+ * @see #Wms_Serial_Handle_T
+ * @see #Serial_Read_Buffer_Reset
+ */
+int Wms_Serial_Framing_Change(char *class,char *source,Wms_Serial_Handle_T *handle,int data_bits,char parity,
+			      int stop_bits)
+{
+	int retval,change_errno;
+
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 41;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Framing_Change: Device handle was NULL.");
+		return FALSE;
+	}
+	if(((data_bits != 7)&&(data_bits != 8))||((parity != 'N')&&(parity != 'E')&&(parity != 'O'))||
+	   ((stop_bits != 1)&&(stop_bits != 2)))
+	{
+		Wms_Serial_Error_Number = 42;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Framing_Change: Illegal framing %d%c%d.",
+			data_bits,parity,stop_bits);
+		return FALSE;
+	}
+#if LOGGING > 1
+	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,"Wms_Serial_Framing_Change(%s,%d%c%d).",
+			      handle->Device_Name,data_bits,parity,stop_bits);
+#endif /* LOGGING */
+	handle->Serial_Options.c_cflag &= ~(CSIZE|PARENB|PARODD|CSTOPB);
+	if(data_bits == 7)
+		handle->Serial_Options.c_cflag |= CS7;
+	else
+		handle->Serial_Options.c_cflag |= CS8;
+	if(parity == 'E')
+		handle->Serial_Options.c_cflag |= PARENB;
+	else if(parity == 'O')
+		handle->Serial_Options.c_cflag |= PARENB|PARODD;
+	if(stop_bits == 2)
+		handle->Serial_Options.c_cflag |= CSTOPB;
+	/* TCSADRAIN waits for pending output to be sent with the old framing */
+	retval = tcsetattr(handle->Serial_Fd,TCSADRAIN,&(handle->Serial_Options));
+	if(retval != 0)
+	{
+		change_errno = errno;
+		Wms_Serial_Error_Number = 43;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Framing_Change: tcsetattr failed (%d = %s).",
+			change_errno,strerror(change_errno));
+		return FALSE;
+	}
+	tcflush(handle->Serial_Fd,TCIFLUSH);
+	Serial_Read_Buffer_Reset(handle);
+	return TRUE;
+}
+
 /**
  * Routine to write a message to the opened serial link.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
- * @param handle An instance of Wms_Serial_Handle_T containing connection information to write to.
+ * @param handle The address of a Wms_Serial_Handle_T containing connection information to write to.
  * @param message A pointer to an allocated buffer containing the bytes to write.
  * @param message_length The length of the message to write.
  * @return TRUE if succeeded, FALSE otherwise.
  * @see #Wms_Serial_Handle_T
  */
-int Wms_Serial_Write(char *class,char *source,Wms_Serial_Handle_T handle,void *message,size_t message_length)
+int Wms_Serial_Write(char *class,char *source,Wms_Serial_Handle_T *handle,void *message,size_t message_length)
 {
 	int write_errno,retval;
 
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 22;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Write:Device handle was NULL.");
+		return FALSE;
+	}
 	if(message == NULL)
 	{
 		Wms_Serial_Error_Number = 5;
@@ -341,19 +621,19 @@ int Wms_Serial_Write(char *class,char *source,Wms_Serial_Handle_T handle,void *m
 		return FALSE;
 	}
 #if LOGGING > 0
-	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Write(%d bytes).",
-			     message_length);
+	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Write(%lu bytes).",
+			     (unsigned long)message_length);
 #endif /* LOGGING */
-	retval = write(handle.Serial_Fd,message,message_length);
+	retval = write(handle->Serial_Fd,message,message_length);
 #if LOGGING > 1
 	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Write returned %d.",retval);
 #endif /* LOGGING */
-	if(retval != message_length)
+	if((retval < 0)||(((size_t)retval) != message_length))
 	{
 		write_errno = errno;
 		Wms_Serial_Error_Number = 6;
 		sprintf(Wms_Serial_Error_String,"Wms_Serial_Write: failed (%d,%d,%d = %s).",
-			handle.Serial_Fd,retval,write_errno,strerror(write_errno));
+			handle->Serial_Fd,retval,write_errno,strerror(write_errno));
 		return FALSE;
 	}
 #if LOGGING > 0
@@ -363,22 +643,39 @@ int Wms_Serial_Write(char *class,char *source,Wms_Serial_Handle_T handle,void *m
 }
 
 /**
- * Routine to read a message from the opened serial link. 
+ * Routine to read a message from the opened serial link. If the handle's read buffer contains bytes left over
+ * from a previous call to Wms_Serial_Read_Line, these are returned first, without reading the serial link.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
- * @param handle An instance of Wms_Serial_Handle_T containing connection information to read from.
+ * @param handle The address of a Wms_Serial_Handle_T containing connection information to read from.
  * @param message A buffer of message_length bytes, to fill with any serial data returned.
  * @param message_length The length of the message buffer.
+ * @param timeout_ms How long to wait for data to arrive, in milliseconds, or WMS_SERIAL_READ_TIMEOUT_DEFAULT to
+ *        use the handle's Read_Timeout, or WMS_SERIAL_READ_TIMEOUT_NONE not to wait at all. 
+ *        If no data arrives within this time, the routine succeeds with zero bytes read.
  * @param bytes_read The address of an integer. On return this will be filled with the number of bytes read from
  *        the serial interface. The address can be NULL, if this data is not needed.
  * @return TRUE if succeeded, FALSE otherwise.
+ * @see #WMS_SERIAL_READ_TIMEOUT_DEFAULT
+ * @see #WMS_SERIAL_READ_TIMEOUT_NONE
+ * @see #Wms_Serial_Handle_T
+ * @see #Serial_Read_Buffer_Extract
+ * @see #Serial_Deadline_Get
+ * @see #Serial_Wait_For_Data
  */
-int Wms_Serial_Read(char *class,char *source,Wms_Serial_Handle_T handle,void *message,int message_length,
-			  int *bytes_read)
+int Wms_Serial_Read(char *class,char *source,Wms_Serial_Handle_T *handle,void *message,int message_length,
+		    int timeout_ms,int *bytes_read)
 {
-	int read_errno,retval;
+	struct timespec deadline;
+	int read_errno,retval,data_available;
 
 	/* check input parameters */
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 23;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read:Device handle was NULL.");
+		return FALSE;
+	}
 	if(message == NULL)
 	{
 		Wms_Serial_Error_Number = 7;
@@ -399,7 +696,38 @@ int Wms_Serial_Read(char *class,char *source,Wms_Serial_Handle_T handle,void *me
 	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Read:Max length %d.",
 			     message_length);
 #endif /* LOGGING */
-	retval = read(handle.Serial_Fd,message,message_length);
+	/* return any bytes left over from a previous line read first */
+	if(handle->Read_Buffer_Count > 0)
+	{
+		retval = handle->Read_Buffer_Count;
+		if(retval > message_length)
+			retval = message_length;
+		Serial_Read_Buffer_Extract(handle,message,retval);
+		if(bytes_read != NULL)
+			(*bytes_read) = retval;
+#if LOGGING > 1
+		Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,
+				      "Wms_Serial_Read:returned %d buffered bytes.",retval);
+#endif /* LOGGING */
+		return TRUE;
+	}
+	/* wait for data to arrive */
+	if(timeout_ms == WMS_SERIAL_READ_TIMEOUT_DEFAULT)
+		timeout_ms = handle->Read_Timeout;
+	else if(timeout_ms == WMS_SERIAL_READ_TIMEOUT_NONE)
+		timeout_ms = 0;
+	Serial_Deadline_Get(timeout_ms,&deadline);
+	if(!Serial_Wait_For_Data(class,source,handle,deadline,&data_available))
+		return FALSE;
+	if(data_available == FALSE)
+	{
+#if LOGGING > 1
+		Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Read:Timed out after %d ms.",
+				      timeout_ms);
+#endif /* LOGGING */
+		return TRUE;
+	}
+	retval = read(handle->Serial_Fd,message,message_length);
 #if LOGGING > 1
 	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Read:returned %d.",retval);
 #endif /* LOGGING */
@@ -411,7 +739,7 @@ int Wms_Serial_Read(char *class,char *source,Wms_Serial_Handle_T handle,void *me
 		{
 			Wms_Serial_Error_Number = 9;
 			sprintf(Wms_Serial_Error_String,"Wms_Serial_Read: failed (%d,%d,%d = %s).",
-				handle.Serial_Fd,retval,read_errno,strerror(read_errno));
+				handle->Serial_Fd,retval,read_errno,strerror(read_errno));
 			return FALSE;
 		}
 		else
@@ -433,27 +761,53 @@ int Wms_Serial_Read(char *class,char *source,Wms_Serial_Handle_T handle,void *me
 }
 
 /**
- * Routine to read a message from the opened serial link. 
- * We have setup each individual read to timeout after 1 second, if no data arrives. We loop until we get
- * a terminator in the received data string, or we timeout after 10 reads attempts with no new data read (i.e. 10s).
+ * Routine to read a line from the opened serial link. Bytes read from the serial link are stored in the handle's
+ * ring buffer. Each byte is scanned once for the terminator, and when a complete line is found it is returned,
+ * and any bytes received after the terminator are kept in the ring buffer for the next call. So exactly one line
+ * is returned per call.
+ * We use poll to wait for more data, until we get a terminator in the received data, or the deadline
+ * (timeout_ms after the routine was called) passes.
+ * If we time out, any partial line received is returned in message (and removed from the ring buffer), 
+ * but the routine fails (with Wms_Serial_Error_Number 10).
+ * If timeout_ms is WMS_SERIAL_READ_TIMEOUT_NONE, we only read the data already available. If that does not
+ * complete a line, the routine succeeds with bytes_read set to zero, and any partial line is kept in the
+ * ring buffer to be completed by a later call. This is used by event driven callers that only call
+ * this routine when poll/epoll says the device is readable.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
- * @param handle An instance of Wms_Serial_Handle_T containing connection information to read from.
+ * @param handle The address of a Wms_Serial_Handle_T containing connection information to read from.
  * @param terminator A NULL terminated string containing the characters that are at the end of the current input line.
- * @param message A buffer of message_length bytes, to fill with any serial data returned.
- * @param message_length The length of the message buffer.
- * @param bytes_read The address of an integer. On return this will be filled with the number of bytes read from
- *        the serial interface. 
+ * @param message A buffer of at least message_length+1 bytes, to fill with the line read (including the terminator).
+ *        The returned line is NULL terminated.
+ * @param message_length The maximum number of bytes to return in message.
+ * @param timeout_ms How long to wait for a complete line, in milliseconds, or WMS_SERIAL_READ_TIMEOUT_DEFAULT to
+ *        use the handle's Read_Timeout, or WMS_SERIAL_READ_TIMEOUT_NONE not to wait at all.
+ * @param bytes_read The address of an integer. On return this will be filled with the number of bytes 
+ *        returned in message. 
  * @return TRUE if succeeded, FALSE otherwise.
- * @see #READ_LINE_TIMEOUT
+ * @see #WMS_SERIAL_READ_TIMEOUT_DEFAULT
+ * @see #WMS_SERIAL_READ_TIMEOUT_NONE
  * @see #Wms_Serial_Handle_T
+ * @see #WMS_SERIAL_READ_BUFFER_LENGTH
+ * @see #Serial_Read_Buffer_Reset
+ * @see #Serial_Read_Buffer_Scan
+ * @see #Serial_Read_Buffer_Extract
+ * @see #Serial_Deadline_Get
+ * @see #Serial_Wait_For_Data
  */
-int Wms_Serial_Read_Line(char *class,char *source,Wms_Serial_Handle_T handle,char *terminator,char *message,
-			 int message_length, int *bytes_read)
+int Wms_Serial_Read_Line(char *class,char *source,Wms_Serial_Handle_T *handle,char *terminator,char *message,
+			 int message_length,int timeout_ms,int *bytes_read)
 {
-	int read_errno,retval,timeout;
+	struct timespec deadline;
+	int read_errno,retval,timed_out,terminator_length,line_length,buffer_end,free_length,data_available;
 
 	/* check input parameters */
+	if(handle == NULL)
+	{
+		Wms_Serial_Error_Number = 24;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line:Device handle was NULL.");
+		return FALSE;
+	}
 	if(message == NULL)
 	{
 		Wms_Serial_Error_Number = 16;
@@ -473,20 +827,57 @@ int Wms_Serial_Read_Line(char *class,char *source,Wms_Serial_Handle_T handle,cha
 		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line:bytes_read was NULL.");
 		return FALSE;
 	}
+	if((terminator == NULL)||(strlen(terminator) < 1))
+	{
+		Wms_Serial_Error_Number = 25;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line:terminator was NULL or empty.");
+		return FALSE;
+	}
 #if LOGGING > 5
 	Wms_Serial_Log(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Read_line:starting.");
 #endif /* LOGGING */
 	/* initialise bytes_read */
 	(*bytes_read) = 0;
 	message[(*bytes_read)] = '\0';
-	timeout = 0;
-	while((strstr(message,terminator) == NULL)&&(timeout < READ_LINE_TIMEOUT))
+	terminator_length = strlen(terminator);
+	/* compute the absolute deadline for the whole line */
+	if(timeout_ms == WMS_SERIAL_READ_TIMEOUT_DEFAULT)
+		timeout_ms = handle->Read_Timeout;
+	if(timeout_ms == WMS_SERIAL_READ_TIMEOUT_NONE)
+		Serial_Deadline_Get(0,&deadline);
+	else
+		Serial_Deadline_Get(timeout_ms,&deadline);
+	timed_out = FALSE;
+	while(((line_length = Serial_Read_Buffer_Scan(handle,terminator,terminator_length)) < 0)&&
+	      (timed_out == FALSE))
 	{
+		if(handle->Read_Buffer_Count >= WMS_SERIAL_READ_BUFFER_LENGTH)
+		{
+			Serial_Read_Buffer_Reset(handle);
+			Wms_Serial_Error_Number = 26;
+			sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line: No terminator found in %d bytes, "
+				"discarding read buffer.",WMS_SERIAL_READ_BUFFER_LENGTH);
+			return FALSE;
+		}
+		/* read into the contiguous free space after the buffered bytes */
+		buffer_end = (handle->Read_Buffer_Start+handle->Read_Buffer_Count)%WMS_SERIAL_READ_BUFFER_LENGTH;
+		if(buffer_end >= handle->Read_Buffer_Start)
+			free_length = WMS_SERIAL_READ_BUFFER_LENGTH-buffer_end;
+		else
+			free_length = handle->Read_Buffer_Start-buffer_end;
 #if LOGGING > 10
 		Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,
-				      "Wms_Serial_Read_line:starting read, current length %d bytes.",(*bytes_read));
+				      "Wms_Serial_Read_line:starting read, current length %d bytes.",
+				      handle->Read_Buffer_Count);
 #endif /* LOGGING */
-		retval = read(handle.Serial_Fd,message+strlen(message),message_length-strlen(message));
+		if(!Serial_Wait_For_Data(class,source,handle,deadline,&data_available))
+			return FALSE;
+		if(data_available == FALSE)
+		{
+			timed_out = TRUE;
+			continue;
+		}
+		retval = read(handle->Serial_Fd,handle->Read_Buffer+buffer_end,free_length);
 		if(retval < 0)
 		{
 			read_errno = errno;
@@ -495,31 +886,231 @@ int Wms_Serial_Read_Line(char *class,char *source,Wms_Serial_Handle_T handle,cha
 			{
 				Wms_Serial_Error_Number = 19;
 				sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line: failed (%d,%d,%d = %s).",
-					handle.Serial_Fd,retval,read_errno,strerror(read_errno));
+					handle->Serial_Fd,retval,read_errno,strerror(read_errno));
 				return FALSE;
 			}
 		}
-		else
+		else if(retval == 0)
 		{
-			(*bytes_read) += retval;
-			message[(*bytes_read)] = '\0';
-			if(retval > 0)
-				timeout = 0;
-			else
-				timeout++;
+			/* poll said data was available, but none was read: the device has hung up */
+			Wms_Serial_Error_Number = 29;
+			sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line: read returned end of file (%d).",
+				handle->Serial_Fd);
+			return FALSE;
 		}
+		else
+			handle->Read_Buffer_Count += retval;
 	}/* end while */
-	message[(*bytes_read)] = '\0';
-	if(timeout >= READ_LINE_TIMEOUT)
+	if((line_length < 0)&&(timeout_ms == WMS_SERIAL_READ_TIMEOUT_NONE))
+	{
+		/* no complete line yet, keep any partial line buffered for the next call */
+		return TRUE;
+	}
+	if(line_length < 0)
 	{
+		/* return any partial line */
+		(*bytes_read) = handle->Read_Buffer_Count;
+		if((*bytes_read) > message_length)
+			(*bytes_read) = message_length;
+		Serial_Read_Buffer_Extract(handle,message,(*bytes_read));
+		message[(*bytes_read)] = '\0';
 		Wms_Serial_Error_Number = 10;
-		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line: Timed out after %d reads and %d bytes read.",
-			timeout,(*bytes_read));
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line: Timed out after %d ms and %d bytes read.",
+			timeout_ms,(*bytes_read));
 		return FALSE;
 	}
+	if(line_length > message_length)
+	{
+		/* discard the line, so the next call starts at the next line */
+		Serial_Read_Buffer_Extract(handle,NULL,line_length);
+		Wms_Serial_Error_Number = 27;
+		sprintf(Wms_Serial_Error_String,"Wms_Serial_Read_Line: Line too long (%d vs %d bytes).",
+			line_length,message_length);
+		return FALSE;
+	}
+	Serial_Read_Buffer_Extract(handle,message,line_length);
+	(*bytes_read) = line_length;
+	message[(*bytes_read)] = '\0';
 #if LOGGING > 0
 	Wms_Serial_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,"Wms_Serial_Read_line:read %d bytes.",(*bytes_read));
 #endif /* LOGGING */
 	return TRUE;
 }
 
+/**
+ * Routine to check whether the handle's read buffer already contains a complete line, i.e. whether the next
+ * call to Wms_Serial_Read_Line will return a line without reading from the serial device. Event driven callers 
+ * use this to process every buffered line, as poll/epoll only reports data not yet read from the device.
+ * @param handle The address of a Wms_Serial_Handle_T containing the read buffer.
+ * @param terminator A NULL terminated string containing the characters that are at the end of a line.
+ * @return TRUE if a complete line is buffered, FALSE otherwise (or if handle or terminator is NULL).
+ * @see #Wms_Serial_Handle_T
+ * @see #Serial_Read_Buffer_Scan
+ */
+int Wms_Serial_Read_Line_Buffered(Wms_Serial_Handle_T *handle,char *terminator)
+{
+	if((handle == NULL)||(terminator == NULL)||(strlen(terminator) < 1))
+		return FALSE;
+	return (Serial_Read_Buffer_Scan(handle,terminator,strlen(terminator)) >= 0);
+}
+
+/* =======================================================
+** internal functions 
+** ======================================================= */
+/**
+ * Check a baud rate is one the serial library supports.
+ * This is a subset of all allowable values, man tcsetattr to see all of them.
+ * @param baud_rate The baud rate to check, a B* constant from termios.h.
+ * @return TRUE if the baud rate is supported, FALSE otherwise.
+ */
+static int Serial_Baud_Rate_Check(int baud_rate)
+{
+	return ((baud_rate == B1200)||(baud_rate == B1800)||(baud_rate == B2400)||(baud_rate == B4800)||
+		(baud_rate == B9600)||(baud_rate == B19200)||(baud_rate == B38400)||(baud_rate == B57600)||
+		(baud_rate == B115200));
+}
+
+/**
+ * Empty the handle's read buffer.
+ * @param handle The address of a Wms_Serial_Handle_T containing the read buffer.
+ * @see #Wms_Serial_Handle_T
+ */
+static void Serial_Read_Buffer_Reset(Wms_Serial_Handle_T *handle)
+{
+	handle->Read_Buffer_Start = 0;
+	handle->Read_Buffer_Count = 0;
+	handle->Read_Buffer_Scan_Count = 0;
+}
+
+/**
+ * Search the handle's read buffer for the terminator. Only bytes not searched by a previous call are examined,
+ * Read_Buffer_Scan_Count records how far we got.
+ * @param handle The address of a Wms_Serial_Handle_T containing the read buffer.
+ * @param terminator The terminator string to search for.
+ * @param terminator_length The length of the terminator string.
+ * @return The length of the first line in the buffer (including the terminator), or -1 if the buffer does not
+ *         contain a complete line.
+ * @see #Wms_Serial_Handle_T
+ * @see #WMS_SERIAL_READ_BUFFER_LENGTH
+ */
+static int Serial_Read_Buffer_Scan(Wms_Serial_Handle_T *handle,char *terminator,int terminator_length)
+{
+	int i,j;
+
+	for(i = handle->Read_Buffer_Scan_Count; i <= (handle->Read_Buffer_Count-terminator_length); i++)
+	{
+		for(j = 0; j < terminator_length; j++)
+		{
+			if(handle->Read_Buffer[(handle->Read_Buffer_Start+i+j)%WMS_SERIAL_READ_BUFFER_LENGTH] != 
+			   terminator[j])
+				break;
+		}
+		if(j == terminator_length)
+			return i+terminator_length;
+	}
+	handle->Read_Buffer_Scan_Count = i;
+	return -1;
+}
+
+/**
+ * Remove bytes from the front of the handle's read buffer.
+ * @param handle The address of a Wms_Serial_Handle_T containing the read buffer.
+ * @param message A buffer of at least length bytes to copy the removed bytes into, or NULL to discard them.
+ * @param length The number of bytes to remove, which must be no more than Read_Buffer_Count.
+ * @see #Wms_Serial_Handle_T
+ * @see #WMS_SERIAL_READ_BUFFER_LENGTH
+ */
+static void Serial_Read_Buffer_Extract(Wms_Serial_Handle_T *handle,char *message,int length)
+{
+	int first_length;
+
+	if(message != NULL)
+	{
+		first_length = WMS_SERIAL_READ_BUFFER_LENGTH-handle->Read_Buffer_Start;
+		if(first_length > length)
+			first_length = length;
+		memcpy(message,handle->Read_Buffer+handle->Read_Buffer_Start,first_length);
+		memcpy(message+first_length,handle->Read_Buffer,length-first_length);
+	}
+	handle->Read_Buffer_Start = (handle->Read_Buffer_Start+length)%WMS_SERIAL_READ_BUFFER_LENGTH;
+	handle->Read_Buffer_Count -= length;
+	handle->Read_Buffer_Scan_Count = 0;
+	if(handle->Read_Buffer_Count == 0)
+		handle->Read_Buffer_Start = 0;
+}
+
+/**
+ * Compute the absolute time (measured using CLOCK_MONOTONIC) timeout_ms milliseconds from now.
+ * @param timeout_ms The timeout in milliseconds.
+ * @param deadline The address of a timespec, on return filled in with the deadline.
+ * @see #ONE_SECOND_MS
+ */
+static void Serial_Deadline_Get(int timeout_ms,struct timespec *deadline)
+{
+	clock_gettime(CLOCK_MONOTONIC,deadline);
+	deadline->tv_sec += timeout_ms/ONE_SECOND_MS;
+	deadline->tv_nsec += (timeout_ms%ONE_SECOND_MS)*WMS_SERIAL_ONE_MILLISECOND_NS;
+	if(deadline->tv_nsec >= (ONE_SECOND_MS*WMS_SERIAL_ONE_MILLISECOND_NS))
+	{
+		deadline->tv_sec++;
+		deadline->tv_nsec -= (ONE_SECOND_MS*WMS_SERIAL_ONE_MILLISECOND_NS);
+	}
+}
+
+/**
+ * Wait until data is available to read from the serial device, or the deadline passes. 
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param handle The address of a Wms_Serial_Handle_T containing the serial device file descriptor.
+ * @param deadline The absolute time (measured using CLOCK_MONOTONIC) to stop waiting at.
+ * @param data_available The address of an integer, on a successful return this is TRUE if there is data to read,
+ *        and FALSE if the deadline passed.
+ * @return TRUE if succeeded, FALSE otherwise.
+ * @see #Wms_Serial_Handle_T
+ * @see #ONE_SECOND_MS
+ */
+static int Serial_Wait_For_Data(char *class,char *source,Wms_Serial_Handle_T *handle,struct timespec deadline,
+				int *data_available)
+{
+	struct pollfd poll_fd;
+	struct timespec current_time;
+	int poll_errno,retval,remaining_ms;
+
+	(*data_available) = FALSE;
+	do
+	{
+		clock_gettime(CLOCK_MONOTONIC,&current_time);
+		remaining_ms = ((deadline.tv_sec-current_time.tv_sec)*ONE_SECOND_MS)+
+			((deadline.tv_nsec-current_time.tv_nsec)/WMS_SERIAL_ONE_MILLISECOND_NS);
+		if(remaining_ms < 0)
+			remaining_ms = 0;
+		poll_fd.fd = handle->Serial_Fd;
+		poll_fd.events = POLLIN;
+		poll_fd.revents = 0;
+		retval = poll(&poll_fd,1,remaining_ms);
+		if(retval < 0)
+		{
+			poll_errno = errno;
+			if(poll_errno != EINTR)
+			{
+				Wms_Serial_Error_Number = 30;
+				sprintf(Wms_Serial_Error_String,"Serial_Wait_For_Data: poll failed (%d,%d = %s).",
+					handle->Serial_Fd,poll_errno,strerror(poll_errno));
+				return FALSE;
+			}
+		}
+	}
+	while((retval < 0)&&(remaining_ms > 0));
+	if(retval > 0)
+	{
+		if(poll_fd.revents & (POLLERR|POLLNVAL))
+		{
+			Wms_Serial_Error_Number = 31;
+			sprintf(Wms_Serial_Error_String,"Serial_Wait_For_Data: poll returned error events %#x (%d).",
+				poll_fd.revents,handle->Serial_Fd);
+			return FALSE;
+		}
+		(*data_available) = TRUE;
+	}
+	return TRUE;
+}
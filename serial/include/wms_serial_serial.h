@@ -11,6 +11,22 @@
  * The length of string to use for holding the name of the serial device.
  */
 #define WMS_SERIAL_DEVICE_NAME_STRING_LENGTH (256)
+/**
+ * The length of the per-handle ring buffer holding bytes read from the serial device, but not yet returned
+ * to the caller. This is also the longest line Wms_Serial_Read_Line can return.
+ */
+#define WMS_SERIAL_READ_BUFFER_LENGTH (1024)
+/**
+ * Value to pass as the timeout_ms parameter of Wms_Serial_Read and Wms_Serial_Read_Line, to use the handle's
+ * default read timeout (Read_Timeout).
+ */
+#define WMS_SERIAL_READ_TIMEOUT_DEFAULT (-1)
+/**
+ * Value to pass as the timeout_ms parameter of Wms_Serial_Read_Line, to read only the data already available
+ * without waiting. If there is no complete line, any partial line is left in the handle's read buffer.
+ * This is distinct from a timeout of 0 ms, which also does not wait, but fails if no complete line is available.
+ */
+#define WMS_SERIAL_READ_TIMEOUT_NONE    (-2)
 
 /* structures */
 /**
@@ -21,8 +37,23 @@
  * <li><b>Serial_Options_Saved</b> The saved set of serial options.
  * <li><b>Serial_Options</b> The set of serial options configured.
  * <li><b>Serial_Fd</b> The opened serial port's file descriptor.
+ * <li><b>Baud_Rate</b> The baud rate the serial port is configured with when opened: usually B19200 or B9600 
+ *     from termios.h.
+ * <li><b>Input_Flags</b> Flags to or into c_iflag when opened.
+ * <li><b>Output_Flags</b> Flags to or into c_oflag when opened.
+ * <li><b>Control_Flags</b> Flags to or into c_cflag when opened.
+ * <li><b>Local_Flags</b> Flags to or into c_lflag when opened.
+ * <li><b>Read_Timeout</b> The default time to wait for data in Wms_Serial_Read and Wms_Serial_Read_Line, 
+ *     in milliseconds.
+ * <li><b>Read_Buffer</b> A ring buffer of bytes read from the serial port, that have not yet been returned to the caller.
+ *     Maximum length WMS_SERIAL_READ_BUFFER_LENGTH.
+ * <li><b>Read_Buffer_Start</b> The index in Read_Buffer of the first byte not yet returned.
+ * <li><b>Read_Buffer_Count</b> The number of bytes in Read_Buffer not yet returned.
+ * <li><b>Read_Buffer_Scan_Count</b> The number of bytes (from Read_Buffer_Start) already searched for a 
+ *     line terminator, so each byte is only scanned once.
  * </ul>
  * @see #WMS_SERIAL_DEVICE_NAME_STRING_LENGTH
+ * @see #WMS_SERIAL_READ_BUFFER_LENGTH
  */
 typedef struct Wms_Serial_Handle_Struct
 {
@@ -30,22 +61,40 @@ typedef struct Wms_Serial_Handle_Struct
 	struct termios Serial_Options_Saved;
 	struct termios Serial_Options;
 	int Serial_Fd;
+	int Baud_Rate;
+	int Input_Flags;
+	int Output_Flags;
+	int Control_Flags;
+	int Local_Flags;
+	int Read_Timeout;
+	char Read_Buffer[WMS_SERIAL_READ_BUFFER_LENGTH];
+	int Read_Buffer_Start;
+	int Read_Buffer_Count;
+	int Read_Buffer_Scan_Count;
 } Wms_Serial_Handle_T;
 
-extern int Wms_Serial_Baud_Rate_Set(int baud_rate);
-extern int Wms_Serial_Input_Flags_Set(int flags);
-extern int Wms_Serial_Output_Flags_Set(int flags);
-extern int Wms_Serial_Control_Flags_Set(int flags);
-extern int Wms_Serial_Local_Flags_Set(int flags);
+extern int Wms_Serial_Handle_Initialise(Wms_Serial_Handle_T *handle);
+extern int Wms_Serial_Baud_Rate_Set(Wms_Serial_Handle_T *handle,int baud_rate);
+extern int Wms_Serial_Input_Flags_Set(Wms_Serial_Handle_T *handle,int flags);
+extern int Wms_Serial_Output_Flags_Set(Wms_Serial_Handle_T *handle,int flags);
+extern int Wms_Serial_Control_Flags_Set(Wms_Serial_Handle_T *handle,int flags);
+extern int Wms_Serial_Local_Flags_Set(Wms_Serial_Handle_T *handle,int flags);
+extern int Wms_Serial_Read_Timeout_Set(Wms_Serial_Handle_T *handle,int timeout_ms);
 
 extern int Wms_Serial_Open(char *class,char *source,Wms_Serial_Handle_T *handle);
 extern int Wms_Serial_Close(char *class,char *source,Wms_Serial_Handle_T *handle);
-extern int Wms_Serial_Write(char *class,char *source,Wms_Serial_Handle_T handle,void *message,
+extern int Wms_Serial_RS485_Set(char *class,char *source,Wms_Serial_Handle_T *handle,int enable,
+				int delay_after_send_ms);
+extern int Wms_Serial_Baud_Rate_Change(char *class,char *source,Wms_Serial_Handle_T *handle,int baud_rate);
+extern int Wms_Serial_Framing_Change(char *class,char *source,Wms_Serial_Handle_T *handle,int data_bits,
+				     char parity,int stop_bits);
+extern int Wms_Serial_Write(char *class,char *source,Wms_Serial_Handle_T *handle,void *message,
 			    size_t message_length);
-extern int Wms_Serial_Read(char *class,char *source,Wms_Serial_Handle_T handle,void *message,
-			   int message_length,int *bytes_read);
-extern int Wms_Serial_Read_Line(char *class,char *source,Wms_Serial_Handle_T handle,
-				char *terminator,char *message,int message_length,int *bytes_read);
+extern int Wms_Serial_Read(char *class,char *source,Wms_Serial_Handle_T *handle,void *message,
+			   int message_length,int timeout_ms,int *bytes_read);
+extern int Wms_Serial_Read_Line(char *class,char *source,Wms_Serial_Handle_T *handle,
+				char *terminator,char *message,int message_length,int timeout_ms,int *bytes_read);
+extern int Wms_Serial_Read_Line_Buffered(Wms_Serial_Handle_T *handle,char *terminator);
 
 
 #endif
@@ -62,6 +62,11 @@ int main(int argc, char *argv[])
 	if(!Parse_Arguments(argc,argv))
 		return 1;
 	/* open interface */
+	if(!Wms_Serial_Handle_Initialise(&serial_handle))
+	{
+		Wms_Serial_Error();
+		return 2;
+	}
 	strcpy(serial_handle.Device_Name,Serial_Device_Name);
 	if(!Wms_Serial_Open("Serial Listener","serial_listener.c",&serial_handle))
 	{
@@ -72,7 +77,8 @@ int main(int argc, char *argv[])
 	done = FALSE;
 	while(done == FALSE)
 	{
-		if(!Wms_Serial_Read_Line("Serial Listener","serial_listener.c",serial_handle,TERMINATOR_CRLF,message,255,&bytes_read))
+		if(!Wms_Serial_Read_Line("Serial Listener","serial_listener.c",&serial_handle,TERMINATOR_CRLF,message,255,
+					 WMS_SERIAL_READ_TIMEOUT_DEFAULT,&bytes_read))
 		{
 			Wms_Serial_Error();
 			Wms_Serial_Close("Serial Listener","serial_listener.c",&serial_handle);
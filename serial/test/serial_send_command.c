@@ -70,6 +70,11 @@ int main(int argc, char *argv[])
 		fprintf(stdout,"Serial Send Command: Specify a serial device filename.\n");
 		return 2;
 	}
+	if(!Wms_Serial_Handle_Initialise(&serial_handle))
+	{
+		Wms_Serial_Error();
+		return 2;
+	}
 	strcpy(serial_handle.Device_Name,Serial_Device_Name);
 	if(!Wms_Serial_Open("Serial Send Command","serial_send_command.c",&serial_handle))
 	{
@@ -84,7 +89,7 @@ int main(int argc, char *argv[])
 	}
 	strcpy(message,Command_String);
 	strcat(message,TERMINATOR_CRLF);
-	if(!Wms_Serial_Write("Serial Send Command","serial_send_command.c",serial_handle,
+	if(!Wms_Serial_Write("Serial Send Command","serial_send_command.c",&serial_handle,
 				    message,strlen(message)))
 	{
 		Wms_Serial_Error();
@@ -92,7 +97,8 @@ int main(int argc, char *argv[])
 		return 5;
 	}
 	/* read any reply */
-	if(!Wms_Serial_Read_Line("Serial Send Command","serial_send_command.c",serial_handle,TERMINATOR_CRLF,message,255,&bytes_read))
+	if(!Wms_Serial_Read_Line("Serial Send Command","serial_send_command.c",&serial_handle,TERMINATOR_CRLF,message,255,
+				 WMS_SERIAL_READ_TIMEOUT_DEFAULT,&bytes_read))
 	{
 		Wms_Serial_Error();
 		Wms_Serial_Close("Serial Send Command","serial_send_command.c",&serial_handle);
@@ -16,8 +16,10 @@
  */
 #define _POSIX_C_SOURCE 199309L
 
+#include <ctype.h>
 #include <errno.h>   /* Error number definitions */
 #include <math.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,29 +35,198 @@
  */
 #define TERMINATOR_CRLF         ("\r\n")
 /**
- * Length of the Keyword String in Wxt536_Parameter_Value_Struct.
- * @see #Wxt536_Parameter_Value_Struct
+ * Length of the message buffer used in Wms_Wxt536_Command to hold the command sent and the reply read. 
+ * This needs to be long enough to hold a composite data message (aR0) reply, which contains every data field.
+ * @see #Wms_Wxt536_Command
  */
-#define KEYWORD_LENGTH          (32)
+#define MESSAGE_LENGTH          (1024)
 /**
- * Length of the Value String in Wxt536_Parameter_Value_Struct.
- * @see #Wxt536_Parameter_Value_Struct
+ * The number of bits in a Wxt536 parameter selection (R) field, for one data message. The R field in the
+ * aWU/aTU/aRU/aSU/aIU settings contains two sets of bits, the first for the individual data message (aR1..aR5),
+ * the second for the composite data message (aR0).
+ */
+#define PARAMETER_SELECTION_BIT_COUNT (8)
+/**
+ * The maximum number of unsolicited data message lines (sent by a Wxt536 in automatic mode) 
+ * Wms_Wxt536_Command will discard whilst waiting for the reply to a command.
+ * @see #Wms_Wxt536_Command
+ */
+#define MAX_UNSOLICITED_LINE_COUNT (16)
+/**
+ * The maximum number of times Wms_Wxt536_Command will resend a command, when the reply fails it's CRC check.
+ * The command is sent at most MAX_CRC_RETRY_COUNT+1 times in all.
+ * @see #Wms_Wxt536_Command
+ */
+#define MAX_CRC_RETRY_COUNT     (1)
+/**
+ * The number of characters used to encode a Vaisala CRC at the end of a message.
+ */
+#define CRC_LENGTH              (3)
+/**
+ * The maximum number of keyword/value pairs Wxt536_Parse_CSV_Reply can parse from one reply. The composite data 
+ * message (aR0) with every parameter selected is the longest reply, with 26 parameters.
+ * @see #Wxt536_Parameter_List_Struct
+ * @see #Wxt536_Parse_CSV_Reply
+ */
+#define MAX_PARAMETER_COUNT     (32)
+/**
+ * The number of distinct keyword ids Wxt536_Keyword_Id_Get can return. Wxt536 keywords are an upper case letter,
+ * optionally followed by a lower case letter (e.g. "A", "Dn", "Ta"), giving 26*27 possible keywords.
+ * @see #Wxt536_Keyword_Id_Get
+ * @see #Wxt536_Parameter_List_Struct
  */
-#define VALUE_LENGTH            (128)
+#define KEYWORD_ID_COUNT        (26*27)
+/**
+ * The maximum number of digits Wxt536_Parse_Number accepts in a value. Up to this many digits the 
+ * mantissa is held exactly in a double, so the value is correctly rounded when it is scaled.
+ * @see #Wxt536_Parse_Number
+ * @see #Power_Of_Ten_List
+ */
+#define MAX_NUMBER_DIGIT_COUNT  (15)
+/**
+ * The number of individual data messages (aR1..aR5), and therefore the number of entries in 
+ * Message_Descriptor_List.
+ * @see #Message_Descriptor_List
+ */
+#define MESSAGE_DESCRIPTOR_COUNT (5)
+/**
+ * The length of the string fields in the data structures (e.g. Wxt536_Command_Supervisor_Data_Struct.Information).
+ * @see #Wxt536_Data_Decode
+ */
+#define FIELD_STRING_LENGTH     (256)
+/**
+ * Macro returning the offset of a field within a Wxt536_Command_Composite_Data_Struct, used to build the 
+ * data message descriptor tables.
+ * @param field The field, e.g. Wind_Data.Wind_Direction_Minimum.
+ * @see #Wxt536_Field_Descriptor_Struct
+ */
+#define WXT536_DATA_OFFSET(field) (offsetof(struct Wxt536_Command_Composite_Data_Struct,field))
+/**
+ * The number of serial settings in Probe_Setting_List.
+ * @see #Probe_Setting_List
+ */
+#define PROBE_SETTING_COUNT     (11)
+/**
+ * How many characters a probe and it's reply (e.g. "?" and "0", each with a CRLF terminator) take to send, 
+ * allowed for on top of the probe timeout.
+ * @see #Wxt536_Probe_Timeout_Get
+ */
+#define PROBE_REPLY_CHARACTER_COUNT (8)
 /* internal structures */
 /**
  * Structure to hold one keyword/value pair in the list of parameter values returned by a command.
+ * The pointers point into the reply string the pair was parsed from (which has been NULL terminated
+ * in place by Wxt536_Parse_CSV_Reply), so they are only valid whilst that reply string is.
  * <dl>
- * <dt>Keyword</dt> <dd>The keyword we are holding the value for, of length KEYWORD_LENGTH.</dd>
- * <dt>Value_String</dt> <dd>The value of the keyword, of length VALUE_LENGTH.</dd>
+ * <dt>Keyword</dt> <dd>The keyword we are holding the value for.</dd>
+ * <dt>Value_String</dt> <dd>The value of the keyword.</dd>
  * </dl>
- * @see #KEYWORD_LENGTH
- * @see #VALUE_LENGTH
+ * @see #Wxt536_Parse_CSV_Reply
  */
 struct Wxt536_Parameter_Value_Struct
 {
-	char Keyword[KEYWORD_LENGTH];
-	char Value_String[VALUE_LENGTH];
+	char *Keyword;
+	char *Value_String;
+};
+
+/**
+ * Structure holding the list of keyword/value pairs parsed from a reply by Wxt536_Parse_CSV_Reply, and an index 
+ * from keyword id to position in the list, so a parameter can be found without searching the list.
+ * <dl>
+ * <dt>Parameter_List</dt> <dd>The list of parsed keyword/value pairs.</dd>
+ * <dt>Parameter_Count</dt> <dd>The number of elements of Parameter_List in use.</dd>
+ * <dt>Keyword_Index</dt> <dd>For each keyword id (see Wxt536_Keyword_Id_Get), the index in Parameter_List of the
+ *     first parameter with that keyword, or -1 if the reply did not contain that keyword.</dd>
+ * </dl>
+ * @see #MAX_PARAMETER_COUNT
+ * @see #KEYWORD_ID_COUNT
+ * @see #Wxt536_Parameter_Value_Struct
+ * @see #Wxt536_Parse_CSV_Reply
+ * @see #Wxt536_Keyword_Id_Get
+ */
+struct Wxt536_Parameter_List_Struct
+{
+	struct Wxt536_Parameter_Value_Struct Parameter_List[MAX_PARAMETER_COUNT];
+	int Parameter_Count;
+	signed char Keyword_Index[KEYWORD_ID_COUNT];
+};
+
+/**
+ * Structure describing one set of serial settings the Wxt536 may be using, tried by Wms_Wxt536_Command_Comms_Probe.
+ * <dl>
+ * <dt>Baud_Rate</dt> <dd>The baud rate, e.g. 19200.</dd>
+ * <dt>Data_Bits</dt> <dd>The number of data bits, 7 or 8.</dd>
+ * <dt>Parity</dt> <dd>The parity, 'N', 'E' or 'O'.</dd>
+ * <dt>Stop_Bits</dt> <dd>The number of stop bits, 1 or 2.</dd>
+ * </dl>
+ * @see #Probe_Setting_List
+ * @see #Wms_Wxt536_Command_Comms_Probe
+ */
+struct Wxt536_Probe_Setting_Struct
+{
+	int Baud_Rate;
+	int Data_Bits;
+	char Parity;
+	int Stop_Bits;
+};
+
+/* enums */
+/**
+ * Enumeration describing how the value of a data message field is parsed.
+ * <ul>
+ * <li><b>FIELD_TYPE_DOUBLE</b> A number followed by a units character, parsed into a double.
+ * <li><b>FIELD_TYPE_STRING</b> A string, copied into a character array of length FIELD_STRING_LENGTH.
+ * </ul>
+ * @see #FIELD_STRING_LENGTH
+ * @see #Wxt536_Field_Descriptor_Struct
+ */
+enum Wxt536_Field_Type_Enum
+{
+	FIELD_TYPE_DOUBLE=0,FIELD_TYPE_STRING=1
+};
+
+/**
+ * Structure describing one field in a data message.
+ * <dl>
+ * <dt>Keyword</dt> <dd>The field's keyword, e.g. "Dn".</dd>
+ * <dt>Units</dt> <dd>For FIELD_TYPE_DOUBLE fields, a string containing the units characters allowed 
+ *     after the number.</dd>
+ * <dt>Type</dt> <dd>How to parse the field's value.</dd>
+ * <dt>Offset</dt> <dd>The offset of the field within a Wxt536_Command_Composite_Data_Struct.</dd>
+ * </dl>
+ * @see #Wxt536_Field_Type_Enum
+ * @see #WXT536_DATA_OFFSET
+ */
+struct Wxt536_Field_Descriptor_Struct
+{
+	char *Keyword;
+	char *Units;
+	enum Wxt536_Field_Type_Enum Type;
+	size_t Offset;
+};
+
+/**
+ * Structure describing one individual data message (aR1..aR5), and the data group it fills in.
+ * <dl>
+ * <dt>Data_Mask</dt> <dd>The data mask bit for the data group, e.g. WXT536_COMMAND_DATA_WIND.</dd>
+ * <dt>Offset</dt> <dd>The offset of the data group within a Wxt536_Command_Composite_Data_Struct.</dd>
+ * <dt>Size</dt> <dd>The size of the data group structure.</dd>
+ * <dt>Valid_Mask_Offset</dt> <dd>The offset of the data group's Valid_Mask within a 
+ *     Wxt536_Command_Composite_Data_Struct.</dd>
+ * <dt>Field_List</dt> <dd>The descriptors of the fields in the message, in the order the Wxt536 sends them.
+ *     A field's index in the list is it's bit in Valid_Mask.</dd>
+ * <dt>Field_Count</dt> <dd>The number of descriptors in Field_List (at most 32).</dd>
+ * </dl>
+ * @see #Wxt536_Field_Descriptor_Struct
+ */
+struct Wxt536_Message_Descriptor_Struct
+{
+	int Data_Mask;
+	size_t Offset;
+	size_t Size;
+	size_t Valid_Mask_Offset;
+	const struct Wxt536_Field_Descriptor_Struct *Field_List;
+	int Field_Count;
 };
 
 /* internal variables */
@@ -63,263 +234,595 @@ struct Wxt536_Parameter_Value_Struct
  * Revision Control System identifier.
  */
 static char rcsid[] = "$Id$";
+/**
+ * A boolean, TRUE if the Wxt536 is using one of the CRC protocols ('a' or 'p'). In this case, commands
+ * are sent with a lower case command letter and a CRC, and replies must have a valid CRC.
+ * This is set by Wms_Wxt536_Command_Comms_Settings_Protocol_Set, or can be set directly using 
+ * Wms_Wxt536_Command_CRC_Enable_Set. This is thread local, as it belongs with the calling thread's serial handle.
+ * It is the CRC use for the calling thread's current exchange: a caller talking to several Wxt536s (which may use
+ * different protocols) should keep each Wxt536's CRC use itself, and set it before each exchange.
+ * @see #Wms_Wxt536_Command_Comms_Settings_Protocol_Set
+ * @see #Wms_Wxt536_Command_CRC_Enable_Set
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Handle_Set
+ */
+static __thread int CRC_Enable = FALSE;
+/**
+ * The serial settings Wms_Wxt536_Command_Comms_Probe tries, most likely first: the factory default (19200 8N1),
+ * the other baud rates with 8N1, and then the 7E1 framings used by the SDI-12 interface 
+ * and some data loggers.
+ * @see #PROBE_SETTING_COUNT
+ * @see #Wxt536_Probe_Setting_Struct
+ * @see #Wms_Wxt536_Command_Comms_Probe
+ */
+static const struct Wxt536_Probe_Setting_Struct Probe_Setting_List[PROBE_SETTING_COUNT] = 
+{
+	{19200,8,'N',1},{9600,8,'N',1},{115200,8,'N',1},{57600,8,'N',1},{38400,8,'N',1},{4800,8,'N',1},
+	{2400,8,'N',1},{1200,8,'N',1},{19200,7,'E',1},{9600,7,'E',1},{1200,7,'E',1}
+};
+/**
+ * Lookup table used to calculate the Vaisala CRC-16 (polynomial 0xA001 (reflected 0x8005), initial value 0) 
+ * one byte at a time.
+ * @see #Wxt536_CRC_Calculate
+ */
+static const unsigned short CRC_Table[256] = 
+{
+	0x0000,0xc0c1,0xc181,0x0140,0xc301,0x03c0,0x0280,0xc241,
+	0xc601,0x06c0,0x0780,0xc741,0x0500,0xc5c1,0xc481,0x0440,
+	0xcc01,0x0cc0,0x0d80,0xcd41,0x0f00,0xcfc1,0xce81,0x0e40,
+	0x0a00,0xcac1,0xcb81,0x0b40,0xc901,0x09c0,0x0880,0xc841,
+	0xd801,0x18c0,0x1980,0xd941,0x1b00,0xdbc1,0xda81,0x1a40,
+	0x1e00,0xdec1,0xdf81,0x1f40,0xdd01,0x1dc0,0x1c80,0xdc41,
+	0x1400,0xd4c1,0xd581,0x1540,0xd701,0x17c0,0x1680,0xd641,
+	0xd201,0x12c0,0x1380,0xd341,0x1100,0xd1c1,0xd081,0x1040,
+	0xf001,0x30c0,0x3180,0xf141,0x3300,0xf3c1,0xf281,0x3240,
+	0x3600,0xf6c1,0xf781,0x3740,0xf501,0x35c0,0x3480,0xf441,
+	0x3c00,0xfcc1,0xfd81,0x3d40,0xff01,0x3fc0,0x3e80,0xfe41,
+	0xfa01,0x3ac0,0x3b80,0xfb41,0x3900,0xf9c1,0xf881,0x3840,
+	0x2800,0xe8c1,0xe981,0x2940,0xeb01,0x2bc0,0x2a80,0xea41,
+	0xee01,0x2ec0,0x2f80,0xef41,0x2d00,0xedc1,0xec81,0x2c40,
+	0xe401,0x24c0,0x2580,0xe541,0x2700,0xe7c1,0xe681,0x2640,
+	0x2200,0xe2c1,0xe381,0x2340,0xe101,0x21c0,0x2080,0xe041,
+	0xa001,0x60c0,0x6180,0xa141,0x6300,0xa3c1,0xa281,0x6240,
+	0x6600,0xa6c1,0xa781,0x6740,0xa501,0x65c0,0x6480,0xa441,
+	0x6c00,0xacc1,0xad81,0x6d40,0xaf01,0x6fc0,0x6e80,0xae41,
+	0xaa01,0x6ac0,0x6b80,0xab41,0x6900,0xa9c1,0xa881,0x6840,
+	0x7800,0xb8c1,0xb981,0x7940,0xbb01,0x7bc0,0x7a80,0xba41,
+	0xbe01,0x7ec0,0x7f80,0xbf41,0x7d00,0xbdc1,0xbc81,0x7c40,
+	0xb401,0x74c0,0x7580,0xb541,0x7700,0xb7c1,0xb681,0x7640,
+	0x7200,0xb2c1,0xb381,0x7340,0xb101,0x71c0,0x7080,0xb041,
+	0x5000,0x90c1,0x9181,0x5140,0x9301,0x53c0,0x5280,0x9241,
+	0x9601,0x56c0,0x5780,0x9741,0x5500,0x95c1,0x9481,0x5440,
+	0x9c01,0x5cc0,0x5d80,0x9d41,0x5f00,0x9fc1,0x9e81,0x5e40,
+	0x5a00,0x9ac1,0x9b81,0x5b40,0x9901,0x59c0,0x5880,0x9841,
+	0x8801,0x48c0,0x4980,0x8941,0x4b00,0x8bc1,0x8a81,0x4a40,
+	0x4e00,0x8ec1,0x8f81,0x4f40,0x8d01,0x4dc0,0x4c80,0x8c41,
+	0x4400,0x84c1,0x8581,0x4540,0x8701,0x47c0,0x4680,0x8641,
+	0x8201,0x42c0,0x4380,0x8341,0x4100,0x81c1,0x8081,0x4040
+};
+/**
+ * Powers of ten, used by Wxt536_Parse_Number to scale the mantissa of a parsed value by the number of digits after
+ * the decimal point. These are all exactly representable as doubles.
+ * @see #MAX_NUMBER_DIGIT_COUNT
+ * @see #Wxt536_Parse_Number
+ */
+static const double Power_Of_Ten_List[MAX_NUMBER_DIGIT_COUNT+1] = 
+{
+	1.0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,1.0e7,1.0e8,1.0e9,1.0e10,1.0e11,1.0e12,1.0e13,1.0e14,1.0e15
+};
+/**
+ * Descriptor table for the fields of the Wind Data Message (aR1), and the wind part of the composite data
+ * message (aR0).
+ * @see #Wxt536_Field_Descriptor_Struct
+ * @see #Message_Descriptor_List
+ */
+static const struct Wxt536_Field_Descriptor_Struct Wind_Field_List[] =
+{
+	{"Dn","D",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Wind_Data.Wind_Direction_Minimum)},
+	{"Dm","D",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Wind_Data.Wind_Direction_Average)},
+	{"Dx","D",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Wind_Data.Wind_Direction_Maximum)},
+	{"Sn","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Wind_Data.Wind_Speed_Minimum)},
+	{"Sm","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Wind_Data.Wind_Speed_Average)},
+	{"Sx","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Wind_Data.Wind_Speed_Maximum)}
+};
+/**
+ * Descriptor table for the fields of the Pressure/Temperature/Humidity Data Message (aR2), and the
+ * pressure/temperature/humidity part of the composite data message (aR0).
+ * @see #Wxt536_Field_Descriptor_Struct
+ * @see #Message_Descriptor_List
+ */
+static const struct Wxt536_Field_Descriptor_Struct Pressure_Temperature_Humidity_Field_List[] =
+{
+	{"Ta","C",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Pressure_Temperature_Humidity_Data.Air_Temperature)},
+	{"Ua","P",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Pressure_Temperature_Humidity_Data.Relative_Humidity)},
+	{"Pa","H",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Pressure_Temperature_Humidity_Data.Air_Pressure)}
+};
+/**
+ * Descriptor table for the fields of the Precipitation Data Message (aR3), and the precipitation part of the
+ * composite data message (aR0). The peak intensities (Rp,Hp) are not returned by our weather station, and are not
+ * selected in the composite data message by Wms_Wxt536_Command_Composite_Data_Configure, but are decoded if present.
+ * @see #Wxt536_Field_Descriptor_Struct
+ * @see #Message_Descriptor_List
+ */
+static const struct Wxt536_Field_Descriptor_Struct Precipitation_Field_List[] =
+{
+	{"Rc","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Precipitation_Data.Rain_Accumulation)},
+	{"Rd","s",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Precipitation_Data.Rain_Duration)},
+	{"Ri","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Precipitation_Data.Rain_Intensity)},
+	{"Hc","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Precipitation_Data.Hail_Accumulation)},
+	{"Hd","s",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Precipitation_Data.Hail_Duration)},
+	{"Hi","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Precipitation_Data.Hail_Intensity)},
+	{"Rp","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Precipitation_Data.Rain_Peak_Intensity)},
+	{"Hp","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Precipitation_Data.Hail_Peak_Intensity)}
+};
+/**
+ * Descriptor table for the fields of the Analog Data Message (aR4), and the analogue part of the composite data
+ * message (aR0).
+ * @see #Wxt536_Field_Descriptor_Struct
+ * @see #Message_Descriptor_List
+ */
+static const struct Wxt536_Field_Descriptor_Struct Analogue_Field_List[] =
+{
+	{"Tr","C",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Analogue_Data.PT1000_Temperaure)},
+	{"Ra","M",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Analogue_Data.Aux_Rain_Accumulation)},
+	{"Sl","V",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Analogue_Data.Ultrasonic_Level_Voltage)},
+	{"Sr","V",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Analogue_Data.Solar_Radiation_Voltage)}
+};
+/**
+ * Descriptor table for the fields of the Supervisor Data Message (aR5), and the supervisor part of the composite
+ * data message (aR0). The heating voltage units character reflects the heating state: 'N' when the heater is off,
+ * 'V', 'W' or 'F' when it is on. The information field (Id) does not seem to be returned by our unit, and is not
+ * selected in the composite data message by Wms_Wxt536_Command_Composite_Data_Configure, but is decoded if present.
+ * @see #Wxt536_Field_Descriptor_Struct
+ * @see #Message_Descriptor_List
+ */
+static const struct Wxt536_Field_Descriptor_Struct Supervisor_Field_List[] =
+{
+	{"Th","C",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Supervisor_Data.Heating_Temperaure)},
+	{"Vh","NVWF",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Supervisor_Data.Heating_Voltage)},
+	{"Vs","V",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Supervisor_Data.Supply_Voltage)},
+	{"Vr","V",FIELD_TYPE_DOUBLE,WXT536_DATA_OFFSET(Supervisor_Data.Reference_Voltage)},
+	{"Id",NULL,FIELD_TYPE_STRING,WXT536_DATA_OFFSET(Supervisor_Data.Information)}
+};
+/**
+ * Descriptor table for the individual data messages, indexed by message id - 1 (i.e. aR1..aR5). The composite data
+ * message (aR0) can contain the fields of any of them. Each field list is in the same order as the data group's
+ * field enumeration (e.g. Wxt536_Command_Wind_Field_Enum), so a field's index is it's Valid_Mask bit.
+ * @see #MESSAGE_DESCRIPTOR_COUNT
+ * @see #Wxt536_Message_Descriptor_Struct
+ * @see #Wind_Field_List
+ * @see #Pressure_Temperature_Humidity_Field_List
+ * @see #Precipitation_Field_List
+ * @see #Analogue_Field_List
+ * @see #Supervisor_Field_List
+ * @see #Wxt536_Data_Decode
+ */
+static const struct Wxt536_Message_Descriptor_Struct Message_Descriptor_List[MESSAGE_DESCRIPTOR_COUNT] =
+{
+	{WXT536_COMMAND_DATA_WIND,WXT536_DATA_OFFSET(Wind_Data),sizeof(struct Wxt536_Command_Wind_Data_Struct),
+	 WXT536_DATA_OFFSET(Wind_Data.Valid_Mask),Wind_Field_List,sizeof(Wind_Field_List)/sizeof(Wind_Field_List[0])},
+	{WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY,WXT536_DATA_OFFSET(Pressure_Temperature_Humidity_Data),
+	 sizeof(struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct),
+	 WXT536_DATA_OFFSET(Pressure_Temperature_Humidity_Data.Valid_Mask),Pressure_Temperature_Humidity_Field_List,
+	 sizeof(Pressure_Temperature_Humidity_Field_List)/sizeof(Pressure_Temperature_Humidity_Field_List[0])},
+	{WXT536_COMMAND_DATA_PRECIPITATION,WXT536_DATA_OFFSET(Precipitation_Data),
+	 sizeof(struct Wxt536_Command_Precipitation_Data_Struct),WXT536_DATA_OFFSET(Precipitation_Data.Valid_Mask),
+	 Precipitation_Field_List,sizeof(Precipitation_Field_List)/sizeof(Precipitation_Field_List[0])},
+	{WXT536_COMMAND_DATA_ANALOGUE,WXT536_DATA_OFFSET(Analogue_Data),sizeof(struct Wxt536_Command_Analogue_Data_Struct),
+	 WXT536_DATA_OFFSET(Analogue_Data.Valid_Mask),Analogue_Field_List,sizeof(Analogue_Field_List)/sizeof(Analogue_Field_List[0])},
+	{WXT536_COMMAND_DATA_SUPERVISOR,WXT536_DATA_OFFSET(Supervisor_Data),
+	 sizeof(struct Wxt536_Command_Supervisor_Data_Struct),WXT536_DATA_OFFSET(Supervisor_Data.Valid_Mask),
+	 Supervisor_Field_List,sizeof(Supervisor_Field_List)/sizeof(Supervisor_Field_List[0])}
+};
 
 /* internal function declarations */
 static int Wxt536_Parse_CSV_Reply(char *class,char *source,char *reply_string,
-				  struct Wxt536_Parameter_Value_Struct **parameter_value_list,
-				  int *parameter_value_count);
+				  struct Wxt536_Parameter_List_Struct *parameter_list);
+static int Wxt536_Keyword_Id_Get(char *keyword);
+static struct Wxt536_Parameter_Value_Struct *Wxt536_Parameter_Find(char *keyword,
+								  struct Wxt536_Parameter_List_Struct *parameter_list);
 static int Wxt536_Parse_Parameter(char *class,char *source,char *keyword,char *format,
-				  struct Wxt536_Parameter_Value_Struct *parameter_value_list,
-				  int parameter_value_count,void *data_ptr);
+				  struct Wxt536_Parameter_List_Struct *parameter_list,void *data_ptr);
+static int Wxt536_Parse_Number(char *class,char *source,char *value_string,char *units,double *value);
+static int Wxt536_Data_Get(char *class,char *source,char device_address,int message_id,
+			   struct Wxt536_Command_Composite_Data_Struct *data,int *data_mask);
+static int Wxt536_Data_Decode(char *class,char *source,char *message,int message_id,
+			      struct Wxt536_Command_Composite_Data_Struct *data,int *data_mask);
+static int Wxt536_Composite_Parameter_Selection_Set(char *class,char *source,char device_address,
+						    char *settings_command,char *composite_selection);
+static void Wxt536_Parameter_Selection_Strip(char *selection_string);
+static int Wxt536_Data_Message_Id_Get(char *message_string);
+static unsigned short Wxt536_CRC_Calculate(char *string,int length);
+static void Wxt536_CRC_Encode(unsigned short crc,char *crc_string);
+static void Wxt536_CRC_Add(char *command_string);
+static int Wxt536_CRC_Check(char *class,char *source,char *message);
+static int Wxt536_Probe_Setting_Set(char *class,char *source,const struct Wxt536_Probe_Setting_Struct *setting);
+static int Wxt536_Probe_Timeout_Get(const struct Wxt536_Probe_Setting_Struct *setting,int timeout_ms);
+static int Wxt536_Command_Timeout(char *class,char *source,char *command_string,char *reply_string,
+				  int reply_string_length,int timeout_ms);
+static int Wxt536_Device_Address_Get_Timeout(char *class,char *source,int timeout_ms,char *device_address);
+static int Wxt536_Ack_Active_Timeout(char *class,char *source,char device_address,int timeout_ms);
 
 /* external functions */
 /**
  * Basic routine to send a string command to the Vaisala Wxt536 over a previously opened connection, 
- * and wait for a reply string.
+ * and wait for a reply string. If the Wxt536 is in automatic mode, it may send data messages at any time,
+ * so reply lines that are data messages (aR0..aR5) not requested by this command are discarded 
+ * (up to MAX_UNSOLICITED_LINE_COUNT of them). If CRC_Enable is set, the command is sent with a CRC 
+ * (using Wxt536_CRC_Add), and each reply line has it's CRC checked and removed (using Wxt536_CRC_Check). 
+ * If a reply line fails it's CRC check, the command is resent at once (up to MAX_CRC_RETRY_COUNT times), 
+ * rather than parsing a corrupt reply. Each reply line is waited for for the connection's default read timeout.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
  * @param The command to send to the Vaisala Wxt536, as a NULL terminated string. The standard CRLF terminator
  *        will be added to this string before onward transmission to the Wxt536.
  * @param reply_string An empty string, on return this is filled with any reply received from the Wxt536.
- * @param reply_string_length The allocated length of the reply_string buffer.
+ *        The reply is read directly into this buffer, or NULL if no reply is expected.
+ * @param reply_string_length The allocated length of the reply_string buffer. Replies that do not fit fail to be read.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
  * @see #TERMINATOR_CRLF
- * @see wms_wxt536_connection.html#Wms_Wxt536_Serial_Handle
- * @see wms_wxt536_general.html#Wms_Wxt536_Log
+ * @see #MAX_UNSOLICITED_LINE_COUNT
+ * @see #MAX_CRC_RETRY_COUNT
+ * @see #CRC_Enable
+ * @see #Wxt536_Command_Timeout
+ * @see ../../serial/cdocs/wms_serial_serial.html#WMS_SERIAL_READ_TIMEOUT_DEFAULT
+ */
+int Wms_Wxt536_Command(char *class,char *source,char *command_string,char *reply_string,int reply_string_length)
+{
+	return Wxt536_Command_Timeout(class,source,command_string,reply_string,reply_string_length,
+				      WMS_SERIAL_READ_TIMEOUT_DEFAULT);
+}
+
+/**
+ * Command to retrieve the Device Address of a Wxt536 on the connected serial port.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The address of a character. If the procedure is successful, on return this will contain
+ *        the device_address character of the Wxt536 on the connected serial port.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wxt536_Device_Address_Get_Timeout
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+int Wms_Wxt536_Command_Device_Address_Get(char *class,char *source,char *device_address)
+{
+	return Wxt536_Device_Address_Get_Timeout(class,source,WMS_SERIAL_READ_TIMEOUT_DEFAULT,device_address);
+}
+
+/**
+ * Command to check the  Wxt536 with the specified device_address is active on the connected serial port.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wxt536_Ack_Active_Timeout
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+int Wms_Wxt536_Command_Ack_Active(char *class,char *source,char device_address)
+{
+	return Wxt536_Ack_Active_Timeout(class,source,device_address,WMS_SERIAL_READ_TIMEOUT_DEFAULT);
+}
+
+/**
+ * Command to find the Wxt536s on the connected serial port, by checking whether a Wxt536 is active at each 
+ * possible device address (WXT536_COMMAND_DEVICE_ADDRESS_LIST) in turn, using Wms_Wxt536_Command_Ack_Active. 
+ * This is used to enumerate several Wxt536s sharing an RS-485 bus (where the '?' command used by 
+ * Wms_Wxt536_Command_Device_Address_Get would be answered by every device at once). Addresses that do not reply 
+ * within timeout_ms are skipped, so the scan takes about 
+ * (WXT536_COMMAND_DEVICE_ADDRESS_COUNT - number of devices found) * timeout_ms.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param timeout_ms How long to wait for each device address to reply, in milliseconds. The connection's default 
+ *        read timeout is not changed.
+ * @param device_address_list A character array, on return filled with the device addresses of the Wxt536s found.
+ *        This should be at least WXT536_COMMAND_DEVICE_ADDRESS_COUNT characters long.
+ * @param device_address_list_length The number of characters that can be stored in device_address_list.
+ * @param device_count The address of an integer, on return set to the number of device addresses
+ *        in device_address_list.
+ * @return The procedure returns TRUE if successful (even if no Wxt536s were found), and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #WXT536_COMMAND_DEVICE_ADDRESS_LIST
+ * @see #WXT536_COMMAND_DEVICE_ADDRESS_COUNT
+ * @see #Wxt536_Ack_Active_Timeout
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
- * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Write
- * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Line
  */
-int Wms_Wxt536_Command(char *class,char *source,char *command_string,char *reply_string,int reply_string_length)
+int Wms_Wxt536_Command_Device_Address_Scan(char *class,char *source,int timeout_ms,char *device_address_list,
+					   int device_address_list_length,int *device_count)
 {
-	char message[256];
-	int bytes_read;
-	
+	char *address_list = WXT536_COMMAND_DEVICE_ADDRESS_LIST;
+	int i;
+
 	Wms_Wxt536_Error_Number = 0;
-	if(command_string == NULL)
+	if(device_address_list == NULL)
 	{
-		Wms_Wxt536_Error_Number = 100;
-		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:Command String was NULL.");
+		Wms_Wxt536_Error_Number = 163;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Device_Address_Scan:device_address_list was NULL.");
 		return FALSE;
-		
 	}
-	if(strlen(command_string) >= 256)
+	if(device_count == NULL)
 	{
-		Wms_Wxt536_Error_Number = 101;
-		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:Command String was too long (%lu vs 255).",
-			strlen(command_string));
+		Wms_Wxt536_Error_Number = 164;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Device_Address_Scan:device_count was NULL.");
 		return FALSE;
-		
 	}
-#if LOGGING > 9
-	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Wxt536_Command(%s) started.",command_string);
-#endif /* LOGGING */
-	strcpy(message,command_string);
-	strcat(message,TERMINATOR_CRLF);
-	if(!Wms_Serial_Write(class,source,Wms_Wxt536_Serial_Handle,message,strlen(message)))
+	if(timeout_ms < 1)
 	{
-		Wms_Wxt536_Error_Number = 102;
-		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:Failed to write command string '%s'.",
-			command_string);
+		Wms_Wxt536_Error_Number = 165;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Device_Address_Scan:Illegal timeout %d ms.",
+			timeout_ms);
 		return FALSE;
 	}
-	/* read any reply */
-	if(reply_string != NULL)
+	(*device_count) = 0;
+	for(i = 0; i < WXT536_COMMAND_DEVICE_ADDRESS_COUNT; i++)
 	{
-		if(!Wms_Serial_Read_Line(class,source,Wms_Wxt536_Serial_Handle,TERMINATOR_CRLF,message,255,&bytes_read))
+		if(Wxt536_Ack_Active_Timeout(class,source,address_list[i],timeout_ms))
 		{
-			Wms_Wxt536_Error_Number = 103;
-			sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:Failed to read reply line.");
-			return FALSE;
+#if LOGGING > 1
+			Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,
+					      "Wms_Wxt536_Command_Device_Address_Scan:Found Wxt536 at device address '%c'.",
+					      address_list[i]);
+#endif /* LOGGING */
+			if((*device_count) >= device_address_list_length)
+			{
+				Wms_Wxt536_Error_Number = 166;
+				sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Device_Address_Scan:"
+					"Too many Wxt536s found (%d).",(*device_count)+1);
+				return FALSE;
+			}
+			device_address_list[(*device_count)++] = address_list[i];
 		}
-		message[bytes_read] = '\0';
-		if(strlen(message) >= reply_string_length)
+		else if(Wms_Wxt536_Error_Number == 102)
 		{
-			Wms_Wxt536_Error_Number = 104;
-			sprintf(Wms_Wxt536_Error_String,
-				"Wms_Wxt536_Command:Reply message was too long to fit into reply string (%lu vs %d).",
-				strlen(message),reply_string_length);
+			/* failing to write the command is a real error, rather than no device at this address */
 			return FALSE;
 		}
-		strcpy(reply_string,message);
-#if LOGGING > 9
-		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Wxt536_Command(%s) returned reply '%s'.",
-				      command_string,reply_string);
-#endif /* LOGGING */
-	}/* end if reply string was not NULL */
-#if LOGGING > 9
-	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Wxt536_Command(%s) finished.",command_string);
-#endif /* LOGGING */
+	}
+	Wms_Wxt536_Error_Number = 0;
 	return TRUE;
 }
 
 /**
- * Command to retrieve the Device Address of a Wxt536 on the connected serial port.
+ * Routine to find the serial settings and protocol a Wxt536 is using, for instance after it has been power cycled
+ * or reconfigured by hand. Each serial setting in Probe_Setting_List is tried in turn (most likely first): 
+ * the connection is switched to the setting, and a short probe sent, which the Wxt536 answers whatever 
+ * protocol it is using. If device_address is '?', the probe is a device address query ('?'), which only works with 
+ * one Wxt536 on the serial link. Otherwise, the probe is an acknowledge active command ('a') to that device address.
+ * Each probe waits timeout_ms milliseconds (plus the time the reply takes to send at the probed baud rate) 
+ * for a reply, so the whole probe is quick even if the Wxt536 is using the last setting in the list.
+ * Settings the serial port cannot use are skipped.
+ * Once the Wxt536 replies, it's communication settings are retrieved using Wms_Wxt536_Command_Comms_Settings_Get
+ * (with the connection's normal read timeout), first without a CRC, and then with a CRC (the CRC protocols only 
+ * answer commands with a CRC). CRC_Enable is set to match the protocol the Wxt536 is using.
+ * On success, the connection is left using the Wxt536's serial settings. On failure, the connection is put back
+ * to the first setting in Probe_Setting_List (the Wxt536 factory default).
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
- * @param device_address The address of a character. If the procedure is successful, on return this will contain
- *        the device_address character of the Wxt536 on the connected serial port.
+ * @param device_address The device address of the Wxt536 to probe for, or '?' to probe for a single Wxt536 at 
+ *        any device address.
+ * @param timeout_ms How long to wait for a reply to each probe, in milliseconds, on top of the time the reply takes
+ *        to send. This should be much shorter than the connection's normal read timeout.
+ * @param comms_settings The address of a Wxt536_Command_Comms_Settings_Struct structure, on success filled in 
+ *        with the Wxt536's communication settings (including it's Address, Protocol, Baud_Rate, Data_Bits, 
+ *        Parity and Stop_Bits).
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
- * @see #Wms_Wxt536_Command
- * @see wms_wxt536_general.html#Wms_Wxt536_Log
+ * @see #PROBE_SETTING_COUNT
+ * @see #Probe_Setting_List
+ * @see #CRC_Enable
+ * @see #Wxt536_Probe_Setting_Set
+ * @see #Wxt536_Probe_Timeout_Get
+ * @see #Wxt536_Device_Address_Get_Timeout
+ * @see #Wxt536_Ack_Active_Timeout
+ * @see #Wms_Wxt536_Command_Comms_Settings_Get
+ * @see #Wxt536_Command_Comms_Settings_Struct
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
  */
-int Wms_Wxt536_Command_Device_Address_Get(char *class,char *source,char *device_address)
+int Wms_Wxt536_Command_Comms_Probe(char *class,char *source,char device_address,int timeout_ms,
+				   struct Wxt536_Command_Comms_Settings_Struct *comms_settings)
 {
-	char reply_string[256];
-	int retval;
+	char found_device_address;
+	int probe_timeout,i,found;
 
 	Wms_Wxt536_Error_Number = 0;
-	if(device_address == NULL)
+	if(comms_settings == NULL)
 	{
-		Wms_Wxt536_Error_Number = 105;
-		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Device_Address_Get:device_address was NULL.");
+		Wms_Wxt536_Error_Number = 174;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Probe:comms_settings was NULL.");
 		return FALSE;
 	}
-	if(!Wms_Wxt536_Command(class,source,"?",reply_string,255))
+	if(timeout_ms < 1)
+	{
+		Wms_Wxt536_Error_Number = 175;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Probe:Illegal timeout %d ms.",timeout_ms);
 		return FALSE;
-	retval = sscanf(reply_string,"%c",device_address);
-	if(retval != 1)
+	}
+	found = FALSE;
+	for(i = 0; (i < PROBE_SETTING_COUNT)&&(found == FALSE); i++)
 	{
-		Wms_Wxt536_Error_Number = 106;
-		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Device_Address_Get:"
-			"Failed to parse device address from reply string '%s'.",reply_string);
-		return FALSE;		
+#if LOGGING > 5
+		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,
+				      "Wms_Wxt536_Command_Comms_Probe:Probing for '%c' at %d %d%c%d.",device_address,
+				      Probe_Setting_List[i].Baud_Rate,Probe_Setting_List[i].Data_Bits,
+				      Probe_Setting_List[i].Parity,Probe_Setting_List[i].Stop_Bits);
+#endif /* LOGGING */
+		if(!Wxt536_Probe_Setting_Set(class,source,&(Probe_Setting_List[i])))
+		{
+			/* the serial port may not support every setting, try the next one */
+#if LOGGING > 1
+			Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,
+					      "Wms_Wxt536_Command_Comms_Probe:Skipping %d %d%c%d:%s",
+					      Probe_Setting_List[i].Baud_Rate,Probe_Setting_List[i].Data_Bits,
+					      Probe_Setting_List[i].Parity,Probe_Setting_List[i].Stop_Bits,
+					      Wms_Wxt536_Error_String);
+#endif /* LOGGING */
+			continue;
+		}
+		probe_timeout = Wxt536_Probe_Timeout_Get(&(Probe_Setting_List[i]),timeout_ms);
+		if(device_address == '?')
+		{
+			found = (Wxt536_Device_Address_Get_Timeout(class,source,probe_timeout,&found_device_address)&&
+				 (strchr(WXT536_COMMAND_DEVICE_ADDRESS_LIST,found_device_address) != NULL)&&
+				 Wxt536_Ack_Active_Timeout(class,source,found_device_address,probe_timeout));
+		}
+		else
+		{
+			found_device_address = device_address;
+			found = Wxt536_Ack_Active_Timeout(class,source,found_device_address,probe_timeout);
+		}
+		if((found == FALSE)&&(Wms_Wxt536_Error_Number == 102))
+		{
+			/* failing to write the command is a real error, rather than the wrong serial settings */
+			return FALSE;
+		}
 	}
+	if(found == FALSE)
+	{
+		Wxt536_Probe_Setting_Set(class,source,&(Probe_Setting_List[0]));
+		Wms_Wxt536_Error_Number = 176;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Probe:"
+			"Wxt536 '%c' did not reply at any of %d serial settings.",device_address,PROBE_SETTING_COUNT);
+		return FALSE;
+	}
+	/* i has been incremented past the setting that worked. Get the protocol, without and then with a CRC */
+	i--;
+	CRC_Enable = FALSE;
+	if(!Wms_Wxt536_Command_Comms_Settings_Get(class,source,found_device_address,comms_settings))
+	{
+		CRC_Enable = TRUE;
+		if(!Wms_Wxt536_Command_Comms_Settings_Get(class,source,found_device_address,comms_settings))
+		{
+			CRC_Enable = FALSE;
+			Wms_Wxt536_Error_Number = 177;
+			sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Probe:"
+				"Failed to get the communication settings of Wxt536 '%c' at %d %d%c%d.",
+				found_device_address,Probe_Setting_List[i].Baud_Rate,Probe_Setting_List[i].Data_Bits,
+				Probe_Setting_List[i].Parity,Probe_Setting_List[i].Stop_Bits);
+			return FALSE;
+		}
+	}
+	CRC_Enable = ((comms_settings->Protocol == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_AUTOMATIC_CRC)||
+		      (comms_settings->Protocol == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_POLLED_CRC));
+#if LOGGING > 1
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,
+			      "Wms_Wxt536_Command_Comms_Probe:Found Wxt536 '%c' at %d %d%c%d using protocol '%c'.",
+			      found_device_address,Probe_Setting_List[i].Baud_Rate,Probe_Setting_List[i].Data_Bits,
+			      Probe_Setting_List[i].Parity,Probe_Setting_List[i].Stop_Bits,comms_settings->Protocol);
+#endif /* LOGGING */
 	return TRUE;
 }
 
 /**
- * Command to check the  Wxt536 with the specified device_address is active on the connected serial port.
+ * Send the Wxt536 with the specified device_address a command to retrieve it's current communication settings, 
+ * and parse it's reply using Wms_Wxt536_Command_Comms_Settings_Parse.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
  * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param comms_settings The address of a Wxt536_Command_Comms_Settings_Struct structure to fill in the parsed reply.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
  * @see #Wms_Wxt536_Command
- * @see wms_wxt536_general.html#Wms_Wxt536_Log
- * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see #Wms_Wxt536_Command_Comms_Settings_Parse
+ * @see #Wxt536_Command_Comms_Settings_Struct
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
  */
-int Wms_Wxt536_Command_Ack_Active(char *class,char *source,char device_address)
+int Wms_Wxt536_Command_Comms_Settings_Get(char *class,char *source,char device_address,
+					  struct Wxt536_Command_Comms_Settings_Struct *comms_settings)
 {
 	char command_string[256];
 	char reply_string[256];
-	char reply_device_address;
-	int retval;
 
 	Wms_Wxt536_Error_Number = 0;
-	sprintf(command_string,"%c",device_address);
-	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
-		return FALSE;
-	retval = sscanf(reply_string,"%c",&reply_device_address);
-	if(retval != 1)
-	{
-		Wms_Wxt536_Error_Number = 107;
-		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Ack_Active:"
-			"Failed to parse device address from reply string '%s'.",reply_string);
-		return FALSE;		
-	}
-	if(device_address != reply_device_address)
+	if(comms_settings == NULL)
 	{
-		Wms_Wxt536_Error_Number = 108;
-		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Ack_Active:"
-			"Returned device address differed from command: '%c' vs '%c'  ('%s').",
-			device_address,reply_device_address,reply_string);
+		Wms_Wxt536_Error_Number = 118;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Get:comms_settings was NULL.");
 		return FALSE;		
 	}
-	return TRUE;	
+	sprintf(command_string,"%cXU",device_address);
+	/* send the command and get the reply string */
+	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
+		return FALSE;
+	return Wms_Wxt536_Command_Comms_Settings_Parse(class,source,reply_string,comms_settings);
 }
 
 /**
- * Send the Wxt536 with the specified device_address a command to retrieve it's current communication settings, 
- * and parse it's reply.
+ * Parse a Wxt536's reply to the communication settings command (aXU), e.g.
+ * "0XU,A=0,M=P,T=1,C=3,I=0,B=19200,D=8,P=N,S=1,L=25,N=WXT530,V=3.86,H=0". This is used by 
+ * Wms_Wxt536_Command_Comms_Settings_Get, and by callers that send the command and read the reply themselves.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
- * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param reply_string The reply to parse. This is tokenised in place, so it's contents are changed.
  * @param comms_settings The address of a Wxt536_Command_Comms_Settings_Struct structure to fill in the parsed reply.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
- * @see #Wms_Wxt536_Command
  * @see #Wxt536_Command_Comms_Settings_Struct
  * @see #Wxt536_Parameter_Value_Struct
  * @see #Wxt536_Parse_CSV_Reply
  * @see #Wxt536_Parse_Parameter
- * @see wms_wxt536_general.html#Wms_Wxt536_Log
- * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
  */
-int Wms_Wxt536_Command_Comms_Settings_Get(char *class,char *source,char device_address,
-					  struct Wxt536_Command_Comms_Settings_Struct *comms_settings)
+int Wms_Wxt536_Command_Comms_Settings_Parse(char *class,char *source,char *reply_string,
+					    struct Wxt536_Command_Comms_Settings_Struct *comms_settings)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
-	char command_string[256];
-	char reply_string[256];
-	int parameter_value_count;
+	struct Wxt536_Parameter_List_Struct parameter_list;
 
 	Wms_Wxt536_Error_Number = 0;
 	if(comms_settings == NULL)
 	{
-		Wms_Wxt536_Error_Number = 118;
-		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Get:comms_settings was NULL.");
+		Wms_Wxt536_Error_Number = 183;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Parse:comms_settings was NULL.");
 		return FALSE;		
 	}
-	sprintf(command_string,"%cXU",device_address);
-	/* send the command and get the reply string */
-	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
-		return FALSE;
 	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
 		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
+	/* Extract the relevant parameters from the parameter_list, parse them and store them in the
 	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"A","%c",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"A","%c",&parameter_list,
 				   &(comms_settings->Address)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"M","%c",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"M","%c",&parameter_list,
 				   &(comms_settings->Protocol)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"C","%c",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"C","%c",&parameter_list,
 				   &(comms_settings->Serial_Interface)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"I","%d",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"I","%d",&parameter_list,
 				   &(comms_settings->Composite_Repeat_Interval)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"B","%d",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"B","%d",&parameter_list,
 				   &(comms_settings->Baud_Rate)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"D","%d",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"D","%d",&parameter_list,
 				   &(comms_settings->Data_Bits)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"P","%c",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"P","%c",&parameter_list,
 				   &(comms_settings->Parity)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"S","%d",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"S","%d",&parameter_list,
 				   &(comms_settings->Stop_Bits)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"L","%d",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"L","%d",&parameter_list,
 				   &(comms_settings->RS485_Line_Delay)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"N","%256s",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"N","%256s",&parameter_list,
 				   &(comms_settings->Device_Name)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"V","%256s",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"V","%256s",&parameter_list,
 				   &(comms_settings->Software_Version)))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"H","%d",parameter_value_list,parameter_value_count,
+	if(!Wxt536_Parse_Parameter(class,source,"H","%d",&parameter_list,
 				   &(comms_settings->Parameter_Locking)))
 		return FALSE;
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);
        	return TRUE;
 }
 
@@ -348,10 +851,9 @@ int Wms_Wxt536_Command_Comms_Settings_Get(char *class,char *source,char device_a
  */
 int Wms_Wxt536_Command_Comms_Settings_Protocol_Set(char *class,char *source,char device_address,char protocol)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
+	struct Wxt536_Parameter_List_Struct parameter_list;
 	char command_string[256];
 	char reply_string[256];
-	int parameter_value_count;
 
 	Wms_Wxt536_Error_Number = 0;
 	if((protocol != WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_AUTOMATIC)&&
@@ -369,33 +871,34 @@ int Wms_Wxt536_Command_Comms_Settings_Protocol_Set(char *class,char *source,char
 	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
 		return FALSE;
 	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
 		return FALSE;
 	/* there should be one reply parameter, M=protocol */
-	if(parameter_value_count != 1)
+	if(parameter_list.Parameter_Count != 1)
 	{
 		Wms_Wxt536_Error_Number = 120;
 		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Protocol_Set:"
-			"Wrong number of reply parameters in reply (%d vd 1).",parameter_value_count);
+			"Wrong number of reply parameters in reply (%d vd 1).",parameter_list.Parameter_Count);
 		return FALSE;		
 	}
-	if(strcmp(parameter_value_list[0].Keyword,"M") != 0)
+	if(strcmp(parameter_list.Parameter_List[0].Keyword,"M") != 0)
 	{
 		Wms_Wxt536_Error_Number = 121;
 		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Protocol_Set:"
-			"Wrong reply parameter keyword ('%s' vd 'M').",parameter_value_list[0].Keyword);
+			"Wrong reply parameter keyword ('%s' vd 'M').",parameter_list.Parameter_List[0].Keyword);
 		return FALSE;		
 	}
-	if(parameter_value_list[0].Value_String[0] != protocol)
+	if(parameter_list.Parameter_List[0].Value_String[0] != protocol)
 	{
 		Wms_Wxt536_Error_Number = 122;
 		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Protocol_Set:"
-			"Wrong reply parameter value ('%c' vd '%c').",parameter_value_list[0].Value_String[0],protocol);
+			"Wrong reply parameter value ('%c' vd '%c').",parameter_list.Parameter_List[0].Value_String[0],
+			protocol);
 		return FALSE;		
 	}
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);
+	/* subsequent commands should use a CRC if a CRC protocol was selected */
+	CRC_Enable = ((protocol == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_AUTOMATIC_CRC)||
+		      (protocol == WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_POLLED_CRC));
  	return TRUE;
 }
 
@@ -488,6 +991,72 @@ int Wms_Wxt536_Command_Reset_Precipitation_Intensity(char *class,char *source,ch
 	return TRUE;
 }
 
+/**
+ * Routine to query the Wxt536 with the specified device_address for how often it updates the data returned in a 
+ * data message. The update interval is parsed from the reply to the data message's settings command: 
+ * wind (aWU), pressure/temperature/humidity (aTU), analogue input (aIU) or supervisor (aSU). 
+ * Precipitation data (aR3) is updated as rain is detected, so has no fixed update interval.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 
+ *        (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param message_id Which data message to get the update interval of, 1 (wind), 2 (pressure/temperature/humidity),
+ *        4 (analogue) or 5 (supervisor).
+ * @param update_interval The address of a double to fill in with the parsed update interval (in seconds) 
+ *        used by the Wxt536. i.e. The Wxt536 changes the values returned in the data message on this cadence.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wms_Wxt536_Command
+ * @see #Wxt536_Parse_CSV_Reply
+ * @see #Wxt536_Parse_Parameter
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+int Wms_Wxt536_Command_Update_Interval_Get(char *class,char *source,char device_address,int message_id,
+					   double *update_interval)
+{
+	struct Wxt536_Parameter_List_Struct parameter_list;
+	char command_string[256];
+	char reply_string[256];
+
+	Wms_Wxt536_Error_Number = 0;
+	if(update_interval == NULL)
+	{
+		Wms_Wxt536_Error_Number = 170;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Update_Interval_Get:update_interval was NULL.");
+		return FALSE;		
+	}
+	switch(message_id)
+	{
+		case 1:
+			sprintf(command_string,"%cWU",device_address);
+			break;
+		case 2:
+			sprintf(command_string,"%cTU",device_address);
+			break;
+		case 4:
+			sprintf(command_string,"%cIU",device_address);
+			break;
+		case 5:
+			sprintf(command_string,"%cSU",device_address);
+			break;
+		default:
+			Wms_Wxt536_Error_Number = 171;
+			sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Update_Interval_Get:"
+				"Data message %d has no update interval.",message_id);
+			return FALSE;		
+	}
+	/* send the command and get the reply string */
+	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
+		return FALSE;
+	/* parse the reply string into keyword/value pairs */
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"I","%lf",&parameter_list,update_interval))
+		return FALSE;
+	return TRUE;
+}
+
 /**
  * Routine to query the Wxt536 with the specified device_address a command to retrieve the 
  * analogue input settings and parse the update_interval and averaging time from it's reply.
@@ -514,10 +1083,9 @@ int Wms_Wxt536_Command_Reset_Precipitation_Intensity(char *class,char *source,ch
 int Wms_Wxt536_Command_Analogue_Input_Settings_Get(char *class,char *source,char device_address,
 							  double *update_interval, double *averaging_time)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
+	struct Wxt536_Parameter_List_Struct parameter_list;
 	char command_string[256];
 	char reply_string[256];
-	int parameter_value_count;
 
 	Wms_Wxt536_Error_Number = 0;
 	if(update_interval == NULL)
@@ -537,17 +1105,14 @@ int Wms_Wxt536_Command_Analogue_Input_Settings_Get(char *class,char *source,char
 	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
 		return FALSE;
 	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
 		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
+	/* Extract the relevant parameters from the parameter_list, parse them and store them in the
 	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"I","%lf",parameter_value_list,parameter_value_count,update_interval))
+	if(!Wxt536_Parse_Parameter(class,source,"I","%lf",&parameter_list,update_interval))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"A","%lf",parameter_value_list,parameter_value_count,averaging_time))
+	if(!Wxt536_Parse_Parameter(class,source,"A","%lf",&parameter_list,averaging_time))
 		return FALSE;
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
 	return TRUE;
 }
 
@@ -577,10 +1142,9 @@ int Wms_Wxt536_Command_Analogue_Input_Settings_Get(char *class,char *source,char
 int Wms_Wxt536_Command_Analogue_Input_Settings_Set(char *class,char *source,char device_address,
 						   double update_interval, double averaging_time)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
+	struct Wxt536_Parameter_List_Struct parameter_list;
 	char command_string[256];
 	char reply_string[256];
-	int parameter_value_count;
 	double returned_update_interval,returned_averaging_time;
 	
 	Wms_Wxt536_Error_Number = 0;
@@ -589,12 +1153,12 @@ int Wms_Wxt536_Command_Analogue_Input_Settings_Set(char *class,char *source,char
 	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
 		return FALSE;
 	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
 		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, and check they have been set correctly */
-	if(!Wxt536_Parse_Parameter(class,source,"I","%lf",parameter_value_list,parameter_value_count,&returned_update_interval))
+	/* Extract the relevant parameters from the parameter_list, and check they have been set correctly */
+	if(!Wxt536_Parse_Parameter(class,source,"I","%lf",&parameter_list,&returned_update_interval))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"A","%lf",parameter_value_list,parameter_value_count,&returned_averaging_time))
+	if(!Wxt536_Parse_Parameter(class,source,"A","%lf",&parameter_list,&returned_averaging_time))
 		return FALSE;
 	/* check the values have been set correctly */
 	if(fabs(update_interval-returned_update_interval) > 0.1)
@@ -613,9 +1177,6 @@ int Wms_Wxt536_Command_Analogue_Input_Settings_Set(char *class,char *source,char
 			averaging_time,returned_averaging_time);
 		return FALSE;		
 	}
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
 	return TRUE;
 }
 
@@ -640,10 +1201,9 @@ int Wms_Wxt536_Command_Analogue_Input_Settings_Set(char *class,char *source,char
  */
 int Wms_Wxt536_Command_Solar_Radiation_Gain_Get(char *class,char *source,char device_address,double *gain)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
+	struct Wxt536_Parameter_List_Struct parameter_list;
 	char command_string[256];
 	char reply_string[256];
-	int parameter_value_count;
 
 	Wms_Wxt536_Error_Number = 0;
 	if(gain == NULL)
@@ -657,15 +1217,12 @@ int Wms_Wxt536_Command_Solar_Radiation_Gain_Get(char *class,char *source,char de
 	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
 		return FALSE;
 	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
 		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
+	/* Extract the relevant parameters from the parameter_list, parse them and store them in the
 	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"G","%lf",parameter_value_list,parameter_value_count,gain))
+	if(!Wxt536_Parse_Parameter(class,source,"G","%lf",&parameter_list,gain))
 		return FALSE;
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
 	return TRUE;
 }
 
@@ -689,10 +1246,9 @@ int Wms_Wxt536_Command_Solar_Radiation_Gain_Get(char *class,char *source,char de
  */
 int Wms_Wxt536_Command_Solar_Radiation_Gain_Set(char *class,char *source,char device_address,double gain)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
+	struct Wxt536_Parameter_List_Struct parameter_list;
 	char command_string[256];
 	char reply_string[256];
-	int parameter_value_count;
 	double returned_gain;
 	
 	Wms_Wxt536_Error_Number = 0;
@@ -701,11 +1257,11 @@ int Wms_Wxt536_Command_Solar_Radiation_Gain_Set(char *class,char *source,char de
 	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
 		return FALSE;
 	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
 		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
+	/* Extract the relevant parameters from the parameter_list, parse them and store them in the
 	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"G","%lf",parameter_value_list,parameter_value_count,&returned_gain))
+	if(!Wxt536_Parse_Parameter(class,source,"G","%lf",&parameter_list,&returned_gain))
 		return FALSE;
 	/* check the returned gain is the one we are trying to set */
 	if(fabs(gain-returned_gain) > 0.1)
@@ -716,9 +1272,6 @@ int Wms_Wxt536_Command_Solar_Radiation_Gain_Set(char *class,char *source,char de
 			gain,returned_gain);
 		return FALSE;		
 	}
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
 	return TRUE;
 }
 
@@ -731,11 +1284,8 @@ int Wms_Wxt536_Command_Solar_Radiation_Gain_Set(char *class,char *source,char de
  *        from the Wxt536 into.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
- * @see #Wxt536_Parameter_Value_Struct
  * @see #Wxt536_Command_Wind_Data_Struct
- * @see #Wms_Wxt536_Command
- * @see #Wxt536_Parse_CSV_Reply
- * @see #Wxt536_Parse_Parameter
+ * @see #Wxt536_Data_Get
  * @see wms_wxt536_general.html#Wms_Wxt536_Log
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
@@ -744,10 +1294,8 @@ int Wms_Wxt536_Command_Solar_Radiation_Gain_Set(char *class,char *source,char de
 int Wms_Wxt536_Command_Wind_Data_Get(char *class,char *source,char device_address,
 				     struct Wxt536_Command_Wind_Data_Struct *data)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
-	char command_string[256];
-	char reply_string[256];
-	int parameter_value_count;
+	struct Wxt536_Command_Composite_Data_Struct composite_data;
+	int data_mask;
 
 	Wms_Wxt536_Error_Number = 0;
 	if(data == NULL)
@@ -756,36 +1304,11 @@ int Wms_Wxt536_Command_Wind_Data_Get(char *class,char *source,char device_addres
 		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Wind_Data_Get:data was NULL.");
 		return FALSE;		
 	}
-	sprintf(command_string,"%cR1",device_address);
-	/* send the command and get the reply string */
-	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
-		return FALSE;
-	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
+	/* send the command, and decode the reply. Fields not in the reply are left unchanged. */
+	composite_data.Wind_Data = (*data);
+	if(!Wxt536_Data_Get(class,source,device_address,1,&composite_data,&data_mask))
 		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
-	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"Dn","%lfD",parameter_value_list,parameter_value_count,
-				   &(data->Wind_Direction_Minimum)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Dm","%lfD",parameter_value_list,parameter_value_count,
-				   &(data->Wind_Direction_Average)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Dx","%lfD",parameter_value_list,parameter_value_count,
-				   &(data->Wind_Direction_Maximum)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Sn","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Wind_Speed_Minimum)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Sm","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Wind_Speed_Average)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Sx","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Wind_Speed_Maximum)))
-		return FALSE;
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
+	(*data) = composite_data.Wind_Data;
 	return TRUE;
 }
 
@@ -798,11 +1321,8 @@ int Wms_Wxt536_Command_Wind_Data_Get(char *class,char *source,char device_addres
  *             to store the values retrieved from the Wxt536 into.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
- * @see #Wxt536_Parameter_Value_Struct
  * @see #Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct
- * @see #Wms_Wxt536_Command
- * @see #Wxt536_Parse_CSV_Reply
- * @see #Wxt536_Parse_Parameter
+ * @see #Wxt536_Data_Get
  * @see wms_wxt536_general.html#Wms_Wxt536_Log
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
@@ -811,10 +1331,8 @@ int Wms_Wxt536_Command_Wind_Data_Get(char *class,char *source,char device_addres
 int Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get(char *class,char *source,char device_address,
 		       struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct *data)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
-	char command_string[256];
-	char reply_string[256];
-	int parameter_value_count;
+	struct Wxt536_Command_Composite_Data_Struct composite_data;
+	int data_mask;
 
 	Wms_Wxt536_Error_Number = 0;
 	if(data == NULL)
@@ -824,28 +1342,12 @@ int Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get(char *class,char *
 			"Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get:data was NULL.");
 		return FALSE;		
 	}
-	sprintf(command_string,"%cR2",device_address);
-	/* send the command and get the reply string */
-	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
-		return FALSE;
-	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
-		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
-	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"Ta","%lfC",parameter_value_list,parameter_value_count,
-				   &(data->Air_Temperature)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Ua","%lfP",parameter_value_list,parameter_value_count,
-				   &(data->Relative_Humidity)))
+	/* send the command, and decode the reply. Fields not in the reply are left unchanged. */
+	composite_data.Pressure_Temperature_Humidity_Data = (*data);
+	if(!Wxt536_Data_Get(class,source,device_address,2,&composite_data,&data_mask))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Pa","%lfH",parameter_value_list,parameter_value_count,
-				   &(data->Air_Pressure)))
-		return FALSE;
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
-	return TRUE;	
+	(*data) = composite_data.Pressure_Temperature_Humidity_Data;
+	return TRUE;
 }
 
 /**
@@ -857,11 +1359,8 @@ int Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get(char *class,char *
  *             to store the values retrieved from the Wxt536 into.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
- * @see #Wxt536_Parameter_Value_Struct
  * @see #Wxt536_Command_Precipitation_Data_Struct
- * @see #Wms_Wxt536_Command
- * @see #Wxt536_Parse_CSV_Reply
- * @see #Wxt536_Parse_Parameter
+ * @see #Wxt536_Data_Get
  * @see wms_wxt536_general.html#Wms_Wxt536_Log
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
@@ -870,10 +1369,8 @@ int Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get(char *class,char *
 int Wms_Wxt536_Command_Precipitation_Data_Get(char *class,char *source,char device_address,
 						     struct Wxt536_Command_Precipitation_Data_Struct *data)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
-	char command_string[256];
-	char reply_string[256];
-	int parameter_value_count;
+	struct Wxt536_Command_Composite_Data_Struct composite_data;
+	int data_mask;
 
 	Wms_Wxt536_Error_Number = 0;
 	if(data == NULL)
@@ -882,45 +1379,12 @@ int Wms_Wxt536_Command_Precipitation_Data_Get(char *class,char *source,char devi
 		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Precipitation_Data_Get:data was NULL.");
 		return FALSE;		
 	}
-	sprintf(command_string,"%cR3",device_address);
-	/* send the command and get the reply string */
-	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
-		return FALSE;
-	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
-		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
-	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"Rc","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Rain_Accumulation)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Rd","%lfs",parameter_value_list,parameter_value_count,
-				   &(data->Rain_Duration)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Ri","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Rain_Intensity)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Hc","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Hail_Accumulation)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Hd","%lfs",parameter_value_list,parameter_value_count,
-				   &(data->Hail_Duration)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Hi","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Hail_Intensity)))
+	/* send the command, and decode the reply. Fields not in the reply are left unchanged. */
+	composite_data.Precipitation_Data = (*data);
+	if(!Wxt536_Data_Get(class,source,device_address,3,&composite_data,&data_mask))
 		return FALSE;
-	/* Not returned by our weather station 
-	if(!Wxt536_Parse_Parameter(class,source,"Rp","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Rain_Peak_Intensity)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Hp","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Hail_Peak_Intensity)))
-		return FALSE;
-	*/
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
-	return TRUE;	
+	(*data) = composite_data.Precipitation_Data;
+	return TRUE;
 }
 
 
@@ -934,11 +1398,8 @@ int Wms_Wxt536_Command_Precipitation_Data_Get(char *class,char *source,char devi
  *             to store the values retrieved from the Wxt536 into.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
- * @see #Wxt536_Parameter_Value_Struct
  * @see #Wxt536_Command_Supervisor_Data_Struct
- * @see #Wms_Wxt536_Command
- * @see #Wxt536_Parse_CSV_Reply
- * @see #Wxt536_Parse_Parameter
+ * @see #Wxt536_Data_Get
  * @see wms_wxt536_general.html#Wms_Wxt536_Log
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
@@ -947,10 +1408,8 @@ int Wms_Wxt536_Command_Precipitation_Data_Get(char *class,char *source,char devi
 int Wms_Wxt536_Command_Supervisor_Data_Get(char *class,char *source,char device_address,
 						  struct Wxt536_Command_Supervisor_Data_Struct *data)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
-	char command_string[256];
-	char reply_string[256];
-	int parameter_value_count;
+	struct Wxt536_Command_Composite_Data_Struct composite_data;
+	int data_mask;
 
 	Wms_Wxt536_Error_Number = 0;
 	if(data == NULL)
@@ -959,37 +1418,12 @@ int Wms_Wxt536_Command_Supervisor_Data_Get(char *class,char *source,char device_
 		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Supervisor_Data_Get:data was NULL.");
 		return FALSE;		
 	}
-	sprintf(command_string,"%cR5",device_address);
-	/* send the command and get the reply string */
-	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
-		return FALSE;
-	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
-		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
-	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"Th","%lfC",parameter_value_list,parameter_value_count,
-				   &(data->Heating_Temperaure)))
+	/* send the command, and decode the reply. Fields not in the reply are left unchanged. */
+	composite_data.Supervisor_Data = (*data);
+	if(!Wxt536_Data_Get(class,source,device_address,5,&composite_data,&data_mask))
 		return FALSE;
-	/* NB Not sure the units are 'N' when the heater is on. Manual is unclear? */
-	if(!Wxt536_Parse_Parameter(class,source,"Vh","%lfN",parameter_value_list,parameter_value_count,
-				   &(data->Heating_Voltage)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Vs","%lfV",parameter_value_list,parameter_value_count,
-				   &(data->Supply_Voltage)))
-		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Vr","%lfV",parameter_value_list,parameter_value_count,
-				   &(data->Reference_Voltage)))
-		return FALSE;
-	/* This field does not seem to be returned by our unit.
-	if(!Wxt536_Parse_Parameter(class,source,"Id","%256s",parameter_value_list,parameter_value_count,
-				   &(data->Information)))
-		return FALSE;
-	*/
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
-	return TRUE;	
+	(*data) = composite_data.Supervisor_Data;
+	return TRUE;
 }
 
 /**
@@ -1002,11 +1436,8 @@ int Wms_Wxt536_Command_Supervisor_Data_Get(char *class,char *source,char device_
  *             to store the values retrieved from the Wxt536 into.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
- * @see #Wxt536_Parameter_Value_Struct
  * @see #Wxt536_Command_Analogue_Data_Struct
- * @see #Wms_Wxt536_Command
- * @see #Wxt536_Parse_CSV_Reply
- * @see #Wxt536_Parse_Parameter
+ * @see #Wxt536_Data_Get
  * @see wms_wxt536_general.html#Wms_Wxt536_Log
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
@@ -1015,10 +1446,8 @@ int Wms_Wxt536_Command_Supervisor_Data_Get(char *class,char *source,char device_
 int Wms_Wxt536_Command_Analogue_Data_Get(char *class,char *source,char device_address,
 					 struct Wxt536_Command_Analogue_Data_Struct *data)
 {
-	struct Wxt536_Parameter_Value_Struct *parameter_value_list = NULL;
-	char command_string[256];
-	char reply_string[256];
-	int parameter_value_count;
+	struct Wxt536_Command_Composite_Data_Struct composite_data;
+	int data_mask;
 
 	Wms_Wxt536_Error_Number = 0;
 	if(data == NULL)
@@ -1027,228 +1456,1647 @@ int Wms_Wxt536_Command_Analogue_Data_Get(char *class,char *source,char device_ad
 		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Analogue_Data_Get:data was NULL.");
 		return FALSE;		
 	}
-	sprintf(command_string,"%cR4",device_address);
-	/* send the command and get the reply string */
-	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
+	/* send the command, and decode the reply. Fields not in the reply are left unchanged. */
+	composite_data.Analogue_Data = (*data);
+	if(!Wxt536_Data_Get(class,source,device_address,4,&composite_data,&data_mask))
 		return FALSE;
-	/* parse the reply string into keyword/value pairs */
-	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_value_list,&parameter_value_count))
+	(*data) = composite_data.Analogue_Data;
+	return TRUE;
+}
+
+/**
+ * Routine to configure the Wxt536 with the specified device_address so that the composite data message (aR0)
+ * contains the data fields used by the Qli50 replies. The pressure/temperature/humidity internal temperature (Tp),
+ * the precipitation peak intensities (Rp,Hp) and the supervisor information field (Id) are deliberately not 
+ * selected, as our unit does not return them; Wms_Wxt536_Command_Composite_Data_Get still decodes them if a 
+ * unit configured elsewhere does return them. This sets the composite
+ * half of the parameter selection (R) field of the wind (aWU), pressure/temperature/humidity (aTU), 
+ * precipitation (aRU), supervisor (aSU) and analogue input (aIU) settings. The individual data message 
+ * (aR1..aR5) half of each parameter selection field is left unchanged, so the individual data get commands 
+ * continue to work.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wms_Wxt536_Command_Composite_Data_Get
+ * @see #Wxt536_Composite_Parameter_Selection_Set
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+int Wms_Wxt536_Command_Composite_Data_Configure(char *class,char *source,char device_address)
+{
+	Wms_Wxt536_Error_Number = 0;
+#if LOGGING > 1
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,
+			      "Wms_Wxt536_Command_Composite_Data_Configure(device_address='%c') started.",device_address);
+#endif /* LOGGING */
+	/* wind: Dn,Dm,Dx,Sn,Sm,Sx */
+	if(!Wxt536_Composite_Parameter_Selection_Set(class,source,device_address,"WU","11111100"))
 		return FALSE;
-	/* Extract the relevant parameters from the parameter_value_list, parse them and store them in the
-	** return data structure */
-	if(!Wxt536_Parse_Parameter(class,source,"Tr","%lfC",parameter_value_list,parameter_value_count,
-				   &(data->PT1000_Temperaure)))
+	/* pressure/temperature/humidity: Pa,Ta,(not Tp),Ua */
+	if(!Wxt536_Composite_Parameter_Selection_Set(class,source,device_address,"TU","11010000"))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Ra","%lfM",parameter_value_list,parameter_value_count,
-				   &(data->Aux_Rain_Accumulation)))
+	/* precipitation: Rc,Rd,Ri,Hc,Hd,Hi,(not Rp,Hp) */
+	if(!Wxt536_Composite_Parameter_Selection_Set(class,source,device_address,"RU","11111100"))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Sl","%lfV",parameter_value_list,parameter_value_count,
-				   &(data->Ultrasonic_Level_Voltage)))
+	/* supervisor: Th,Vh,Vs,Vr,(not Id) */
+	if(!Wxt536_Composite_Parameter_Selection_Set(class,source,device_address,"SU","11110000"))
 		return FALSE;
-	if(!Wxt536_Parse_Parameter(class,source,"Sr","%lfV",parameter_value_list,parameter_value_count,
-				   &(data->Solar_Radiation_Voltage)))
+	/* analogue inputs: Tr,Ra,Sl,Sr */
+	if(!Wxt536_Composite_Parameter_Selection_Set(class,source,device_address,"IU","11110000"))
 		return FALSE;
-	/* free parameter_value_list */
-	if(parameter_value_list != NULL)
-		free(parameter_value_list);	
-	return TRUE;	
+#if LOGGING > 1
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,
+			      "Wms_Wxt536_Command_Composite_Data_Configure(device_address='%c') finished.",device_address);
+#endif /* LOGGING */
+	return TRUE;
 }
 
-/* ----------------------------------------------------------------------
-** internal functions
-** ---------------------------------------------------------------------- */
 /**
- * Internal routine to parse a reply into a series of keyword/value pairs. Many Wxt536 commands return replies of the
- * form:
- * "0XU,A=0,M=A,T=1,C=3,I=0,B=9600,D=8,P=N,S=1,L=25, N=WXT530,V=1.00<cr><lf>"
- * i.e. the command, followed by a series of comma separated parameters, of the form "keyword=value".
+ * Function to retrieve all the wind, pressure/temperature/humidity, precipitation, supervisor and analogue data 
+ * from the Wxt536 in one exchange, using the composite data message (aR0). The Wxt536 must have previously been 
+ * configured to return all the required fields in the composite data message, 
+ * using Wms_Wxt536_Command_Composite_Data_Configure.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
- * @param reply_string The character string containing the reply to be parsed. The string contents are edited
- *        as part of the parsing.
- * @param parameter_value_list The address of a list pointer of Wxt536_Parameter_Value_Struct structs. On return
- *        of the function this list will be allocated and filled with parsed parameter keyword/values.
- * @param parameter_value_count The address of an integer, on a successful return this contains the number of elements
- *        in parameter_value_list.
+ * @param device_address The device address of the Wxt536(can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param data The address of an allocated Wxt536_Command_Composite_Data_Struct structure, 
+ *             to store the values retrieved from the Wxt536 into.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
  *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
- * @see #Wxt536_Parameter_Value_Struct
- * @see #TERMINATOR_CRLF
- * @see #KEYWORD_LENGTH
- * @see #VALUE_LENGTH
+ * @see #Wxt536_Command_Composite_Data_Struct
+ * @see #Wms_Wxt536_Command_Composite_Data_Configure
+ * @see #Wxt536_Data_Get
  * @see wms_wxt536_general.html#Wms_Wxt536_Log
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
  */
-static int Wxt536_Parse_CSV_Reply(char *class,char *source,char *reply_string,
-				  struct Wxt536_Parameter_Value_Struct **parameter_value_list,
-				  int *parameter_value_count)
+int Wms_Wxt536_Command_Composite_Data_Get(char *class,char *source,char device_address,
+					  struct Wxt536_Command_Composite_Data_Struct *data)
 {
-	char *comma_ptr = NULL;
-	char *end_parameter_comma_ptr = NULL;
-	char *equals_ptr = NULL;
-	char *crlf_ptr = NULL;
-	
-	if(reply_string == NULL)
-	{
-		Wms_Wxt536_Error_Number = 109;
-		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:reply_string was NULL.");
-		return FALSE;		
-	}
-	if(parameter_value_list == NULL)
-	{
-		Wms_Wxt536_Error_Number = 110;
-		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:parameter_value_list was NULL.");
-		return FALSE;		
-	}
-	if(parameter_value_count == NULL)
+	int data_mask;
+
+	Wms_Wxt536_Error_Number = 0;
+	if(data == NULL)
 	{
-		Wms_Wxt536_Error_Number = 111;
-		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:parameter_value_count was NULL.");
+		Wms_Wxt536_Error_Number = 134;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Composite_Data_Get:data was NULL.");
 		return FALSE;		
 	}
-#if LOGGING > 9
-	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wxt536_Parse_CSV_Reply: Parsing'%s'.",reply_string);
-#endif /* LOGGING */
-	(*parameter_value_count) = 0;
-	(*parameter_value_list) = NULL;
-	/* remove the terminator at the end */
-	crlf_ptr = strstr(reply_string,TERMINATOR_CRLF);
-	if(crlf_ptr != NULL)
-		(*crlf_ptr) = '\0';
-	/* find the end of the command string */
-	comma_ptr = strstr(reply_string,",");
-	if(comma_ptr != NULL)
+	/* send the command, and decode the reply */
+	if(!Wxt536_Data_Get(class,source,device_address,0,data,&data_mask))
+		return FALSE;
+	/* all the data groups should have been returned */
+	if(data_mask != (WXT536_COMMAND_DATA_WIND|WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY|
+			 WXT536_COMMAND_DATA_PRECIPITATION|WXT536_COMMAND_DATA_SUPERVISOR|WXT536_COMMAND_DATA_ANALOGUE))
 	{
-		/* first part of the reply is the command */
-		(*comma_ptr) = '\0';
-#if LOGGING > 9
-		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,
-				      "Wxt536_Parse_CSV_Reply: Parsed command string '%s'.",reply_string);
-#endif /* LOGGING */		
+		Wms_Wxt536_Error_Number = 162;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Composite_Data_Get:"
+			"Composite data message only contained data groups 0x%x.",data_mask);
+		return FALSE;
 	}
-	/* while there are more parameters */
-	while(comma_ptr != NULL)
-	{
-		/* find the end of this parameter and null terminate it (if it is NOT the last parameter) */
-		end_parameter_comma_ptr = strstr(comma_ptr+1,",");
-		if(end_parameter_comma_ptr != NULL)
-			(*end_parameter_comma_ptr) = '\0';
-		/* the current parameter now starts at comma_ptr+1, ends at end_parameter_comma_ptr,
-		**  and is NULL terminated */
-#if LOGGING > 9
-		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,
-				      "Wxt536_Parse_CSV_Reply: Parsing keyword value string '%s'.",comma_ptr+1);
-#endif /* LOGGING */
-		/* reallocate the parameter list */
-		if((*parameter_value_list) == NULL)
-		{
-			(*parameter_value_list) = (struct Wxt536_Parameter_Value_Struct *)malloc(sizeof(struct Wxt536_Parameter_Value_Struct));
-		}
-		else
-		{
-			(*parameter_value_list) = (struct Wxt536_Parameter_Value_Struct *)realloc((*parameter_value_list),((*parameter_value_count)+1)*sizeof(struct Wxt536_Parameter_Value_Struct));
-		}
-		if((*parameter_value_list) == NULL)
-		{
-			Wms_Wxt536_Error_Number = 112;
-			sprintf(Wms_Wxt536_Error_String,
-				"Wxt536_Parse_CSV_Reply:Failed to realloc parameter_value_list (%d).",
-				(*parameter_value_count));
-			return FALSE;		
-		}
-		/* parse the keyword=value pair and put the results in the newly alloacted list position */
-		equals_ptr = strstr(comma_ptr+1,"=");
-		if(equals_ptr == NULL)
-		{
-			Wms_Wxt536_Error_Number = 113;
-			sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:"
-				"Failed to parse keyword/value string '%s' at parameter %d: No equals sign found.",
-				comma_ptr+1,(*parameter_value_count));
-			return FALSE;
-		}
-		(*equals_ptr) = '\0';
-		/* keyword now null terminated at comma_ptr+1 */
-		if(strlen(comma_ptr+1) > KEYWORD_LENGTH)
-		{
-			Wms_Wxt536_Error_Number = 114;
-			sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:"
-			  "Failed to parse keyword string '%s' at parameter %d:Keyword was too long (%lu vs %d).",
-				comma_ptr+1,(*parameter_value_count),strlen(comma_ptr+1),KEYWORD_LENGTH);
-			return FALSE;
-		}
-		strcpy((*parameter_value_list)[(*parameter_value_count)].Keyword,comma_ptr+1);
-		/* value now null terminated at equals_ptr+1 */
-		if(strlen(equals_ptr+1) > VALUE_LENGTH)
-		{
-			Wms_Wxt536_Error_Number = 115;
-			sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:"
-			  "Failed to parse value string '%s' at parameter %d:Value was too long (%lu vs %d).",
-				equals_ptr+1,(*parameter_value_count),strlen(equals_ptr+1),VALUE_LENGTH);
-			return FALSE;
-		}
-		strcpy((*parameter_value_list)[(*parameter_value_count)].Value_String,equals_ptr+1);
-#if LOGGING > 9
-		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,
-				      "Wxt536_Parse_CSV_Reply: Parsed keyword '%s' with value '%s'.",
-				      (*parameter_value_list)[(*parameter_value_count)].Keyword,
-				      (*parameter_value_list)[(*parameter_value_count)].Value_String);
-#endif /* LOGGING */
-		(*parameter_value_count)++;
-		comma_ptr = end_parameter_comma_ptr;
-	}/* end while */
 	return TRUE;
 }
 
 /**
- * This routine finds the specified keyword in the parameter_value_list, uses the format to parse
- * the value, and stores the parsed value in the variable pointed to data address data_ptr.
+ * Routine to set the Wxt536 composite data message automatic repeat interval. When the Wxt536 is in automatic mode,
+ * it sends a composite data message (aR0) every interval seconds.
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
- * @param keyword The keyword of the parameter we want to parse.
- * @param format The format of the paramaters value we want to parse, specified as a sscanf format string.
- * @param parameter_value_list The list of keyword/value pairs parsed from a Wxt536 command.
- * @param parameter_value_count The number of elements in parameter_value_list.
- * @param data_ptr The address of a variable (hopefully of a type matching for format) to store the parsed 
- *        parameter value in.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param interval The automatic repeat interval in seconds, 1..3600, or 0 to stop the automatic composite data message.
  * @return The procedure returns TRUE if successful, and FALSE if it failed 
- *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure). 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wms_Wxt536_Command
  * @see #Wxt536_Parameter_Value_Struct
- * @see #Wxt536_Parameter_Parsing_Struct
- * @see wms_wxt536_general.html#Wms_Wxt536_Log
- * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see #Wxt536_Parse_CSV_Reply
+ * @see #Wxt536_Parse_Parameter
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
  * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
  */
-static int Wxt536_Parse_Parameter(char *class,char *source,char *keyword,char *format,
-				  struct Wxt536_Parameter_Value_Struct *parameter_value_list,
-				  int parameter_value_count,void *data_ptr)
+int Wms_Wxt536_Command_Comms_Settings_Composite_Interval_Set(char *class,char *source,char device_address,int interval)
 {
-	int parameter_value_list_index,retval;
+	struct Wxt536_Parameter_List_Struct parameter_list;
+	char command_string[256];
+	char reply_string[256];
+	int returned_interval;
 
-	/* find keyword/value pair in parameter_value_list with the specified keyword */
-	parameter_value_list_index = 0;
-	while((parameter_value_list_index < parameter_value_count)&&
-	      strcmp(parameter_value_list[parameter_value_list_index].Keyword,keyword))
+	Wms_Wxt536_Error_Number = 0;
+	if((interval < 0)||(interval > 3600))
 	{
-		parameter_value_list_index++;
+		Wms_Wxt536_Error_Number = 138;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Composite_Interval_Set:"
+			"Illegal interval %d.",interval);
+		return FALSE;		
 	}
-	if(parameter_value_list_index == parameter_value_count)
-	{
-		Wms_Wxt536_Error_Number = 116;
-		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_Parameter:"
-			"Failed to find keyword string '%s' in parameter value list.",keyword);
+	sprintf(command_string,"%cXU,I=%d",device_address,interval);
+	/* send the command and get the reply string */
+	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
 		return FALSE;
-	}
-	retval = sscanf(parameter_value_list[parameter_value_list_index].Value_String,format,data_ptr);
-	if(retval != 1)
-	{
-		Wms_Wxt536_Error_Number = 117;
+	/* parse the reply string into keyword/value pairs */
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"I","%d",&parameter_list,&returned_interval))
+		return FALSE;
+	if(returned_interval != interval)
+	{
+		Wms_Wxt536_Error_Number = 139;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Composite_Interval_Set:"
+			"interval was not set (%d vs %d).",interval,returned_interval);
+		return FALSE;		
+	}
+ 	return TRUE;
+}
+
+/**
+ * Routine to set the Wxt536 baud rate. The Wxt536 replies to the command at it's old baud rate, and then switches
+ * to the new baud rate, so once this routine returns the connection's baud rate should be changed to match
+ * using Wms_Wxt536_Connection_Baud_Rate_Set.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param baud_rate The baud rate, one of 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wms_Wxt536_Command
+ * @see #Wxt536_Parameter_Value_Struct
+ * @see #Wxt536_Parse_CSV_Reply
+ * @see #Wxt536_Parse_Parameter
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Baud_Rate_Set
+ */
+int Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set(char *class,char *source,char device_address,int baud_rate)
+{
+	struct Wxt536_Parameter_List_Struct parameter_list;
+	char command_string[256];
+	char reply_string[256];
+	int returned_baud_rate;
+
+	Wms_Wxt536_Error_Number = 0;
+	if((baud_rate != 1200)&&(baud_rate != 2400)&&(baud_rate != 4800)&&(baud_rate != 9600)&&
+	   (baud_rate != 19200)&&(baud_rate != 38400)&&(baud_rate != 57600)&&(baud_rate != 115200))
+	{
+		Wms_Wxt536_Error_Number = 172;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set:"
+			"Illegal baud rate %d.",baud_rate);
+		return FALSE;		
+	}
+	sprintf(command_string,"%cXU,B=%d",device_address,baud_rate);
+	/* send the command and get the reply string */
+	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
+		return FALSE;
+	/* parse the reply string into keyword/value pairs */
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"B","%d",&parameter_list,&returned_baud_rate))
+		return FALSE;
+	if(returned_baud_rate != baud_rate)
+	{
+		Wms_Wxt536_Error_Number = 173;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set:"
+			"baud rate was not set (%d vs %d).",baud_rate,returned_baud_rate);
+		return FALSE;		
+	}
+ 	return TRUE;
+}
+
+/**
+ * Routine to set the Wxt536 serial settings (baud rate and character framing) in one command. The Wxt536 replies to
+ * the command using it's old serial settings, and then switches to the new ones, so once this routine returns
+ * the connection should be changed to match using Wms_Wxt536_Connection_Baud_Rate_Set and 
+ * Wms_Wxt536_Connection_Framing_Set.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param baud_rate The baud rate, one of 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200.
+ * @param data_bits The number of data bits, 7 or 8.
+ * @param parity The parity, one of 'N' (none), 'E' (even) or 'O' (odd).
+ * @param stop_bits The number of stop bits, 1 or 2.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wms_Wxt536_Command
+ * @see #Wxt536_Parameter_Value_Struct
+ * @see #Wxt536_Parse_CSV_Reply
+ * @see #Wxt536_Parse_Parameter
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Baud_Rate_Set
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Framing_Set
+ */
+int Wms_Wxt536_Command_Comms_Settings_Serial_Set(char *class,char *source,char device_address,int baud_rate,
+						 int data_bits,char parity,int stop_bits)
+{
+	struct Wxt536_Parameter_List_Struct parameter_list;
+	char command_string[256];
+	char reply_string[256];
+	char returned_parity;
+	int returned_baud_rate,returned_data_bits,returned_stop_bits;
+
+	Wms_Wxt536_Error_Number = 0;
+	if((baud_rate != 1200)&&(baud_rate != 2400)&&(baud_rate != 4800)&&(baud_rate != 9600)&&
+	   (baud_rate != 19200)&&(baud_rate != 38400)&&(baud_rate != 57600)&&(baud_rate != 115200))
+	{
+		Wms_Wxt536_Error_Number = 178;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Serial_Set:"
+			"Illegal baud rate %d.",baud_rate);
+		return FALSE;		
+	}
+	if(((data_bits != 7)&&(data_bits != 8))||((parity != 'N')&&(parity != 'E')&&(parity != 'O'))||
+	   ((stop_bits != 1)&&(stop_bits != 2)))
+	{
+		Wms_Wxt536_Error_Number = 179;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Serial_Set:"
+			"Illegal framing %d%c%d.",data_bits,parity,stop_bits);
+		return FALSE;		
+	}
+	sprintf(command_string,"%cXU,B=%d,D=%d,P=%c,S=%d",device_address,baud_rate,data_bits,parity,stop_bits);
+	/* send the command and get the reply string */
+	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
+		return FALSE;
+	/* parse the reply string into keyword/value pairs */
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"B","%d",&parameter_list,&returned_baud_rate))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"D","%d",&parameter_list,&returned_data_bits))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"P","%c",&parameter_list,&returned_parity))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"S","%d",&parameter_list,&returned_stop_bits))
+		return FALSE;
+	if((returned_baud_rate != baud_rate)||(returned_data_bits != data_bits)||(returned_parity != parity)||
+	   (returned_stop_bits != stop_bits))
+	{
+		Wms_Wxt536_Error_Number = 180;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Comms_Settings_Serial_Set:"
+			"serial settings were not set (%d %d%c%d vs %d %d%c%d).",baud_rate,data_bits,parity,stop_bits,
+			returned_baud_rate,returned_data_bits,returned_parity,returned_stop_bits);
+		return FALSE;		
+	}
+ 	return TRUE;
+}
+
+/**
+ * Send a data message request (aR0..aR5) to the Wxt536, without waiting for the reply. This is used by event driven
+ * callers, which read and parse the reply with Wms_Wxt536_Command_Data_Message_Read when the serial link 
+ * becomes readable. If CRC_Enable is set the request is sent with a CRC (by Wms_Wxt536_Command).
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param message_id Which data message to request, 0 (composite data) to 5 (supervisor data).
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wms_Wxt536_Command
+ * @see #Wms_Wxt536_Command_Data_Message_Read
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+int Wms_Wxt536_Command_Data_Message_Request(char *class,char *source,char device_address,int message_id)
+{
+	char command_string[256];
+
+	Wms_Wxt536_Error_Number = 0;
+	if((message_id < 0)||(message_id > 5))
+	{
+		Wms_Wxt536_Error_Number = 151;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Data_Message_Request:Illegal message id %d.",
+			message_id);
+		return FALSE;		
+	}
+	sprintf(command_string,"%cR%d",device_address,message_id);
+	/* send the command, the reply is read later */
+	if(!Wms_Wxt536_Command(class,source,command_string,NULL,0))
+		return FALSE;
+ 	return TRUE;
+}
+
+/**
+ * Streaming reader for a Wxt536 in automatic mode. This routine reads the next line sent by the Wxt536,
+ * and demultiplexes it by message id. Data messages (aR0..aR5) from the specified device are parsed into the relevant
+ * parts of data, and data_mask is set to indicate which parts of data were updated. 
+ * Composite data messages (aR0) only update the data groups whose fields are present in the message. 
+ * Other lines (e.g. from other devices, or replies to commands) are ignored, and data_mask is returned as 0.
+ * A line that fails it's CRC check (when CRC_Enable is set) causes the routine to fail 
+ * (with Wms_Wxt536_Error_Number 181), so the caller can request the data again.
+ * If no line is received within timeout_ms, the routine fails. If timeout_ms is WMS_SERIAL_READ_TIMEOUT_NONE,
+ * only data already received is used, and if it does not contain a complete line the routine succeeds with
+ * data_mask set to 0.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param timeout_ms How long to wait for a line from the Wxt536, in milliseconds, or 
+ *        WMS_SERIAL_READ_TIMEOUT_DEFAULT to use the connection's default read timeout, or 
+ *        WMS_SERIAL_READ_TIMEOUT_NONE not to wait.
+ * @param data The address of an allocated Wxt536_Command_Composite_Data_Struct structure, 
+ *             to store the values received from the Wxt536 into. Only the parts indicated by data_mask are changed.
+ * @param data_mask The address of an integer, on a successful return this is a bit mask of 
+ *        WXT536_COMMAND_DATA_WIND, WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY, 
+ *        WXT536_COMMAND_DATA_PRECIPITATION, WXT536_COMMAND_DATA_SUPERVISOR and WXT536_COMMAND_DATA_ANALOGUE,
+ *        indicating which parts of data were updated.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #TERMINATOR_CRLF
+ * @see #MESSAGE_LENGTH
+ * @see #WXT536_COMMAND_DATA_WIND
+ * @see #WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY
+ * @see #WXT536_COMMAND_DATA_PRECIPITATION
+ * @see #WXT536_COMMAND_DATA_SUPERVISOR
+ * @see #WXT536_COMMAND_DATA_ANALOGUE
+ * @see #Wxt536_Command_Composite_Data_Struct
+ * @see #Wms_Wxt536_Command_Data_Message_Parse
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Handle_Get
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Line
+ */
+int Wms_Wxt536_Command_Data_Message_Read(char *class,char *source,char device_address,int timeout_ms,
+					 struct Wxt536_Command_Composite_Data_Struct *data,int *data_mask)
+{
+	char message[MESSAGE_LENGTH];
+	int bytes_read;
+
+	Wms_Wxt536_Error_Number = 0;
+	if(data == NULL)
+	{
+		Wms_Wxt536_Error_Number = 140;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Data_Message_Read:data was NULL.");
+		return FALSE;		
+	}
+	if(data_mask == NULL)
+	{
+		Wms_Wxt536_Error_Number = 141;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Data_Message_Read:data_mask was NULL.");
+		return FALSE;		
+	}
+	(*data_mask) = 0;
+	if(!Wms_Serial_Read_Line(class,source,Wms_Wxt536_Connection_Handle_Get(),TERMINATOR_CRLF,message,
+				 MESSAGE_LENGTH-1,timeout_ms,&bytes_read))
+	{
+		Wms_Wxt536_Error_Number = 142;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Data_Message_Read:Failed to read data message.");
+		return FALSE;
+	}
+	/* no complete line available yet */
+	if(bytes_read == 0)
+		return TRUE;
+	return Wms_Wxt536_Command_Data_Message_Parse(class,source,device_address,message,data,data_mask);
+}
+
+/**
+ * Routine to parse one line received from a Wxt536 in automatic mode (or in reply to a data message request), 
+ * as read by Wms_Wxt536_Command_Data_Message_Read. The line is demultiplexed by message id. 
+ * Data messages (aR0..aR5) from the specified device are parsed into the relevant parts of data, and data_mask is 
+ * set to indicate which parts of data were updated. Composite data messages (aR0) only update the data groups whose 
+ * fields are present in the message. Other lines (e.g. from other devices, or replies to commands) are ignored, 
+ * and data_mask is returned as 0. A line that fails it's CRC check (when CRC_Enable is set) causes the routine 
+ * to fail with Wms_Wxt536_Error_Number 181.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param message The line received from the Wxt536, without it's terminator. The string contents are edited
+ *        as part of the parsing.
+ * @param data The address of an allocated Wxt536_Command_Composite_Data_Struct structure, 
+ *             to store the values received from the Wxt536 into. Only the parts indicated by data_mask are changed.
+ * @param data_mask The address of an integer, on a successful return this is a bit mask of 
+ *        WXT536_COMMAND_DATA_WIND, WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY, 
+ *        WXT536_COMMAND_DATA_PRECIPITATION, WXT536_COMMAND_DATA_SUPERVISOR and WXT536_COMMAND_DATA_ANALOGUE,
+ *        indicating which parts of data were updated.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #WXT536_COMMAND_DATA_WIND
+ * @see #WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY
+ * @see #WXT536_COMMAND_DATA_PRECIPITATION
+ * @see #WXT536_COMMAND_DATA_SUPERVISOR
+ * @see #WXT536_COMMAND_DATA_ANALOGUE
+ * @see #Wxt536_Command_Composite_Data_Struct
+ * @see #Wxt536_Data_Message_Id_Get
+ * @see #Wxt536_CRC_Check
+ * @see #Wxt536_Data_Decode
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+int Wms_Wxt536_Command_Data_Message_Parse(char *class,char *source,char device_address,char *message,
+					  struct Wxt536_Command_Composite_Data_Struct *data,int *data_mask)
+{
+	int message_id;
+
+	Wms_Wxt536_Error_Number = 0;
+	if(message == NULL)
+	{
+		Wms_Wxt536_Error_Number = 157;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Data_Message_Parse:message was NULL.");
+		return FALSE;		
+	}
+	if(data == NULL)
+	{
+		Wms_Wxt536_Error_Number = 158;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Data_Message_Parse:data was NULL.");
+		return FALSE;		
+	}
+	if(data_mask == NULL)
+	{
+		Wms_Wxt536_Error_Number = 159;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Data_Message_Parse:data_mask was NULL.");
+		return FALSE;		
+	}
+	(*data_mask) = 0;
+	/* reject corrupt lines */
+	if(!Wxt536_CRC_Check(class,source,message))
+	{
+		Wms_Wxt536_Error_Number = 181;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Data_Message_Parse:Line '%.80s' failed CRC check.",
+			message);
+		return FALSE;
+	}
+	/* demultiplex on message id */
+	message_id = Wxt536_Data_Message_Id_Get(message);
+	if((message_id == -1)||(message[0] != device_address))
+	{
+#if LOGGING > 9
+		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,
+				      "Wms_Wxt536_Command_Data_Message_Parse:Ignoring line '%s'.",message);
+#endif /* LOGGING */
+		return TRUE;
+	}
+	return Wxt536_Data_Decode(class,source,message,message_id,data,data_mask);
+}
+
+/**
+ * Routine to check whether a complete line from the Wxt536 has already been received, and is buffered in the
+ * connection's serial handle. If so, the next call to Wms_Wxt536_Command_Data_Message_Read returns it without
+ * reading from (or waiting on) the serial link. Event driven callers use this to process every received line, 
+ * as poll/epoll only reports data not yet read from the serial device.
+ * @return TRUE if a complete line is buffered, FALSE otherwise.
+ * @see #TERMINATOR_CRLF
+ * @see #Wms_Wxt536_Command_Data_Message_Read
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Handle_Get
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Line_Buffered
+ */
+int Wms_Wxt536_Command_Data_Message_Buffered(void)
+{
+	return Wms_Serial_Read_Line_Buffered(Wms_Wxt536_Connection_Handle_Get(),TERMINATOR_CRLF);
+}
+
+/**
+ * Routine to read the reply to a command sent without waiting for it's reply (i.e. Wms_Wxt536_Command with a NULL
+ * reply_string). Event driven callers use this to read replies to arbitrary (e.g. engineering) commands when the 
+ * serial link becomes readable. If CRC_Enable is set, the reply line has it's CRC checked and removed 
+ * (using Wxt536_CRC_Check), and a corrupt line causes the routine to fail with Wms_Wxt536_Error_Number 182, 
+ * so the caller can resend the command.
+ * If timeout_ms is WMS_SERIAL_READ_TIMEOUT_NONE, only data already received is used, and if it does not contain
+ * a complete line the routine succeeds with bytes_read set to 0.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param timeout_ms How long to wait for a line from the Wxt536, in milliseconds, or 
+ *        WMS_SERIAL_READ_TIMEOUT_DEFAULT to use the connection's default read timeout, or 
+ *        WMS_SERIAL_READ_TIMEOUT_NONE not to wait.
+ * @param reply_string A string, on a successful return with bytes_read non-zero, this is filled with the reply line 
+ *        (without it's terminator or CRC).
+ * @param reply_string_length The allocated length of the reply_string buffer.
+ * @param bytes_read The address of an integer, on a successful return set to the number of bytes read 
+ *        (including the terminator), or 0 if no complete line was available.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #TERMINATOR_CRLF
+ * @see #Wms_Wxt536_Command
+ * @see #Wxt536_CRC_Check
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Handle_Get
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Line
+ */
+int Wms_Wxt536_Command_Reply_Read(char *class,char *source,int timeout_ms,char *reply_string,int reply_string_length,
+				  int *bytes_read)
+{
+	char *terminator_ptr = NULL;
+
+	Wms_Wxt536_Error_Number = 0;
+	if(reply_string == NULL)
+	{
+		Wms_Wxt536_Error_Number = 167;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Reply_Read:reply_string was NULL.");
+		return FALSE;		
+	}
+	if(bytes_read == NULL)
+	{
+		Wms_Wxt536_Error_Number = 168;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Reply_Read:bytes_read was NULL.");
+		return FALSE;		
+	}
+	if(!Wms_Serial_Read_Line(class,source,Wms_Wxt536_Connection_Handle_Get(),TERMINATOR_CRLF,reply_string,
+				 reply_string_length-1,timeout_ms,bytes_read))
+	{
+		Wms_Wxt536_Error_Number = 169;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Reply_Read:Failed to read reply line.");
+		return FALSE;
+	}
+	/* no complete line available yet */
+	if((*bytes_read) == 0)
+		return TRUE;
+	if(!Wxt536_CRC_Check(class,source,reply_string))
+	{
+		Wms_Wxt536_Error_Number = 182;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Reply_Read:Reply '%.80s' failed CRC check.",
+			reply_string);
+		return FALSE;
+	}
+	/* remove the terminator */
+	terminator_ptr = strstr(reply_string,TERMINATOR_CRLF);
+	if(terminator_ptr != NULL)
+		(*terminator_ptr) = '\0';
+#if LOGGING > 9
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Wxt536_Command_Reply_Read:Read reply '%s'.",
+			      reply_string);
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Routine to set whether commands are sent to (and replies received from) the Wxt536 using a CRC.
+ * This is normally set by Wms_Wxt536_Command_Comms_Settings_Protocol_Set, this routine is used when the
+ * Wxt536 is already using a CRC protocol ('a' or 'p').
+ * @param enable A boolean, TRUE to use CRCs, and FALSE not to.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #CRC_Enable
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+int Wms_Wxt536_Command_CRC_Enable_Set(int enable)
+{
+	Wms_Wxt536_Error_Number = 0;
+	if(!WMS_WXT536_IS_BOOLEAN(enable))
+	{
+		Wms_Wxt536_Error_Number = 147;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_CRC_Enable_Set:Illegal enable value %d.",enable);
+		return FALSE;
+	}
+	CRC_Enable = enable;
+	return TRUE;
+}
+
+/**
+ * Routine to return whether commands are sent to (and replies received from) the Wxt536 using a CRC.
+ * @return The routine returns TRUE if CRCs are being used, and FALSE if they are not.
+ * @see #CRC_Enable
+ */
+int Wms_Wxt536_Command_CRC_Enable_Get(void)
+{
+	return CRC_Enable;
+}
+
+/* ----------------------------------------------------------------------
+** internal functions
+** ---------------------------------------------------------------------- */
+/**
+ * Internal routine to parse a reply into a series of keyword/value pairs. Many Wxt536 commands return replies of the
+ * form:
+ * "0XU,A=0,M=A,T=1,C=3,I=0,B=9600,D=8,P=N,S=1,L=25, N=WXT530,V=1.00<cr><lf>"
+ * i.e. the command, followed by a series of comma separated parameters, of the form "keyword=value".
+ * The reply is tokenised in place: the separators are replaced by NULL characters, and each element of
+ * the parameter list points at a keyword and value within reply_string. Nothing is allocated or copied.
+ * Each parameter's position is also recorded in the list's Keyword_Index, so later lookups by keyword take
+ * one table access rather than a search of the list.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param reply_string The character string containing the reply to be parsed. The string contents are edited
+ *        as part of the parsing, and must remain valid whilst parameter_list is used.
+ * @param parameter_list The address of a Wxt536_Parameter_List_Struct. On return of the function this is filled
+ *        with parsed parameter keyword/values, and the keyword index is updated.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #MAX_PARAMETER_COUNT
+ * @see #Wxt536_Parameter_List_Struct
+ * @see #Wxt536_Keyword_Id_Get
+ * @see #TERMINATOR_CRLF
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+static int Wxt536_Parse_CSV_Reply(char *class,char *source,char *reply_string,
+				  struct Wxt536_Parameter_List_Struct *parameter_list)
+{
+	struct Wxt536_Parameter_Value_Struct *parameter_value = NULL;
+	char *parameter_ptr = NULL;
+	char *comma_ptr = NULL;
+	char *equals_ptr = NULL;
+	char *crlf_ptr = NULL;
+	int keyword_id;
+
+	if(reply_string == NULL)
+	{
+		Wms_Wxt536_Error_Number = 109;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:reply_string was NULL.");
+		return FALSE;
+	}
+	if(parameter_list == NULL)
+	{
+		Wms_Wxt536_Error_Number = 110;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:parameter_list was NULL.");
+		return FALSE;
+	}
+#if LOGGING > 9
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wxt536_Parse_CSV_Reply: Parsing'%s'.",reply_string);
+#endif /* LOGGING */
+	parameter_list->Parameter_Count = 0;
+	memset(parameter_list->Keyword_Index,-1,sizeof(parameter_list->Keyword_Index));
+	/* remove the terminator at the end */
+	crlf_ptr = strstr(reply_string,TERMINATOR_CRLF);
+	if(crlf_ptr != NULL)
+		(*crlf_ptr) = '\0';
+	/* find the end of the command string */
+	parameter_ptr = strchr(reply_string,',');
+	if(parameter_ptr != NULL)
+	{
+		/* first part of the reply is the command */
+		(*parameter_ptr) = '\0';
+		parameter_ptr++;
+#if LOGGING > 9
+		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,
+				      "Wxt536_Parse_CSV_Reply: Parsed command string '%s'.",reply_string);
+#endif /* LOGGING */
+	}
+	/* while there are more parameters */
+	while(parameter_ptr != NULL)
+	{
+		if(parameter_list->Parameter_Count >= MAX_PARAMETER_COUNT)
+		{
+			Wms_Wxt536_Error_Number = 112;
+			sprintf(Wms_Wxt536_Error_String,
+				"Wxt536_Parse_CSV_Reply:Too many parameters in reply (more than %d).",
+				MAX_PARAMETER_COUNT);
+			return FALSE;
+		}
+		/* find the end of this parameter and null terminate it (if it is NOT the last parameter) */
+		comma_ptr = strchr(parameter_ptr,',');
+		if(comma_ptr != NULL)
+			(*comma_ptr) = '\0';
+		/* split the keyword=value pair */
+		equals_ptr = strchr(parameter_ptr,'=');
+		if(equals_ptr == NULL)
+		{
+			Wms_Wxt536_Error_Number = 113;
+			sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_CSV_Reply:"
+				"Failed to parse keyword/value string '%s' at parameter %d: No equals sign found.",
+				parameter_ptr,parameter_list->Parameter_Count);
+			return FALSE;
+		}
+		(*equals_ptr) = '\0';
+		parameter_value = &(parameter_list->Parameter_List[parameter_list->Parameter_Count]);
+		parameter_value->Keyword = parameter_ptr;
+		parameter_value->Value_String = equals_ptr+1;
+		/* index the first parameter with each keyword */
+		keyword_id = Wxt536_Keyword_Id_Get(parameter_value->Keyword);
+		if((keyword_id != -1)&&(parameter_list->Keyword_Index[keyword_id] == -1))
+			parameter_list->Keyword_Index[keyword_id] = parameter_list->Parameter_Count;
+#if LOGGING > 9
+		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,
+				      "Wxt536_Parse_CSV_Reply: Parsed keyword '%s' with value '%s'.",
+				      parameter_value->Keyword,parameter_value->Value_String);
+#endif /* LOGGING */
+		parameter_list->Parameter_Count++;
+		if(comma_ptr != NULL)
+			parameter_ptr = comma_ptr+1;
+		else
+			parameter_ptr = NULL;
+	}/* end while */
+	return TRUE;
+}
+
+/**
+ * Routine to map a Wxt536 keyword to a small integer id, used to index a parameter list by keyword.
+ * Wxt536 keywords are an upper case letter, optionally followed by a lower case letter, e.g. "A", "Dn", "Ta".
+ * @param keyword The keyword to map.
+ * @return The routine returns the keyword id, 0 to (KEYWORD_ID_COUNT-1), or -1 if the keyword is not of the
+ *         standard form (in which case it cannot be indexed, and has to be searched for).
+ * @see #KEYWORD_ID_COUNT
+ */
+static int Wxt536_Keyword_Id_Get(char *keyword)
+{
+	if((keyword[0] < 'A')||(keyword[0] > 'Z'))
+		return -1;
+	if(keyword[1] == '\0')
+		return (keyword[0]-'A')*27;
+	if((keyword[1] < 'a')||(keyword[1] > 'z')||(keyword[2] != '\0'))
+		return -1;
+	return ((keyword[0]-'A')*27)+(keyword[1]-'a'+1);
+}
+
+/**
+ * Routine to find the first keyword/value pair with the specified keyword in a parsed parameter list.
+ * Standard keywords are looked up in the list's keyword index, other keywords are searched for.
+ * @param keyword The keyword of the parameter we want to find.
+ * @param parameter_list The list of keyword/value pairs parsed from a Wxt536 reply.
+ * @return The routine returns a pointer to the keyword/value pair, or NULL if the keyword was not found.
+ * @see #Wxt536_Parameter_Value_Struct
+ * @see #Wxt536_Parameter_List_Struct
+ * @see #Wxt536_Keyword_Id_Get
+ */
+static struct Wxt536_Parameter_Value_Struct *Wxt536_Parameter_Find(char *keyword,
+								  struct Wxt536_Parameter_List_Struct *parameter_list)
+{
+	int keyword_id,index;
+
+	keyword_id = Wxt536_Keyword_Id_Get(keyword);
+	if(keyword_id != -1)
+	{
+		index = parameter_list->Keyword_Index[keyword_id];
+		if(index == -1)
+			return NULL;
+		return &(parameter_list->Parameter_List[index]);
+	}
+	for(index = 0; index < parameter_list->Parameter_Count; index++)
+	{
+		if(strcmp(parameter_list->Parameter_List[index].Keyword,keyword) == 0)
+			return &(parameter_list->Parameter_List[index]);
+	}
+	return NULL;
+}
+
+/**
+ * This routine finds the specified keyword in the parameter_list, uses the format to parse
+ * the value, and stores the parsed value in the variable pointed to data address data_ptr.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param keyword The keyword of the parameter we want to parse.
+ * @param format The format of the paramaters value we want to parse, specified as a sscanf format string.
+ * @param parameter_list The list of keyword/value pairs parsed from a Wxt536 command.
+ * @param data_ptr The address of a variable (hopefully of a type matching for format) to store the parsed
+ *        parameter value in.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wxt536_Parameter_Value_Struct
+ * @see #Wxt536_Parameter_Find
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+static int Wxt536_Parse_Parameter(char *class,char *source,char *keyword,char *format,
+				  struct Wxt536_Parameter_List_Struct *parameter_list,void *data_ptr)
+{
+	struct Wxt536_Parameter_Value_Struct *parameter_value = NULL;
+	int retval;
+
+	/* find keyword/value pair in parameter_list with the specified keyword */
+	parameter_value = Wxt536_Parameter_Find(keyword,parameter_list);
+	if(parameter_value == NULL)
+	{
+		Wms_Wxt536_Error_Number = 116;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_Parameter:"
+			"Failed to find keyword string '%s' in parameter value list.",keyword);
+		return FALSE;
+	}
+	retval = sscanf(parameter_value->Value_String,format,data_ptr);
+	if(retval != 1)
+	{
+		Wms_Wxt536_Error_Number = 117;
 		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_Parameter:"
 			"Failed to parse keyword '%s' value '%s' with format '%s' in parameter value list.",
-			keyword,parameter_value_list[parameter_value_list_index].Value_String,format);
+			keyword,parameter_value->Value_String,format);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Routine to parse a Wxt536 measurement value, a decimal number followed by a units character, e.g. "-3.4C".
+ * The number and units are checked in a single pass over the string:
+ * <ul>
+ * <li>An optional sign, and the digits either side of an optional decimal point, are accumulated into an integer
+ *     mantissa, which is then scaled by a power of ten. Up to MAX_NUMBER_DIGIT_COUNT digits, this
+ *     gives the same (correctly rounded) result as sscanf/strtod.
+ * <li>The Wxt536 replaces the units character with '#' when the measurement is invalid. This is reported
+ *     as an error, rather than returning a meaningless value.
+ * <li>Otherwise the units character must be one of those in units, and must end the value.
+ * </ul>
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param value_string The value string to parse.
+ * @param units A string containing the units characters allowed after the number.
+ * @param value The address of a double, on a successful return this contains the parsed value.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #MAX_NUMBER_DIGIT_COUNT
+ * @see #Power_Of_Ten_List
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+static int Wxt536_Parse_Number(char *class,char *source,char *value_string,char *units,double *value)
+{
+	char *ch_ptr = NULL;
+	unsigned long long mantissa;
+	int negative,digit_count,fraction_digit_count;
+
+	ch_ptr = value_string;
+	negative = FALSE;
+	if(((*ch_ptr) == '-')||((*ch_ptr) == '+'))
+	{
+		negative = ((*ch_ptr) == '-');
+		ch_ptr++;
+	}
+	mantissa = 0;
+	digit_count = 0;
+	fraction_digit_count = 0;
+	/* integer part */
+	while(((*ch_ptr) >= '0')&&((*ch_ptr) <= '9'))
+	{
+		mantissa = (mantissa*10)+((*ch_ptr)-'0');
+		digit_count++;
+		ch_ptr++;
+	}
+	/* fractional part */
+	if((*ch_ptr) == '.')
+	{
+		ch_ptr++;
+		while(((*ch_ptr) >= '0')&&((*ch_ptr) <= '9'))
+		{
+			mantissa = (mantissa*10)+((*ch_ptr)-'0');
+			fraction_digit_count++;
+			ch_ptr++;
+		}
+		digit_count += fraction_digit_count;
+	}
+	if((*ch_ptr) == '#')
+	{
+		Wms_Wxt536_Error_Number = 153;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_Number:Value '%s' is marked invalid.",value_string);
+		return FALSE;
+	}
+	if((digit_count == 0)||(digit_count > MAX_NUMBER_DIGIT_COUNT))
+	{
+		Wms_Wxt536_Error_Number = 154;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_Number:Failed to parse number in value '%s'.",
+			value_string);
+		return FALSE;
+	}
+	if(((*ch_ptr) == '\0')||(strchr(units,(*ch_ptr)) == NULL))
+	{
+		Wms_Wxt536_Error_Number = 155;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_Number:Value '%s' has the wrong units (expected one of '%s').",
+			value_string,units);
+		return FALSE;
+	}
+	if(ch_ptr[1] != '\0')
+	{
+		Wms_Wxt536_Error_Number = 156;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Parse_Number:Value '%s' has trailing characters after the units.",
+			value_string);
+		return FALSE;
+	}
+	(*value) = ((double)mantissa)/Power_Of_Ten_List[fraction_digit_count];
+	if(negative)
+		(*value) = -(*value);
+	return TRUE;
+}
+
+/**
+ * Routine to send a data message request (aRn) to the Wxt536, and decode the reply.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param message_id Which data message to request, 0 (composite) to 5.
+ * @param data The address of a Wxt536_Command_Composite_Data_Struct, the parts of this indicated by data_mask
+ *        are filled in with the decoded reply.
+ * @param data_mask The address of an integer, on a successful return this is a bit mask of the parts of data
+ *        that were filled in (WXT536_COMMAND_DATA_WIND etc).
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #MESSAGE_LENGTH
+ * @see #Wms_Wxt536_Command
+ * @see #Wxt536_Data_Decode
+ */
+static int Wxt536_Data_Get(char *class,char *source,char device_address,int message_id,
+			   struct Wxt536_Command_Composite_Data_Struct *data,int *data_mask)
+{
+	char command_string[256];
+	char reply_string[MESSAGE_LENGTH];
+
+	sprintf(command_string,"%cR%d",device_address,message_id);
+	/* send the command and get the reply string */
+	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,MESSAGE_LENGTH))
+		return FALSE;
+	/* decode the reply string into the data structure */
+	return Wxt536_Data_Decode(class,source,reply_string,message_id,data,data_mask);
+}
+
+/**
+ * Generic data message decoder. The reply to (or automatic transmission of) a data message is of the form:
+ * "0R2,Ta=23.6C,Ua=14.2P,Pa=1026.6H<cr><lf>"
+ * We make a single pass over the message, splitting off each "keyword=value" parameter in turn, looking up the
+ * keyword's descriptor in Message_Descriptor_List, and parsing the value straight into it's place in the data
+ * structure. The Wxt536 sends fields in the same order as the descriptor tables, so the lookup starts with the
+ * descriptor after the last one matched, and normally succeeds at once. Keywords without a descriptor are ignored.
+ * <ul>
+ * <li>An individual data message (aR1..aR5) updates it's data group, and must contain at least one of it's fields.
+ * <li>A composite data message (aR0) updates each data group with at least one field in the message.
+ * </ul>
+ * Each updated data group's Valid_Mask is set to the fields whose values parsed successfully. Fields the Wxt536
+ * reports as invalid (with a '#' units character), fields with an unparsable value, and fields missing from the
+ * message, keep their previous values and are marked not valid, so one bad field does not lose the rest of the message.
+ * The fields are decoded into a copy of data, which is only copied back if the whole message decodes.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param message The message to decode. The string contents are edited as part of the decoding.
+ * @param message_id The data message id, 0 (composite) to 5.
+ * @param data The address of a Wxt536_Command_Composite_Data_Struct, the parts of this indicated by data_mask
+ *        are filled in with the decoded message.
+ * @param data_mask The address of an integer, on return this is a bit mask of the parts of data
+ *        that were filled in (WXT536_COMMAND_DATA_WIND etc).
+ * @return The procedure returns TRUE if successful, and FALSE if it failed
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #TERMINATOR_CRLF
+ * @see #MESSAGE_DESCRIPTOR_COUNT
+ * @see #Message_Descriptor_List
+ * @see #Wxt536_Message_Descriptor_Struct
+ * @see #Wxt536_Field_Descriptor_Struct
+ * @see #Wxt536_Parse_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+static int Wxt536_Data_Decode(char *class,char *source,char *message,int message_id,
+			      struct Wxt536_Command_Composite_Data_Struct *data,int *data_mask)
+{
+	struct Wxt536_Command_Composite_Data_Struct decoded_data;
+	const struct Wxt536_Message_Descriptor_Struct *message_descriptor = NULL;
+	const struct Wxt536_Field_Descriptor_Struct *field = NULL;
+	unsigned int found_field_mask[MESSAGE_DESCRIPTOR_COUNT];
+	unsigned int valid_field_mask[MESSAGE_DESCRIPTOR_COUNT];
+	char *parameter_ptr = NULL;
+	char *keyword_ptr = NULL;
+	char *equals_ptr = NULL;
+	char *end_ptr = NULL;
+	int first_message_index,last_message_index,message_index,field_index,field_count,search_count;
+
+	(*data_mask) = 0;
+	if(message_id == 0)
+	{
+		first_message_index = 0;
+		last_message_index = MESSAGE_DESCRIPTOR_COUNT-1;
+	}
+	else if((message_id > 0)&&(message_id <= MESSAGE_DESCRIPTOR_COUNT))
+	{
+		first_message_index = message_id-1;
+		last_message_index = message_id-1;
+	}
+	else
+	{
+		Wms_Wxt536_Error_Number = 160;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Data_Decode:Illegal message id %d.",message_id);
+		return FALSE;
+	}
+	decoded_data = (*data);
+	field_count = 0;
+	for(message_index = 0; message_index < MESSAGE_DESCRIPTOR_COUNT; message_index++)
+	{
+		found_field_mask[message_index] = 0;
+		valid_field_mask[message_index] = 0;
+		if((message_index >= first_message_index)&&(message_index <= last_message_index))
+			field_count += Message_Descriptor_List[message_index].Field_Count;
+	}
+	/* the first field descriptor we expect */
+	message_index = first_message_index;
+	field_index = 0;
+	/* skip the message id */
+	parameter_ptr = strchr(message,',');
+	while(parameter_ptr != NULL)
+	{
+		/* scan to the end of this parameter (the next comma, or the terminator), noting the equals sign */
+		keyword_ptr = parameter_ptr+1;
+		equals_ptr = NULL;
+		end_ptr = keyword_ptr;
+		while(((*end_ptr) != ',')&&((*end_ptr) != '\0')&&((*end_ptr) != '\r')&&((*end_ptr) != '\n'))
+		{
+			if(((*end_ptr) == '=')&&(equals_ptr == NULL))
+				equals_ptr = end_ptr;
+			end_ptr++;
+		}
+		if((*end_ptr) == ',')
+			parameter_ptr = end_ptr;
+		else
+			parameter_ptr = NULL;
+		(*end_ptr) = '\0';
+		if(equals_ptr == NULL)
+		{
+			Wms_Wxt536_Error_Number = 161;
+			sprintf(Wms_Wxt536_Error_String,"Wxt536_Data_Decode:"
+				"Failed to parse keyword/value string '%s': No equals sign found.",keyword_ptr);
+			return FALSE;
+		}
+		(*equals_ptr) = '\0';
+		/* find the field descriptor, starting with the one after the last one found */
+		field = NULL;
+		search_count = 0;
+		while((field == NULL)&&(search_count < field_count))
+		{
+			message_descriptor = &(Message_Descriptor_List[message_index]);
+			if(field_index >= message_descriptor->Field_Count)
+			{
+				/* wrap round to the next message's descriptors */
+				field_index = 0;
+				message_index++;
+				if(message_index > last_message_index)
+					message_index = first_message_index;
+			}
+			else if((message_descriptor->Field_List[field_index].Keyword[0] == keyword_ptr[0])&&
+				(strcmp(message_descriptor->Field_List[field_index].Keyword,keyword_ptr) == 0))
+				field = &(message_descriptor->Field_List[field_index]);
+			else
+			{
+				field_index++;
+				search_count++;
+			}
+		}
+		if(field == NULL)
+		{
+#if LOGGING > 9
+			Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERY_VERBOSE,
+					      "Wxt536_Data_Decode:Ignoring unknown keyword '%s' with value '%s'.",
+					      keyword_ptr,equals_ptr+1);
+#endif /* LOGGING */
+		}
+		else
+		{
+			found_field_mask[message_index] |= (1<<field_index);
+			if(field->Type == FIELD_TYPE_DOUBLE)
+			{
+				/* an invalid value leaves the field as it was, and not valid */
+				if(Wxt536_Parse_Number(class,source,equals_ptr+1,field->Units,
+						       (double*)(((char*)&decoded_data)+field->Offset)))
+				{
+					valid_field_mask[message_index] |= (1<<field_index);
+				}
+				else
+				{
+#if LOGGING > 1
+					Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_INTERMEDIATE,
+							      "Wxt536_Data_Decode:Field '%s' is not valid:%s",keyword_ptr,
+							      Wms_Wxt536_Error_String);
+#endif /* LOGGING */
+					Wms_Wxt536_Error_Number = 0;
+				}
+			}
+			else
+			{
+				strncpy(((char*)&decoded_data)+field->Offset,equals_ptr+1,FIELD_STRING_LENGTH-1);
+				(((char*)&decoded_data)+field->Offset)[FIELD_STRING_LENGTH-1] = '\0';
+				valid_field_mask[message_index] |= (1<<field_index);
+			}
+			field_index++;
+		}
+	}
+	/* copy back the data groups the message contained, with their field validity */
+	for(message_index = first_message_index; message_index <= last_message_index; message_index++)
+	{
+		message_descriptor = &(Message_Descriptor_List[message_index]);
+		if(found_field_mask[message_index] == 0)
+		{
+			/* composite messages only update the data groups they contain */
+			if(message_id == 0)
+				continue;
+			Wms_Wxt536_Error_Number = 152;
+			sprintf(Wms_Wxt536_Error_String,"Wxt536_Data_Decode:No fields found in data message aR%d.",
+				message_id);
+			return FALSE;
+		}
+		(*(unsigned int*)(((char*)&decoded_data)+message_descriptor->Valid_Mask_Offset)) = 
+			valid_field_mask[message_index];
+		memcpy(((char*)data)+message_descriptor->Offset,((char*)&decoded_data)+message_descriptor->Offset,
+		       message_descriptor->Size);
+		(*data_mask) |= message_descriptor->Data_Mask;
+	}
+#if LOGGING > 9
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,
+			      "Wxt536_Data_Decode:Message aR%d updated data mask 0x%x.",message_id,(*data_mask));
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Set the composite data message (aR0) half of the parameter selection (R) field for one of the Wxt536 
+ * sensor settings commands. We query the current settings, keep the individual data message half of the 
+ * parameter selection field as it is, replace the composite half with composite_selection, 
+ * and then (if this is different from the current setting) set the new parameter selection and check the reply.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536 (can be retrieved using Wms_Wxt536_Command_Device_Address_Get).
+ * @param settings_command The settings command to use, without the device address, i.e. one of "WU","TU","RU","SU","IU".
+ * @param composite_selection A string of PARAMETER_SELECTION_BIT_COUNT '0'/'1' characters, 
+ *        the parameters to include in the composite data message.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #PARAMETER_SELECTION_BIT_COUNT
+ * @see #Wms_Wxt536_Command
+ * @see #Wxt536_Parse_CSV_Reply
+ * @see #Wxt536_Parse_Parameter
+ * @see #Wxt536_Parameter_Selection_Strip
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+static int Wxt536_Composite_Parameter_Selection_Set(char *class,char *source,char device_address,
+						    char *settings_command,char *composite_selection)
+{
+	struct Wxt536_Parameter_List_Struct parameter_list;
+	char command_string[256];
+	char reply_string[256];
+	char current_selection[32];
+	char new_selection[32];
+
+	/* get the current parameter selection */
+	sprintf(command_string,"%c%s",device_address,settings_command);
+	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
+		return FALSE;
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"R","%31s",&parameter_list,
+				   current_selection))
+		return FALSE;
+	Wxt536_Parameter_Selection_Strip(current_selection);
+	if(strlen(current_selection) != (2*PARAMETER_SELECTION_BIT_COUNT))
+	{
+		Wms_Wxt536_Error_Number = 135;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Composite_Parameter_Selection_Set:"
+			"%c%s returned illegal parameter selection '%s'.",device_address,settings_command,
+			current_selection);
+		return FALSE;
+	}
+	/* keep the individual data message selection, replace the composite data message selection */
+	strncpy(new_selection,current_selection,PARAMETER_SELECTION_BIT_COUNT);
+	new_selection[PARAMETER_SELECTION_BIT_COUNT] = '\0';
+	strcat(new_selection,composite_selection);
+	if(strcmp(new_selection,current_selection) == 0)
+	{
+#if LOGGING > 5
+		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wxt536_Composite_Parameter_Selection_Set:"
+				      "%c%s parameter selection already '%s'.",device_address,settings_command,
+				      current_selection);
+#endif /* LOGGING */
+		return TRUE;
+	}
+#if LOGGING > 5
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wxt536_Composite_Parameter_Selection_Set:"
+			      "Changing %c%s parameter selection from '%s' to '%s'.",device_address,settings_command,
+			      current_selection,new_selection);
+#endif /* LOGGING */
+	/* set the new parameter selection, and check the reply */
+	sprintf(command_string,"%c%s,R=%s",device_address,settings_command,new_selection);
+	if(!Wms_Wxt536_Command(class,source,command_string,reply_string,255))
+		return FALSE;
+	if(!Wxt536_Parse_CSV_Reply(class,source,reply_string,&parameter_list))
+		return FALSE;
+	if(!Wxt536_Parse_Parameter(class,source,"R","%31s",&parameter_list,
+				   current_selection))
+		return FALSE;
+	Wxt536_Parameter_Selection_Strip(current_selection);
+	if(strcmp(new_selection,current_selection) != 0)
+	{
+		Wms_Wxt536_Error_Number = 136;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_Composite_Parameter_Selection_Set:"
+			"%c%s parameter selection was not set ('%s' vs '%s').",device_address,settings_command,
+			new_selection,current_selection);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * The Wxt536 returns parameter selection (R) fields with an '&' between the individual data message bits and the
+ * composite data message bits, e.g. "11111100&01001000". This routine removes the '&' in place, so the selection
+ * can be compared with, and sent back to the Wxt536 as, a plain string of bits.
+ * @param selection_string The parameter selection string to edit.
+ */
+static void Wxt536_Parameter_Selection_Strip(char *selection_string)
+{
+	char *src_ptr = NULL;
+	char *dest_ptr = NULL;
+
+	for(src_ptr = selection_string, dest_ptr = selection_string; (*src_ptr) != '\0'; src_ptr++)
+	{
+		if((*src_ptr) != '&')
+		{
+			(*dest_ptr) = (*src_ptr);
+			dest_ptr++;
+		}
+	}
+	(*dest_ptr) = '\0';
+}
+
+/**
+ * Routine to determine whether a command or reply string is a data message, of the form "aRn" or "aRn,...", 
+ * where 'a' is the device address and n is a digit 0..5, and if so which one.
+ * @param message_string The command or reply string to examine.
+ * @return The routine returns the data message number (0..5), or -1 if the string is not a data message.
+ */
+static int Wxt536_Data_Message_Id_Get(char *message_string)
+{
+	if(strlen(message_string) < 3)
+		return -1;
+	if(message_string[1] != 'R')
+		return -1;
+	if((message_string[2] < '0')||(message_string[2] > '5'))
+		return -1;
+	if((message_string[3] != '\0')&&(message_string[3] != ',')&&(message_string[3] != '\r'))
+		return -1;
+	return message_string[2]-'0';
+}
+
+/**
+ * Calculate the Vaisala CRC-16 of a string, using CRC_Table.
+ * @param string The string to calculate the CRC of.
+ * @param length The number of characters from the start of string to include in the CRC.
+ * @return The calculated CRC.
+ * @see #CRC_Table
+ */
+static unsigned short Wxt536_CRC_Calculate(char *string,int length)
+{
+	unsigned short crc;
+	int i;
+
+	crc = 0;
+	for(i = 0; i < length; i++)
+		crc = (crc >> 8)^CRC_Table[(crc^((unsigned char)string[i]))&0xff];
+	return crc;
+}
+
+/**
+ * Encode a CRC into the three printable characters used by the Vaisala CRC protocols.
+ * @param crc The CRC to encode.
+ * @param crc_string A string of at least CRC_LENGTH+1 characters, on return containing the encoded CRC.
+ * @see #CRC_LENGTH
+ */
+static void Wxt536_CRC_Encode(unsigned short crc,char *crc_string)
+{
+	crc_string[0] = (char)(0x40|(crc >> 12));
+	crc_string[1] = (char)(0x40|((crc >> 6)&0x3f));
+	crc_string[2] = (char)(0x40|(crc&0x3f));
+	crc_string[CRC_LENGTH] = '\0';
+}
+
+/**
+ * Convert a command into it's CRC form: the command letter following the device address is converted to
+ * lower case, and the encoded CRC of the result is appended. Commands without a command letter 
+ * (e.g. the device address query '?') are left unchanged.
+ * @param command_string The command to convert. There must be space for CRC_LENGTH more characters.
+ * @see #CRC_LENGTH
+ * @see #Wxt536_CRC_Calculate
+ * @see #Wxt536_CRC_Encode
+ */
+static void Wxt536_CRC_Add(char *command_string)
+{
+	char crc_string[CRC_LENGTH+1];
+
+	if((strlen(command_string) < 2)||(isalpha((int)(command_string[1])) == 0))
+		return;
+	command_string[1] = tolower((int)(command_string[1]));
+	Wxt536_CRC_Encode(Wxt536_CRC_Calculate(command_string,strlen(command_string)),crc_string);
+	strcat(command_string,crc_string);
+}
+
+/**
+ * Check and remove the CRC from a line received from the Wxt536. Lines sent with a CRC have a lower case
+ * message letter following the device address. For these, the CRC (the CRC_LENGTH characters before the terminator)
+ * is checked against the CRC calculated over the rest of the line. If it is correct, it is removed and the message letter
+ * converted back to upper case, so the line can be parsed as normal. If CRC_Enable is set, lines with a message letter
+ * that do not have a CRC are rejected.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param message The line to check, including the terminator. On success any CRC is removed from this string.
+ * @return The procedure returns TRUE if the line is valid, and FALSE if it is not 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #CRC_Enable
+ * @see #CRC_LENGTH
+ * @see #TERMINATOR_CRLF
+ * @see #Wxt536_CRC_Calculate
+ * @see #Wxt536_CRC_Encode
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+static int Wxt536_CRC_Check(char *class,char *source,char *message)
+{
+	char crc_string[CRC_LENGTH+1];
+	char *terminator_ptr = NULL;
+	int length;
+
+	if((strlen(message) < 2)||(isalpha((int)(message[1])) == 0))
+		return TRUE;
+	if(isupper((int)(message[1])))
+	{
+		if(CRC_Enable)
+		{
+			Wms_Wxt536_Error_Number = 148;
+			sprintf(Wms_Wxt536_Error_String,"Wxt536_CRC_Check:Line had no CRC.");
+			return FALSE;
+		}
+		return TRUE;
+	}
+	terminator_ptr = strstr(message,TERMINATOR_CRLF);
+	if(terminator_ptr != NULL)
+		length = terminator_ptr-message;
+	else
+		length = strlen(message);
+	if(length < (2+CRC_LENGTH))
+	{
+		Wms_Wxt536_Error_Number = 149;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_CRC_Check:Line too short (%d) to contain a CRC.",length);
+		return FALSE;
+	}
+	Wxt536_CRC_Encode(Wxt536_CRC_Calculate(message,length-CRC_LENGTH),crc_string);
+	if(strncmp(message+length-CRC_LENGTH,crc_string,CRC_LENGTH) != 0)
+	{
+		Wms_Wxt536_Error_Number = 150;
+		sprintf(Wms_Wxt536_Error_String,"Wxt536_CRC_Check:CRC mismatch ('%.3s' vs '%s').",
+			message+length-CRC_LENGTH,crc_string);
+		return FALSE;
+	}
+	/* remove the CRC, keeping the terminator */
+	memmove(message+length-CRC_LENGTH,message+length,strlen(message+length)+1);
+	message[1] = toupper((int)(message[1]));
+	return TRUE;
+}
+
+/**
+ * Switch the connection to one of the serial settings being probed by Wms_Wxt536_Command_Comms_Probe.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param setting The serial settings to use.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wxt536_Probe_Setting_Struct
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Baud_Rate_Set
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Framing_Set
+ */
+static int Wxt536_Probe_Setting_Set(char *class,char *source,const struct Wxt536_Probe_Setting_Struct *setting)
+{
+	if(!Wms_Wxt536_Connection_Baud_Rate_Set(class,source,setting->Baud_Rate))
+		return FALSE;
+	if(!Wms_Wxt536_Connection_Framing_Set(class,source,setting->Data_Bits,setting->Parity,setting->Stop_Bits))
+		return FALSE;
+	return TRUE;
+}
+
+/**
+ * Work out how long to wait for a reply to a probe at the specified serial settings. This is the probe timeout,
+ * plus the time PROBE_REPLY_CHARACTER_COUNT characters take to send at the setting's baud rate, so slow baud rates
+ * get the same margin as fast ones.
+ * @param setting The serial settings being probed.
+ * @param timeout_ms The probe timeout, in milliseconds.
+ * @return The time to wait for a reply, in milliseconds.
+ * @see #PROBE_REPLY_CHARACTER_COUNT
+ * @see #Wxt536_Probe_Setting_Struct
+ */
+static int Wxt536_Probe_Timeout_Get(const struct Wxt536_Probe_Setting_Struct *setting,int timeout_ms)
+{
+	int bits_per_character;
+
+	/* start bit, data bits, optional parity bit, stop bits */
+	bits_per_character = 1+setting->Data_Bits+((setting->Parity != 'N') ? 1 : 0)+setting->Stop_Bits;
+	return timeout_ms+((PROBE_REPLY_CHARACTER_COUNT*bits_per_character*1000)/setting->Baud_Rate)+1;
+}
+
+/**
+ * Internal routine used by Wms_Wxt536_Command (and the device probing routines) to send a string command to 
+ * the Vaisala Wxt536 over a previously opened connection, and wait up to timeout_ms for each reply line. 
+ * If the Wxt536 is in automatic mode, it may send data messages at any time, so reply lines that are data messages 
+ * (aR0..aR5) not requested by this command are discarded (up to MAX_UNSOLICITED_LINE_COUNT of them). 
+ * If CRC_Enable is set, the command is sent with a CRC (using Wxt536_CRC_Add), and each reply line has it's CRC 
+ * checked and removed (using Wxt536_CRC_Check). If a reply line fails it's CRC check, the command is resent at once 
+ * (up to MAX_CRC_RETRY_COUNT times), rather than parsing a corrupt reply.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param The command to send to the Vaisala Wxt536, as a NULL terminated string. The standard CRLF terminator
+ *        will be added to this string before onward transmission to the Wxt536.
+ * @param reply_string An empty string, on return this is filled with any reply received from the Wxt536.
+ *        The reply is read directly into this buffer, or NULL if no reply is expected.
+ * @param reply_string_length The allocated length of the reply_string buffer. Replies that do not fit fail to be read.
+ * @param timeout_ms How long to wait for each reply line, in milliseconds, or WMS_SERIAL_READ_TIMEOUT_DEFAULT to use
+ *        the connection's default read timeout.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wms_Wxt536_Command
+ * @see #TERMINATOR_CRLF
+ * @see #MESSAGE_LENGTH
+ * @see #MAX_UNSOLICITED_LINE_COUNT
+ * @see #MAX_CRC_RETRY_COUNT
+ * @see #CRC_Enable
+ * @see #Wxt536_Data_Message_Id_Get
+ * @see #Wxt536_CRC_Add
+ * @see #Wxt536_CRC_Check
+ * @see wms_wxt536_connection.html#Wms_Wxt536_Connection_Handle_Get
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log
+ * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Write
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Line
+ * @see ../../serial/cdocs/wms_serial_serial.html#WMS_SERIAL_READ_TIMEOUT_DEFAULT
+ */
+static int Wxt536_Command_Timeout(char *class,char *source,char *command_string,char *reply_string,
+				  int reply_string_length,int timeout_ms)
+{
+	char message[MESSAGE_LENGTH];
+	int bytes_read,command_message_id,reply_message_id,unsolicited_line_count,crc_retry_count,crc_ok;
+	
+	Wms_Wxt536_Error_Number = 0;
+	if(command_string == NULL)
+	{
+		Wms_Wxt536_Error_Number = 100;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:Command String was NULL.");
+		return FALSE;
+		
+	}
+	if(strlen(command_string) >= 256)
+	{
+		Wms_Wxt536_Error_Number = 101;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:Command String was too long (%lu vs 255).",
+			strlen(command_string));
+		return FALSE;
+		
+	}
+#if LOGGING > 9
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Wxt536_Command(%s) started.",command_string);
+#endif /* LOGGING */
+	command_message_id = Wxt536_Data_Message_Id_Get(command_string);
+	crc_retry_count = 0;
+	do
+	{
+		strcpy(message,command_string);
+		if(CRC_Enable)
+			Wxt536_CRC_Add(message);
+		strcat(message,TERMINATOR_CRLF);
+		if(!Wms_Serial_Write(class,source,Wms_Wxt536_Connection_Handle_Get(),message,strlen(message)))
+		{
+			Wms_Wxt536_Error_Number = 102;
+			sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:Failed to write command string '%s'.",
+				command_string);
+			return FALSE;
+		}
+		/* if we are not expecting a reply we are done */
+		if(reply_string == NULL)
+			break;
+		/* read the reply */
+		crc_ok = TRUE;
+		unsolicited_line_count = 0;
+		do
+		{
+			if(!Wms_Serial_Read_Line(class,source,Wms_Wxt536_Connection_Handle_Get(),TERMINATOR_CRLF,
+						 reply_string,reply_string_length-1,timeout_ms,
+						 &bytes_read))
+			{
+				Wms_Wxt536_Error_Number = 103;
+				sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:Failed to read reply line.");
+				return FALSE;
+			}
+			/* check and remove any CRC. Stop reading on a corrupt line, and resend the command. */
+			if(!Wxt536_CRC_Check(class,source,reply_string))
+			{
+#if LOGGING > 1
+				Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_TERSE,
+						      "Wms_Wxt536_Command(%s) reply '%s' failed CRC check:%s",
+						      command_string,reply_string,Wms_Wxt536_Error_String);
+#endif /* LOGGING */
+				crc_ok = FALSE;
+				break;
+			}
+			/* discard any unrequested data messages sent by a Wxt536 in automatic mode */
+			reply_message_id = Wxt536_Data_Message_Id_Get(reply_string);
+			if((reply_message_id != -1)&&(reply_message_id != command_message_id))
+			{
+#if LOGGING > 9
+				Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,
+						      "Wms_Wxt536_Command(%s) discarding unsolicited data message '%s'.",
+						      command_string,reply_string);
+#endif /* LOGGING */
+				unsolicited_line_count++;
+			}
+			else
+				break;
+		}
+		while(unsolicited_line_count < MAX_UNSOLICITED_LINE_COUNT);
+		if(unsolicited_line_count >= MAX_UNSOLICITED_LINE_COUNT)
+		{
+			Wms_Wxt536_Error_Number = 137;
+			sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:"
+				"Too many unsolicited data messages (%d) received whilst waiting for reply to '%s'.",
+				unsolicited_line_count,command_string);
+			return FALSE;
+		}
+		if(crc_ok == FALSE)
+			crc_retry_count++;
+	}
+	while((crc_ok == FALSE)&&(crc_retry_count <= MAX_CRC_RETRY_COUNT));
+	/* read any reply */
+	if(reply_string != NULL)
+	{
+		if(crc_ok == FALSE)
+		{
+			Wms_Wxt536_Error_Number = 146;
+			sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command:"
+				"Reply to '%s' failed CRC check %d times.",command_string,crc_retry_count);
+			return FALSE;
+		}
+#if LOGGING > 9
+		Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Wxt536_Command(%s) returned reply '%s'.",
+				      command_string,reply_string);
+#endif /* LOGGING */
+	}/* end if reply string was not NULL */
+#if LOGGING > 9
+	Wms_Wxt536_Log_Format(class,source,LOG_VERBOSITY_VERBOSE,"Wms_Wxt536_Command(%s) finished.",command_string);
+#endif /* LOGGING */
+	return TRUE;
+}
+
+/**
+ * Internal routine to retrieve the Device Address of a Wxt536 on the connected serial port, waiting up to
+ * timeout_ms for the reply. Used by Wms_Wxt536_Command_Device_Address_Get and Wms_Wxt536_Command_Comms_Probe.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param timeout_ms How long to wait for the reply, in milliseconds, or WMS_SERIAL_READ_TIMEOUT_DEFAULT to use
+ *        the connection's default read timeout.
+ * @param device_address The address of a character. If the procedure is successful, on return this will contain
+ *        the device_address character of the Wxt536 on the connected serial port.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wxt536_Command_Timeout
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+static int Wxt536_Device_Address_Get_Timeout(char *class,char *source,int timeout_ms,char *device_address)
+{
+	char reply_string[256];
+	int retval;
+
+	Wms_Wxt536_Error_Number = 0;
+	if(device_address == NULL)
+	{
+		Wms_Wxt536_Error_Number = 105;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Device_Address_Get:device_address was NULL.");
+		return FALSE;
+	}
+	if(!Wxt536_Command_Timeout(class,source,"?",reply_string,255,timeout_ms))
 		return FALSE;
+	retval = sscanf(reply_string,"%c",device_address);
+	if(retval != 1)
+	{
+		Wms_Wxt536_Error_Number = 106;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Device_Address_Get:"
+			"Failed to parse device address from reply string '%s'.",reply_string);
+		return FALSE;		
 	}
 	return TRUE;
 }
+
+/**
+ * Internal routine to check the Wxt536 with the specified device_address is active on the connected serial port,
+ * waiting up to timeout_ms for it's reply. Used by Wms_Wxt536_Command_Ack_Active, and by 
+ * Wms_Wxt536_Command_Device_Address_Scan and Wms_Wxt536_Command_Comms_Probe, which wait much less than the
+ * connection's default read timeout.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param device_address The device address of the Wxt536.
+ * @param timeout_ms How long to wait for the reply, in milliseconds, or WMS_SERIAL_READ_TIMEOUT_DEFAULT to use
+ *        the connection's default read timeout.
+ * @return The procedure returns TRUE if successful, and FALSE if it failed 
+ *         (Wms_Wxt536_Error_Number and Wms_Wxt536_Error_String are filled in on failure).
+ * @see #Wxt536_Command_Timeout
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+static int Wxt536_Ack_Active_Timeout(char *class,char *source,char device_address,int timeout_ms)
+{
+	char command_string[256];
+	char reply_string[256];
+	char reply_device_address;
+	int retval;
+
+	Wms_Wxt536_Error_Number = 0;
+	sprintf(command_string,"%c",device_address);
+	if(!Wxt536_Command_Timeout(class,source,command_string,reply_string,255,timeout_ms))
+		return FALSE;
+	retval = sscanf(reply_string,"%c",&reply_device_address);
+	if(retval != 1)
+	{
+		Wms_Wxt536_Error_Number = 107;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Ack_Active:"
+			"Failed to parse device address from reply string '%s'.",reply_string);
+		return FALSE;		
+	}
+	if(device_address != reply_device_address)
+	{
+		Wms_Wxt536_Error_Number = 108;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Command_Ack_Active:"
+			"Returned device address differed from command: '%c' vs '%c'  ('%s').",
+			device_address,reply_device_address,reply_string);
+		return FALSE;		
+	}
+	return TRUE;	
+}
@@ -29,9 +29,17 @@
 #include "wms_wxt536_general.h"
 #include "wms_wxt536_connection.h"
 
+/* hash defines */
+/**
+ * The read timeout the connection is opened with, if Wms_Wxt536_Connection_Read_Timeout_Set has not been used to set
+ * the serial handle's read timeout, in milliseconds.
+ */
+#define DEFAULT_READ_TIMEOUT (1000)
+
 /* external variables */
 /**
- * The handle we use (via the Wms Serial library) to open and close the serial port connection.
+ * The default handle we use (via the Wms Serial library) to open and close the serial port connection.
+ * @see #Connection_Handle
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Handle_T
  */
 Wms_Serial_Handle_T Wms_Wxt536_Serial_Handle;
@@ -41,6 +49,15 @@ Wms_Serial_Handle_T Wms_Wxt536_Serial_Handle;
  * Revision Control System identifier.
  */
 static char rcsid[] = "$Id$";
+/**
+ * The serial handle the calling thread's Wxt536 library routines use. This is thread local, and defaults to
+ * Wms_Wxt536_Serial_Handle. A thread can use another serial device by selecting it's own handle with
+ * Wms_Wxt536_Connection_Handle_Set before opening the connection.
+ * @see #Wms_Wxt536_Serial_Handle
+ * @see #Wms_Wxt536_Connection_Handle_Set
+ * @see #Wms_Wxt536_Connection_Handle_Get
+ */
+static __thread Wms_Serial_Handle_T *Connection_Handle = &Wms_Wxt536_Serial_Handle;
 
 /* external functions */
 /**
@@ -50,7 +67,7 @@ static char rcsid[] = "$Id$";
  * @param source The source parameter for logging.
  * @param device_name The device filename (i.e. /dev/ttyS0) that the Wxt536 is connected to.
  * @return We return TRUE if the connection is opened successfully, FALSE otherwise.
- * @see #Wms_Wxt536_Serial_Handle
+ * @see #Connection_Handle
  * @see wms_wxt536_general.html#Wms_Wxt536_Log
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see ../../serial/cdocs/wms_serial_serial.html#WMS_SERIAL_DEVICE_NAME_STRING_LENGTH
@@ -59,6 +76,9 @@ static char rcsid[] = "$Id$";
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Input_Flags_Set
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Output_Flags_Set
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Control_Flags_Set
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Local_Flags_Set
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Read_Timeout_Set
+ * @see #DEFAULT_READ_TIMEOUT
  */
 int Wms_Wxt536_Connection_Open(char *class,char *source,char *device_name)
 {
@@ -79,37 +99,53 @@ int Wms_Wxt536_Connection_Open(char *class,char *source,char *device_name)
 			strlen(device_name),WMS_SERIAL_DEVICE_NAME_STRING_LENGTH);
 		return FALSE;
 	}
-	strcpy(Wms_Wxt536_Serial_Handle.Device_Name,device_name);
+	strcpy(Connection_Handle->Device_Name,device_name);
 	/* set baud rate to B19200 */
-	if(!Wms_Serial_Baud_Rate_Set(B19200))
+	if(!Wms_Serial_Baud_Rate_Set(Connection_Handle,B19200))
 	{
 		Wms_Wxt536_Error_Number = 3;
 		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Connection_Open:Failed to configure baud rate to B19200.");
 		return FALSE;
 	}
 	/* Configure input flags to ignore parity bits */
-	if(!Wms_Serial_Input_Flags_Set(IGNPAR))
+	if(!Wms_Serial_Input_Flags_Set(Connection_Handle,IGNPAR))
 	{
 		Wms_Wxt536_Error_Number = 4;
 		sprintf(Wms_Wxt536_Error_String,
 			"Wms_Wxt536_Connection_Open:Failed to configure input flags to IGNPAR.");
 		return FALSE;
 	}
-	if(!Wms_Serial_Output_Flags_Set(0))
+	if(!Wms_Serial_Output_Flags_Set(Connection_Handle,0))
 	{
 		Wms_Wxt536_Error_Number = 5;
 		sprintf(Wms_Wxt536_Error_String,
 			"Wms_Wxt536_Connection_Open:Failed to configure output flags to 0.");
 		return FALSE;
 	}
-	if(!Wms_Serial_Control_Flags_Set(CS8|CLOCAL|CREAD))
+	if(!Wms_Serial_Control_Flags_Set(Connection_Handle,CS8|CLOCAL|CREAD))
 	{
 		Wms_Wxt536_Error_Number = 6;
 		sprintf(Wms_Wxt536_Error_String,
 			"Wms_Wxt536_Connection_Open:Failed to configure control flags to CS8|CLOCAL|CREAD (8N1).");
 		return FALSE;
 	}
-	if(!Wms_Serial_Open(class,source,&Wms_Wxt536_Serial_Handle))
+	if(!Wms_Serial_Local_Flags_Set(Connection_Handle,0))
+	{
+		Wms_Wxt536_Error_Number = 15;
+		sprintf(Wms_Wxt536_Error_String,
+			"Wms_Wxt536_Connection_Open:Failed to configure local flags to 0.");
+		return FALSE;
+	}
+	/* a serial handle's read timeout is zero until it is set */
+	if((Connection_Handle->Read_Timeout < 1)&&
+	   (!Wms_Serial_Read_Timeout_Set(Connection_Handle,DEFAULT_READ_TIMEOUT)))
+	{
+		Wms_Wxt536_Error_Number = 9;
+		sprintf(Wms_Wxt536_Error_String,
+			"Wms_Wxt536_Connection_Open:Failed to configure read timeout to %d ms.",DEFAULT_READ_TIMEOUT);
+		return FALSE;
+	}
+	if(!Wms_Serial_Open(class,source,Connection_Handle))
 	{
 		Wms_Wxt536_Error_Number = 7;
 		sprintf(Wms_Wxt536_Error_String,
@@ -127,7 +163,7 @@ int Wms_Wxt536_Connection_Open(char *class,char *source,char *device_name)
  * @param class The class parameter for logging.
  * @param source The source parameter for logging.
  * @return We return TRUE if the connection is opened successfully, FALSE otherwise.
- * @see #Wms_Wxt536_Serial_Handle
+ * @see #Connection_Handle
  * @see wms_wxt536_general.html#Wms_Wxt536_Log
  * @see wms_wxt536_general.html#Wms_Wxt536_Log_Format
  * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Close
@@ -137,7 +173,7 @@ int Wms_Wxt536_Connection_Close(char *class,char *source)
 #if LOGGING > 0
 	Wms_Wxt536_Log(class,source,LOG_VERBOSITY_INTERMEDIATE,"Wms_Wxt536_Connection_Close:Started.");
 #endif /* LOGGING */
-	if(!Wms_Serial_Close(class,source,&Wms_Wxt536_Serial_Handle))
+	if(!Wms_Serial_Close(class,source,Connection_Handle))
 	{
 		Wms_Wxt536_Error_Number = 8;
 		sprintf(Wms_Wxt536_Error_String,
@@ -149,3 +185,168 @@ int Wms_Wxt536_Connection_Close(char *class,char *source)
 #endif /* LOGGING */
 	return TRUE;
 }
+
+/**
+ * Routine to set how long reads from the Wxt536 wait for a reply, in milliseconds. This sets the read timeout of the
+ * calling thread's serial handle (Connection_Handle), so it is shared by every thread using that handle, and is kept
+ * when the connection is closed and opened again.
+ * @param timeout_ms The read timeout in milliseconds, which must be positive.
+ * @return We return TRUE if the timeout was set successfully, FALSE otherwise.
+ * @see #Connection_Handle
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ */
+int Wms_Wxt536_Connection_Read_Timeout_Set(int timeout_ms)
+{
+	if(timeout_ms < 1)
+	{
+		Wms_Wxt536_Error_Number = 10;
+		sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Connection_Read_Timeout_Set:Illegal timeout %d ms.",timeout_ms);
+		return FALSE;
+	}
+	Connection_Handle->Read_Timeout = timeout_ms;
+	return TRUE;
+}
+
+/**
+ * Routine to configure RS-485 half-duplex direction control on the open connection, for Wxt536s sharing an RS-485
+ * bus. The transmitter is released as soon as each command is sent, so the Wxt536 can reply after it's
+ * RS-485 line delay.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param enable A boolean, TRUE to enable RS-485 direction control, FALSE to disable it.
+ * @return We return TRUE if direction control was configured successfully, FALSE otherwise.
+ * @see #Connection_Handle
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_RS485_Set
+ */
+int Wms_Wxt536_Connection_RS485_Set(char *class,char *source,int enable)
+{
+	if(!Wms_Serial_RS485_Set(class,source,Connection_Handle,enable,0))
+	{
+		Wms_Wxt536_Error_Number = 11;
+		sprintf(Wms_Wxt536_Error_String,
+			"Wms_Wxt536_Connection_RS485_Set:Failed to set RS-485 direction control to %d on '%s'.",
+			enable,Connection_Handle->Device_Name);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Routine to change the baud rate of the open connection. This is used after the Wxt536's baud rate has been changed
+ * (using Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set), to continue talking to it at the new baud rate.
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param baud_rate The baud rate, one of 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200 
+ *        (the baud rates the Wxt536 supports).
+ * @return We return TRUE if the baud rate was changed successfully, FALSE otherwise.
+ * @see #Connection_Handle
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ * @see wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Baud_Rate_Change
+ */
+int Wms_Wxt536_Connection_Baud_Rate_Set(char *class,char *source,int baud_rate)
+{
+	int termios_baud_rate;
+
+	switch(baud_rate)
+	{
+		case 1200:
+			termios_baud_rate = B1200;
+			break;
+		case 2400:
+			termios_baud_rate = B2400;
+			break;
+		case 4800:
+			termios_baud_rate = B4800;
+			break;
+		case 9600:
+			termios_baud_rate = B9600;
+			break;
+		case 19200:
+			termios_baud_rate = B19200;
+			break;
+		case 38400:
+			termios_baud_rate = B38400;
+			break;
+		case 57600:
+			termios_baud_rate = B57600;
+			break;
+		case 115200:
+			termios_baud_rate = B115200;
+			break;
+		default:
+			Wms_Wxt536_Error_Number = 12;
+			sprintf(Wms_Wxt536_Error_String,"Wms_Wxt536_Connection_Baud_Rate_Set:Illegal baud rate %d.",
+				baud_rate);
+			return FALSE;
+	}
+	if(!Wms_Serial_Baud_Rate_Change(class,source,Connection_Handle,termios_baud_rate))
+	{
+		Wms_Wxt536_Error_Number = 13;
+		sprintf(Wms_Wxt536_Error_String,
+			"Wms_Wxt536_Connection_Baud_Rate_Set:Failed to change the baud rate to %d on '%s'.",
+			baud_rate,Connection_Handle->Device_Name);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Routine to change the character framing of the open connection. This is used after the Wxt536's framing has been
+ * changed (using Wms_Wxt536_Command_Comms_Settings_Serial_Set), or when probing for the Wxt536's serial settings
+ * (Wms_Wxt536_Command_Comms_Probe).
+ * @param class The class parameter for logging.
+ * @param source The source parameter for logging.
+ * @param data_bits The number of data bits per character, 7 or 8.
+ * @param parity The parity to use, one of 'N' (none), 'E' (even) or 'O' (odd).
+ * @param stop_bits The number of stop bits per character, 1 or 2.
+ * @return We return TRUE if the framing was changed successfully, FALSE otherwise.
+ * @see #Connection_Handle
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_Number
+ * @see wms_wxt536_general.html#Wms_Wxt536_Error_String
+ * @see wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Settings_Serial_Set
+ * @see wms_wxt536_command.html#Wms_Wxt536_Command_Comms_Probe
+ * @see ../../serial/cdocs/wms_serial_serial.html#Wms_Serial_Framing_Change
+ */
+int Wms_Wxt536_Connection_Framing_Set(char *class,char *source,int data_bits,char parity,int stop_bits)
+{
+	if(!Wms_Serial_Framing_Change(class,source,Connection_Handle,data_bits,parity,stop_bits))
+	{
+		Wms_Wxt536_Error_Number = 14;
+		sprintf(Wms_Wxt536_Error_String,
+			"Wms_Wxt536_Connection_Framing_Set:Failed to change the framing to %d%c%d on '%s'.",
+			data_bits,parity,stop_bits,Connection_Handle->Device_Name);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Routine to select the serial handle the calling thread's Wxt536 library routines use. This allows several threads to
+ * each use a different serial device at once. The handle should be selected before the connection is opened.
+ * @param handle The address of the serial handle to use, or NULL to use the default handle, 
+ *        Wms_Wxt536_Serial_Handle.
+ * @see #Connection_Handle
+ * @see #Wms_Wxt536_Serial_Handle
+ */
+void Wms_Wxt536_Connection_Handle_Set(Wms_Serial_Handle_T *handle)
+{
+	if(handle == NULL)
+		Connection_Handle = &Wms_Wxt536_Serial_Handle;
+	else
+		Connection_Handle = handle;
+}
+
+/**
+ * Routine to get the serial handle the calling thread's Wxt536 library routines use.
+ * @return The address of the serial handle.
+ * @see #Connection_Handle
+ */
+Wms_Serial_Handle_T *Wms_Wxt536_Connection_Handle_Get(void)
+{
+	return Connection_Handle;
+}
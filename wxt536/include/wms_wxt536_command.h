@@ -23,6 +23,143 @@
  * @see #Wms_Wxt536_Command_Comms_Settings_Protocol_Set
  */
 #define WXT536_COMMAND_COMMS_SETTINGS_PROTOCOL_POLLED_CRC      ('p')
+/**
+ * The device addresses a Wxt536 can be configured to use, in the order Wms_Wxt536_Command_Device_Address_Scan
+ * checks them.
+ * @see #Wms_Wxt536_Command_Device_Address_Scan
+ */
+#define WXT536_COMMAND_DEVICE_ADDRESS_LIST   ("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz")
+/**
+ * The number of device addresses in WXT536_COMMAND_DEVICE_ADDRESS_LIST.
+ * @see #WXT536_COMMAND_DEVICE_ADDRESS_LIST
+ */
+#define WXT536_COMMAND_DEVICE_ADDRESS_COUNT  (62)
+/**
+ * Bit returned in the data_mask of Wms_Wxt536_Command_Data_Message_Read, when the wind data was updated.
+ * @see #Wms_Wxt536_Command_Data_Message_Read
+ */
+#define WXT536_COMMAND_DATA_WIND                               (1<<0)
+/**
+ * Bit returned in the data_mask of Wms_Wxt536_Command_Data_Message_Read, 
+ * when the pressure/temperature/humidity data was updated.
+ * @see #Wms_Wxt536_Command_Data_Message_Read
+ */
+#define WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY      (1<<1)
+/**
+ * Bit returned in the data_mask of Wms_Wxt536_Command_Data_Message_Read, when the precipitation data was updated.
+ * @see #Wms_Wxt536_Command_Data_Message_Read
+ */
+#define WXT536_COMMAND_DATA_PRECIPITATION                      (1<<2)
+/**
+ * Bit returned in the data_mask of Wms_Wxt536_Command_Data_Message_Read, when the supervisor data was updated.
+ * @see #Wms_Wxt536_Command_Data_Message_Read
+ */
+#define WXT536_COMMAND_DATA_SUPERVISOR                         (1<<3)
+/**
+ * Bit returned in the data_mask of Wms_Wxt536_Command_Data_Message_Read, when the analogue data was updated.
+ * @see #Wms_Wxt536_Command_Data_Message_Read
+ */
+#define WXT536_COMMAND_DATA_ANALOGUE                           (1<<4)
+
+/* enums */
+/**
+ * The fields of the Wind Data Message (aR1). Each value is the bit number of the field in 
+ * Wxt536_Command_Wind_Data_Struct's Valid_Mask. This is one of:
+ * <ul>
+ * <li>WXT536_COMMAND_WIND_DIRECTION_MINIMUM
+ * <li>WXT536_COMMAND_WIND_DIRECTION_AVERAGE
+ * <li>WXT536_COMMAND_WIND_DIRECTION_MAXIMUM
+ * <li>WXT536_COMMAND_WIND_SPEED_MINIMUM
+ * <li>WXT536_COMMAND_WIND_SPEED_AVERAGE
+ * <li>WXT536_COMMAND_WIND_SPEED_MAXIMUM
+ * </ul>
+ * WXT536_COMMAND_WIND_FIELD_COUNT is the number of fields.
+ * @see #Wxt536_Command_Wind_Data_Struct
+ */
+enum Wxt536_Command_Wind_Field_Enum
+{
+	WXT536_COMMAND_WIND_DIRECTION_MINIMUM,WXT536_COMMAND_WIND_DIRECTION_AVERAGE,
+	WXT536_COMMAND_WIND_DIRECTION_MAXIMUM,WXT536_COMMAND_WIND_SPEED_MINIMUM,WXT536_COMMAND_WIND_SPEED_AVERAGE,
+	WXT536_COMMAND_WIND_SPEED_MAXIMUM,WXT536_COMMAND_WIND_FIELD_COUNT
+};
+
+/**
+ * The fields of the Pressure/Temperature/Humidity Data Message (aR2). Each value is the bit number of the field in 
+ * Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct's Valid_Mask. This is one of:
+ * <ul>
+ * <li>WXT536_COMMAND_AIR_TEMPERATURE
+ * <li>WXT536_COMMAND_RELATIVE_HUMIDITY
+ * <li>WXT536_COMMAND_AIR_PRESSURE
+ * </ul>
+ * WXT536_COMMAND_PRESSURE_TEMPERATURE_HUMIDITY_FIELD_COUNT is the number of fields.
+ * @see #Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct
+ */
+enum Wxt536_Command_Pressure_Temperature_Humidity_Field_Enum
+{
+	WXT536_COMMAND_AIR_TEMPERATURE,WXT536_COMMAND_RELATIVE_HUMIDITY,WXT536_COMMAND_AIR_PRESSURE,
+	WXT536_COMMAND_PRESSURE_TEMPERATURE_HUMIDITY_FIELD_COUNT
+};
+
+/**
+ * The fields of the Precipitation Data Message (aR3). Each value is the bit number of the field in 
+ * Wxt536_Command_Precipitation_Data_Struct's Valid_Mask. This is one of:
+ * <ul>
+ * <li>WXT536_COMMAND_RAIN_ACCUMULATION
+ * <li>WXT536_COMMAND_RAIN_DURATION
+ * <li>WXT536_COMMAND_RAIN_INTENSITY
+ * <li>WXT536_COMMAND_HAIL_ACCUMULATION
+ * <li>WXT536_COMMAND_HAIL_DURATION
+ * <li>WXT536_COMMAND_HAIL_INTENSITY
+ * <li>WXT536_COMMAND_RAIN_PEAK_INTENSITY
+ * <li>WXT536_COMMAND_HAIL_PEAK_INTENSITY
+ * </ul>
+ * WXT536_COMMAND_PRECIPITATION_FIELD_COUNT is the number of fields.
+ * @see #Wxt536_Command_Precipitation_Data_Struct
+ */
+enum Wxt536_Command_Precipitation_Field_Enum
+{
+	WXT536_COMMAND_RAIN_ACCUMULATION,WXT536_COMMAND_RAIN_DURATION,WXT536_COMMAND_RAIN_INTENSITY,
+	WXT536_COMMAND_HAIL_ACCUMULATION,WXT536_COMMAND_HAIL_DURATION,WXT536_COMMAND_HAIL_INTENSITY,
+	WXT536_COMMAND_RAIN_PEAK_INTENSITY,WXT536_COMMAND_HAIL_PEAK_INTENSITY,WXT536_COMMAND_PRECIPITATION_FIELD_COUNT
+};
+
+/**
+ * The fields of the Supervisor Data Message (aR5). Each value is the bit number of the field in 
+ * Wxt536_Command_Supervisor_Data_Struct's Valid_Mask. This is one of:
+ * <ul>
+ * <li>WXT536_COMMAND_HEATING_TEMPERATURE
+ * <li>WXT536_COMMAND_HEATING_VOLTAGE
+ * <li>WXT536_COMMAND_SUPPLY_VOLTAGE
+ * <li>WXT536_COMMAND_REFERENCE_VOLTAGE
+ * <li>WXT536_COMMAND_INFORMATION
+ * </ul>
+ * WXT536_COMMAND_SUPERVISOR_FIELD_COUNT is the number of fields.
+ * @see #Wxt536_Command_Supervisor_Data_Struct
+ */
+enum Wxt536_Command_Supervisor_Field_Enum
+{
+	WXT536_COMMAND_HEATING_TEMPERATURE,WXT536_COMMAND_HEATING_VOLTAGE,WXT536_COMMAND_SUPPLY_VOLTAGE,
+	WXT536_COMMAND_REFERENCE_VOLTAGE,WXT536_COMMAND_INFORMATION,WXT536_COMMAND_SUPERVISOR_FIELD_COUNT
+};
+
+/**
+ * The fields of the Analog Data Message (aR4). Each value is the bit number of the field in 
+ * Wxt536_Command_Analogue_Data_Struct's Valid_Mask. This is one of:
+ * <ul>
+ * <li>WXT536_COMMAND_PT1000_TEMPERATURE
+ * <li>WXT536_COMMAND_AUX_RAIN_ACCUMULATION
+ * <li>WXT536_COMMAND_ULTRASONIC_LEVEL_VOLTAGE
+ * <li>WXT536_COMMAND_SOLAR_RADIATION_VOLTAGE
+ * </ul>
+ * WXT536_COMMAND_ANALOGUE_FIELD_COUNT is the number of fields.
+ * @see #Wxt536_Command_Analogue_Data_Struct
+ */
+enum Wxt536_Command_Analogue_Field_Enum
+{
+	WXT536_COMMAND_PT1000_TEMPERATURE,WXT536_COMMAND_AUX_RAIN_ACCUMULATION,
+	WXT536_COMMAND_ULTRASONIC_LEVEL_VOLTAGE,WXT536_COMMAND_SOLAR_RADIATION_VOLTAGE,
+	WXT536_COMMAND_ANALOGUE_FIELD_COUNT
+};
 
 /**
  * Data structure containing data parsed from a reply to a Request Current Communication Settings Message (aXU).
@@ -92,6 +229,8 @@ struct Wxt536_Command_Comms_Settings_Struct
  * <dt>Wind_Speed_Minimum</dt> <dd>A double representing the wind speed minimum in metres/s.</dd>
  * <dt>Wind_Speed_Average</dt> <dd>A double representing the wind speed average in metres/s.</dd>
  * <dt>Wind_Speed_Maximum</dt> <dd>A double representing the wind speed maximum in metres/s.</dd>
+ * <dt>Valid_Mask</dt> <dd>A bit mask of the fields that were valid in the last reply, indexed by
+ *     Wxt536_Command_Wind_Field_Enum. Invalid fields keep their previous values.</dd>
  * </dl>
  */
 struct Wxt536_Command_Wind_Data_Struct
@@ -102,6 +241,7 @@ struct Wxt536_Command_Wind_Data_Struct
 	double Wind_Speed_Minimum;
 	double Wind_Speed_Average;
 	double Wind_Speed_Maximum;
+	unsigned int Valid_Mask;
 };
 
 /**
@@ -110,6 +250,8 @@ struct Wxt536_Command_Wind_Data_Struct
  * <dt>Air_Temperature</dt> <dd>A double representing the air temperature in degrees Centigrade.</dd>
  * <dt>Relative_Humidity</dt> <dd>A double representing the relative humidity in percent RH.</dd>
  * <dt>Air_Pressure</dt> <dd>A double representing the air pressure in hPA (Hectopascals = mbar).</dd>
+ * <dt>Valid_Mask</dt> <dd>A bit mask of the fields that were valid in the last reply, indexed by
+ *     Wxt536_Command_Pressure_Temperature_Humidity_Field_Enum. Invalid fields keep their previous values.</dd>
  * </dl>
  */
 struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct
@@ -117,6 +259,7 @@ struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct
 	double Air_Temperature;
 	double Relative_Humidity;
 	double Air_Pressure;
+	unsigned int Valid_Mask;
 };
 
 /**
@@ -132,6 +275,8 @@ struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct
  *                              Not returned by our weather station.</dd>
  * <dt>Hail_Peak_Intensity</dt> <dd>A double representing the hail peak intensity in hits/cm^2h. 
  *                              Not returned by our weather station.</dd>
+ * <dt>Valid_Mask</dt> <dd>A bit mask of the fields that were valid in the last reply, indexed by
+ *     Wxt536_Command_Precipitation_Field_Enum. Invalid fields keep their previous values.</dd>
  * </dl>
  */
 struct Wxt536_Command_Precipitation_Data_Struct
@@ -144,6 +289,7 @@ struct Wxt536_Command_Precipitation_Data_Struct
 	double Hail_Intensity;
 	double Rain_Peak_Intensity;
 	double Hail_Peak_Intensity;
+	unsigned int Valid_Mask;
 };
 
 /**
@@ -156,6 +302,8 @@ struct Wxt536_Command_Precipitation_Data_Struct
  *     nominally 3.5V.</dd>
  * <dt>Information</dt> <dd>A string containing the returned information field. 
  *                      This field does not seem to be returned by our unit.</dd>
+ * <dt>Valid_Mask</dt> <dd>A bit mask of the fields that were valid in the last reply, indexed by
+ *     Wxt536_Command_Supervisor_Field_Enum. Invalid fields keep their previous values.</dd>
  * </dl>
  */
 struct Wxt536_Command_Supervisor_Data_Struct
@@ -165,6 +313,7 @@ struct Wxt536_Command_Supervisor_Data_Struct
 	double Supply_Voltage;
 	double Reference_Voltage;
 	char Information[256];
+	unsigned int Valid_Mask;
 };
 
 /**
@@ -179,6 +328,8 @@ struct Wxt536_Command_Supervisor_Data_Struct
  *                                   This returns 3v when dry, and 1v when fully wet.</dd>
  * <dt>Solar_Radiation_Voltage</dt> <dd>A double representing the voltage returned by the pyranometer 
  *                                  (in Volts multiplied by the gain)</dd>
+ * <dt>Valid_Mask</dt> <dd>A bit mask of the fields that were valid in the last reply, indexed by
+ *     Wxt536_Command_Analogue_Field_Enum. Invalid fields keep their previous values.</dd>
  * </dl>
  */
 struct Wxt536_Command_Analogue_Data_Struct
@@ -187,17 +338,59 @@ struct Wxt536_Command_Analogue_Data_Struct
 	double Aux_Rain_Accumulation;
 	double Ultrasonic_Level_Voltage;
 	double Solar_Radiation_Voltage;
+	unsigned int Valid_Mask;
+};
+
+/**
+ * Data structure containing data parsed from a reply to a Composite Data Message (aR0). The Wxt536 must be configured
+ * (using Wms_Wxt536_Command_Composite_Data_Configure) to return all the required fields in the composite data message.
+ * <dl>
+ * <dt>Wind_Data</dt> <dd>The wind data, as would be returned by the Wind Data Message (aR1).</dd>
+ * <dt>Pressure_Temperature_Humidity_Data</dt> <dd>The pressure/temperature/humidity data, 
+ *     as would be returned by the Pressure/Temperature/Humidity Data Message (aR2).</dd>
+ * <dt>Precipitation_Data</dt> <dd>The precipitation data, as would be returned by the Precipitation Data Message (aR3).</dd>
+ * <dt>Supervisor_Data</dt> <dd>The supervisor data, as would be returned by the Supervisor Data Message (aR5).</dd>
+ * <dt>Analogue_Data</dt> <dd>The analogue data, as would be returned by the Analog Data Message (aR4).</dd>
+ * </dl>
+ * @see #Wxt536_Command_Wind_Data_Struct
+ * @see #Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct
+ * @see #Wxt536_Command_Precipitation_Data_Struct
+ * @see #Wxt536_Command_Supervisor_Data_Struct
+ * @see #Wxt536_Command_Analogue_Data_Struct
+ * @see #Wms_Wxt536_Command_Composite_Data_Configure
+ */
+struct Wxt536_Command_Composite_Data_Struct
+{
+	struct Wxt536_Command_Wind_Data_Struct Wind_Data;
+	struct Wxt536_Command_Pressure_Temperature_Humidity_Data_Struct Pressure_Temperature_Humidity_Data;
+	struct Wxt536_Command_Precipitation_Data_Struct Precipitation_Data;
+	struct Wxt536_Command_Supervisor_Data_Struct Supervisor_Data;
+	struct Wxt536_Command_Analogue_Data_Struct Analogue_Data;
 };
 
 extern int Wms_Wxt536_Command(char *class,char *source,char *command_string,char *reply_string,int reply_string_length);
 extern int Wms_Wxt536_Command_Device_Address_Get(char *class,char *source,char *device_address);
 extern int Wms_Wxt536_Command_Ack_Active(char *class,char *source,char device_address);
+extern int Wms_Wxt536_Command_Device_Address_Scan(char *class,char *source,int timeout_ms,char *device_address_list,
+						  int device_address_list_length,int *device_count);
+extern int Wms_Wxt536_Command_Comms_Probe(char *class,char *source,char device_address,int timeout_ms,
+					  struct Wxt536_Command_Comms_Settings_Struct *comms_settings);
 extern int Wms_Wxt536_Command_Comms_Settings_Get(char *class,char *source,char device_address,
 						 struct Wxt536_Command_Comms_Settings_Struct *comms_settings);
+extern int Wms_Wxt536_Command_Comms_Settings_Parse(char *class,char *source,char *reply_string,
+						   struct Wxt536_Command_Comms_Settings_Struct *comms_settings);
 extern int Wms_Wxt536_Command_Comms_Settings_Protocol_Set(char *class,char *source,char device_address,char protocol);
+extern int Wms_Wxt536_Command_Comms_Settings_Composite_Interval_Set(char *class,char *source,char device_address,
+								    int interval);
+extern int Wms_Wxt536_Command_Comms_Settings_Baud_Rate_Set(char *class,char *source,char device_address,
+							    int baud_rate);
+extern int Wms_Wxt536_Command_Comms_Settings_Serial_Set(char *class,char *source,char device_address,int baud_rate,
+							int data_bits,char parity,int stop_bits);
 extern int Wms_Wxt536_Command_Reset(char *class,char *source,char device_address);
 extern int Wms_Wxt536_Command_Reset_Precipitation_Counter(char *class,char *source,char device_address);
 extern int Wms_Wxt536_Command_Reset_Precipitation_Intensity(char *class,char *source,char device_address);
+extern int Wms_Wxt536_Command_Update_Interval_Get(char *class,char *source,char device_address,int message_id,
+						  double *update_interval);
 extern int Wms_Wxt536_Command_Analogue_Input_Settings_Get(char *class,char *source,char device_address,
 							  double *update_interval, double *averaging_time);
 extern int Wms_Wxt536_Command_Analogue_Input_Settings_Set(char *class,char *source,char device_address,
@@ -214,4 +407,17 @@ extern int Wms_Wxt536_Command_Supervisor_Data_Get(char *class,char *source,char
 						  struct Wxt536_Command_Supervisor_Data_Struct *data);
 extern int Wms_Wxt536_Command_Analogue_Data_Get(char *class,char *source,char device_address,
 						struct Wxt536_Command_Analogue_Data_Struct *data);
+extern int Wms_Wxt536_Command_Composite_Data_Configure(char *class,char *source,char device_address);
+extern int Wms_Wxt536_Command_Composite_Data_Get(char *class,char *source,char device_address,
+						 struct Wxt536_Command_Composite_Data_Struct *data);
+extern int Wms_Wxt536_Command_CRC_Enable_Set(int enable);
+extern int Wms_Wxt536_Command_CRC_Enable_Get(void);
+extern int Wms_Wxt536_Command_Data_Message_Request(char *class,char *source,char device_address,int message_id);
+extern int Wms_Wxt536_Command_Data_Message_Read(char *class,char *source,char device_address,int timeout_ms,
+						struct Wxt536_Command_Composite_Data_Struct *data,int *data_mask);
+extern int Wms_Wxt536_Command_Data_Message_Parse(char *class,char *source,char device_address,char *message,
+						 struct Wxt536_Command_Composite_Data_Struct *data,int *data_mask);
+extern int Wms_Wxt536_Command_Data_Message_Buffered(void);
+extern int Wms_Wxt536_Command_Reply_Read(char *class,char *source,int timeout_ms,char *reply_string,
+					 int reply_string_length,int *bytes_read);
 #endif
@@ -6,6 +6,12 @@
 
 extern int Wms_Wxt536_Connection_Open(char *class,char *source,char *device_name);
 extern int Wms_Wxt536_Connection_Close(char *class,char *source);
+extern int Wms_Wxt536_Connection_Read_Timeout_Set(int timeout_ms);
+extern int Wms_Wxt536_Connection_RS485_Set(char *class,char *source,int enable);
+extern int Wms_Wxt536_Connection_Baud_Rate_Set(char *class,char *source,int baud_rate);
+extern int Wms_Wxt536_Connection_Framing_Set(char *class,char *source,int data_bits,char parity,int stop_bits);
+extern void Wms_Wxt536_Connection_Handle_Set(Wms_Serial_Handle_T *handle);
+extern Wms_Serial_Handle_T *Wms_Wxt536_Connection_Handle_Get(void);
 
 /* external variables */
 extern Wms_Serial_Handle_T Wms_Wxt536_Serial_Handle;
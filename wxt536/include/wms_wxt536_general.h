@@ -49,7 +49,7 @@ extern int Wms_Wxt536_Log_Filter_Level_Absolute(char *class,char *source,int lev
 extern int Wms_Wxt536_Log_Filter_Level_Bitwise(char *class,char *source,int level,char *string);
 
 /* external variables */
-extern int Wms_Wxt536_Error_Number;
-extern char Wms_Wxt536_Error_String[];
+extern __thread int Wms_Wxt536_Error_Number;
+extern __thread char Wms_Wxt536_Error_String[];
 
 #endif
@@ -0,0 +1,366 @@
+/* wxt536_command_composite_data_get.c
+** Open a connection to the Vaisala Wxt536, retrieve all the current data using the composite data message 
+** and print it out.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "wms_wxt536_command.h"
+#include "wms_wxt536_connection.h"
+#include "wms_wxt536_general.h"
+#include "wms_serial_general.h"
+
+/**
+ * Open a connection to the Vaisala Wxt536, retrieve all the current data using the composite data message (aR0)
+ * and print it out. Optionally, configure the Wxt536 composite data message first, and/or time a number of
+ * composite data refreshes against the same number of refreshes using the individual data messages (aR1..aR5).
+ * @author $Author: cjm $
+ */
+/* hash definitions */
+/**
+ * Default log level.
+ */
+#define DEFAULT_LOG_LEVEL       (LOG_VERBOSITY_VERY_VERBOSE)
+/* internal variables */
+/**
+ * Revision control system identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The name of the serial device to open.
+ */
+char Serial_Device_Name[256];
+/**
+ * A character identifying the Vaisala Wxt536 device address.
+ */
+char Device_Address = ' ';
+/**
+ * A boolean, if TRUE call Wms_Wxt536_Command_Composite_Data_Configure before retrieving the data.
+ */
+int Configure = FALSE;
+/**
+ * The number of refreshes to time, for each of the composite and individual data messages. 
+ * If zero, no timing comparison is done.
+ */
+int Compare_Count = 0;
+
+/* internal routines */
+static int Parse_Arguments(int argc, char *argv[]);
+static void Help(void);
+static int Compare_Refresh_Times(void);
+
+/**
+ * Main program.
+ * @param argc The number of arguments to the program.
+ * @param argv An array of argument strings.
+ * @return This function returns 0 if the program succeeds, and a positive integer if it fails.
+ * @see #DEFAULT_LOG_LEVEL
+ * @see #Serial_Device_Name
+ * @see #Device_Address
+ * @see #Configure
+ * @see #Compare_Count
+ * @see #Parse_Arguments
+ * @see #Compare_Refresh_Times
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Handler_Function
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Log_Handler_Stdout
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Function
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Log_Filter_Level_Absolute
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Level
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Error
+ * @see ../cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Open
+ * @see ../cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Close
+ * @see ../cdocs/wms_wxt536_command.html#Wxt536_Command_Composite_Data_Struct
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Composite_Data_Configure
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Composite_Data_Get
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Handler_Function
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Log_Handler_Stdout
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Function
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Log_Filter_Level_Absolute
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Level
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Get_Error_Number
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Error
+ */
+int main(int argc, char *argv[])
+{
+	struct Wxt536_Command_Composite_Data_Struct data;
+	
+	fprintf(stdout,"Wxt536 Get Composite Data\n");
+	/* initialise logging */
+	Wms_Wxt536_Set_Log_Handler_Function(Wms_Wxt536_Log_Handler_Stdout);
+	Wms_Wxt536_Set_Log_Filter_Function(Wms_Wxt536_Log_Filter_Level_Absolute);
+	Wms_Wxt536_Set_Log_Filter_Level(DEFAULT_LOG_LEVEL);
+	Wms_Serial_Set_Log_Handler_Function(Wms_Serial_Log_Handler_Stdout);
+	Wms_Serial_Set_Log_Filter_Function(Wms_Serial_Log_Filter_Level_Absolute);
+	Wms_Serial_Set_Log_Filter_Level(DEFAULT_LOG_LEVEL);
+	fprintf(stdout,"Parsing Arguments.\n");
+	/* parse arguments */
+	if(!Parse_Arguments(argc,argv))
+		return 1;
+	/* open interface */
+	if(strlen(Serial_Device_Name) < 1)
+	{
+		fprintf(stdout,"Wxt536 Get Composite Data: Specify a serial device filename.\n");
+		return 2;
+	}
+	if(!Wms_Wxt536_Connection_Open("Wxt536 Get Composite Data","wxt536_command_composite_data_get.c",
+				       Serial_Device_Name))
+	{
+		Wms_Wxt536_Error();
+		if(Wms_Serial_Get_Error_Number() != 0)
+			Wms_Serial_Error();
+		return 3;
+	}
+	/* configure the composite data message, if requested */
+	if(Configure)
+	{
+		fprintf(stdout,"Configuring the composite data message of Wxt536 with Device Address '%c'.\n",
+			Device_Address);
+		if(!Wms_Wxt536_Command_Composite_Data_Configure("Wxt536 Get Composite Data",
+								"wxt536_command_composite_data_get.c",Device_Address))
+		{
+			Wms_Wxt536_Error();
+			if(Wms_Serial_Get_Error_Number() != 0)
+				Wms_Serial_Error();
+			return 4;
+		}
+	}
+	/* send command and read reply */
+	fprintf(stdout,"Getting Composite Data from Wxt536 with Device Address '%c'.\n",Device_Address);
+	if(!Wms_Wxt536_Command_Composite_Data_Get("Wxt536 Get Composite Data","wxt536_command_composite_data_get.c",
+						  Device_Address,&data))
+	{
+		Wms_Wxt536_Error();
+		if(Wms_Serial_Get_Error_Number() != 0)
+			Wms_Serial_Error();
+		return 4;
+	}
+	fprintf(stdout,"Average wind direction %.2f degrees.\n",data.Wind_Data.Wind_Direction_Average);
+	fprintf(stdout,"Average wind speed %.2f m/s.\n",data.Wind_Data.Wind_Speed_Average);
+	fprintf(stdout,"Air temperature %.2f C.\n",data.Pressure_Temperature_Humidity_Data.Air_Temperature);
+	fprintf(stdout,"Relative humidity %.2f %%RH.\n",data.Pressure_Temperature_Humidity_Data.Relative_Humidity);
+	fprintf(stdout,"Air pressure %.2f hPa.\n",data.Pressure_Temperature_Humidity_Data.Air_Pressure);
+	fprintf(stdout,"Rain intensity %.2f mm/h.\n",data.Precipitation_Data.Rain_Intensity);
+	fprintf(stdout,"Hail intensity %.2f hits/cm^2h.\n",data.Precipitation_Data.Hail_Intensity);
+	fprintf(stdout,"Supply voltage %.2f V.\n",data.Supervisor_Data.Supply_Voltage);
+	fprintf(stdout,"Ultrasonic level voltage %.3f V.\n",data.Analogue_Data.Ultrasonic_Level_Voltage);
+	fprintf(stdout,"Solar radiation voltage %.3f V.\n",data.Analogue_Data.Solar_Radiation_Voltage);
+	/* compare refresh times, if requested */
+	if(Compare_Count > 0)
+	{
+		if(!Compare_Refresh_Times())
+		{
+			Wms_Wxt536_Error();
+			if(Wms_Serial_Get_Error_Number() != 0)
+				Wms_Serial_Error();
+			return 4;
+		}
+	}
+	/* close interface */
+	if(!Wms_Wxt536_Connection_Close("Wxt536 Get Composite Data","wxt536_command_composite_data_get.c"))
+	{
+		Wms_Wxt536_Error();
+		if(Wms_Serial_Get_Error_Number() != 0)
+			Wms_Serial_Error();
+		return 5;
+	}
+	fprintf(stdout,"Wxt536 Get Composite Data:Finished.\n");
+	return 0;
+}
+
+/**
+ * Routine to parse command line arguments.
+ * @param argc The number of arguments sent to the program.
+ * @param argv An array of argument strings.
+ * @see #Help
+ * @see #Configure
+ * @see #Compare_Count
+ * @see #Device_Address
+ * @see #Serial_Device_Name
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Level
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Level
+ */
+static int Parse_Arguments(int argc, char *argv[])
+{
+	int i,retval,ivalue;
+
+	for(i=1;i<argc;i++)
+	{
+		if((strcmp(argv[i],"-compare")==0)||(strcmp(argv[i],"-compare_count")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Compare_Count);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Wxt536 Get Composite Data:Parse_Arguments:"
+						"Illegal compare count %s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Get Composite Data:Parse_Arguments:"
+					"Compare count requires a number.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-c")==0)||(strcmp(argv[i],"-configure")==0))
+		{
+			Configure = TRUE;
+		}
+		else if((strcmp(argv[i],"-d")==0)||(strcmp(argv[i],"-device_address")==0))
+		{
+			if((i+1)<argc)
+			{
+				if(strlen(argv[i+1]) != 1)
+				{
+					fprintf(stderr,"Wxt536 Get Composite Data:Parse_Arguments:"
+						"Illegal device address '%s'.\n",argv[i+1]);
+					return FALSE;
+				}
+				Device_Address = argv[i+1][0];
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Get Composite Data:Parse_Arguments:"
+					"Device Address requires a character.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-h")==0)||(strcmp(argv[i],"-help")==0))
+		{
+			Help();
+			exit(0);
+		}
+		else if((strcmp(argv[i],"-l")==0)||(strcmp(argv[i],"-log_level")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&ivalue);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Wxt536 Get Composite Data:Parse_Arguments:"
+						"Illegal log level %s.\n",argv[i+1]);
+					return FALSE;
+				}
+				Wms_Wxt536_Set_Log_Filter_Level(ivalue);
+				Wms_Serial_Set_Log_Filter_Level(ivalue);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Get Composite Data:Parse_Arguments:"
+					"Log Level requires a number.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-se")==0)||(strcmp(argv[i],"-serial_device")==0))
+		{
+			if((i+1)<argc)
+			{
+				strcpy(Serial_Device_Name,argv[i+1]);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Get Composite Data:Parse_Arguments:"
+					"Device filename requires a filename.\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			fprintf(stderr,"Wxt536 Get Composite Data:Parse_Arguments:argument '%s' not recognized.\n",
+				argv[i]);
+			return FALSE;
+		}			
+	}
+	return TRUE;
+}
+
+/**
+ * Help routine.
+ */
+static void Help(void)
+{
+	fprintf(stdout,"Wxt536 Get Composite Data:Help.\n");
+	fprintf(stdout,"Wxt536 Get Composite Data queries the Vaisala Wxt536 and gets all the current data, "
+		"using the composite data message.\n");
+	fprintf(stdout,"wxt536_command_composite_data_get [-serial_device|-se <filename>][-d[evice_address] <character>]\n");
+	fprintf(stdout,"\t[-c[onfigure]][-compare[_count] <number>][-l[og_level] <number>][-h[elp]]\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t-serial_device specifies the serial device name.\n");
+	fprintf(stdout,"\te.g. /dev/ttyS0 for Linux.\n");
+	fprintf(stdout,"\t-device_address specifies the Wxt536. This character is normally '0'.\n");
+	fprintf(stdout,"\t-configure configures the composite data message fields before getting the data.\n");
+	fprintf(stdout,"\t-compare_count times that number of composite data refreshes, "
+		"and the same number of individual (aR1..aR5) data refreshes.\n");
+	fprintf(stdout,"\t-log_level specifies the logging(0..5).\n");
+}
+
+/**
+ * Time Compare_Count data refreshes using the individual data messages (aR1,aR2,aR3,aR5,aR4), 
+ * and then Compare_Count data refreshes using the composite data message (aR0), and print the average wall time
+ * per refresh for each.
+ * @return The routine returns TRUE on success and FALSE on failure.
+ * @see #Compare_Count
+ * @see #Device_Address
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Wind_Data_Get
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Precipitation_Data_Get
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Supervisor_Data_Get
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Analogue_Data_Get
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Composite_Data_Get
+ */
+static int Compare_Refresh_Times(void)
+{
+	struct Wxt536_Command_Composite_Data_Struct data;
+	struct timespec start_time,end_time;
+	double individual_time,composite_time;
+	int i;
+
+	fprintf(stdout,"Timing %d individual data message refreshes.\n",Compare_Count);
+	clock_gettime(CLOCK_MONOTONIC,&start_time);
+	for(i=0; i < Compare_Count; i++)
+	{
+		if(!Wms_Wxt536_Command_Wind_Data_Get("Wxt536 Get Composite Data","wxt536_command_composite_data_get.c",
+						     Device_Address,&(data.Wind_Data)))
+			return FALSE;
+		if(!Wms_Wxt536_Command_Pressure_Temperature_Humidity_Data_Get("Wxt536 Get Composite Data",
+						"wxt536_command_composite_data_get.c",Device_Address,
+						&(data.Pressure_Temperature_Humidity_Data)))
+			return FALSE;
+		if(!Wms_Wxt536_Command_Precipitation_Data_Get("Wxt536 Get Composite Data",
+							      "wxt536_command_composite_data_get.c",
+							      Device_Address,&(data.Precipitation_Data)))
+			return FALSE;
+		if(!Wms_Wxt536_Command_Supervisor_Data_Get("Wxt536 Get Composite Data",
+							   "wxt536_command_composite_data_get.c",
+							   Device_Address,&(data.Supervisor_Data)))
+			return FALSE;
+		if(!Wms_Wxt536_Command_Analogue_Data_Get("Wxt536 Get Composite Data","wxt536_command_composite_data_get.c",
+							 Device_Address,&(data.Analogue_Data)))
+			return FALSE;
+	}
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+	individual_time = ((double)(end_time.tv_sec-start_time.tv_sec))+
+		(((double)(end_time.tv_nsec-start_time.tv_nsec))/1000000000.0);
+	fprintf(stdout,"Timing %d composite data message refreshes.\n",Compare_Count);
+	clock_gettime(CLOCK_MONOTONIC,&start_time);
+	for(i=0; i < Compare_Count; i++)
+	{
+		if(!Wms_Wxt536_Command_Composite_Data_Get("Wxt536 Get Composite Data",
+							  "wxt536_command_composite_data_get.c",Device_Address,&data))
+			return FALSE;
+	}
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+	composite_time = ((double)(end_time.tv_sec-start_time.tv_sec))+
+		(((double)(end_time.tv_nsec-start_time.tv_nsec))/1000000000.0);
+	fprintf(stdout,"Individual data messages (aR1..aR5): %.3f s per refresh.\n",individual_time/Compare_Count);
+	fprintf(stdout,"Composite data message (aR0): %.3f s per refresh.\n",composite_time/Compare_Count);
+	return TRUE;
+}
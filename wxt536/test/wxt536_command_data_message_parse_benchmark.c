@@ -0,0 +1,499 @@
+/* wxt536_command_data_message_parse_benchmark.c
+** Time parsing a canned Wxt536 composite data message (aR0) with Wms_Wxt536_Command_Data_Message_Parse, against
+** the original linear keyword search and sscanf parsing.
+*/
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_SOURCE 1
+/**
+ * This hash define is needed before including source files give us POSIX.4/IEEE1003.1b-1993 prototypes.
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "log_udp.h"
+#include "wms_wxt536_command.h"
+#include "wms_wxt536_general.h"
+
+/**
+ * Time parsing a canned Wxt536 composite data message (aR0) with Wms_Wxt536_Command_Data_Message_Parse, against
+ * the original linear keyword search and sscanf parsing, and check both produce the same values.
+ * No serial device is needed. The library's parsing routines log at LOGGING > 9, so for meaningful timings the
+ * library should be built with a lower LOGGING level.
+ * @author $Author: cjm $
+ */
+/* hash definitions */
+/**
+ * Default log level.
+ */
+#define DEFAULT_LOG_LEVEL       (LOG_VERBOSITY_TERSE)
+/**
+ * The length of the message buffers.
+ */
+#define MESSAGE_LENGTH          (1024)
+/**
+ * The maximum number of keyword/value pairs in the reference parser's list.
+ */
+#define MAX_PARAMETER_COUNT     (32)
+/**
+ * The number of nanoseconds in one second.
+ */
+#define ONE_SECOND_NS           (1000000000)
+/**
+ * The canned composite data message (aR0) to parse, as returned by our Wxt536 once configured by
+ * Wms_Wxt536_Command_Composite_Data_Configure (so without Tp, Rp, Hp or Id). The message has no CRC.
+ */
+#define COMPOSITE_MESSAGE       ("0R0,Dn=236D,Dm=283D,Dx=031D,Sn=0.0M,Sm=1.0M,Sx=2.2M,Ta=23.6C,Ua=14.2P,Pa=1026.6H,"\
+				 "Rc=0.00M,Rd=0s,Ri=0.0M,Hc=0.0M,Hd=0s,Hi=0.0M,Th=25.9C,Vh=12.0N,Vs=15.2V,Vr=3.475V,"\
+				 "Tr=24.1C,Ra=0.0M,Sl=2.950V,Sr=0.123V")
+
+/* structures */
+/**
+ * Structure holding one keyword/value pair, for the reference parser.
+ * <dl>
+ * <dt>Keyword</dt> <dd>The keyword.</dd>
+ * <dt>Value_String</dt> <dd>The value of the keyword.</dd>
+ * </dl>
+ */
+struct Reference_Parameter_Struct
+{
+	char *Keyword;
+	char *Value_String;
+};
+
+/* internal variables */
+/**
+ * Revision control system identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The number of times to parse the message, for each parser.
+ */
+int Count = 100000;
+
+/* internal routines */
+static int Reference_Parse(char *message,struct Wxt536_Command_Composite_Data_Struct *data);
+static int Reference_Parse_Parameter(struct Reference_Parameter_Struct *parameter_list,int parameter_count,
+				     char *keyword,char *format,void *data_ptr);
+static double Time_Difference_Ns(struct timespec start_time,struct timespec end_time);
+static int Data_Compare(struct Wxt536_Command_Composite_Data_Struct *data,
+			struct Wxt536_Command_Composite_Data_Struct *reference_data);
+static int Parse_Arguments(int argc, char *argv[]);
+static void Help(void);
+
+/**
+ * Main program.
+ * @param argc The number of arguments to the program.
+ * @param argv An array of argument strings.
+ * @return This function returns 0 if the program succeeds, and a positive integer if it fails.
+ * @see #DEFAULT_LOG_LEVEL
+ * @see #MESSAGE_LENGTH
+ * @see #COMPOSITE_MESSAGE
+ * @see #Count
+ * @see #Reference_Parse
+ * @see #Time_Difference_Ns
+ * @see #Data_Compare
+ * @see #Parse_Arguments
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Handler_Function
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Log_Handler_Stdout
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Function
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Log_Filter_Level_Absolute
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Level
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Error
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Data_Message_Parse
+ */
+int main(int argc, char *argv[])
+{
+	struct Wxt536_Command_Composite_Data_Struct data,reference_data;
+	struct timespec start_time,end_time;
+	char message[MESSAGE_LENGTH];
+	double parse_ns,reference_ns;
+	int i,data_mask;
+
+	fprintf(stdout,"Wxt536 Data Message Parse Benchmark\n");
+	/* initialise logging */
+	Wms_Wxt536_Set_Log_Handler_Function(Wms_Wxt536_Log_Handler_Stdout);
+	Wms_Wxt536_Set_Log_Filter_Function(Wms_Wxt536_Log_Filter_Level_Absolute);
+	Wms_Wxt536_Set_Log_Filter_Level(DEFAULT_LOG_LEVEL);
+	fprintf(stdout,"Parsing Arguments.\n");
+	/* parse arguments */
+	if(!Parse_Arguments(argc,argv))
+		return 1;
+	if(Count < 1)
+	{
+		fprintf(stdout,"Wxt536 Data Message Parse Benchmark: Illegal count %d.\n",Count);
+		return 2;
+	}
+	memset(&data,0,sizeof(struct Wxt536_Command_Composite_Data_Struct));
+	memset(&reference_data,0,sizeof(struct Wxt536_Command_Composite_Data_Struct));
+	/* check both parsers produce the same values */
+	strcpy(message,COMPOSITE_MESSAGE);
+	if(!Wms_Wxt536_Command_Data_Message_Parse("Wxt536 Data Message Parse Benchmark",
+						  "wxt536_command_data_message_parse_benchmark.c",'0',message,
+						  &data,&data_mask))
+	{
+		Wms_Wxt536_Error();
+		return 3;
+	}
+	strcpy(message,COMPOSITE_MESSAGE);
+	if(!Reference_Parse(message,&reference_data))
+		return 4;
+	if(data_mask != (WXT536_COMMAND_DATA_WIND|WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY|
+			 WXT536_COMMAND_DATA_PRECIPITATION|WXT536_COMMAND_DATA_SUPERVISOR|
+			 WXT536_COMMAND_DATA_ANALOGUE))
+	{
+		fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Wrong data mask 0x%x.\n",data_mask);
+		return 5;
+	}
+	if(!Data_Compare(&data,&reference_data))
+		return 6;
+	fprintf(stdout,"Both parsers returned the same values.\n");
+	/* time the reference parser */
+	fprintf(stdout,"Parsing the message %d times with each parser.\n",Count);
+	clock_gettime(CLOCK_MONOTONIC,&start_time);
+	for(i = 0; i < Count; i++)
+	{
+		strcpy(message,COMPOSITE_MESSAGE);
+		if(!Reference_Parse(message,&reference_data))
+			return 7;
+	}
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+	reference_ns = Time_Difference_Ns(start_time,end_time)/((double)Count);
+	/* time Wms_Wxt536_Command_Data_Message_Parse */
+	clock_gettime(CLOCK_MONOTONIC,&start_time);
+	for(i = 0; i < Count; i++)
+	{
+		strcpy(message,COMPOSITE_MESSAGE);
+		if(!Wms_Wxt536_Command_Data_Message_Parse("Wxt536 Data Message Parse Benchmark",
+							  "wxt536_command_data_message_parse_benchmark.c",'0',
+							  message,&data,&data_mask))
+		{
+			Wms_Wxt536_Error();
+			return 8;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC,&end_time);
+	parse_ns = Time_Difference_Ns(start_time,end_time)/((double)Count);
+	fprintf(stdout,"Reference (linear search/sscanf) parse: %.1f ns/message.\n",reference_ns);
+	fprintf(stdout,"Wms_Wxt536_Command_Data_Message_Parse: %.1f ns/message.\n",parse_ns);
+	if(parse_ns > 0.0)
+		fprintf(stdout,"Speedup: %.2f.\n",reference_ns/parse_ns);
+	fprintf(stdout,"Wxt536 Data Message Parse Benchmark:Finished.\n");
+	return 0;
+}
+
+/**
+ * Reference parser, a copy of the original data message parsing. The message is split into keyword/value pairs,
+ * each field is found with a linear search of the pairs, and parsed with sscanf.
+ * @param message The message to parse. This is edited in place.
+ * @param data The address of a Wxt536_Command_Composite_Data_Struct to fill in.
+ * @return The routine returns TRUE on success and FALSE on failure.
+ * @see #MAX_PARAMETER_COUNT
+ * @see #Reference_Parameter_Struct
+ * @see #Reference_Parse_Parameter
+ */
+static int Reference_Parse(char *message,struct Wxt536_Command_Composite_Data_Struct *data)
+{
+	struct Reference_Parameter_Struct parameter_list[MAX_PARAMETER_COUNT];
+	char *parameter_ptr = NULL;
+	char *comma_ptr = NULL;
+	char *equals_ptr = NULL;
+	int parameter_count;
+
+	parameter_count = 0;
+	parameter_ptr = strchr(message,',');
+	if(parameter_ptr != NULL)
+	{
+		(*parameter_ptr) = '\0';
+		parameter_ptr++;
+	}
+	while(parameter_ptr != NULL)
+	{
+		if(parameter_count >= MAX_PARAMETER_COUNT)
+		{
+			fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Reference_Parse:Too many parameters.\n");
+			return FALSE;
+		}
+		comma_ptr = strchr(parameter_ptr,',');
+		if(comma_ptr != NULL)
+			(*comma_ptr) = '\0';
+		equals_ptr = strchr(parameter_ptr,'=');
+		if(equals_ptr == NULL)
+		{
+			fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Reference_Parse:No equals sign in '%s'.\n",
+				parameter_ptr);
+			return FALSE;
+		}
+		(*equals_ptr) = '\0';
+		parameter_list[parameter_count].Keyword = parameter_ptr;
+		parameter_list[parameter_count].Value_String = equals_ptr+1;
+		parameter_count++;
+		if(comma_ptr != NULL)
+			parameter_ptr = comma_ptr+1;
+		else
+			parameter_ptr = NULL;
+	}
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Dn","%lfD",&(data->Wind_Data.Wind_Direction_Minimum)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Dm","%lfD",&(data->Wind_Data.Wind_Direction_Average)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Dx","%lfD",&(data->Wind_Data.Wind_Direction_Maximum)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Sn","%lfM",&(data->Wind_Data.Wind_Speed_Minimum)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Sm","%lfM",&(data->Wind_Data.Wind_Speed_Average)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Sx","%lfM",&(data->Wind_Data.Wind_Speed_Maximum)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Ta","%lfC",
+				      &(data->Pressure_Temperature_Humidity_Data.Air_Temperature)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Ua","%lfP",
+				      &(data->Pressure_Temperature_Humidity_Data.Relative_Humidity)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Pa","%lfH",
+				      &(data->Pressure_Temperature_Humidity_Data.Air_Pressure)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Rc","%lfM",
+				      &(data->Precipitation_Data.Rain_Accumulation)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Rd","%lfs",&(data->Precipitation_Data.Rain_Duration)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Ri","%lfM",&(data->Precipitation_Data.Rain_Intensity)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Hc","%lfM",
+				      &(data->Precipitation_Data.Hail_Accumulation)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Hd","%lfs",&(data->Precipitation_Data.Hail_Duration)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Hi","%lfM",&(data->Precipitation_Data.Hail_Intensity)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Th","%lfC",
+				      &(data->Supervisor_Data.Heating_Temperaure)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Vh","%lfN",&(data->Supervisor_Data.Heating_Voltage)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Vs","%lfV",&(data->Supervisor_Data.Supply_Voltage)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Vr","%lfV",&(data->Supervisor_Data.Reference_Voltage)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Tr","%lfC",&(data->Analogue_Data.PT1000_Temperaure)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Ra","%lfM",
+				      &(data->Analogue_Data.Aux_Rain_Accumulation)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Sl","%lfV",
+				      &(data->Analogue_Data.Ultrasonic_Level_Voltage)))
+		return FALSE;
+	if(!Reference_Parse_Parameter(parameter_list,parameter_count,"Sr","%lfV",
+				      &(data->Analogue_Data.Solar_Radiation_Voltage)))
+		return FALSE;
+	return TRUE;
+}
+
+/**
+ * Reference parser routine to find a keyword, with a linear search of the parameter list, and parse it's value
+ * using sscanf.
+ * @param parameter_list The list of keyword/value pairs.
+ * @param parameter_count The number of elements in parameter_list.
+ * @param keyword The keyword to find.
+ * @param format The sscanf format to parse the value with.
+ * @param data_ptr The address to store the parsed value in.
+ * @return The routine returns TRUE on success and FALSE on failure.
+ * @see #Reference_Parameter_Struct
+ */
+static int Reference_Parse_Parameter(struct Reference_Parameter_Struct *parameter_list,int parameter_count,
+				     char *keyword,char *format,void *data_ptr)
+{
+	int index;
+
+	index = 0;
+	while((index < parameter_count)&&strcmp(parameter_list[index].Keyword,keyword))
+		index++;
+	if(index == parameter_count)
+	{
+		fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Reference_Parse_Parameter:"
+			"Failed to find keyword '%s'.\n",keyword);
+		return FALSE;
+	}
+	if(sscanf(parameter_list[index].Value_String,format,data_ptr) != 1)
+	{
+		fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Reference_Parse_Parameter:"
+			"Failed to parse keyword '%s' value '%s'.\n",keyword,parameter_list[index].Value_String);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Return the difference between two times, in nanoseconds.
+ * @param start_time The start time.
+ * @param end_time The end time.
+ * @return The difference (end_time - start_time) in nanoseconds.
+ * @see #ONE_SECOND_NS
+ */
+static double Time_Difference_Ns(struct timespec start_time,struct timespec end_time)
+{
+	return (((double)(end_time.tv_sec-start_time.tv_sec))*((double)ONE_SECOND_NS))+
+		((double)(end_time.tv_nsec-start_time.tv_nsec));
+}
+
+/**
+ * Check the values parsed by Wms_Wxt536_Command_Data_Message_Parse match those parsed by the reference parser.
+ * The values are compared exactly, both parsers should return the nearest double to each value.
+ * @param data The values parsed by Wms_Wxt536_Command_Data_Message_Parse.
+ * @param reference_data The values parsed by the reference parser.
+ * @return The routine returns TRUE if the values match, and FALSE if they do not.
+ */
+static int Data_Compare(struct Wxt536_Command_Composite_Data_Struct *data,
+			struct Wxt536_Command_Composite_Data_Struct *reference_data)
+{
+	double value_list[23],reference_value_list[23];
+	int i;
+
+	value_list[0] = data->Wind_Data.Wind_Direction_Minimum;
+	value_list[1] = data->Wind_Data.Wind_Direction_Average;
+	value_list[2] = data->Wind_Data.Wind_Direction_Maximum;
+	value_list[3] = data->Wind_Data.Wind_Speed_Minimum;
+	value_list[4] = data->Wind_Data.Wind_Speed_Average;
+	value_list[5] = data->Wind_Data.Wind_Speed_Maximum;
+	value_list[6] = data->Pressure_Temperature_Humidity_Data.Air_Temperature;
+	value_list[7] = data->Pressure_Temperature_Humidity_Data.Relative_Humidity;
+	value_list[8] = data->Pressure_Temperature_Humidity_Data.Air_Pressure;
+	value_list[9] = data->Precipitation_Data.Rain_Accumulation;
+	value_list[10] = data->Precipitation_Data.Rain_Duration;
+	value_list[11] = data->Precipitation_Data.Rain_Intensity;
+	value_list[12] = data->Precipitation_Data.Hail_Accumulation;
+	value_list[13] = data->Precipitation_Data.Hail_Duration;
+	value_list[14] = data->Precipitation_Data.Hail_Intensity;
+	value_list[15] = data->Supervisor_Data.Heating_Temperaure;
+	value_list[16] = data->Supervisor_Data.Heating_Voltage;
+	value_list[17] = data->Supervisor_Data.Supply_Voltage;
+	value_list[18] = data->Supervisor_Data.Reference_Voltage;
+	value_list[19] = data->Analogue_Data.PT1000_Temperaure;
+	value_list[20] = data->Analogue_Data.Aux_Rain_Accumulation;
+	value_list[21] = data->Analogue_Data.Ultrasonic_Level_Voltage;
+	value_list[22] = data->Analogue_Data.Solar_Radiation_Voltage;
+	reference_value_list[0] = reference_data->Wind_Data.Wind_Direction_Minimum;
+	reference_value_list[1] = reference_data->Wind_Data.Wind_Direction_Average;
+	reference_value_list[2] = reference_data->Wind_Data.Wind_Direction_Maximum;
+	reference_value_list[3] = reference_data->Wind_Data.Wind_Speed_Minimum;
+	reference_value_list[4] = reference_data->Wind_Data.Wind_Speed_Average;
+	reference_value_list[5] = reference_data->Wind_Data.Wind_Speed_Maximum;
+	reference_value_list[6] = reference_data->Pressure_Temperature_Humidity_Data.Air_Temperature;
+	reference_value_list[7] = reference_data->Pressure_Temperature_Humidity_Data.Relative_Humidity;
+	reference_value_list[8] = reference_data->Pressure_Temperature_Humidity_Data.Air_Pressure;
+	reference_value_list[9] = reference_data->Precipitation_Data.Rain_Accumulation;
+	reference_value_list[10] = reference_data->Precipitation_Data.Rain_Duration;
+	reference_value_list[11] = reference_data->Precipitation_Data.Rain_Intensity;
+	reference_value_list[12] = reference_data->Precipitation_Data.Hail_Accumulation;
+	reference_value_list[13] = reference_data->Precipitation_Data.Hail_Duration;
+	reference_value_list[14] = reference_data->Precipitation_Data.Hail_Intensity;
+	reference_value_list[15] = reference_data->Supervisor_Data.Heating_Temperaure;
+	reference_value_list[16] = reference_data->Supervisor_Data.Heating_Voltage;
+	reference_value_list[17] = reference_data->Supervisor_Data.Supply_Voltage;
+	reference_value_list[18] = reference_data->Supervisor_Data.Reference_Voltage;
+	reference_value_list[19] = reference_data->Analogue_Data.PT1000_Temperaure;
+	reference_value_list[20] = reference_data->Analogue_Data.Aux_Rain_Accumulation;
+	reference_value_list[21] = reference_data->Analogue_Data.Ultrasonic_Level_Voltage;
+	reference_value_list[22] = reference_data->Analogue_Data.Solar_Radiation_Voltage;
+	for(i = 0; i < 23; i++)
+	{
+		if(value_list[i] != reference_value_list[i])
+		{
+			fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Data_Compare:"
+				"Value %d differs (%.6f vs %.6f).\n",i,value_list[i],reference_value_list[i]);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Routine to parse command line arguments.
+ * @param argc The number of arguments sent to the program.
+ * @param argv An array of argument strings.
+ * @see #Help
+ * @see #Count
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Level
+ */
+static int Parse_Arguments(int argc, char *argv[])
+{
+	int i,retval,ivalue;
+
+	for(i=1;i<argc;i++)
+	{
+		if((strcmp(argv[i],"-c")==0)||(strcmp(argv[i],"-count")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Count);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Parse_Arguments:"
+						"Illegal count %s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Parse_Arguments:"
+					"Count requires a number.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-h")==0)||(strcmp(argv[i],"-help")==0))
+		{
+			Help();
+			exit(0);
+		}
+		else if((strcmp(argv[i],"-l")==0)||(strcmp(argv[i],"-log_level")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&ivalue);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Parse_Arguments:"
+						"Illegal log level %s.\n",argv[i+1]);
+					return FALSE;
+				}
+				Wms_Wxt536_Set_Log_Filter_Level(ivalue);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Parse_Arguments:"
+					"Log Level requires a number.\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			fprintf(stderr,"Wxt536 Data Message Parse Benchmark:Parse_Arguments:argument '%s' not recognized.\n",
+				argv[i]);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Help routine.
+ */
+static void Help(void)
+{
+	fprintf(stdout,"Wxt536 Data Message Parse Benchmark:Help.\n");
+	fprintf(stdout,"Wxt536 Data Message Parse Benchmark times parsing a canned composite data message (aR0),\n");
+	fprintf(stdout,"with Wms_Wxt536_Command_Data_Message_Parse and with the original linear search/sscanf parser.\n");
+	fprintf(stdout,"wxt536_command_data_message_parse_benchmark [-c[ount] <number>][-l[og_level] <number>][-h[elp]]\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t-count specifies the number of times to parse the message with each parser.\n");
+	fprintf(stdout,"\t-log_level specifies the logging(0..5).\n");
+	fprintf(stdout,"\tBuild the library with LOGGING less than 10 for meaningful timings.\n");
+}
@@ -0,0 +1,304 @@
+/* wxt536_command_data_message_read.c
+** Open a connection to the Vaisala Wxt536 (which should be in automatic mode), and read and print data messages 
+** as they are sent by the Wxt536.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log_udp.h"
+#include "wms_wxt536_command.h"
+#include "wms_wxt536_connection.h"
+#include "wms_wxt536_general.h"
+#include "wms_serial_general.h"
+
+/**
+ * Open a connection to the Vaisala Wxt536 (which should be in automatic mode), and read and print data messages 
+ * as they are sent by the Wxt536.
+ * @author $Author: cjm $
+ */
+/* hash definitions */
+/**
+ * Default log level.
+ */
+#define DEFAULT_LOG_LEVEL       (LOG_VERBOSITY_VERY_VERBOSE)
+/* internal variables */
+/**
+ * Revision control system identifier.
+ */
+static char rcsid[] = "$Id$";
+/**
+ * The name of the serial device to open.
+ */
+char Serial_Device_Name[256];
+/**
+ * A character identifying the Vaisala Wxt536 device address to tested.
+ */
+char Device_Address = ' ';
+/**
+ * The number of lines to read from the Wxt536 before exiting.
+ */
+int Line_Count = 10;
+
+/* internal routines */
+static int Parse_Arguments(int argc, char *argv[]);
+static void Help(void);
+
+/**
+ * Main program.
+ * @param argc The number of arguments to the program.
+ * @param argv An array of argument strings.
+ * @return This function returns 0 if the program succeeds, and a positive integer if it fails.
+ * @see #DEFAULT_LOG_LEVEL
+ * @see #Serial_Device_Name
+ * @see #Device_Address
+ * @see #Line_Count
+ * @see #Parse_Arguments
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Handler_Function
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Log_Handler_Stdout
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Function
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Log_Filter_Level_Absolute
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Level
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Error
+ * @see ../cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Open
+ * @see ../cdocs/wms_wxt536_connection.html#Wms_Wxt536_Connection_Close
+ * @see ../cdocs/wms_wxt536_command.html#Wms_Wxt536_Command_Data_Message_Read
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Handler_Function
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Log_Handler_Stdout
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Function
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Log_Filter_Level_Absolute
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Level
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Get_Error_Number
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Error
+ */
+int main(int argc, char *argv[])
+{
+	struct Wxt536_Command_Composite_Data_Struct data;
+	int i,data_mask;
+
+	fprintf(stdout,"Wxt536 Data Message Read\n");
+	/* initialise logging */
+	Wms_Wxt536_Set_Log_Handler_Function(Wms_Wxt536_Log_Handler_Stdout);
+	Wms_Wxt536_Set_Log_Filter_Function(Wms_Wxt536_Log_Filter_Level_Absolute);
+	Wms_Wxt536_Set_Log_Filter_Level(DEFAULT_LOG_LEVEL);
+	Wms_Serial_Set_Log_Handler_Function(Wms_Serial_Log_Handler_Stdout);
+	Wms_Serial_Set_Log_Filter_Function(Wms_Serial_Log_Filter_Level_Absolute);
+	Wms_Serial_Set_Log_Filter_Level(DEFAULT_LOG_LEVEL);
+	fprintf(stdout,"Parsing Arguments.\n");
+	/* parse arguments */
+	if(!Parse_Arguments(argc,argv))
+		return 1;
+	/* open interface */
+	if(strlen(Serial_Device_Name) < 1)
+	{
+		fprintf(stdout,"Wxt536 Data Message Read: Specify a serial device filename.\n");
+		return 2;
+	}
+	if(!Wms_Wxt536_Connection_Open("Wxt536 Data Message Read","wxt536_command_data_message_read.c",
+				       Serial_Device_Name))
+	{
+		Wms_Wxt536_Error();
+		if(Wms_Serial_Get_Error_Number() != 0)
+			Wms_Serial_Error();
+		return 3;
+	}
+	/* read data messages */
+	memset(&data,0,sizeof(struct Wxt536_Command_Composite_Data_Struct));
+	fprintf(stdout,"Reading %d lines from Wxt536 with Device Address %c.\n",Line_Count,Device_Address);
+	for(i = 0; i < Line_Count; i++)
+	{
+		if(!Wms_Wxt536_Command_Data_Message_Read("Wxt536 Data Message Read","wxt536_command_data_message_read.c",
+							 Device_Address,WMS_SERIAL_READ_TIMEOUT_DEFAULT,&data,&data_mask))
+		{
+			/* a line that failed it's CRC check, carry on with the next one */
+			if(Wms_Wxt536_Error_Number == 181)
+			{
+				Wms_Wxt536_Error();
+				continue;
+			}
+			Wms_Wxt536_Error();
+			if(Wms_Serial_Get_Error_Number() != 0)
+				Wms_Serial_Error();
+			return 4;
+		}
+		fprintf(stdout,"Line %d: Data mask 0x%x.\n",i,data_mask);
+		if(data_mask & WXT536_COMMAND_DATA_WIND)
+		{
+			fprintf(stdout,"Wind Direction: Minimum %.2f deg, Average %.2f deg, Maximum %.2f deg.\n",
+				data.Wind_Data.Wind_Direction_Minimum,data.Wind_Data.Wind_Direction_Average,
+				data.Wind_Data.Wind_Direction_Maximum);
+			fprintf(stdout,"Wind Speed: Minimum %.2f m/s, Average %.2f m/s, Maximum %.2f m/s.\n",
+				data.Wind_Data.Wind_Speed_Minimum,data.Wind_Data.Wind_Speed_Average,
+				data.Wind_Data.Wind_Speed_Maximum);
+			fprintf(stdout,"Wind valid mask 0x%x.\n",data.Wind_Data.Valid_Mask);
+		}
+		if(data_mask & WXT536_COMMAND_DATA_PRESSURE_TEMPERATURE_HUMIDITY)
+		{
+			fprintf(stdout,"Air Temperature: %.2f C, Relative Humidity: %.2f %%, Air Pressure: %.2f hPa.\n",
+				data.Pressure_Temperature_Humidity_Data.Air_Temperature,
+				data.Pressure_Temperature_Humidity_Data.Relative_Humidity,
+				data.Pressure_Temperature_Humidity_Data.Air_Pressure);
+			fprintf(stdout,"Pressure/Temperature/Humidity valid mask 0x%x.\n",
+				data.Pressure_Temperature_Humidity_Data.Valid_Mask);
+		}
+		if(data_mask & WXT536_COMMAND_DATA_PRECIPITATION)
+		{
+			fprintf(stdout,"Rain Accumulation: %.2f mm, Duration: %.2f s, Intensity: %.2f mm/h.\n",
+				data.Precipitation_Data.Rain_Accumulation,data.Precipitation_Data.Rain_Duration,
+				data.Precipitation_Data.Rain_Intensity);
+			fprintf(stdout,"Precipitation valid mask 0x%x.\n",data.Precipitation_Data.Valid_Mask);
+		}
+		if(data_mask & WXT536_COMMAND_DATA_SUPERVISOR)
+		{
+			fprintf(stdout,"Heating Temperature: %.2f C, Heating Voltage: %.2f V, Supply Voltage: %.2f V, "
+				"Reference Voltage: %.2f V.\n",
+				data.Supervisor_Data.Heating_Temperaure,data.Supervisor_Data.Heating_Voltage,
+				data.Supervisor_Data.Supply_Voltage,data.Supervisor_Data.Reference_Voltage);
+			fprintf(stdout,"Supervisor valid mask 0x%x.\n",data.Supervisor_Data.Valid_Mask);
+		}
+		if(data_mask & WXT536_COMMAND_DATA_ANALOGUE)
+		{
+			fprintf(stdout,"PT1000 Temperature: %.2f C, Aux Rain Accumulation: %.2f mm, "
+				"Ultrasonic Level Voltage: %.2f V, Solar Radiation Voltage: %.2f V.\n",
+				data.Analogue_Data.PT1000_Temperaure,data.Analogue_Data.Aux_Rain_Accumulation,
+				data.Analogue_Data.Ultrasonic_Level_Voltage,data.Analogue_Data.Solar_Radiation_Voltage);
+			fprintf(stdout,"Analogue valid mask 0x%x.\n",data.Analogue_Data.Valid_Mask);
+		}
+	}
+	/* close interface */
+	if(!Wms_Wxt536_Connection_Close("Wxt536 Data Message Read","wxt536_command_data_message_read.c"))
+	{
+		Wms_Wxt536_Error();
+		if(Wms_Serial_Get_Error_Number() != 0)
+			Wms_Serial_Error();
+		return 5;
+	}
+	fprintf(stdout,"Wxt536 Data Message Read:Finished.\n");
+	return 0;
+}
+
+/**
+ * Routine to parse command line arguments.
+ * @param argc The number of arguments sent to the program.
+ * @param argv An array of argument strings.
+ * @see #Help
+ * @see #Serial_Device_Name
+ * @see #Device_Address
+ * @see #Line_Count
+ * @see ../cdocs/wms_wxt536_general.html#Wms_Wxt536_Set_Log_Filter_Level
+ * @see ../../serial/cdocs/wms_serial_general.html#Wms_Serial_Set_Log_Filter_Level
+ */
+static int Parse_Arguments(int argc, char *argv[])
+{
+	int i,retval,ivalue;
+
+	for(i=1;i<argc;i++)
+	{
+		if((strcmp(argv[i],"-c")==0)||(strcmp(argv[i],"-count")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&Line_Count);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Wxt536 Data Message Read:Parse_Arguments:"
+						"Illegal line count %s.\n",argv[i+1]);
+					return FALSE;
+				}
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Data Message Read:Parse_Arguments:"
+					"Line count requires a number.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-d")==0)||(strcmp(argv[i],"-device_address")==0))
+		{
+			if((i+1)<argc)
+			{
+				if(strlen(argv[i+1]) != 1)
+				{
+					fprintf(stderr,"Wxt536 Data Message Read:Parse_Arguments:"
+						"Illegal device address '%s'.\n",argv[i+1]);
+					return FALSE;
+				}
+				Device_Address = argv[i+1][0];
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Data Message Read:Parse_Arguments:"
+					"Device Address requires a character.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-h")==0)||(strcmp(argv[i],"-help")==0))
+		{
+			Help();
+			exit(0);
+		}
+		else if((strcmp(argv[i],"-l")==0)||(strcmp(argv[i],"-log_level")==0))
+		{
+			if((i+1)<argc)
+			{
+				retval = sscanf(argv[i+1],"%d",&ivalue);
+				if(retval != 1)
+				{
+					fprintf(stderr,"Wxt536 Data Message Read:Parse_Arguments:"
+						"Illegal log level %s.\n",argv[i+1]);
+					return FALSE;
+				}
+				Wms_Wxt536_Set_Log_Filter_Level(ivalue);
+				Wms_Serial_Set_Log_Filter_Level(ivalue);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Data Message Read:Parse_Arguments:"
+					"Log Level requires a number.\n");
+				return FALSE;
+			}
+		}
+		else if((strcmp(argv[i],"-se")==0)||(strcmp(argv[i],"-serial_device")==0))
+		{
+			if((i+1)<argc)
+			{
+				strcpy(Serial_Device_Name,argv[i+1]);
+				i++;
+			}
+			else
+			{
+				fprintf(stderr,"Wxt536 Data Message Read:Parse_Arguments:"
+					"Device filename requires a filename.\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			fprintf(stderr,"Wxt536 Data Message Read:Parse_Arguments:argument '%s' not recognized.\n",
+				argv[i]);
+			return FALSE;
+		}			
+	}
+	return TRUE;
+}
+
+/**
+ * Help routine.
+ */
+static void Help(void)
+{
+	fprintf(stdout,"Wxt536 Data Message Read:Help.\n");
+	fprintf(stdout,"Wxt536 Data Message Read reads data messages sent by a Vaisala Wxt536 in automatic mode.\n");
+	fprintf(stdout,"wxt536_command_data_message_read [-serial_device|-se <filename>][-d[evice_address] <character>]\n");
+	fprintf(stdout,"\t[-c[ount] <number>][-l[og_level] <number>][-h[elp]]\n");
+	fprintf(stdout,"\n");
+	fprintf(stdout,"\t-serial_device specifies the serial device name.\n");
+	fprintf(stdout,"\te.g. /dev/ttyS0 for Linux.\n");
+	fprintf(stdout,"\t-device_address specifies the Wxt536. This character is normally '0'.\n");
+	fprintf(stdout,"\t-count specifies the number of lines to read from the Wxt536 before exiting.\n");
+	fprintf(stdout,"\t-log_level specifies the logging(0..5).\n");
+	fprintf(stdout,"\tThe Wxt536 should previously have been put into automatic mode, \n");
+	fprintf(stdout,"\tusing wxt536_command_comms_protocol_set -protocol A.\n");
+}